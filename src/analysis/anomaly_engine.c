@@ -0,0 +1,123 @@
+/**
+ * Anomaly Engine - Detector registry plus result bookkeeping
+ */
+
+#include <float.h>
+#include <string.h>
+#include "anomaly_engine.h"
+
+void anomaly_engine_init(AnomalyEngine_t* engine, DetectorClockFn clock_us) {
+    memset(engine, 0, sizeof(AnomalyEngine_t));
+    engine->results.health_score = 100.0;
+
+    detector_registry_init(&engine->registry, clock_us);
+#if ANALYSIS_USE_FIXED_POINT
+    // Float-only detectors stay out of the integer build: the Mahalanobis
+    // update is O(d^2) float work on every sample. sigma3q15 watches its
+    // channels instead.
+    detector_registry_add(&engine->registry, &sigma_q15_detector_ops, 1.0f, true);
+#else
+    detector_registry_add(&engine->registry, &sigma_detector_ops, 1.0f, true);
+    detector_registry_add(&engine->registry, &mahalanobis_detector_ops, 1.0f, true);
+#endif
+
+    for (uint32_t scale = 0; scale < TREND_SCALES; scale++) {
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            trend_init(&engine->channel_trend[ch][scale], trend_time_constant_s[scale]);
+        }
+        trend_init(&engine->health_trend[scale], trend_time_constant_s[scale]);
+    }
+}
+
+void anomaly_engine_feed(AnomalyEngine_t* engine, const SensorData_t* sample) {
+    detector_registry_update(&engine->registry, sample);
+    engine->latest = *sample;
+    engine->fed_since_evaluate++;
+}
+
+// Advance every trend by the time since the previous cycle's newest sample
+static void update_trends(AnomalyEngine_t* engine, const ThresholdConfig_t* thresholds,
+                          float health) {
+    if (engine->fed_since_evaluate == 0) {
+        return;     // Nothing new: re-evaluation must not add duplicate points
+    }
+    engine->fed_since_evaluate = 0;
+
+    uint32_t now = engine->latest.timestamp;
+    float dt_s = 0.0f;
+    if (engine->trend_started) {
+        dt_s = (float)(uint32_t)(now - engine->trend_timestamp) / TREND_TIMESTAMP_HZ;
+    }
+    engine->trend_timestamp = now;
+    engine->trend_started = true;
+
+    for (uint32_t scale = 0; scale < TREND_SCALES; scale++) {
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            TrendEstimator_t* trend = &engine->channel_trend[ch][scale];
+            const ChannelLimits_t* limits = &thresholds->channels[ch];
+            if (trend_update(trend, dt_s, engine->latest.values[ch],
+                             limits->critical_low, limits->critical_high)) {
+                engine->results.channel_trend[ch][scale] = trend->result;
+            }
+        }
+        TrendEstimator_t* trend = &engine->health_trend[scale];
+        if (trend_update(trend, dt_s, health, TREND_HEALTH_LIMIT, FLT_MAX)) {
+            engine->results.health_trend[scale] = trend->result;
+        }
+    }
+}
+
+// Evaluate the detectors and fold the verdict into the running results
+uint32_t anomaly_engine_evaluate(AnomalyEngine_t* engine, const ThresholdConfig_t* thresholds,
+                                 bool emergency_stop) {
+    uint32_t flags = 0;
+    float health = detector_registry_evaluate(&engine->registry, thresholds, &flags);
+
+    uint32_t anomaly_count = 0;
+    for (uint32_t bits = flags; bits != 0; bits &= bits - 1) {
+        anomaly_count++;
+    }
+
+    if (emergency_stop) {
+        health = 0;
+    }
+
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        engine->results.channel_anomaly[ch] = (flags & CHANNEL_FLAG(ch)) != 0;
+    }
+    engine->results.anomaly_flags = flags;
+    engine->results.anomaly_count += anomaly_count;
+    engine->results.health_score = health;
+    engine->last_flags = flags;
+    engine->cycles++;
+
+    update_trends(engine, thresholds, health);
+
+    return flags;
+}
+
+// Baselines are established once a full window has been fed
+bool anomaly_engine_ready(const AnomalyEngine_t* engine) {
+    return engine->registry.samples_seen >= BASELINE_WINDOW;
+}
+
+bool anomaly_results_earliest_limit(const AnomalyResults_t* results, TrendScale_t min_scale,
+                                    float* hours, int* channel) {
+    bool found = false;
+
+    for (uint32_t scale = min_scale; scale < TREND_SCALES; scale++) {
+        for (int ch = -1; ch < (int)CHANNEL_COUNT; ch++) {
+            const TrendResult_t* trend = ch < 0 ? &results->health_trend[scale]
+                                                : &results->channel_trend[ch][scale];
+            if (!trend->valid || trend->hours_to_limit == TREND_NO_CROSSING) {
+                continue;
+            }
+            if (!found || trend->hours_to_limit < *hours) {
+                *hours = trend->hours_to_limit;
+                *channel = ch;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
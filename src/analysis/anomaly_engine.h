@@ -0,0 +1,45 @@
+#ifndef ANOMALY_ENGINE_H
+#define ANOMALY_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_types.h"
+#include "detector.h"
+
+// Health score at which a trend projects failure
+#define TREND_HEALTH_LIMIT      50.0f
+// Sample timestamps count milliseconds (system ticks at 1kHz, trace timestamps)
+#define TREND_TIMESTAMP_HZ      1000
+
+// Complete detection pipeline for one turbine, with no kernel dependency.
+// The anomaly task and the offline tools drive the same engine: feed() every
+// sample, evaluate() once per cycle. Each cycle also advances the trend of
+// every channel and of the health score at three time scales.
+typedef struct {
+    DetectorRegistry_t registry;
+    AnomalyResults_t results;
+    uint32_t last_flags;
+    uint32_t cycles;
+
+    // Trend estimators, fed once per cycle with the newest sample
+    TrendEstimator_t channel_trend[CHANNEL_COUNT][TREND_SCALES];
+    TrendEstimator_t health_trend[TREND_SCALES];
+    SensorData_t latest;
+    uint32_t fed_since_evaluate;
+    uint32_t trend_timestamp;
+    bool trend_started;
+} AnomalyEngine_t;
+
+void anomaly_engine_init(AnomalyEngine_t* engine, DetectorClockFn clock_us);
+void anomaly_engine_feed(AnomalyEngine_t* engine, const SensorData_t* sample);
+uint32_t anomaly_engine_evaluate(AnomalyEngine_t* engine, const ThresholdConfig_t* thresholds,
+                                 bool emergency_stop);
+bool anomaly_engine_ready(const AnomalyEngine_t* engine);
+
+// Soonest projected limit crossing over the scales from min_scale up, for
+// maintenance scheduling. channel is the channel index, or -1 for the health
+// score. Returns false if no trend projects a crossing.
+bool anomaly_results_earliest_limit(const AnomalyResults_t* results, TrendScale_t min_scale,
+                                    float* hours, int* channel);
+
+#endif // ANOMALY_ENGINE_H
@@ -0,0 +1,131 @@
+/**
+ * Checkpoint - Detector state persisted for a warm start
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "checkpoint.h"
+
+#define FNV_OFFSET      2166136261u
+#define FNV_PRIME       16777619u
+
+const char* const checkpoint_result_names[] = {
+    "ok", "missing", "corrupt", "incompatible", "stale"
+};
+
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// What a state block means depends on the channel table and the window sizes
+static uint32_t layout_hash(void) {
+    const uint32_t constants[] = { CHANNEL_COUNT, HISTORY_SIZE, BASELINE_WINDOW, sizeof(float) };
+    uint32_t hash = fnv1a(FNV_OFFSET, constants, sizeof(constants));
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        hash = fnv1a(hash, sensor_channels[ch].name, strlen(sensor_channels[ch].name) + 1);
+    }
+    return hash;
+}
+
+void checkpoint_capture(Checkpoint_t* cp, const AnomalyEngine_t* engine, uint32_t flags, uint32_t now_s) {
+    CheckpointHeader_t* header = &cp->header;
+    const DetectorRegistry_t* reg = &engine->registry;
+
+    memset(header, 0, sizeof(*header));
+    header->magic = CHECKPOINT_MAGIC;
+    header->version = CHECKPOINT_VERSION;
+    header->layout = layout_hash();
+    header->flags = flags;
+    header->saved_s = now_s;
+    header->samples_seen = reg->samples_seen;
+    header->detector_count = reg->count;
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < reg->count; i++) {
+        const DetectorSlot_t* slot = &reg->slots[i];
+        strncpy(header->detectors[i].name, slot->ops->name, DETECTOR_NAME_LEN - 1);
+        header->detectors[i].state_size = (uint32_t)slot->ops->state_size;
+        memcpy(cp->payload + offset, slot->state, slot->ops->state_size);
+        offset += (uint32_t)slot->ops->state_size;
+    }
+    header->payload_bytes = offset;
+    header->checksum = fnv1a(FNV_OFFSET, cp->payload, offset);
+}
+
+bool checkpoint_write(const Checkpoint_t* cp, const char* path) {
+    char tmp[256];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return false;
+    }
+    FILE* file = fopen(tmp, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = fwrite(&cp->header, sizeof(cp->header), 1, file) == 1 &&
+              fwrite(cp->payload, 1, cp->header.payload_bytes, file) == cp->header.payload_bytes;
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+CheckpointResult_t checkpoint_read(Checkpoint_t* cp, const char* path, uint32_t now_s, uint32_t max_age_s) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return CHECKPOINT_MISSING;
+    }
+    CheckpointHeader_t* header = &cp->header;
+    bool complete = fread(header, sizeof(*header), 1, file) == 1 &&
+                    header->magic == CHECKPOINT_MAGIC &&
+                    header->payload_bytes <= sizeof(cp->payload) &&
+                    fread(cp->payload, 1, header->payload_bytes, file) == header->payload_bytes;
+    fclose(file);
+
+    if (!complete || header->checksum != fnv1a(FNV_OFFSET, cp->payload, header->payload_bytes)) {
+        return CHECKPOINT_CORRUPT;
+    }
+    if (header->version != CHECKPOINT_VERSION || header->layout != layout_hash() ||
+        header->detector_count > MAX_DETECTORS) {
+        return CHECKPOINT_INCOMPATIBLE;
+    }
+    if (max_age_s > 0 && now_s - header->saved_s > max_age_s) {
+        return CHECKPOINT_STALE;
+    }
+    return CHECKPOINT_OK;
+}
+
+CheckpointResult_t checkpoint_apply(const Checkpoint_t* cp, AnomalyEngine_t* engine) {
+    const CheckpointHeader_t* header = &cp->header;
+    DetectorRegistry_t* reg = &engine->registry;
+
+    // Every block must land in a detector of the same name and size
+    if (header->detector_count != reg->count) {
+        return CHECKPOINT_INCOMPATIBLE;
+    }
+    for (uint32_t i = 0; i < reg->count; i++) {
+        const DetectorOps_t* ops = reg->slots[i].ops;
+        if (strncmp(header->detectors[i].name, ops->name, DETECTOR_NAME_LEN - 1) != 0 ||
+            header->detectors[i].state_size != ops->state_size) {
+            return CHECKPOINT_INCOMPATIBLE;
+        }
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < reg->count; i++) {
+        DetectorSlot_t* slot = &reg->slots[i];
+        memcpy(slot->state, cp->payload + offset, slot->ops->state_size);
+        offset += (uint32_t)slot->ops->state_size;
+    }
+    reg->samples_seen = header->samples_seen;
+    return CHECKPOINT_OK;
+}
+
+uint32_t checkpoint_bytes(const Checkpoint_t* cp) {
+    return (uint32_t)sizeof(cp->header) + cp->header.payload_bytes;
+}
@@ -0,0 +1,73 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "anomaly_engine.h"
+
+// Warm-start checkpoint of the anomaly engine: every detector's state block
+// (baselines, rolling windows, covariance) and the samples seen, so that a
+// restart is ready within one cycle instead of after BASELINE_WINDOW new
+// samples. Trends and results are not kept; they rebuild from the next cycle.
+//
+// The file is a header followed by the state blocks in registry order, in
+// the writer's native layout. It is only restored into a build with the
+// same version, channel table and detector names and state sizes, and only
+// if its checksum matches and it is not older than the caller allows.
+#define CHECKPOINT_MAGIC            0x4B435754u     // "TWCK"
+#define CHECKPOINT_VERSION          1
+
+// Header flags, owned by the caller
+#define CHECKPOINT_FLAG_SENSORS_CALIBRATED  0x01u
+
+typedef enum {
+    CHECKPOINT_OK,
+    CHECKPOINT_MISSING,         // No file
+    CHECKPOINT_CORRUPT,         // Short, bad magic or bad checksum
+    CHECKPOINT_INCOMPATIBLE,    // Other version, channel table or detector set
+    CHECKPOINT_STALE            // Older than the caller's limit
+} CheckpointResult_t;
+
+extern const char* const checkpoint_result_names[];
+
+typedef struct {
+    char name[DETECTOR_NAME_LEN];
+    uint32_t state_size;
+} CheckpointDetector_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout;            // Hash of the channel table and detection constants
+    uint32_t flags;
+    uint32_t saved_s;           // Caller's clock (seconds) at capture
+    uint32_t samples_seen;
+    uint32_t detector_count;
+    uint32_t payload_bytes;
+    uint32_t checksum;          // FNV-1a of the payload
+    CheckpointDetector_t detectors[MAX_DETECTORS];
+} CheckpointHeader_t;
+
+typedef struct {
+    CheckpointHeader_t header;
+    uint8_t payload[DETECTOR_ARENA_SIZE];   // State blocks back to back
+} Checkpoint_t;
+
+// Copy the engine's detector states into cp (no I/O)
+void checkpoint_capture(Checkpoint_t* cp, const AnomalyEngine_t* engine, uint32_t flags, uint32_t now_s);
+
+// Write cp to path through path.tmp and a rename, so a crash mid-write
+// leaves the previous checkpoint in place. Returns false on any I/O error.
+bool checkpoint_write(const Checkpoint_t* cp, const char* path);
+
+// Read and validate path into cp. max_age_s 0 accepts any age.
+CheckpointResult_t checkpoint_read(Checkpoint_t* cp, const char* path, uint32_t now_s, uint32_t max_age_s);
+
+// Restore a read checkpoint into an engine initialised with anomaly_engine_init.
+// CHECKPOINT_INCOMPATIBLE leaves the engine untouched.
+CheckpointResult_t checkpoint_apply(const Checkpoint_t* cp, AnomalyEngine_t* engine);
+
+// Bytes checkpoint_write puts on disk
+uint32_t checkpoint_bytes(const Checkpoint_t* cp);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,125 @@
+/**
+ * Decimator - Polyphase FIR decimation for high-rate sensor channels
+ */
+
+#include <math.h>
+#include <string.h>
+#include "decimator.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Windowed-sinc low-pass with its cutoff at the output Nyquist rate, unity DC gain
+static void stage_init(DecimatorStage_t* st, uint32_t factor) {
+    memset(st, 0, sizeof(*st));
+    st->factor = factor;
+    st->taps = DECIMATOR_TAPS_PER_PHASE * factor;
+    st->phase = factor;
+
+    float cutoff = 0.5f / (float)factor;    // cycles per input sample
+    float center = (float)(st->taps - 1) / 2.0f;
+    float sum = 0.0f;
+
+    for (uint32_t k = 0; k < st->taps; k++) {
+        float t = (float)k - center;
+        float sinc = (t == 0.0f) ? 2.0f * cutoff
+                                 : sinf(2.0f * (float)M_PI * cutoff * t) / ((float)M_PI * t);
+        float window = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * (float)k / (float)(st->taps - 1));
+        st->coeffs[k] = sinc * window;
+        sum += st->coeffs[k];
+    }
+    for (uint32_t k = 0; k < st->taps; k++) {
+        st->coeffs[k] /= sum;
+    }
+}
+
+// Returns true when a frame of M inputs completed and *out holds its output
+static bool stage_push(DecimatorStage_t* st, float value, float* out) {
+    const uint32_t frames = DECIMATOR_TAPS_PER_PHASE;
+    const uint32_t m = st->factor;
+
+    // Start from steady state instead of ramping up from zero
+    if (!st->primed) {
+        for (uint32_t i = 0; i < 2 * st->taps; i++) {
+            st->delay[i] = value;
+        }
+        st->primed = true;
+    }
+
+    // First input of a frame: the oldest frame slot becomes the newest
+    if (st->phase == m) {
+        st->head = (st->head + frames - 1) % frames;
+    }
+
+    // Inputs of a frame arrive for branches M-1 .. 0
+    uint32_t branch = st->phase - 1;
+    st->delay[st->head * m + branch] = value;
+    st->delay[(st->head + frames) * m + branch] = value;
+
+    if (--st->phase > 0) {
+        return false;
+    }
+    st->phase = m;
+
+    // delay[head*M + j*M + p] = x[(n-j)M - p], so the taps line up in order
+    const float* x = &st->delay[st->head * m];
+    float acc = 0.0f;
+    for (uint32_t k = 0; k < st->taps; k++) {
+        acc += st->coeffs[k] * x[k];
+    }
+    *out = acc;
+    return true;
+}
+
+bool decimator_init(Decimator_t* dec, uint32_t factor) {
+    memset(dec, 0, sizeof(*dec));
+    if (factor == 0) {
+        return false;
+    }
+    dec->factor = factor;
+
+    // Largest stage factor first, so later stages run at the lowest rate
+    uint32_t remaining = factor;
+    while (remaining > 1) {
+        uint32_t stage_factor = 0;
+        for (uint32_t d = DECIMATOR_MAX_STAGE_FACTOR; d >= 2; d--) {
+            if (remaining % d == 0) {
+                stage_factor = d;
+                break;
+            }
+        }
+        if (stage_factor == 0 || dec->stage_count >= DECIMATOR_MAX_STAGES) {
+            return false;
+        }
+        stage_init(&dec->stages[dec->stage_count++], stage_factor);
+        remaining /= stage_factor;
+    }
+    return true;
+}
+
+void decimator_reset(Decimator_t* dec) {
+    for (uint32_t s = 0; s < dec->stage_count; s++) {
+        DecimatorStage_t* st = &dec->stages[s];
+        st->phase = st->factor;
+        st->head = 0;
+        st->primed = false;
+    }
+}
+
+uint32_t decimator_push(Decimator_t* dec, const float* in, uint32_t count,
+                        float* out, uint32_t max_out) {
+    uint32_t produced = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        float value = in[i];
+        uint32_t s = 0;
+        while (s < dec->stage_count && stage_push(&dec->stages[s], value, &value)) {
+            s++;
+        }
+        if (s == dec->stage_count && produced < max_out) {
+            out[produced++] = value;
+        }
+    }
+    return produced;
+}
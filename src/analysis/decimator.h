@@ -0,0 +1,42 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Polyphase FIR decimation. Each stage low-pass filters and keeps every
+// M-th sample, computing only the kept outputs: TAPS_PER_PHASE * M taps per
+// output, TAPS_PER_PHASE multiply-adds per input sample.
+#define DECIMATOR_TAPS_PER_PHASE    6
+#define DECIMATOR_MAX_STAGE_FACTOR  10
+#define DECIMATOR_MAX_STAGES        3
+#define DECIMATOR_MAX_TAPS          (DECIMATOR_TAPS_PER_PHASE * DECIMATOR_MAX_STAGE_FACTOR)
+
+typedef struct {
+    uint32_t factor;                        // M
+    uint32_t taps;                          // TAPS_PER_PHASE * M
+    uint32_t phase;                         // Next input goes to branch phase-1
+    uint32_t head;                          // Newest frame in the delay line
+    bool primed;                            // Delay line filled with the first sample
+    float coeffs[DECIMATOR_MAX_TAPS];
+    // Frames of M inputs, newest first, stored twice so the dot product
+    // over TAPS_PER_PHASE frames never wraps. Column p is polyphase branch p.
+    float delay[2 * DECIMATOR_MAX_TAPS];
+} DecimatorStage_t;
+
+// Cascade of stages for factors above DECIMATOR_MAX_STAGE_FACTOR (100 = 10 x 10)
+typedef struct {
+    uint32_t factor;
+    uint32_t stage_count;
+    DecimatorStage_t stages[DECIMATOR_MAX_STAGES];
+} Decimator_t;
+
+// False if factor cannot be split into stages of at most DECIMATOR_MAX_STAGE_FACTOR
+bool decimator_init(Decimator_t* dec, uint32_t factor);
+void decimator_reset(Decimator_t* dec);
+
+// Feed input samples; returns the number of decimated samples written to out
+uint32_t decimator_push(Decimator_t* dec, const float* in, uint32_t count,
+                        float* out, uint32_t max_out);
+
+#endif // DECIMATOR_H
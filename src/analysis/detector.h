@@ -0,0 +1,96 @@
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sensor_types.h"
+
+// Detection parameters (shared by the task and the statistical detectors)
+#define HISTORY_SIZE           100
+#define BASELINE_WINDOW        20
+
+// Registry limits
+#define MAX_DETECTORS          4
+#define DETECTOR_NAME_LEN      12
+
+// Per-registry state arena (detector states are carved from it at registration)
+#define DETECTOR_ARENA_SIZE    4096
+
+// Detector interface
+// A detector owns an opaque state block of state_size bytes. update() is called
+// for every sample taken off the sensor queue, evaluate() once per anomaly cycle
+// and returns the CHANNEL_FLAG() bits it raises, score() returns the health
+// penalty (0-100) computed by the last evaluate().
+typedef struct {
+    const char* name;
+    size_t state_size;
+    void     (*init)(void* state);
+    void     (*update)(void* state, const SensorData_t* sample);
+    uint32_t (*evaluate)(void* state, const ThresholdConfig_t* thresholds);
+    float    (*score)(const void* state);
+} DetectorOps_t;
+
+// Microsecond clock used for cost accounting (NULL disables it)
+typedef uint32_t (*DetectorClockFn)(void);
+
+// Per-detector cost and output, as published to the dashboard
+typedef struct {
+    char name[DETECTOR_NAME_LEN];
+    bool enabled;
+    uint32_t flags;          // Anomaly flags raised in the last cycle
+    float score;             // Health penalty from the last cycle
+    uint32_t avg_cycle_us;   // Average CPU time per anomaly cycle
+    uint32_t max_cycle_us;   // Worst CPU time in a single cycle
+    uint32_t memory_bytes;   // Detector state footprint
+} DetectorStats_t;
+
+// Per-detector cost accounting (microseconds from the registry clock)
+typedef struct {
+    uint32_t update_calls;
+    uint32_t evaluate_calls;
+    uint64_t update_us;
+    uint64_t evaluate_us;
+    uint32_t max_cycle_us;      // Worst update+evaluate time within one cycle
+    uint32_t pending_us;        // Update time accumulated since last evaluate
+} DetectorCost_t;
+
+typedef struct {
+    const DetectorOps_t* ops;
+    void* state;
+    float weight;               // Contribution of score() to the fused penalty
+    bool enabled;
+    uint32_t last_flags;
+    float last_score;
+    DetectorCost_t cost;
+} DetectorSlot_t;
+
+typedef struct {
+    DetectorSlot_t slots[MAX_DETECTORS];
+    uint32_t count;
+    uint32_t samples_seen;
+    DetectorClockFn clock_us;
+    size_t arena_used;
+    union {
+        double align;           // Keep detector states suitably aligned
+        uint8_t bytes[DETECTOR_ARENA_SIZE];
+    } arena;
+} DetectorRegistry_t;
+
+// Registry API
+void detector_registry_init(DetectorRegistry_t* reg, DetectorClockFn clock_us);
+bool detector_registry_add(DetectorRegistry_t* reg, const DetectorOps_t* ops,
+                           float weight, bool enabled);
+bool detector_registry_set_enabled(DetectorRegistry_t* reg, const char* name, bool enabled);
+void detector_registry_update(DetectorRegistry_t* reg, const SensorData_t* sample);
+float detector_registry_evaluate(DetectorRegistry_t* reg, const ThresholdConfig_t* thresholds,
+                                 uint32_t* flags_out);
+uint32_t detector_registry_get_stats(const DetectorRegistry_t* reg, DetectorStats_t* out,
+                                     uint32_t max_count);
+
+// Built-in detectors
+extern const DetectorOps_t sigma_detector_ops;       // 3-sigma baseline deviation
+extern const DetectorOps_t sigma_q15_detector_ops;   // Same rule, Q15 fixed-point data path
+extern const DetectorOps_t mahalanobis_detector_ops; // Joint distance of coupled channels
+
+#endif // DETECTOR_H
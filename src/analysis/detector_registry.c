@@ -0,0 +1,136 @@
+/**
+ * Detector Registry - Runs the enabled detectors and fuses their scores
+ * Records per-detector CPU time and state memory footprint
+ */
+
+#include <string.h>
+#include "detector.h"
+
+// Round state blocks up so the next one stays aligned
+#define ARENA_ALIGN(size)   (((size) + sizeof(double) - 1) & ~(sizeof(double) - 1))
+
+static uint32_t registry_now(const DetectorRegistry_t* reg) {
+    return reg->clock_us != NULL ? reg->clock_us() : 0;
+}
+
+void detector_registry_init(DetectorRegistry_t* reg, DetectorClockFn clock_us) {
+    memset(reg, 0, sizeof(DetectorRegistry_t));
+    reg->clock_us = clock_us;
+}
+
+bool detector_registry_add(DetectorRegistry_t* reg, const DetectorOps_t* ops,
+                           float weight, bool enabled) {
+    size_t state_size = ARENA_ALIGN(ops->state_size);
+
+    if (reg->count >= MAX_DETECTORS ||
+        reg->arena_used + state_size > DETECTOR_ARENA_SIZE) {
+        return false;
+    }
+
+    DetectorSlot_t* slot = &reg->slots[reg->count];
+    memset(slot, 0, sizeof(DetectorSlot_t));
+    slot->ops = ops;
+    slot->state = &reg->arena.bytes[reg->arena_used];
+    slot->weight = weight;
+    slot->enabled = enabled;
+
+    memset(slot->state, 0, state_size);
+    if (ops->init != NULL) {
+        ops->init(slot->state);
+    }
+
+    reg->arena_used += state_size;
+    reg->count++;
+    return true;
+}
+
+bool detector_registry_set_enabled(DetectorRegistry_t* reg, const char* name, bool enabled) {
+    for (uint32_t i = 0; i < reg->count; i++) {
+        if (strcmp(reg->slots[i].ops->name, name) == 0) {
+            reg->slots[i].enabled = enabled;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Feed one sample to every enabled detector
+void detector_registry_update(DetectorRegistry_t* reg, const SensorData_t* sample) {
+    for (uint32_t i = 0; i < reg->count; i++) {
+        DetectorSlot_t* slot = &reg->slots[i];
+        if (!slot->enabled || slot->ops->update == NULL) {
+            continue;
+        }
+
+        uint32_t start = registry_now(reg);
+        slot->ops->update(slot->state, sample);
+        uint32_t elapsed = registry_now(reg) - start;
+
+        slot->cost.update_calls++;
+        slot->cost.update_us += elapsed;
+        slot->cost.pending_us += elapsed;
+    }
+    reg->samples_seen++;
+}
+
+// Evaluate every enabled detector and fuse the weighted penalties into a health score
+float detector_registry_evaluate(DetectorRegistry_t* reg, const ThresholdConfig_t* thresholds,
+                                 uint32_t* flags_out) {
+    float penalty = 0.0f;
+    uint32_t flags = 0;
+
+    for (uint32_t i = 0; i < reg->count; i++) {
+        DetectorSlot_t* slot = &reg->slots[i];
+        if (!slot->enabled) {
+            continue;
+        }
+
+        uint32_t start = registry_now(reg);
+        slot->last_flags = slot->ops->evaluate(slot->state, thresholds);
+        slot->last_score = slot->ops->score(slot->state);
+        uint32_t elapsed = registry_now(reg) - start;
+
+        slot->cost.evaluate_calls++;
+        slot->cost.evaluate_us += elapsed;
+        if (slot->cost.pending_us + elapsed > slot->cost.max_cycle_us) {
+            slot->cost.max_cycle_us = slot->cost.pending_us + elapsed;
+        }
+        slot->cost.pending_us = 0;
+
+        flags |= slot->last_flags;
+        penalty += slot->weight * slot->last_score;
+    }
+
+    if (flags_out != NULL) {
+        *flags_out = flags;
+    }
+
+    float health = 100.0f - penalty;
+    return health > 0.0f ? health : 0.0f;
+}
+
+// Snapshot per-detector cost and output for the dashboard
+uint32_t detector_registry_get_stats(const DetectorRegistry_t* reg, DetectorStats_t* out,
+                                     uint32_t max_count) {
+    uint32_t count = reg->count < max_count ? reg->count : max_count;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const DetectorSlot_t* slot = &reg->slots[i];
+        DetectorStats_t* stats = &out[i];
+
+        strncpy(stats->name, slot->ops->name, DETECTOR_NAME_LEN - 1);
+        stats->name[DETECTOR_NAME_LEN - 1] = '\0';
+        stats->enabled = slot->enabled;
+        stats->flags = slot->last_flags;
+        stats->score = slot->last_score;
+        stats->memory_bytes = (uint32_t)ARENA_ALIGN(slot->ops->state_size);
+        stats->max_cycle_us = slot->cost.max_cycle_us;
+        stats->avg_cycle_us = 0;
+        if (slot->cost.evaluate_calls > 0) {
+            stats->avg_cycle_us = (uint32_t)((slot->cost.update_us + slot->cost.evaluate_us) /
+                                             slot->cost.evaluate_calls);
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,155 @@
+/**
+ * Envelope - Band-pass, rectify and decimate vibration, then FFT the envelope
+ */
+
+#include <math.h>
+#include <string.h>
+#include "envelope.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+const char* const bearing_defect_names[BEARING_DEFECT_COUNT] = {
+    "FTF", "BSF", "BPFO", "BPFI"
+};
+
+void bearing_geometry_defaults(BearingGeometry_t* geometry) {
+    geometry->order[BEARING_FTF] = BEARING_DEFAULT_FTF_ORDER;
+    geometry->order[BEARING_BSF] = BEARING_DEFAULT_BSF_ORDER;
+    geometry->order[BEARING_BPFO] = BEARING_DEFAULT_BPFO_ORDER;
+    geometry->order[BEARING_BPFI] = BEARING_DEFAULT_BPFI_ORDER;
+}
+
+// RBJ band-pass with 0dB peak gain at the geometric band center
+static void bandpass_design(BiquadSection_t* bq, float low_hz, float high_hz, float rate_hz) {
+    float center = sqrtf(low_hz * high_hz);
+    float q = center / (high_hz - low_hz);
+    float w0 = 2.0f * (float)M_PI * center / rate_hz;
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+
+    memset(bq, 0, sizeof(*bq));
+    bq->b0 = alpha / a0;
+    bq->b1 = 0.0f;
+    bq->b2 = -alpha / a0;
+    bq->a1 = -2.0f * cosf(w0) / a0;
+    bq->a2 = (1.0f - alpha) / a0;
+}
+
+// Transposed direct form II
+static inline float biquad_step(BiquadSection_t* bq, float x) {
+    float y = bq->b0 * x + bq->z1;
+    bq->z1 = bq->b1 * x - bq->a1 * y + bq->z2;
+    bq->z2 = bq->b2 * x - bq->a2 * y;
+    return y;
+}
+
+void envelope_init(EnvelopeAnalyzer_t* env, const BearingGeometry_t* geometry) {
+    memset(env, 0, sizeof(*env));
+    env->geometry = *geometry;
+
+    for (uint32_t s = 0; s < 2; s++) {
+        bandpass_design(&env->bandpass[s], ENVELOPE_BAND_LOW_HZ, ENVELOPE_BAND_HIGH_HZ,
+                        (float)ENVELOPE_INPUT_RATE_HZ);
+    }
+    decimator_init(&env->lowpass, ENVELOPE_DECIMATION);
+    fft_init(&env->fft, ENVELOPE_FFT_SIZE);
+
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < ENVELOPE_FFT_SIZE; i++) {
+        env->window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)i / (float)ENVELOPE_FFT_SIZE);
+        sum += env->window[i];
+    }
+    env->window_gain = sum / 2.0f;
+}
+
+// Amplitude of the largest bin within one bin of freq_hz
+static float peak_near(const EnvelopeAnalyzer_t* env, float freq_hz) {
+    int32_t center = (int32_t)(freq_hz / envelope_bin_hz() + 0.5f);
+    float peak = 0.0f;
+
+    for (int32_t bin = center - 1; bin <= center + 1; bin++) {
+        if (bin >= 1 && bin < ENVELOPE_FFT_SIZE / 2 && env->spectrum[bin] > peak) {
+            peak = env->spectrum[bin];
+        }
+    }
+    return peak;
+}
+
+static void compute_spectrum(EnvelopeAnalyzer_t* env, float shaft_hz) {
+    float* re = env->fft_re;
+    float* im = env->fft_im;
+
+    // Oldest sample first; remove the mean so rectification DC does not leak
+    float mean = 0.0f;
+    for (uint32_t i = 0; i < ENVELOPE_FFT_SIZE; i++) {
+        mean += env->ring[i];
+    }
+    mean /= ENVELOPE_FFT_SIZE;
+
+    for (uint32_t i = 0; i < ENVELOPE_FFT_SIZE; i++) {
+        uint32_t idx = (env->write + i) % ENVELOPE_FFT_SIZE;
+        re[i] = (env->ring[idx] - mean) * env->window[i];
+        im[i] = 0.0f;
+    }
+    fft_forward(&env->fft, re, im);
+
+    // Averaging steadies the noise floor: a plain mean of the first ENVELOPE_AVERAGES
+    // spectra, then exponential with weight 1/ENVELOPE_AVERAGES, so older spectra
+    // fade (memory of about ENVELOPE_AVERAGES) rather than drop out
+    uint32_t n = env->result.spectra + 1;
+    float weight = 1.0f / (float)(n < ENVELOPE_AVERAGES ? n : ENVELOPE_AVERAGES);
+    float floor = 0.0f;
+    for (uint32_t k = 0; k < ENVELOPE_FFT_SIZE / 2; k++) {
+        float amplitude = sqrtf(re[k] * re[k] + im[k] * im[k]) / env->window_gain;
+        env->spectrum[k] += (amplitude - env->spectrum[k]) * weight;
+        if (k > 0) {
+            floor += env->spectrum[k];
+        }
+    }
+    floor /= (ENVELOPE_FFT_SIZE / 2 - 1);
+
+    EnvelopeResult_t* result = &env->result;
+    result->shaft_hz = shaft_hz;
+    result->floor = floor;
+    for (uint32_t d = 0; d < BEARING_DEFECT_COUNT; d++) {
+        result->peak[d] = peak_near(env, env->geometry.order[d] * shaft_hz);
+        result->ratio[d] = floor > 0.0f ? result->peak[d] / floor : 0.0f;
+    }
+    result->spectra++;
+}
+
+bool envelope_push(EnvelopeAnalyzer_t* env, const float* samples, uint32_t count, float shaft_hz) {
+    float rectified[64];
+    float decimated[64 / ENVELOPE_DECIMATION + 1];
+    bool ready = false;
+
+    while (count > 0) {
+        uint32_t chunk = count < 64 ? count : 64;
+
+        for (uint32_t i = 0; i < chunk; i++) {
+            float y = biquad_step(&env->bandpass[1], biquad_step(&env->bandpass[0], samples[i]));
+            rectified[i] = fabsf(y);
+        }
+
+        uint32_t produced = decimator_push(&env->lowpass, rectified, chunk,
+                                           decimated, sizeof(decimated) / sizeof(decimated[0]));
+        for (uint32_t i = 0; i < produced; i++) {
+            env->ring[env->write] = decimated[i];
+            env->write = (env->write + 1) % ENVELOPE_FFT_SIZE;
+            if (env->filled < ENVELOPE_FFT_SIZE) {
+                env->filled++;
+            }
+            if (++env->since_spectrum >= ENVELOPE_HOP && env->filled == ENVELOPE_FFT_SIZE) {
+                compute_spectrum(env, shaft_hz);
+                env->since_spectrum = 0;
+                ready = true;
+            }
+        }
+
+        samples += chunk;
+        count -= chunk;
+    }
+    return ready;
+}
@@ -0,0 +1,92 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "decimator.h"
+#include "fft.h"
+
+// Envelope (demodulation) analysis of the raw vibration stream. A bearing
+// defect strikes the structure once per roll-over, exciting a resonance well
+// above shaft speed; the defect rate appears as amplitude modulation of that
+// resonance. Band-pass around the resonance, rectify, low-pass and decimate,
+// then the spectrum of the envelope shows peaks at the defect frequencies.
+#define ENVELOPE_INPUT_RATE_HZ  1000
+#define ENVELOPE_BAND_LOW_HZ    150.0f
+#define ENVELOPE_BAND_HIGH_HZ   350.0f
+#define ENVELOPE_DECIMATION     10      // Envelope spectrum up to 50Hz
+#define ENVELOPE_FFT_SIZE       256     // 0.39Hz bins, 2.56s window
+#define ENVELOPE_HOP            (ENVELOPE_FFT_SIZE / 2)
+#define ENVELOPE_AVERAGES       8       // Exponential average memory in spectra, ~10s
+
+// Peak-to-floor ratios worth a look / a maintenance ticket
+#define ENVELOPE_WARNING_RATIO  3.0f
+#define ENVELOPE_ALERT_RATIO    5.0f
+
+// Monitored bearing sits on the intermediate gearbox shaft
+#define ENVELOPE_SHAFT_RATIO    10.0f   // Shaft speed / rotor speed
+
+// Defect frequencies as orders of shaft speed
+typedef enum {
+    BEARING_FTF = 0,    // Cage (fundamental train)
+    BEARING_BSF,        // Ball spin
+    BEARING_BPFO,       // Outer race
+    BEARING_BPFI,       // Inner race
+    BEARING_DEFECT_COUNT
+} BearingDefect_t;
+
+extern const char* const bearing_defect_names[BEARING_DEFECT_COUNT];
+
+// Orders of a typical 9-ball deep-groove bearing
+#define BEARING_DEFAULT_FTF_ORDER   0.398f
+#define BEARING_DEFAULT_BSF_ORDER   2.357f
+#define BEARING_DEFAULT_BPFO_ORDER  3.585f
+#define BEARING_DEFAULT_BPFI_ORDER  5.415f
+
+typedef struct {
+    float order[BEARING_DEFECT_COUNT];
+} BearingGeometry_t;
+
+void bearing_geometry_defaults(BearingGeometry_t* geometry);
+
+typedef struct {
+    float shaft_hz;                         // Shaft speed the spectrum was read at
+    float floor;                            // Mean envelope amplitude across bins
+    float peak[BEARING_DEFECT_COUNT];       // Envelope amplitude at each defect frequency
+    float ratio[BEARING_DEFECT_COUNT];      // peak / floor
+    uint32_t spectra;                       // Spectra computed since init
+} EnvelopeResult_t;
+
+typedef struct {
+    float b0, b1, b2, a1, a2;
+    float z1, z2;
+} BiquadSection_t;
+
+typedef struct {
+    BearingGeometry_t geometry;
+    BiquadSection_t bandpass[2];            // 4th-order band-pass
+    Decimator_t lowpass;                    // Envelope low-pass + decimation
+    Fft_t fft;
+    float window[ENVELOPE_FFT_SIZE];        // Hann
+    float window_gain;                      // sum(window) / 2, amplitude scaling
+    float ring[ENVELOPE_FFT_SIZE];          // Latest decimated envelope samples
+    uint32_t write;
+    uint32_t filled;
+    uint32_t since_spectrum;
+    float spectrum[ENVELOPE_FFT_SIZE / 2];  // Averaged amplitude per bin, bin 0 = DC
+    float fft_re[ENVELOPE_FFT_SIZE];        // FFT scratch, kept off the task stack
+    float fft_im[ENVELOPE_FFT_SIZE];
+    EnvelopeResult_t result;
+} EnvelopeAnalyzer_t;
+
+void envelope_init(EnvelopeAnalyzer_t* env, const BearingGeometry_t* geometry);
+
+// Feed raw vibration at ENVELOPE_INPUT_RATE_HZ. shaft_hz is the current speed of
+// the monitored shaft. Returns true when a new spectrum and result are ready.
+bool envelope_push(EnvelopeAnalyzer_t* env, const float* samples, uint32_t count, float shaft_hz);
+
+static inline float envelope_bin_hz(void) {
+    return (float)ENVELOPE_INPUT_RATE_HZ / ENVELOPE_DECIMATION / ENVELOPE_FFT_SIZE;
+}
+
+#endif // ENVELOPE_H
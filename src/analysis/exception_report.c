@@ -0,0 +1,129 @@
+/**
+ * Exception Report - Deadband telemetry encoder with a presence bitmap
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "exception_report.h"
+
+void exception_report_init(ExceptionReporter_t* reporter) {
+    memset(reporter, 0, sizeof(*reporter));
+}
+
+void exception_report_resync(ExceptionReporter_t* reporter) {
+    reporter->synced = false;
+}
+
+static float channel_deadband(uint32_t ch, float reference) {
+    const ChannelInfo_t* info = &sensor_channels[ch];
+    return fmaxf(info->deadband, info->deadband_rel * fabsf(reference));
+}
+
+// The window's extremes left the deadband around the value last sent
+static bool channel_spiked(const ExceptionReporter_t* reporter, const RollupBucket_t* window,
+                           uint32_t ch) {
+    float reference = reporter->reference[ch];
+    float deadband = channel_deadband(ch, reference);
+    return window->max[ch] - reference > deadband || reference - window->min[ch] > deadband;
+}
+
+uint32_t exception_report_due(const ExceptionReporter_t* reporter, const ReportInput_t* input) {
+    const RollupBucket_t* window = &input->window;
+    uint32_t present = 0;
+
+    if (window->count > 0) {
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            // Extremes include the mean, so a moved mean is caught too
+            if (!reporter->synced || channel_spiked(reporter, window, ch) ||
+                input->time_s - reporter->sent_s[ch] >= sensor_channels[ch].max_silence_s) {
+                present |= REPORT_FIELD_BIT(ch);
+            }
+        }
+    }
+
+    float health = reporter->reference[REPORT_FIELD_HEALTH];
+    if (!reporter->synced || fabsf(input->health_score - health) > REPORT_HEALTH_DEADBAND ||
+        input->time_s - reporter->sent_s[REPORT_FIELD_HEALTH] >= REPORT_HEALTH_SILENCE_S) {
+        present |= REPORT_FIELD_BIT(REPORT_FIELD_HEALTH);
+    }
+
+    if (!reporter->synced || input->anomaly_flags != reporter->anomaly_flags) {
+        present |= REPORT_FIELD_BIT(REPORT_FIELD_ANOMALIES);
+    }
+    return present;
+}
+
+// Append to the report under construction; a full buffer makes later appends no-ops
+static void report_append(char* buffer, uint32_t size, uint32_t* len, const char* fmt, ...) {
+    if (*len >= size) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buffer + *len, size - *len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += (uint32_t)n;
+    }
+}
+
+uint32_t exception_report_encode(ExceptionReporter_t* reporter, uint32_t present,
+                                 const ReportInput_t* input, char* buffer, uint32_t size) {
+    const RollupBucket_t* window = &input->window;
+    uint32_t len = 0;
+
+    if (size == 0) {
+        return 0;
+    }
+    if (window->count == 0) {
+        present &= ~(REPORT_FIELD_BIT(CHANNEL_COUNT) - 1);
+    }
+
+    report_append(buffer, size, &len, "{\"t\":%u,\"p\":%u", (unsigned int)input->time_s,
+                  (unsigned int)present);
+
+    bool any = false;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (!(present & REPORT_FIELD_BIT(ch))) {
+            continue;
+        }
+        int decimals = (int)sensor_channels[ch].decimals;
+        float mean = window->mean[ch];
+        float deadband = channel_deadband(ch, reporter->reference[ch]);
+
+        // A spike the mean hides: send the range so it is not lost
+        if (reporter->synced && fabsf(mean - reporter->reference[ch]) <= deadband &&
+            channel_spiked(reporter, window, ch)) {
+            report_append(buffer, size, &len, "%s[%.*f,%.*f,%.*f]", any ? "," : ",\"v\":[",
+                          decimals, window->min[ch], decimals, mean, decimals, window->max[ch]);
+        } else {
+            report_append(buffer, size, &len, "%s%.*f", any ? "," : ",\"v\":[", decimals, mean);
+        }
+        any = true;
+
+        reporter->reference[ch] = mean;
+        reporter->sent_s[ch] = input->time_s;
+    }
+    if (any) {
+        report_append(buffer, size, &len, "]");
+    }
+
+    if (present & REPORT_FIELD_BIT(REPORT_FIELD_HEALTH)) {
+        report_append(buffer, size, &len, ",\"h\":%.1f", input->health_score);
+        reporter->reference[REPORT_FIELD_HEALTH] = input->health_score;
+        reporter->sent_s[REPORT_FIELD_HEALTH] = input->time_s;
+    }
+    if (present & REPORT_FIELD_BIT(REPORT_FIELD_ANOMALIES)) {
+        report_append(buffer, size, &len, ",\"a\":%u", (unsigned int)input->anomaly_flags);
+        reporter->anomaly_flags = input->anomaly_flags;
+    }
+    report_append(buffer, size, &len, "}");
+
+    // A report with every field brings the receiver up to date
+    if (present == REPORT_ALL_FIELDS) {
+        reporter->synced = true;
+    }
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,53 @@
+#ifndef EXCEPTION_REPORT_H
+#define EXCEPTION_REPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rollup.h"
+
+// Report-by-exception telemetry. A field goes out only when it has moved
+// beyond its deadband from the value last sent, or has been silent for its
+// maximum interval; anomaly flags go out whenever they change. Each report
+// carries a bitmap of the fields present:
+//   {"t":<s>,"p":<bitmap>,"v":[<channel>,...],"h":<health>,"a":<flags>}
+// Channels are listed in table order. A channel whose extremes left the
+// deadband while its mean did not (a spike) is sent as [min,mean,max].
+#define REPORT_FIELD_HEALTH         CHANNEL_COUNT
+#define REPORT_FIELD_ANOMALIES      (CHANNEL_COUNT + 1)
+#define REPORT_FIELD_BIT(field)     (1u << (field))
+#define REPORT_ALL_FIELDS           (REPORT_FIELD_BIT(REPORT_FIELD_ANOMALIES + 1) - 1)
+
+#define REPORT_HEALTH_DEADBAND      15.0f   // Health score points; noise alone swings it ~10
+#define REPORT_HEALTH_SILENCE_S     300
+
+// What the reporter sees each telemetry cycle
+typedef struct {
+    uint32_t time_s;
+    RollupBucket_t window;      // Readings since the previous cycle (count 0 if none)
+    float health_score;
+    uint32_t anomaly_flags;
+} ReportInput_t;
+
+// What the receiver last got
+typedef struct {
+    float reference[CHANNEL_COUNT + 1];     // Channel means, then health
+    uint32_t sent_s[CHANNEL_COUNT + 1];
+    uint32_t anomaly_flags;
+    bool synced;                            // false: the next report carries every field
+} ExceptionReporter_t;
+
+void exception_report_init(ExceptionReporter_t* reporter);
+
+// Bitmap of the fields that need sending, 0 if the receiver is up to date
+uint32_t exception_report_due(const ExceptionReporter_t* reporter, const ReportInput_t* input);
+
+// Encode the present fields and take them as sent. Channels without
+// readings in the window are left out. Returns the length written.
+uint32_t exception_report_encode(ExceptionReporter_t* reporter, uint32_t present,
+                                 const ReportInput_t* input, char* buffer, uint32_t size);
+
+// The receiver may have missed a report or been sent other values: the next
+// report carries every field
+void exception_report_resync(ExceptionReporter_t* reporter);
+
+#endif // EXCEPTION_REPORT_H
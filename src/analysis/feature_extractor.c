@@ -0,0 +1,120 @@
+/**
+ * Feature Extractor - Single-pass statistical feature extraction from raw vibration
+ */
+
+#include <math.h>
+#include <string.h>
+#include "feature_extractor.h"
+
+const char* const feature_names[FEATURE_COUNT] = {
+    "vib_mean", "vib_rms", "vib_peak", "crest", "skewness",
+    "kurtosis", "zcr", "temp_slope", "amps_rpm", "rpm"
+};
+
+static void reset_block(FeatureExtractor_t* fx) {
+    fx->sum1 = fx->sum2 = fx->sum3 = fx->sum4 = 0.0f;
+    fx->min = INFINITY;
+    fx->max = -INFINITY;
+    fx->count = 0;
+    fx->crossings = 0;
+}
+
+void feature_extractor_init(FeatureExtractor_t* fx) {
+    memset(fx, 0, sizeof(*fx));
+    reset_block(fx);
+}
+
+void feature_accumulate(FeatureExtractor_t* fx, const float* samples, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    // Before the first mean exists, measure against the first sample
+    if (!fx->primed) {
+        fx->reference = samples[0];
+        fx->last_sample = samples[0];
+        fx->primed = true;
+    }
+
+    // Sums are taken about the reference, which sits close to the mean, so the
+    // higher powers stay small and float keeps enough precision
+    const float reference = fx->reference;
+    float s1 = 0.0f, s2 = 0.0f, s3 = 0.0f, s4 = 0.0f;
+    float lo = fx->min, hi = fx->max;
+    uint32_t crossings = 0;
+    bool below = fx->last_sample < reference;
+
+    for (uint32_t i = 0; i < count; i++) {
+        float x = samples[i];
+        float d = x - reference;
+        float d2 = d * d;
+        s1 += d;
+        s2 += d2;
+        s3 += d2 * d;
+        s4 += d2 * d2;
+        lo = x < lo ? x : lo;
+        hi = x > hi ? x : hi;
+        bool now_below = d < 0.0f;
+        crossings += now_below != below;
+        below = now_below;
+    }
+
+    fx->sum1 += s1;
+    fx->sum2 += s2;
+    fx->sum3 += s3;
+    fx->sum4 += s4;
+    fx->min = lo;
+    fx->max = hi;
+    fx->crossings += crossings;
+    fx->last_sample = samples[count - 1];
+    fx->count += count;
+}
+
+bool feature_finish(FeatureExtractor_t* fx, const SensorData_t* reading, float block_s,
+                    FeatureVector_t* out) {
+    bool have_block = fx->count > 0;
+
+    if (have_block) {
+        // Central moments from the shifted power sums
+        float n = (float)fx->count;
+        float m = fx->sum1 / n;
+        float e2 = fx->sum2 / n;
+        float e3 = fx->sum3 / n;
+        float e4 = fx->sum4 / n;
+        float m2 = e2 - m * m;
+        float m3 = e3 - 3.0f * m * e2 + 2.0f * m * m * m;
+        float m4 = e4 - 4.0f * m * e3 + 6.0f * m * m * e2 - 3.0f * m * m * m * m;
+        if (m2 < 0.0f) {
+            m2 = 0.0f;
+        }
+
+        float mean = fx->reference + m;
+        float rms = sqrtf(m2);
+        float peak = fmaxf(fx->max - mean, mean - fx->min);
+
+        out->vibration_mean = mean;
+        out->vibration_rms = rms;
+        out->vibration_peak = peak;
+        out->crest_factor = rms > 0.0f ? peak / rms : 0.0f;
+        out->skewness = m2 > 0.0f ? m3 / (m2 * rms) : 0.0f;
+        out->kurtosis = m2 > 0.0f ? m4 / (m2 * m2) : 0.0f;
+        out->zero_crossing_rate = (float)fx->crossings * FEATURE_INPUT_RATE_HZ / n;
+
+        // This block's mean is the next block's reference and crossing level
+        fx->reference = mean;
+    }
+    reset_block(fx);
+
+    // Temperature slope from successive readings, smoothed against sensor noise
+    if (fx->temperature_primed && block_s > 0.0f) {
+        float slope = (reading->temperature - fx->last_temperature) * 60.0f / block_s;
+        fx->temperature_slope += (slope - fx->temperature_slope) * FEATURE_SLOPE_ALPHA;
+    }
+    fx->last_temperature = reading->temperature;
+    fx->temperature_primed = true;
+
+    out->temperature_slope = fx->temperature_slope;
+    out->current_rpm_ratio = reading->rpm > FEATURE_MIN_RPM ? reading->current / reading->rpm : 0.0f;
+    out->rpm = reading->rpm;
+    return have_block;
+}
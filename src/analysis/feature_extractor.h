@@ -0,0 +1,77 @@
+#ifndef FEATURE_EXTRACTOR_H
+#define FEATURE_EXTRACTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_types.h"
+
+// Statistical features of one block of raw vibration plus the slow channels,
+// packed into a fixed vector for a detector or the autoencoder. Raw vibration
+// is accumulated in a single pass as it arrives, with no sample buffer, so
+// the cost per block stays linear in the sample count.
+#define FEATURE_COUNT           10      // Mirrors INPUT_FEATURES in app_config.h
+#define FEATURE_INPUT_RATE_HZ   1000    // Raw vibration rate, for the crossing rate
+#define FEATURE_SLOPE_ALPHA     0.1f    // Smoothing of the temperature slope
+#define FEATURE_MIN_RPM         1.0f    // Below this the current/RPM ratio is 0
+
+typedef enum {
+    FEATURE_VIBRATION_MEAN = 0,
+    FEATURE_VIBRATION_RMS,              // About the mean (AC RMS)
+    FEATURE_VIBRATION_PEAK,             // Largest excursion from the mean
+    FEATURE_CREST_FACTOR,               // Peak / RMS
+    FEATURE_SKEWNESS,
+    FEATURE_KURTOSIS,                   // Pearson, 3 for Gaussian noise
+    FEATURE_ZERO_CROSSING_RATE,         // Mean crossings per second
+    FEATURE_TEMPERATURE_SLOPE,          // Degrees C per minute
+    FEATURE_CURRENT_RPM_RATIO,          // A per rpm, drive train load
+    FEATURE_RPM
+} FeatureIndex_t;
+
+extern const char* const feature_names[FEATURE_COUNT];
+
+typedef struct {
+    union {
+        struct {
+            float vibration_mean;
+            float vibration_rms;
+            float vibration_peak;
+            float crest_factor;
+            float skewness;
+            float kurtosis;
+            float zero_crossing_rate;
+            float temperature_slope;
+            float current_rpm_ratio;
+            float rpm;
+        };
+        float values[FEATURE_COUNT];
+    };
+} FeatureVector_t;
+
+typedef struct {
+    // Block accumulators: power sums of (x - reference) and the extremes
+    float reference;            // Previous block's mean, the crossing level
+    float sum1, sum2, sum3, sum4;
+    float min, max;
+    uint32_t count;
+    uint32_t crossings;
+    float last_sample;          // Carries the crossing test across calls
+    bool primed;                // reference holds a real mean
+
+    float last_temperature;
+    float temperature_slope;
+    bool temperature_primed;
+} FeatureExtractor_t;
+
+void feature_extractor_init(FeatureExtractor_t* fx);
+
+// Accumulate raw vibration; call any number of times per block
+void feature_accumulate(FeatureExtractor_t* fx, const float* samples, uint32_t count);
+
+// Close the block: derive the vibration features from the accumulators, add the
+// slow-channel features from reading, and start the next block. block_s is the
+// time since the previous call. Returns false if no samples arrived, in which
+// case out keeps its vibration features and only the slow channels are updated.
+bool feature_finish(FeatureExtractor_t* fx, const SensorData_t* reading, float block_s,
+                    FeatureVector_t* out);
+
+#endif // FEATURE_EXTRACTOR_H
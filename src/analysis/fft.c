@@ -0,0 +1,64 @@
+/**
+ * FFT - Iterative radix-2 decimation-in-time transform
+ */
+
+#include <math.h>
+#include <string.h>
+#include "fft.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+bool fft_init(Fft_t* fft, uint32_t size) {
+    memset(fft, 0, sizeof(*fft));
+    if (size < 2 || size > FFT_MAX_SIZE || (size & (size - 1)) != 0) {
+        return false;
+    }
+
+    fft->size = size;
+    while ((1u << fft->log2_size) < size) {
+        fft->log2_size++;
+    }
+    for (uint32_t k = 0; k < size / 2; k++) {
+        double angle = 2.0 * M_PI * (double)k / (double)size;
+        fft->cos_table[k] = (float)cos(angle);
+        fft->sin_table[k] = (float)-sin(angle);
+    }
+    return true;
+}
+
+void fft_forward(const Fft_t* fft, float* re, float* im) {
+    const uint32_t n = fft->size;
+
+    // Bit-reversal permutation
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    // Butterflies; the twiddle stride halves as the span doubles
+    for (uint32_t span = 1, stride = n / 2; span < n; span <<= 1, stride >>= 1) {
+        for (uint32_t start = 0; start < n; start += 2 * span) {
+            for (uint32_t k = 0; k < span; k++) {
+                float wr = fft->cos_table[k * stride];
+                float wi = fft->sin_table[k * stride];
+                uint32_t a = start + k;
+                uint32_t b = a + span;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// In-place radix-2 complex FFT with precomputed twiddles
+#define FFT_MAX_SIZE 512
+
+typedef struct {
+    uint32_t size;
+    uint32_t log2_size;
+    float cos_table[FFT_MAX_SIZE / 2];
+    float sin_table[FFT_MAX_SIZE / 2];
+} Fft_t;
+
+// False unless size is a power of two between 2 and FFT_MAX_SIZE
+bool fft_init(Fft_t* fft, uint32_t size);
+
+// Forward transform of size points; re/im hold input and output
+void fft_forward(const Fft_t* fft, float* re, float* im);
+
+#endif // FFT_H
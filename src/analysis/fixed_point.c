@@ -0,0 +1,80 @@
+/**
+ * Fixed Point - Q15 quantization and integer helpers
+ */
+
+#include "fixed_point.h"
+
+// Round to nearest and saturate; single-precision only
+q15_t q15_from_float(float value, float full_scale) {
+    float scaled = value * ((float)Q15_ONE / full_scale);
+    int32_t rounded = (int32_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+
+    if (scaled >= (float)Q15_MAX) return Q15_MAX;
+    if (scaled <= (float)Q15_MIN) return Q15_MIN;
+    return q15_saturate(rounded);
+}
+
+float q15_to_float(q15_t value, float full_scale) {
+    return (float)value * (full_scale / (float)Q15_ONE);
+}
+
+void sensor_sample_to_q15(const SensorData_t* sample, SensorSampleQ15_t* out) {
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        out->values[ch] = q15_from_float(sample->values[ch], sensor_channels[ch].full_scale);
+    }
+    out->timestamp = sample->timestamp;
+}
+
+void threshold_config_to_q15(const ThresholdConfig_t* thresholds, ThresholdConfigQ15_t* out) {
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        const ChannelLimits_t* limits = &thresholds->channels[ch];
+        float full_scale = sensor_channels[ch].full_scale;
+
+        out->channels[ch].warning_low = q15_from_float(limits->warning_low, full_scale);
+        out->channels[ch].warning_high = q15_from_float(limits->warning_high, full_scale);
+        out->channels[ch].critical_low = q15_from_float(limits->critical_low, full_scale);
+        out->channels[ch].critical_high = q15_from_float(limits->critical_high, full_scale);
+    }
+}
+
+// Bit-by-bit method: no division, no FPU
+uint32_t isqrt64(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+// 32-bit variant: 16 iterations, used for Q30 variances
+uint16_t isqrt32(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)result;
+}
@@ -0,0 +1,55 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include "sensor_types.h"
+
+// Q15: signed 16-bit fraction of a per-channel full scale, [-1, 1).
+// Q31 intermediates (int32) hold sums and products; nothing on the per-sample
+// path touches float or double once a sample has been quantized.
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+#define Q15_ONE             32768
+#define Q15_MAX             INT16_MAX
+#define Q15_MIN             INT16_MIN
+
+// Health penalties are carried in Q16.16 percentage points
+#define Q16_SHIFT           16
+#define Q16_ONE             (1 << Q16_SHIFT)
+
+// Quantized sensor sample (per-channel full scales come from the channel table)
+typedef struct {
+    q15_t values[CHANNEL_COUNT];
+    uint32_t timestamp;
+} SensorSampleQ15_t;
+
+// Quantized limits (converted once per threshold change, not per sample)
+typedef struct {
+    q15_t warning_low;
+    q15_t warning_high;
+    q15_t critical_low;
+    q15_t critical_high;
+} ChannelLimitsQ15_t;
+
+typedef struct {
+    ChannelLimitsQ15_t channels[CHANNEL_COUNT];
+} ThresholdConfigQ15_t;
+
+static inline q15_t q15_saturate(int32_t value) {
+    if (value > Q15_MAX) return Q15_MAX;
+    if (value < Q15_MIN) return Q15_MIN;
+    return (q15_t)value;
+}
+
+// Conversions at the boundary of the fixed-point path
+q15_t q15_from_float(float value, float full_scale);
+float q15_to_float(q15_t value, float full_scale);
+void sensor_sample_to_q15(const SensorData_t* sample, SensorSampleQ15_t* out);
+void threshold_config_to_q15(const ThresholdConfig_t* thresholds, ThresholdConfigQ15_t* out);
+
+// Integer square roots (floor)
+uint32_t isqrt64(uint64_t value);
+uint16_t isqrt32(uint32_t value);
+
+#endif // FIXED_POINT_H
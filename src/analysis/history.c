@@ -0,0 +1,93 @@
+/**
+ * History - Min/max-per-column rings rendered as sparklines
+ */
+
+#include <string.h>
+#include "history.h"
+
+#define EMPTY_INDEX     UINT32_MAX      // No column number maps to a fresh slot
+
+// Eighth-height steps, lowest first; a sample at lo still draws the lowest
+static const char* const blocks[] = {
+    "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"
+};
+#define BLOCK_LEVELS    8
+#define BLOCK_BYTES     3
+
+void history_init(History_t* history, uint32_t column_ms) {
+    history->column_ms = column_ms > 0 ? column_ms : 1;
+    for (uint32_t i = 0; i < HISTORY_COLUMNS; i++) {
+        history->columns[i].index = EMPTY_INDEX;
+        history->columns[i].min = 0.0f;
+        history->columns[i].max = 0.0f;
+    }
+}
+
+void history_add(History_t* history, float value, uint32_t now_ms) {
+    uint32_t index = now_ms / history->column_ms;
+    HistoryColumn_t* column = &history->columns[index % HISTORY_COLUMNS];
+    if (column->index != index) {
+        // First sample of this column: the slot held one HISTORY_COLUMNS older
+        column->index = index;
+        column->min = column->max = value;
+        return;
+    }
+    if (value < column->min) column->min = value;
+    if (value > column->max) column->max = value;
+}
+
+// Column `age` back from now_ms, NULL if it has no sample
+static const HistoryColumn_t* column_at(const History_t* history, uint32_t now_ms, uint32_t age) {
+    uint32_t now_index = now_ms / history->column_ms;
+    if (age > now_index) {
+        return NULL;    // Before time zero
+    }
+    uint32_t index = now_index - age;
+    const HistoryColumn_t* column = &history->columns[index % HISTORY_COLUMNS];
+    return column->index == index ? column : NULL;
+}
+
+bool history_range(const History_t* history, uint32_t now_ms, uint32_t width, float* lo, float* hi) {
+    bool found = false;
+    width = width < HISTORY_COLUMNS ? width : HISTORY_COLUMNS;
+    for (uint32_t age = 0; age < width; age++) {
+        const HistoryColumn_t* column = column_at(history, now_ms, age);
+        if (column == NULL) {
+            continue;
+        }
+        if (!found || column->min < *lo) *lo = column->min;
+        if (!found || column->max > *hi) *hi = column->max;
+        found = true;
+    }
+    return found;
+}
+
+uint32_t history_sparkline(const History_t* history, uint32_t now_ms, uint32_t width, float reference,
+                           float lo, float hi, char* out, uint32_t capacity) {
+    uint32_t len = 0;
+    if (capacity == 0) {
+        return 0;
+    }
+    width = width < HISTORY_COLUMNS ? width : HISTORY_COLUMNS;
+    float span = hi > lo ? hi - lo : 1.0f;
+
+    for (uint32_t age = width; age-- > 0;) {
+        const HistoryColumn_t* column = column_at(history, now_ms, age);
+        const char* glyph = " ";
+        uint32_t bytes = 1;
+        if (column != NULL) {
+            float value = column->max - reference > reference - column->min ? column->max : column->min;
+            int level = (int)((value - lo) / span * BLOCK_LEVELS);
+            level = level < 0 ? 0 : (level >= BLOCK_LEVELS ? BLOCK_LEVELS - 1 : level);
+            glyph = blocks[level];
+            bytes = BLOCK_BYTES;
+        }
+        if (len + bytes >= capacity) {
+            break;
+        }
+        memcpy(out + len, glyph, bytes);
+        len += bytes;
+    }
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,43 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Fixed-size history of one value for sparklines. Time is cut into columns
+// of column_ms; each column keeps the min and max of its samples, so a spike
+// shorter than a column still shows. A sample touches only its own column
+// (O(1)); the ring slot of a column HISTORY_COLUMNS old is reused. Readers
+// walk at most the width they draw, whatever the history length, and
+// columns without samples draw blank.
+#define HISTORY_COLUMNS         32
+
+typedef struct {
+    uint32_t index;             // Column number (time / column_ms) this slot holds
+    float min;
+    float max;
+} HistoryColumn_t;
+
+typedef struct {
+    uint32_t column_ms;
+    HistoryColumn_t columns[HISTORY_COLUMNS];
+} History_t;
+
+void history_init(History_t* history, uint32_t column_ms);
+
+// Add a sample taken at now_ms (any monotonic millisecond clock)
+void history_add(History_t* history, float value, uint32_t now_ms);
+
+// Min and max over the newest `width` columns up to now_ms. Returns false if
+// none of them has a sample.
+bool history_range(const History_t* history, uint32_t now_ms, uint32_t width, float* lo, float* hi);
+
+// The newest `width` columns up to now_ms as Unicode block characters
+// (U+2581-U+2588, 3 bytes each in UTF-8), oldest first, scaled from lo to hi.
+// Each column draws whichever of its min and max is farther from reference,
+// so dips show when reference is high and peaks when it is low. Returns the
+// length written, NUL-terminated; stops at whole characters within capacity.
+uint32_t history_sparkline(const History_t* history, uint32_t now_ms, uint32_t width, float reference,
+                           float lo, float hi, char* out, uint32_t capacity);
+
+#endif // HISTORY_H
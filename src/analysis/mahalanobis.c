@@ -0,0 +1,84 @@
+/**
+ * Mahalanobis - Incremental mean and inverse covariance via Sherman-Morrison
+ */
+
+#include <math.h>
+#include <string.h>
+#include "mahalanobis.h"
+
+void mahalanobis_init(MahalanobisModel_t* model, uint32_t dim, const float* mean,
+                      const float* variance, uint32_t window, uint32_t warmup, float gate) {
+    memset(model, 0, sizeof(*model));
+    model->dim = dim < MAHALANOBIS_MAX_DIM ? dim : MAHALANOBIS_MAX_DIM;
+    model->window = window > 1 ? window : 2;
+    model->warmup = warmup;
+    model->gate = gate;
+
+    for (uint32_t i = 0; i < model->dim; i++) {
+        model->mean[i] = mean[i];
+        model->inverse[i][i] = 1.0f / variance[i];
+    }
+}
+
+float mahalanobis_update(MahalanobisModel_t* model, const float* x, float* residual) {
+    const uint32_t d = model->dim;
+    float delta[MAHALANOBIS_MAX_DIM];
+    float u[MAHALANOBIS_MAX_DIM];
+
+    // u = P * delta; the squared distance is delta . u. The residual of
+    // dimension i regressed on the rest is u_i / P_ii with variance 1 / P_ii.
+    float distance = 0.0f;
+    for (uint32_t i = 0; i < d; i++) {
+        delta[i] = x[i] - model->mean[i];
+    }
+    for (uint32_t i = 0; i < d; i++) {
+        float sum = 0.0f;
+        for (uint32_t j = 0; j < d; j++) {
+            sum += model->inverse[i][j] * delta[j];
+        }
+        u[i] = sum;
+        distance += delta[i] * sum;
+        if (residual != NULL) {
+            residual[i] = sum * sum / model->inverse[i][i];
+        }
+    }
+    if (distance < 0.0f) {
+        distance = 0.0f;        // Rounding on a near-singular model
+    }
+
+    // The prior only sets the scale: the first sample sets the centre
+    if (model->count == 0) {
+        memcpy(model->mean, x, d * sizeof(float));
+        model->count = 1;
+        return distance;
+    }
+
+    // Outliers are scored but not learned, unless the shift has lasted a window
+    if (model->gate > 0.0f && model->count >= model->warmup && distance > model->gate) {
+        if (++model->rejected < model->window) {
+            return distance;
+        }
+    } else {
+        model->rejected = 0;
+    }
+
+    // Weight 1/n while the window fills (the prior counts as one sample), then 1/window
+    if (model->count < model->window - 1) {
+        model->count++;
+    }
+    float alpha = 1.0f / (float)(model->count + 1);
+
+    // C' = (1 - alpha) * (C + alpha * delta delta^T), so by Sherman-Morrison
+    // P' = (P - alpha * u u^T / (1 + alpha * delta^T P delta)) / (1 - alpha).
+    // u u^T is symmetric, so updating both triangles keeps P exactly symmetric.
+    float k = alpha / (1.0f + alpha * distance);
+    float rescale = 1.0f / (1.0f - alpha);
+    for (uint32_t i = 0; i < d; i++) {
+        for (uint32_t j = 0; j < d; j++) {
+            model->inverse[i][j] = (model->inverse[i][j] - k * (u[i] * u[j])) * rescale;
+        }
+        model->mean[i] += alpha * delta[i];
+    }
+
+    return distance;
+}
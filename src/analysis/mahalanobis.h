@@ -0,0 +1,38 @@
+#ifndef MAHALANOBIS_H
+#define MAHALANOBIS_H
+
+#include <stdint.h>
+#include "sensor_channels.h"
+
+// Exponentially weighted mean and covariance of a small vector, kept as the
+// inverse covariance. Each sample is a rank-1 change to the covariance, so the
+// inverse follows it by Sherman-Morrison in O(d^2) and is never refactorized.
+// The Mahalanobis distance of a sample falls out of the same update.
+#define MAHALANOBIS_MAX_DIM     CHANNEL_COUNT
+
+typedef struct {
+    uint32_t dim;
+    uint32_t window;                // Samples in the exponential window
+    uint32_t count;                 // Samples learned, capped at window
+    uint32_t warmup;                // Samples learned before the gate applies
+    float gate;                     // Squared distance beyond which samples are not learned
+    uint32_t rejected;              // Consecutive samples beyond the gate
+    float mean[MAHALANOBIS_MAX_DIM];
+    float inverse[MAHALANOBIS_MAX_DIM][MAHALANOBIS_MAX_DIM];
+} MahalanobisModel_t;
+
+// Start from a prior of mean and per-dimension variance, weighted as one sample.
+// The first sample replaces the prior mean, and the first warmup samples are
+// learned whatever their distance: until then there is no baseline to reject from.
+void mahalanobis_init(MahalanobisModel_t* model, uint32_t dim, const float* mean,
+                      const float* variance, uint32_t window, uint32_t warmup, float gate);
+
+// Score x against the model, then learn it. Returns the squared Mahalanobis
+// distance before learning. residual (optional, dim entries) receives each
+// dimension's squared standardized residual given all the others, i.e. how
+// badly the rest of the vector explains that value. Samples beyond the
+// gate are not learned, so a fault does not become the baseline, unless they
+// persist for a whole window: then the process has moved and the model follows.
+float mahalanobis_update(MahalanobisModel_t* model, const float* x, float* residual);
+
+#endif // MAHALANOBIS_H
@@ -0,0 +1,120 @@
+/**
+ * Mahalanobis Detector - Joint distance of the coupled channels from their baseline
+ * Watches every channel tagged DETECTOR_SET_MAHALANOBIS in the channel table.
+ * Per-channel rules pass a turbine drawing the wrong current for its RPM as
+ * long as each value is in range; the covariance captures the coupling.
+ */
+
+#include <math.h>
+#include "detector.h"
+#include "mahalanobis.h"
+
+#define MAHAL_WINDOW            500     // 50s at 10Hz, about one RPM swing
+#define MAHAL_PRIOR_FRACTION    0.01f   // Prior standard deviation, fraction of full scale
+#define MAHAL_HEALTH_SLOPE      10.0f   // Penalty per threshold of distance
+#define MAHAL_HEALTH_CAP        30.0f
+
+// Chi-square quantile at p = 0.999 by degrees of freedom (index 0 = 1 dof).
+// The 1-dof value also marks a channel the others fail to explain.
+static const float chi2_999[] = {
+    10.83f, 13.82f, 16.27f, 18.47f, 20.52f, 22.46f, 24.32f, 26.12f
+};
+
+// Detection state
+typedef struct {
+    MahalanobisModel_t model;
+    uint32_t channel[MAHALANOBIS_MAX_DIM];  // Model dimension -> channel index
+    float threshold;                        // Squared distance flagged as anomalous
+
+    // Worst sample since the last evaluate
+    float worst_distance;
+    uint32_t worst_flags;                   // Channels its neighbours fail to explain
+    float penalty;
+} MahalanobisState_t;
+
+static void mahal_init(void* state) {
+    MahalanobisState_t* ms = (MahalanobisState_t*)state;
+    float mean[MAHALANOBIS_MAX_DIM];
+    float variance[MAHALANOBIS_MAX_DIM];
+    uint32_t dim = 0;
+
+    uint32_t mask = sensor_channel_mask(DETECTOR_SET_MAHALANOBIS);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (mask & CHANNEL_FLAG(ch)) {
+            float sigma = MAHAL_PRIOR_FRACTION * sensor_channels[ch].full_scale;
+            ms->channel[dim] = ch;
+            mean[dim] = sensor_channels[ch].nominal;
+            variance[dim] = sigma * sigma;
+            dim++;
+        }
+    }
+
+    uint32_t quantiles = sizeof(chi2_999) / sizeof(chi2_999[0]);
+    ms->threshold = dim > 0 ? chi2_999[(dim < quantiles ? dim : quantiles) - 1] : 0.0f;
+    mahalanobis_init(&ms->model, dim, mean, variance, MAHAL_WINDOW, BASELINE_WINDOW, ms->threshold);
+}
+
+// Score the sample, then learn it (O(d^2), no matrix inversion)
+static void mahal_update(void* state, const SensorData_t* sample) {
+    MahalanobisState_t* ms = (MahalanobisState_t*)state;
+    const uint32_t dim = ms->model.dim;
+    float x[MAHALANOBIS_MAX_DIM];
+    float residual[MAHALANOBIS_MAX_DIM];
+
+    if (dim == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < dim; i++) {
+        x[i] = sample->values[ms->channel[i]];
+    }
+
+    bool learning = ms->model.count < BASELINE_WINDOW;
+    float distance = mahalanobis_update(&ms->model, x, residual);
+    if (learning || distance <= ms->worst_distance) {
+        return;
+    }
+
+    // Coupled channels share the blame: too much current for the RPM is also
+    // too little RPM for the current, so both are flagged
+    ms->worst_distance = distance;
+    ms->worst_flags = 0;
+    for (uint32_t i = 0; i < dim; i++) {
+        if (residual[i] > chi2_999[0]) {
+            ms->worst_flags |= CHANNEL_FLAG(ms->channel[i]);
+        }
+    }
+}
+
+// Flag the unexplained channels when the worst distance crosses the threshold
+static uint32_t mahal_evaluate(void* state, const ThresholdConfig_t* thresholds) {
+    MahalanobisState_t* ms = (MahalanobisState_t*)state;
+    (void)thresholds;
+    uint32_t flags = 0;
+
+    if (ms->threshold > 0.0f && ms->worst_distance > ms->threshold) {
+        flags = ms->worst_flags;
+    }
+    // A healthy sample's squared distance averages dim; penalize only the excess
+    float dim = (float)ms->model.dim;
+    float excess = ms->worst_distance - dim;
+    ms->penalty = 0.0f;
+    if (ms->threshold > dim && excess > 0.0f) {
+        ms->penalty = fminf(excess / (ms->threshold - dim) * MAHAL_HEALTH_SLOPE, MAHAL_HEALTH_CAP);
+    }
+
+    ms->worst_distance = 0.0f;
+    return flags;
+}
+
+static float mahal_score(const void* state) {
+    return ((const MahalanobisState_t*)state)->penalty;
+}
+
+const DetectorOps_t mahalanobis_detector_ops = {
+    .name = "mahalanobis",
+    .state_size = sizeof(MahalanobisState_t),
+    .init = mahal_init,
+    .update = mahal_update,
+    .evaluate = mahal_evaluate,
+    .score = mahal_score,
+};
@@ -0,0 +1,99 @@
+/**
+ * Multi-Rate - Per-channel acquisition schedule and decimation to the analysis rate
+ */
+
+#include <string.h>
+#include "multirate.h"
+
+bool multirate_init(MultiRate_t* mr, uint32_t analysis_rate_hz) {
+    memset(mr, 0, sizeof(*mr));
+    if (analysis_rate_hz == 0) {
+        return false;
+    }
+    mr->analysis_rate_hz = analysis_rate_hz;
+
+    mr->base_rate_hz = analysis_rate_hz;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (sensor_channels[ch].rate_hz > mr->base_rate_hz) {
+            mr->base_rate_hz = sensor_channels[ch].rate_hz;
+        }
+    }
+    if (mr->base_rate_hz % analysis_rate_hz != 0) {
+        return false;
+    }
+    mr->period_ticks = mr->base_rate_hz / analysis_rate_hz;
+
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        uint32_t rate = sensor_channels[ch].rate_hz;
+        if (rate == 0 || mr->base_rate_hz % rate != 0) {
+            return false;
+        }
+        mr->divisor[ch] = mr->base_rate_hz / rate;
+
+        // Fast channels decimate by rate / analysis rate; the rest pass through
+        uint32_t factor = 1;
+        if (rate > analysis_rate_hz) {
+            if (rate % analysis_rate_hz != 0) {
+                return false;
+            }
+            factor = rate / analysis_rate_hz;
+        }
+        if (!decimator_init(&mr->decimator[ch], factor)) {
+            return false;
+        }
+        mr->latest[ch] = sensor_channels[ch].nominal;
+    }
+    return true;
+}
+
+uint32_t multirate_begin_period(MultiRate_t* mr, uint32_t due[CHANNEL_COUNT]) {
+    uint64_t start = mr->tick;
+    uint64_t end = start + mr->period_ticks;
+    uint32_t mask = 0;
+
+    // Samples land on multiples of the divisor: count those in [start, end)
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        uint64_t d = mr->divisor[ch];
+        due[ch] = (uint32_t)((end + d - 1) / d - (start + d - 1) / d);
+        if (due[ch] > 0) {
+            mask |= CHANNEL_FLAG(ch);
+        }
+    }
+
+    mr->tick = end;
+    return mask;
+}
+
+void multirate_push(MultiRate_t* mr, uint32_t channel, const float* samples, uint32_t count) {
+    if (channel >= CHANNEL_COUNT || count == 0) {
+        return;
+    }
+    mr->samples_in[channel] += count;
+
+    Decimator_t* dec = &mr->decimator[channel];
+    if (dec->stage_count == 0) {
+        mr->latest[channel] = samples[count - 1];
+        return;
+    }
+
+    // Only the newest decimated value is kept; the detectors run once per period
+    float out[8];
+    while (count > 0) {
+        uint32_t chunk = count;
+        if (chunk > dec->factor * 8) {
+            chunk = dec->factor * 8;
+        }
+        uint32_t produced = decimator_push(dec, samples, chunk, out, 8);
+        if (produced > 0) {
+            mr->latest[channel] = out[produced - 1];
+        }
+        samples += chunk;
+        count -= chunk;
+    }
+}
+
+void multirate_output(const MultiRate_t* mr, SensorData_t* out) {
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        out->values[ch] = mr->latest[ch];
+    }
+}
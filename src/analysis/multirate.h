@@ -0,0 +1,39 @@
+#ifndef MULTIRATE_H
+#define MULTIRATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_types.h"
+#include "decimator.h"
+
+// Multi-rate acquisition. Each channel is sampled at its own rate_hz from the
+// channel table and delivered to the detectors at one analysis rate:
+//   rate above the analysis rate  -> polyphase decimation to the analysis rate
+//   rate at or below it           -> read only when due, value held in between
+// The scheduler tick is the fastest channel rate; every rate must divide it.
+typedef struct {
+    uint32_t analysis_rate_hz;
+    uint32_t base_rate_hz;                  // Fastest channel rate
+    uint32_t period_ticks;                  // Base ticks per analysis period
+    uint32_t divisor[CHANNEL_COUNT];        // Base ticks between samples of a channel
+    uint64_t tick;                          // Base ticks at the start of the next period
+    Decimator_t decimator[CHANNEL_COUNT];   // Factor 1 for channels that are not decimated
+    float latest[CHANNEL_COUNT];            // Most recent analysis-rate value
+    uint32_t samples_in[CHANNEL_COUNT];     // Native samples consumed since init
+} MultiRate_t;
+
+// False if a channel rate does not divide the base rate, or a decimation
+// factor cannot be built from DECIMATOR_MAX_STAGES stages
+bool multirate_init(MultiRate_t* mr, uint32_t analysis_rate_hz);
+
+// Start the next analysis period: due[ch] = native samples the channel
+// produces in it. Returns the CHANNEL_FLAG() mask of channels with due > 0.
+uint32_t multirate_begin_period(MultiRate_t* mr, uint32_t due[CHANNEL_COUNT]);
+
+// Feed native-rate samples of one channel
+void multirate_push(MultiRate_t* mr, uint32_t channel, const float* samples, uint32_t count);
+
+// Analysis-rate values for every channel (timestamp untouched)
+void multirate_output(const MultiRate_t* mr, SensorData_t* out);
+
+#endif // MULTIRATE_H
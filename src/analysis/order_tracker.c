@@ -0,0 +1,164 @@
+/**
+ * Order Tracker - Angle-domain resampling and time-synchronous averaging
+ */
+
+#include <math.h>
+#include <string.h>
+#include "order_tracker.h"
+
+void order_tracker_init(OrderTracker_t* ot) {
+    memset(ot, 0, sizeof(*ot));
+    decimator_init(&ot->predecimator, ORDER_PREDECIMATION);
+    fft_init(&ot->fft, ORDER_SAMPLES_PER_REV);
+}
+
+// Catmull-Rom cubic between x1 and x2 at fraction t. The position pass gathers
+// the four neighbours into separate arrays, so this loop is element-wise with
+// no indexed loads. It always runs the whole batch: a fixed trip count lets the
+// compiler vectorize it at -O2 without a scalar tail.
+static void interpolate_cubic(const float* restrict x0, const float* restrict x1,
+                              const float* restrict x2, const float* restrict x3,
+                              const float* restrict frac, float* restrict out) {
+    for (uint32_t k = 0; k < ORDER_RESAMPLE_BATCH; k++) {
+        float t = frac[k];
+        float a = -0.5f * x0[k] + 1.5f * x1[k] - 1.5f * x2[k] + 0.5f * x3[k];
+        float b = x0[k] - 2.5f * x1[k] + 2.0f * x2[k] - 0.5f * x3[k];
+        float c = 0.5f * (x2[k] - x0[k]);
+        out[k] = ((a * t + b) * t + c) * t + x1[k];
+    }
+}
+
+static void complete_revolution(OrderTracker_t* ot) {
+    OrderTrackerResult_t* result = &ot->result;
+    const uint32_t n = ORDER_SAMPLES_PER_REV;
+
+    // Mean of the first ORDER_TSA_AVERAGES revolutions, then exponential with weight
+    // 1/ORDER_TSA_AVERAGES: older revolutions fade rather than drop out
+    uint32_t revs = ++result->revolutions;
+    float weight = 1.0f / (float)(revs < ORDER_TSA_AVERAGES ? revs : ORDER_TSA_AVERAGES);
+    for (uint32_t i = 0; i < n; i++) {
+        ot->tsa[i] += (ot->rev[i] - ot->tsa[i]) * weight;
+        ot->fft_re[i] = ot->tsa[i];
+        ot->fft_im[i] = 0.0f;
+    }
+
+    // One revolution per transform: bin k is exactly order k, no window needed
+    fft_forward(&ot->fft, ot->fft_re, ot->fft_im);
+
+    float ac_power = 0.0f;
+    result->peak_order = 0;
+    result->peak_amplitude = 0.0f;
+    for (uint32_t k = 0; k < n / 2; k++) {
+        float magnitude = sqrtf(ot->fft_re[k] * ot->fft_re[k] + ot->fft_im[k] * ot->fft_im[k]);
+        float amplitude = (k == 0 ? 1.0f : 2.0f) * magnitude / (float)n;
+        ot->order_amplitude[k] = amplitude;
+        if (k == 0) {
+            continue;
+        }
+        ac_power += amplitude * amplitude / 2.0f;
+        if (amplitude > result->peak_amplitude) {
+            result->peak_amplitude = amplitude;
+            result->peak_order = k;
+        }
+    }
+    result->tsa_rms = sqrtf(ac_power);
+    result->rev_hz = ot->rev_hz_count > 0 ? ot->rev_hz_sum / (float)ot->rev_hz_count : 0.0f;
+
+    ot->rev_fill = 0;
+    ot->rev_hz_sum = 0.0f;
+    ot->rev_hz_count = 0;
+}
+
+// Emit every output sample whose position falls inside the buffered history
+static bool resample(OrderTracker_t* ot, float rev_hz) {
+    const float limit = (float)(ot->history_len - 2);   // Cubic needs idx+2 in range
+    bool ready = false;
+
+    // Rotor stopped: no angle reference, drop the partial revolution
+    if (rev_hz <= 0.0f) {
+        ot->rev_fill = 0;
+        ot->rev_hz_sum = 0.0f;
+        ot->rev_hz_count = 0;
+        if (ot->next_pos < limit) {
+            ot->next_pos = limit;
+        }
+        return false;
+    }
+
+    // Speed is constant within one chunk, so positions advance by a fixed step
+    const float step = (float)(ORDER_INPUT_RATE_HZ / ORDER_PREDECIMATION) /
+                       ((float)ORDER_SAMPLES_PER_REV * rev_hz);
+    float (*x)[ORDER_RESAMPLE_BATCH] = ot->gather;
+
+    while (ot->next_pos < limit) {
+        uint32_t count = 0;
+        while (count < ORDER_RESAMPLE_BATCH && ot->next_pos < limit) {
+            uint32_t i = (uint32_t)ot->next_pos;
+            const float* p = &ot->history[i - 1];
+            x[0][count] = p[0];
+            x[1][count] = p[1];
+            x[2][count] = p[2];
+            x[3][count] = p[3];
+            ot->frac[count] = ot->next_pos - (float)i;
+            ot->next_pos += step;
+            count++;
+        }
+
+        // Entries past count hold the previous batch; their outputs are ignored
+        interpolate_cubic(x[0], x[1], x[2], x[3], ot->frac, ot->out);
+
+        for (uint32_t k = 0; k < count; k++) {
+            ot->rev[ot->rev_fill++] = ot->out[k];
+            ot->rev_hz_sum += rev_hz;
+            ot->rev_hz_count++;
+            if (ot->rev_fill == ORDER_SAMPLES_PER_REV) {
+                complete_revolution(ot);
+                ready = true;
+            }
+        }
+    }
+    return ready;
+}
+
+bool order_tracker_push(OrderTracker_t* ot, const float* samples, uint32_t count, float rev_hz) {
+    float decimated[ORDER_CHUNK / ORDER_PREDECIMATION + 1];
+    bool ready = false;
+
+    // Speed ramps linearly across the block; each chunk uses its midpoint speed
+    const float start_hz = ot->last_rev_hz > 0.0f ? ot->last_rev_hz : rev_hz;
+    const uint32_t total = count;
+    uint32_t done = 0;
+    ot->last_rev_hz = rev_hz;
+
+    while (count > 0) {
+        uint32_t chunk = count < ORDER_CHUNK ? count : ORDER_CHUNK;
+        float chunk_hz = start_hz + (rev_hz - start_hz) * ((float)done + chunk / 2.0f) / (float)total;
+        done += chunk;
+        uint32_t produced = decimator_push(&ot->predecimator, samples, chunk, decimated,
+                                           sizeof(decimated) / sizeof(decimated[0]));
+        samples += chunk;
+        count -= chunk;
+        if (produced == 0) {
+            continue;
+        }
+
+        // Start from the first sample repeated so the cubic has its left neighbours
+        if (ot->history_len == 0) {
+            ot->history[0] = ot->history[1] = ot->history[2] = decimated[0];
+            ot->history_len = 3;
+            ot->next_pos = 1.0f;
+        }
+
+        memcpy(&ot->history[ot->history_len], decimated, produced * sizeof(float));
+        ot->history_len += produced;
+
+        ready |= resample(ot, chunk_hz);
+
+        // Keep the last three samples; positions are relative to history[0]
+        uint32_t drop = ot->history_len - 3;
+        memmove(ot->history, &ot->history[drop], 3 * sizeof(float));
+        ot->history_len = 3;
+        ot->next_pos -= (float)drop;
+    }
+    return ready;
+}
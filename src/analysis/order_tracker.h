@@ -0,0 +1,66 @@
+#ifndef ORDER_TRACKER_H
+#define ORDER_TRACKER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "decimator.h"
+#include "fft.h"
+
+// Order tracking and time-synchronous averaging (TSA) of the raw vibration.
+// Rotor speed wanders, so fixed-rate FFT bins smear rotor-locked components
+// (blade pass, gear mesh). Resampling to a fixed number of samples per
+// revolution turns them into exact order bins; averaging whole revolutions
+// keeps what is locked to the rotor and cancels what is not. The average is
+// exponential, with a memory of about ORDER_TSA_AVERAGES revolutions.
+#define ORDER_INPUT_RATE_HZ     1000
+#define ORDER_PREDECIMATION     5       // Anti-alias to 200Hz before resampling
+#define ORDER_SAMPLES_PER_REV   512     // Orders 1..255 resolved
+#define ORDER_TSA_AVERAGES      8       // Exponential average memory in revolutions
+#define ORDER_CHUNK             250     // Raw samples processed per step
+#define ORDER_RESAMPLE_BATCH    64      // Output samples interpolated per kernel call
+
+// Rotor-locked orders worth watching on a 3-blade turbine
+#define ORDER_BLADE_PASS        3
+
+typedef struct {
+    uint32_t revolutions;       // Complete revolutions resampled since init
+    float rev_hz;               // Rotor speed of the latest revolution
+    float tsa_rms;              // RMS of the averaged revolution (mean removed)
+    uint32_t peak_order;        // Largest order in the TSA spectrum (order >= 1)
+    float peak_amplitude;
+} OrderTrackerResult_t;
+
+typedef struct {
+    Decimator_t predecimator;
+    float history[3 + ORDER_CHUNK / ORDER_PREDECIMATION + 1];  // 3 samples kept for the cubic
+    uint32_t history_len;
+    float next_pos;                                 // Next output position in history[]
+    float rev[ORDER_SAMPLES_PER_REV];               // Revolution being resampled
+    uint32_t rev_fill;
+    float last_rev_hz;                              // Speed at the end of the previous push
+    float rev_hz_sum;                               // For the revolution's mean speed
+    uint32_t rev_hz_count;
+    float tsa[ORDER_SAMPLES_PER_REV];               // Exponentially averaged revolution
+    Fft_t fft;
+    float fft_re[ORDER_SAMPLES_PER_REV];
+    float fft_im[ORDER_SAMPLES_PER_REV];
+    float gather[4][ORDER_RESAMPLE_BATCH];          // Interpolation scratch, kept off the task stack
+    float frac[ORDER_RESAMPLE_BATCH];
+    float out[ORDER_RESAMPLE_BATCH];
+    float order_amplitude[ORDER_SAMPLES_PER_REV / 2];  // Bin k = order k, peak amplitude
+    OrderTrackerResult_t result;
+} OrderTracker_t;
+
+void order_tracker_init(OrderTracker_t* ot);
+
+// Feed raw vibration at ORDER_INPUT_RATE_HZ with the rotor speed measured at
+// the end of the block, in revolutions per second (rpm / 60). Speed is ramped
+// from the previous push's value across the block. Returns true when a
+// revolution completed and the TSA, its order spectrum and the result were updated.
+bool order_tracker_push(OrderTracker_t* ot, const float* samples, uint32_t count, float rev_hz);
+
+static inline float order_tracker_amplitude(const OrderTracker_t* ot, uint32_t order) {
+    return order < ORDER_SAMPLES_PER_REV / 2 ? ot->order_amplitude[order] : 0.0f;
+}
+
+#endif // ORDER_TRACKER_H
@@ -0,0 +1,77 @@
+/**
+ * Trace Replay - Offline driver for the anomaly engine
+ */
+
+#include <string.h>
+#include "replay.h"
+#include "trace.h"
+
+void replay_summary_init(ReplaySummary_t* summary) {
+    memset(summary, 0, sizeof(ReplaySummary_t));
+    summary->min_health = 100.0f;
+}
+
+void replay_summary_merge(ReplaySummary_t* into, const ReplaySummary_t* from) {
+    into->files += from->files;
+    into->samples += from->samples;
+    into->cycles += from->cycles;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        into->anomalies[ch] += from->anomalies[ch];
+    }
+    into->skipped_lines += from->skipped_lines;
+    into->health_sum += from->health_sum;
+    if (from->min_health < into->min_health) {
+        into->min_health = from->min_health;
+    }
+}
+
+static void evaluate_cycle(AnomalyEngine_t* engine, const ThresholdConfig_t* thresholds,
+                           ReplaySummary_t* summary) {
+    uint32_t flags = anomaly_engine_evaluate(engine, thresholds, false);
+
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (flags & CHANNEL_FLAG(ch)) summary->anomalies[ch]++;
+    }
+
+    float health = engine->results.health_score;
+    if (health < summary->min_health) {
+        summary->min_health = health;
+    }
+    summary->health_sum += health;
+    summary->cycles++;
+}
+
+bool replay_trace(const char* path, const ThresholdConfig_t* thresholds, uint32_t batch,
+                  AnomalyEngine_t* engine, DetectorClockFn clock_us,
+                  ReplaySummary_t* summary) {
+    TraceReader_t reader;
+    SensorData_t sample;
+
+    replay_summary_init(summary);
+    if (!trace_reader_open(&reader, path)) {
+        return false;
+    }
+
+    anomaly_engine_init(engine, clock_us);
+    if (batch == 0) {
+        batch = 1;
+    }
+
+    uint32_t pending = 0;
+    while (trace_reader_next(&reader, &sample)) {
+        anomaly_engine_feed(engine, &sample);
+        summary->samples++;
+        if (++pending >= batch) {
+            evaluate_cycle(engine, thresholds, summary);
+            pending = 0;
+        }
+    }
+    if (pending > 0) {
+        evaluate_cycle(engine, thresholds, summary);
+    }
+
+    summary->files = 1;
+    summary->skipped_lines = reader.skipped;
+    trace_reader_close(&reader);
+    return true;
+}
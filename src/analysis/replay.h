@@ -0,0 +1,28 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "anomaly_engine.h"
+
+// Summary of one or more replayed traces
+typedef struct {
+    uint32_t files;
+    uint64_t samples;
+    uint64_t cycles;
+    uint32_t anomalies[CHANNEL_COUNT];   // Cycles with the channel flag raised
+    uint32_t skipped_lines;
+    float min_health;
+    double health_sum;               // For the average health score
+} ReplaySummary_t;
+
+void replay_summary_init(ReplaySummary_t* summary);
+void replay_summary_merge(ReplaySummary_t* into, const ReplaySummary_t* from);
+
+// Replay one trace through a freshly initialised engine, evaluating every
+// `batch` samples. Returns false if the trace cannot be opened.
+bool replay_trace(const char* path, const ThresholdConfig_t* thresholds, uint32_t batch,
+                  AnomalyEngine_t* engine, DetectorClockFn clock_us,
+                  ReplaySummary_t* summary);
+
+#endif // REPLAY_H
@@ -0,0 +1,121 @@
+/**
+ * Rollup - Incremental min/max/mean summaries over 1s, 1min and 1h tiers
+ */
+
+#include <string.h>
+#include "rollup.h"
+
+const uint32_t rollup_period_s[ROLLUP_TIERS] = { 1, 60, 3600 };
+
+const char* const rollup_tier_names[ROLLUP_TIERS] = { "1s", "1m", "1h" };
+
+void rollup_init(Rollup_t* rollup) {
+    memset(rollup, 0, sizeof(*rollup));
+}
+
+// Fold bucket b into a; the mean is weighted by sample count
+static void merge_bucket(RollupBucket_t* a, const RollupBucket_t* b) {
+    if (b->count == 0) {
+        return;
+    }
+    if (a->count == 0) {
+        uint32_t start_s = a->start_s;
+        *a = *b;
+        a->start_s = start_s;
+        return;
+    }
+
+    float weight = (float)b->count / (float)(a->count + b->count);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (b->min[ch] < a->min[ch]) a->min[ch] = b->min[ch];
+        if (b->max[ch] > a->max[ch]) a->max[ch] = b->max[ch];
+        a->mean[ch] += (b->mean[ch] - a->mean[ch]) * weight;
+        a->last[ch] = b->last[ch];
+    }
+    a->count += b->count;
+}
+
+// Move a tier's open bucket into its ring and into the next tier's open bucket
+static void close_bucket(Rollup_t* rollup, uint32_t tier) {
+    RollupTierState_t* state = &rollup->tiers[tier];
+
+    state->ring[state->closed % ROLLUP_RING_LENGTH] = state->open;
+    state->closed++;
+
+    if (tier + 1 < ROLLUP_TIERS) {
+        RollupBucket_t* up = &rollup->tiers[tier + 1].open;
+        if (up->count == 0) {
+            up->start_s = state->open.start_s - state->open.start_s % rollup_period_s[tier + 1];
+        }
+        merge_bucket(up, &state->open);
+    }
+    state->open.count = 0;
+}
+
+// First sample of a new second: close every tier whose period has ended,
+// finest first so each closing bucket reaches the next tier before that tier
+// is checked
+static void start_second(Rollup_t* rollup, uint32_t now_s, const SensorData_t* sample) {
+    for (uint32_t tier = 0; tier < ROLLUP_TIERS; tier++) {
+        const RollupBucket_t* open = &rollup->tiers[tier].open;
+        if (open->count > 0 && open->start_s != now_s - now_s % rollup_period_s[tier]) {
+            close_bucket(rollup, tier);
+        }
+    }
+
+    RollupBucket_t* open = &rollup->tiers[ROLLUP_SECOND].open;
+    open->start_s = now_s;
+    open->count = 1;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        float x = sample->values[ch];
+        open->min[ch] = open->max[ch] = open->mean[ch] = open->last[ch] = x;
+    }
+}
+
+void rollup_add(Rollup_t* rollup, const SensorData_t* sample) {
+    uint32_t now_s = sample->timestamp / ROLLUP_TIMESTAMP_HZ;
+    RollupBucket_t* open = &rollup->tiers[ROLLUP_SECOND].open;
+
+    // Higher tiers only change when the second does
+    if (open->count == 0 || open->start_s != now_s) {
+        start_second(rollup, now_s, sample);
+        return;
+    }
+
+    open->count++;
+    float weight = 1.0f / (float)open->count;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        float x = sample->values[ch];
+        if (x < open->min[ch]) open->min[ch] = x;
+        if (x > open->max[ch]) open->max[ch] = x;
+        open->mean[ch] += (x - open->mean[ch]) * weight;
+        open->last[ch] = x;
+    }
+}
+
+const RollupBucket_t* rollup_bucket(const Rollup_t* rollup, RollupTier_t tier, uint32_t age) {
+    const RollupTierState_t* state = &rollup->tiers[tier];
+    if (age >= state->closed || age >= ROLLUP_RING_LENGTH) {
+        return NULL;
+    }
+    return &state->ring[(state->closed - 1 - age) % ROLLUP_RING_LENGTH];
+}
+
+uint32_t rollup_merge_since(const Rollup_t* rollup, RollupTier_t tier, uint32_t since,
+                            RollupBucket_t* out) {
+    const RollupTierState_t* state = &rollup->tiers[tier];
+    uint32_t pending = state->closed - since;
+    if (pending > ROLLUP_RING_LENGTH) {
+        pending = ROLLUP_RING_LENGTH;
+    }
+
+    out->count = 0;
+    for (uint32_t age = pending; age-- > 0; ) {
+        const RollupBucket_t* bucket = &state->ring[(state->closed - 1 - age) % ROLLUP_RING_LENGTH];
+        if (out->count == 0) {
+            out->start_s = bucket->start_s;
+        }
+        merge_bucket(out, bucket);
+    }
+    return state->closed;
+}
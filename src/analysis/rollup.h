@@ -0,0 +1,60 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stdint.h>
+#include "sensor_types.h"
+
+// Min/max/mean/last of every channel over 1s, 1min and 1h buckets. A sample
+// updates only the open 1s bucket; a bucket that closes is merged into the
+// open bucket of the next tier, so a sample costs O(1) and a closing bucket
+// O(channels). Each tier keeps its latest ROLLUP_RING_LENGTH closed buckets.
+#define ROLLUP_TIERS            3
+#define ROLLUP_RING_LENGTH      60
+#define ROLLUP_TIMESTAMP_HZ     1000    // SensorData_t.timestamp ticks per second
+
+typedef enum {
+    ROLLUP_SECOND = 0,
+    ROLLUP_MINUTE,
+    ROLLUP_HOUR
+} RollupTier_t;
+
+extern const uint32_t rollup_period_s[ROLLUP_TIERS];
+extern const char* const rollup_tier_names[ROLLUP_TIERS];
+
+typedef struct {
+    uint32_t start_s;       // Start of the bucket's period in sample time
+    uint32_t count;         // Samples summarized, 0 for an empty bucket
+    float min[CHANNEL_COUNT];
+    float max[CHANNEL_COUNT];
+    float mean[CHANNEL_COUNT];
+    float last[CHANNEL_COUNT];
+} RollupBucket_t;
+
+typedef struct {
+    RollupBucket_t open;                        // Period in progress
+    RollupBucket_t ring[ROLLUP_RING_LENGTH];    // Closed buckets
+    uint32_t closed;                            // Buckets closed since init
+} RollupTierState_t;
+
+typedef struct {
+    RollupTierState_t tiers[ROLLUP_TIERS];
+} Rollup_t;
+
+void rollup_init(Rollup_t* rollup);
+
+// Add an analysis-rate sample. Periods are aligned to the sample timestamps;
+// a sample from a later period first closes the buckets it has left.
+void rollup_add(Rollup_t* rollup, const SensorData_t* sample);
+
+// Closed bucket of a tier, age 0 the newest. NULL if not closed yet or
+// already overwritten.
+const RollupBucket_t* rollup_bucket(const Rollup_t* rollup, RollupTier_t tier, uint32_t age);
+
+// Merge the buckets of a tier closed after the first `since` into out, for
+// a reader that keeps its own position. Returns the tier's closed count to
+// pass next time; out->count is 0 if nothing new closed. Buckets already
+// overwritten are skipped.
+uint32_t rollup_merge_since(const Rollup_t* rollup, RollupTier_t tier, uint32_t since,
+                            RollupBucket_t* out);
+
+#endif // ROLLUP_H
@@ -0,0 +1,99 @@
+/**
+ * Sensor Channels - Channel descriptors generated from the channel table
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sensor_channels.h"
+#include "sensor_types.h"
+
+const ChannelInfo_t sensor_channels[CHANNEL_COUNT] = {
+#define SENSOR_CHANNEL_INFO(ID, name_, label_, unit_, rate_, decimals_, full_scale_, nominal_, \
+                            warn_lo, warn_hi, crit_lo, crit_hi, detectors_, slope, cap, severity, \
+                            deadband_, deadband_rel_, silence) \
+    [CHANNEL_##ID] = { \
+        .name = #name_, \
+        .label = label_, \
+        .unit = unit_, \
+        .rate_hz = rate_, \
+        .decimals = decimals_, \
+        .full_scale = full_scale_, \
+        .nominal = nominal_, \
+        .default_limits = { warn_lo, warn_hi, crit_lo, crit_hi }, \
+        .detectors = detectors_, \
+        .health_slope = slope, \
+        .health_cap = cap, \
+        .alert_severity = severity, \
+        .deadband = deadband_, \
+        .deadband_rel = deadband_rel_, \
+        .max_silence_s = silence, \
+    },
+    SENSOR_CHANNEL_TABLE(SENSOR_CHANNEL_INFO)
+#undef SENSOR_CHANNEL_INFO
+};
+
+int sensor_channel_find(const char* name) {
+    for (int ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (strcmp(sensor_channels[ch].name, name) == 0) {
+            return ch;
+        }
+    }
+    return -1;
+}
+
+uint32_t sensor_channel_mask(uint32_t detector_set) {
+    uint32_t mask = 0;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (sensor_channels[ch].detectors & detector_set) {
+            mask |= CHANNEL_FLAG(ch);
+        }
+    }
+    return mask;
+}
+
+// Default thresholds used at boot and by the offline tools
+void threshold_config_defaults(ThresholdConfig_t* thresholds) {
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        thresholds->channels[ch] = sensor_channels[ch].default_limits;
+    }
+}
+
+bool threshold_config_set(ThresholdConfig_t* thresholds, const char* assignment) {
+    const char* dot = strchr(assignment, '.');
+    const char* eq = strchr(assignment, '=');
+    char channel_name[32];
+
+    if (dot == NULL || eq == NULL || eq < dot || (size_t)(dot - assignment) >= sizeof(channel_name)) {
+        return false;
+    }
+
+    memcpy(channel_name, assignment, (size_t)(dot - assignment));
+    channel_name[dot - assignment] = '\0';
+    int ch = sensor_channel_find(channel_name);
+    if (ch < 0) {
+        return false;
+    }
+
+    ChannelLimits_t* limits = &thresholds->channels[ch];
+    struct { const char* name; float* field; } fields[] = {
+        { "warning_low",   &limits->warning_low },
+        { "warning_high",  &limits->warning_high },
+        { "critical_low",  &limits->critical_low },
+        { "critical_high", &limits->critical_high },
+    };
+
+    const char* limit = dot + 1;
+    size_t limit_len = (size_t)(eq - limit);
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (strlen(fields[i].name) == limit_len && strncmp(fields[i].name, limit, limit_len) == 0) {
+            char* end;
+            float value = strtof(eq + 1, &end);
+            if (end == eq + 1) {
+                return false;
+            }
+            *fields[i].field = value;
+            return true;
+        }
+    }
+    return false;
+}
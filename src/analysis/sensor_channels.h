@@ -0,0 +1,107 @@
+#ifndef SENSOR_CHANNELS_H
+#define SENSOR_CHANNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <float.h>
+
+// Detector sets a channel can be watched by
+#define DETECTOR_SET_SIGMA      (1u << 0)   // 3-sigma baseline (float or Q15)
+#define DETECTOR_SET_MAHALANOBIS (1u << 1)  // Joint distance of coupled channels
+
+// Limit placeholders for channels with a one-sided range
+#define NO_LOWER_LIMIT          (-FLT_MAX)
+#define NO_UPPER_LIMIT          FLT_MAX
+
+/*
+ * Sensor channel table - the single definition of every monitored channel.
+ * Structs (SensorData_t, AnomalyResults_t, ThresholdConfig_t), default limits,
+ * detector loops, safety checks, telemetry and dashboard rows are generated
+ * from it. Adding a channel is one row; traces list channels in this order.
+ *
+ * X(ID, name, label, unit, rate_hz, decimals, full_scale, nominal,
+ *   warning_low, warning_high, critical_low, critical_high,
+ *   detectors, health_slope, health_cap, alert_severity,
+ *   deadband, deadband_rel, max_silence_s)
+ *
+ *   rate_hz          Native sample rate of the sensor; must divide the fastest
+ *                    rate (see multirate.h). Mirrors *_SAMPLE_RATE_HZ in app_config.h
+ *   decimals         Digits shown on the dashboard
+ *   full_scale       Q15 full scale for the fixed-point path (power of two)
+ *   nominal          Typical operating value (boot state, simulation)
+ *   warning_*        Outside this range the detectors raise an anomaly
+ *   critical_*       Outside this range the safety task raises an alarm
+ *   detectors        DETECTOR_SET_* bits watching the channel
+ *   health_slope/cap Health penalty per 3-sigma of deviation, and its ceiling
+ *   alert_severity   Severity of the network alert (0 = no alert)
+ *   deadband         Report-by-exception telemetry sends the channel once it
+ *   deadband_rel     moves more than max(deadband, deadband_rel * |last sent|)
+ *   max_silence_s    from the value last sent, or after max_silence_s anyway
+ */
+#define SENSOR_CHANNEL_TABLE(X) \
+    X(VIBRATION,   vibration,   "Vibration",   "mm/s", 1000, 2, 128.0f,  2.45f, \
+      NO_LOWER_LIMIT,  5.0f, NO_LOWER_LIMIT,  10.0f, DETECTOR_SET_SIGMA, 20.0f, 30.0f, 8.0f, \
+      1.0f, 0.0f, 60) \
+    X(TEMPERATURE, temperature, "Temperature", "C",      10, 1, 128.0f, 45.2f, \
+      NO_LOWER_LIMIT, 70.0f, NO_LOWER_LIMIT,  85.0f, DETECTOR_SET_SIGMA, 15.0f, 25.0f, 5.0f, \
+      0.5f, 0.0f, 300) \
+    X(RPM,         rpm,         "RPM",         "rpm",    10, 1,  64.0f, 20.1f, \
+      10.0f,          30.0f, 10.0f,           30.0f, DETECTOR_SET_SIGMA | DETECTOR_SET_MAHALANOBIS, \
+      15.0f, 25.0f, 0.0f, \
+      0.0f, 0.05f, 60) \
+    X(CURRENT,     current,     "Current",     "A",      10, 1, 256.0f, 50.0f, \
+      NO_LOWER_LIMIT, NO_UPPER_LIMIT, NO_LOWER_LIMIT, 100.0f, DETECTOR_SET_MAHALANOBIS, \
+      0.0f,  0.0f, 0.0f, \
+      0.0f, 0.05f, 60)
+
+// Channel indices: CHANNEL_VIBRATION, CHANNEL_TEMPERATURE, ...
+typedef enum {
+#define SENSOR_CHANNEL_ENUM(ID, ...) CHANNEL_##ID,
+    SENSOR_CHANNEL_TABLE(SENSOR_CHANNEL_ENUM)
+#undef SENSOR_CHANNEL_ENUM
+    CHANNEL_COUNT
+} SensorChannel_t;
+
+// Anomaly/alarm flag for a channel
+#define CHANNEL_FLAG(ch)        (1u << (ch))
+
+// Operating limits of one channel
+typedef struct {
+    float warning_low;
+    float warning_high;
+    float critical_low;
+    float critical_high;
+} ChannelLimits_t;
+
+// Static description of one channel (generated from the table)
+typedef struct {
+    const char* name;
+    const char* label;
+    const char* unit;
+    uint32_t rate_hz;
+    uint32_t decimals;
+    float full_scale;
+    float nominal;
+    ChannelLimits_t default_limits;
+    uint32_t detectors;
+    float health_slope;
+    float health_cap;
+    float alert_severity;
+    float deadband;
+    float deadband_rel;
+    uint32_t max_silence_s;
+} ChannelInfo_t;
+
+extern const ChannelInfo_t sensor_channels[CHANNEL_COUNT];
+
+// Channel index by name, -1 if unknown
+int sensor_channel_find(const char* name);
+
+// Mask of channels watched by a detector set
+uint32_t sensor_channel_mask(uint32_t detector_set);
+
+static inline bool channel_outside(float value, float low, float high) {
+    return value < low || value > high;
+}
+
+#endif // SENSOR_CHANNELS_H
@@ -0,0 +1,54 @@
+#ifndef SENSOR_TYPES_H
+#define SENSOR_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_channels.h"
+#include "trend.h"
+
+// Sensor Data Structure: one named float per channel, also addressable as
+// values[CHANNEL_x] for generic loops
+typedef struct {
+    union {
+        struct {
+#define SENSOR_CHANNEL_FIELD(ID, name, ...) float name;
+            SENSOR_CHANNEL_TABLE(SENSOR_CHANNEL_FIELD)
+#undef SENSOR_CHANNEL_FIELD
+        };
+        float values[CHANNEL_COUNT];
+    };
+    uint32_t timestamp;  // System ticks
+} SensorData_t;
+
+// Anomaly Detection Results
+typedef struct {
+    union {
+        struct {
+#define SENSOR_CHANNEL_ANOMALY(ID, name, ...) bool name##_anomaly;
+            SENSOR_CHANNEL_TABLE(SENSOR_CHANNEL_ANOMALY)
+#undef SENSOR_CHANNEL_ANOMALY
+        };
+        bool channel_anomaly[CHANNEL_COUNT];
+    };
+    uint32_t anomaly_flags;  // CHANNEL_FLAG bits from the last cycle
+    float health_score;      // 0-100%
+    uint32_t anomaly_count;
+
+    // Trends toward the critical limits (channels) and TREND_HEALTH_LIMIT
+    TrendResult_t channel_trend[CHANNEL_COUNT][TREND_SCALES];
+    TrendResult_t health_trend[TREND_SCALES];
+} AnomalyResults_t;
+
+// Threshold Configuration (per channel, defaults come from the channel table)
+typedef struct {
+    ChannelLimits_t channels[CHANNEL_COUNT];
+} ThresholdConfig_t;
+
+// Default thresholds used at boot and by the offline tools
+void threshold_config_defaults(ThresholdConfig_t* thresholds);
+
+// Apply "<channel>.<limit>=<value>", e.g. "vibration.warning_high=6".
+// Limits: warning_low, warning_high, critical_low, critical_high.
+bool threshold_config_set(ThresholdConfig_t* thresholds, const char* assignment);
+
+#endif // SENSOR_TYPES_H
@@ -0,0 +1,121 @@
+/**
+ * Sigma Detector - Moving baseline with 3-sigma deviation rule
+ * Original threshold-based detection, packaged behind the detector interface.
+ * Watches every channel tagged DETECTOR_SET_SIGMA in the channel table.
+ */
+
+#include <math.h>
+#include "detector.h"
+#include "stats.h"
+
+// Detection state
+typedef struct {
+    float history[CHANNEL_COUNT][HISTORY_SIZE];
+    uint32_t history_index;
+    uint32_t channel_mask;       // Channels this detector watches
+
+    float baseline[CHANNEL_COUNT];
+    float stddev[CHANNEL_COUNT];
+
+    SensorData_t latest;
+    float penalty;
+} DetectionState_t;
+
+// Mean and standard deviation of the last `count` entries of a history ring
+static void window_stats(const float* history, uint32_t end_index, uint32_t count,
+                         float* mean, float* stddev) {
+    float window[BASELINE_WINDOW];
+
+    // The window may wrap around the end of the ring
+    for (uint32_t i = 0; i < count; i++) {
+        window[i] = history[(end_index - count + i) % HISTORY_SIZE];
+    }
+
+    *mean = calculate_mean(window, count);
+    *stddev = calculate_stddev(window, count, *mean);
+}
+
+// Update baselines using moving average
+static void update_baselines(DetectionState_t* ds) {
+    uint32_t count = BASELINE_WINDOW;
+
+    if (ds->history_index < BASELINE_WINDOW) {
+        count = ds->history_index;
+    }
+
+    if (count > 0) {
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            if (ds->channel_mask & CHANNEL_FLAG(ch)) {
+                window_stats(ds->history[ch], ds->history_index, count,
+                             &ds->baseline[ch], &ds->stddev[ch]);
+            }
+        }
+    }
+}
+
+static void sigma_init(void* state) {
+    DetectionState_t* ds = (DetectionState_t*)state;
+    ds->channel_mask = sensor_channel_mask(DETECTOR_SET_SIGMA);
+    ds->penalty = 0.0f;
+}
+
+// Store sample in history and refresh the baselines
+static void sigma_update(void* state, const SensorData_t* sample) {
+    DetectionState_t* ds = (DetectionState_t*)state;
+
+    uint32_t idx = ds->history_index % HISTORY_SIZE;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        ds->history[ch][idx] = sample->values[ch];
+    }
+    ds->history_index++;
+    ds->latest = *sample;
+
+    update_baselines(ds);
+}
+
+// Detect anomalies (3-sigma rule or warning limits) and compute the health penalty
+static uint32_t sigma_evaluate(void* state, const ThresholdConfig_t* thresholds) {
+    DetectionState_t* ds = (DetectionState_t*)state;
+    bool baseline_ready = ds->history_index > BASELINE_WINDOW;
+    uint32_t flags = 0;
+    float penalty = 0.0f;
+
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (!(ds->channel_mask & CHANNEL_FLAG(ch))) {
+            continue;
+        }
+
+        const ChannelLimits_t* limits = &thresholds->channels[ch];
+        float value = ds->latest.values[ch];
+        float deviation = fabsf(value - ds->baseline[ch]);
+
+        if (baseline_ready &&
+            (deviation > 3.0f * ds->stddev[ch] ||
+             channel_outside(value, limits->warning_low, limits->warning_high))) {
+            flags |= CHANNEL_FLAG(ch);
+        }
+
+        // Reduce health based on deviations
+        if (ds->stddev[ch] > 0) {
+            float score = deviation / (ds->stddev[ch] * 3.0f);
+            penalty += fminf(score * sensor_channels[ch].health_slope,
+                             sensor_channels[ch].health_cap);
+        }
+    }
+
+    ds->penalty = penalty;
+    return flags;
+}
+
+static float sigma_score(const void* state) {
+    return ((const DetectionState_t*)state)->penalty;
+}
+
+const DetectorOps_t sigma_detector_ops = {
+    .name = "sigma3",
+    .state_size = sizeof(DetectionState_t),
+    .init = sigma_init,
+    .update = sigma_update,
+    .evaluate = sigma_evaluate,
+    .score = sigma_score,
+};
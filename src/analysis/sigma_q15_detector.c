@@ -0,0 +1,147 @@
+/**
+ * Sigma Q15 Detector - Fixed-point twin of the 3-sigma baseline detector
+ *
+ * Same window, rule and penalty caps as sigma_detector.c, but samples are
+ * quantized to Q15 on ingest and every later step is integer math. Intended
+ * for MCUs without a double-precision FPU, where the float path pulls in
+ * soft-float sqrt/fabs/fmin. Window statistics are exact integer running
+ * sums, so each update is O(1) instead of a pass over the window; the mean
+ * and the integer square root for the deviation are taken once per evaluate.
+ */
+
+#include <string.h>
+#include "detector.h"
+#include "fixed_point.h"
+#include "stats.h"
+
+// Detection state
+typedef struct {
+    q15_t history[CHANNEL_COUNT][HISTORY_SIZE];
+    uint32_t history_index;
+    uint32_t channel_mask;       // Channels this detector watches
+
+    // Exact running sums over the last BASELINE_WINDOW samples
+    RollingStatsQ15_t window[CHANNEL_COUNT];
+
+    // Penalty slope and cap per channel in Q16.16 percentage points
+    int32_t slope_q16[CHANNEL_COUNT];
+    int32_t cap_q16[CHANNEL_COUNT];
+
+    SensorSampleQ15_t latest;
+    int32_t penalty_q16;
+
+    // Thresholds are re-quantized only when they change
+    ThresholdConfig_t cached_thresholds;
+    ThresholdConfigQ15_t thresholds_q15;
+    bool thresholds_valid;
+} DetectionStateQ15_t;
+
+// Push a sample into a channel ring and slide its window sums
+static void channel_push(DetectionStateQ15_t* ds, uint32_t ch, q15_t value) {
+    q15_t* history = ds->history[ch];
+    uint32_t index = ds->history_index;
+
+    if (index >= BASELINE_WINDOW) {
+        rolling_stats_q15_remove(&ds->window[ch], history[(index - BASELINE_WINDOW) % HISTORY_SIZE]);
+    }
+    history[index % HISTORY_SIZE] = value;
+    rolling_stats_q15_add(&ds->window[ch], value);
+}
+
+static inline int32_t abs_diff(q15_t a, q15_t b) {
+    int32_t diff = (int32_t)a - b;
+    return diff < 0 ? -diff : diff;
+}
+
+// min(deviation / (3 * stddev) * slope, cap) in Q16.16
+static int32_t channel_penalty(int32_t deviation, q15_t stddev, int32_t slope_q16, int32_t cap_q16) {
+    if (stddev <= 0) {
+        return 0;
+    }
+    int64_t penalty = ((int64_t)deviation * slope_q16) / (3 * (int32_t)stddev);
+    return penalty > cap_q16 ? cap_q16 : (int32_t)penalty;
+}
+
+static void sigma_q15_init(void* state) {
+    DetectionStateQ15_t* ds = (DetectionStateQ15_t*)state;
+#if ANALYSIS_USE_FIXED_POINT
+    // The float-only Mahalanobis detector is not registered in this build, so
+    // the channels only it watches (current) fall back to the 3-sigma rule
+    ds->channel_mask = sensor_channel_mask(DETECTOR_SET_SIGMA | DETECTOR_SET_MAHALANOBIS);
+#else
+    ds->channel_mask = sensor_channel_mask(DETECTOR_SET_SIGMA);
+#endif
+    ds->penalty_q16 = 0;
+    ds->thresholds_valid = false;
+
+    // Converted once here so evaluate() stays integer-only
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        ds->slope_q16[ch] = (int32_t)(sensor_channels[ch].health_slope * Q16_ONE);
+        ds->cap_q16[ch] = (int32_t)(sensor_channels[ch].health_cap * Q16_ONE);
+    }
+}
+
+// O(1) per sample: the window sums slide instead of being recomputed
+static void sigma_q15_update(void* state, const SensorData_t* sample) {
+    DetectionStateQ15_t* ds = (DetectionStateQ15_t*)state;
+
+    sensor_sample_to_q15(sample, &ds->latest);
+
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (ds->channel_mask & CHANNEL_FLAG(ch)) {
+            channel_push(ds, ch, ds->latest.values[ch]);
+        }
+    }
+    ds->history_index++;
+}
+
+static uint32_t sigma_q15_evaluate(void* state, const ThresholdConfig_t* thresholds) {
+    DetectionStateQ15_t* ds = (DetectionStateQ15_t*)state;
+    bool baseline_ready = ds->history_index > BASELINE_WINDOW;
+    uint32_t flags = 0;
+    int32_t penalty = 0;
+
+    if (!ds->thresholds_valid ||
+        memcmp(&ds->cached_thresholds, thresholds, sizeof(ThresholdConfig_t)) != 0) {
+        ds->cached_thresholds = *thresholds;
+        threshold_config_to_q15(thresholds, &ds->thresholds_q15);
+        ds->thresholds_valid = true;
+    }
+
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (!(ds->channel_mask & CHANNEL_FLAG(ch))) {
+            continue;
+        }
+
+        const ChannelLimitsQ15_t* limits = &ds->thresholds_q15.channels[ch];
+        q15_t value = ds->latest.values[ch];
+        q15_t baseline = rolling_stats_q15_mean(&ds->window[ch]);
+        q15_t stddev = rolling_stats_q15_stddev(&ds->window[ch]);
+        int32_t deviation = abs_diff(value, baseline);
+
+        if (baseline_ready &&
+            (deviation > 3 * (int32_t)stddev ||
+             value < limits->warning_low || value > limits->warning_high)) {
+            flags |= CHANNEL_FLAG(ch);
+        }
+
+        penalty += channel_penalty(deviation, stddev, ds->slope_q16[ch], ds->cap_q16[ch]);
+    }
+
+    ds->penalty_q16 = penalty;
+    return flags;
+}
+
+// The registry fuses scores as float; convert once per cycle at the boundary
+static float sigma_q15_score(const void* state) {
+    return (float)((const DetectionStateQ15_t*)state)->penalty_q16 / (float)Q16_ONE;
+}
+
+const DetectorOps_t sigma_q15_detector_ops = {
+    .name = "sigma3q15",
+    .state_size = sizeof(DetectionStateQ15_t),
+    .init = sigma_q15_init,
+    .update = sigma_q15_update,
+    .evaluate = sigma_q15_evaluate,
+    .score = sigma_q15_score,
+};
@@ -0,0 +1,62 @@
+/**
+ * Statistics helpers shared by the detectors
+ */
+
+#include <math.h>
+#include "stats.h"
+
+// Calculate mean of array
+float calculate_mean(const float* data, uint32_t size) {
+    float sum = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        sum += data[i];
+    }
+    return sum / size;
+}
+
+// Calculate standard deviation
+float calculate_stddev(const float* data, uint32_t size, float mean) {
+    float sum_sq = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        float diff = data[i] - mean;
+        sum_sq += diff * diff;
+    }
+    return sqrt(sum_sq / size);
+}
+
+void rolling_stats_q15_add(RollingStatsQ15_t* stats, q15_t value) {
+    stats->sum += value;
+    stats->sum_sq += (uint32_t)((int32_t)value * value);
+    stats->count++;
+}
+
+void rolling_stats_q15_remove(RollingStatsQ15_t* stats, q15_t value) {
+    stats->sum -= value;
+    stats->sum_sq -= (uint32_t)((int32_t)value * value);
+    stats->count--;
+}
+
+// Mean rounded to nearest
+q15_t rolling_stats_q15_mean(const RollingStatsQ15_t* stats) {
+    if (stats->count == 0) {
+        return 0;
+    }
+    int32_t n = (int32_t)stats->count;
+    int32_t sum = stats->sum;
+    return q15_saturate((sum >= 0 ? sum + n / 2 : sum - n / 2) / n);
+}
+
+// Population standard deviation: sqrt((n*sum_sq - sum^2) / n^2)
+q15_t rolling_stats_q15_stddev(const RollingStatsQ15_t* stats) {
+    if (stats->count == 0) {
+        return 0;
+    }
+    uint64_t n = stats->count;
+    uint64_t spread = n * stats->sum_sq - (uint64_t)((int64_t)stats->sum * stats->sum);
+
+    // The spread is small for a steady window - keep the divide in 32 bits
+    if (spread <= UINT32_MAX && n * n <= UINT32_MAX) {
+        return q15_saturate(isqrt32((uint32_t)spread / (uint32_t)(n * n)));
+    }
+    return q15_saturate((int32_t)isqrt64(spread / (n * n)));
+}
@@ -0,0 +1,24 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include "fixed_point.h"
+
+// Basic statistics over a contiguous window
+float calculate_mean(const float* data, uint32_t size);
+float calculate_stddev(const float* data, uint32_t size, float mean);
+
+// Rolling window statistics over Q15 samples. Integer sums are exact, so they
+// can be updated in O(1) per sample without the drift a float running sum has.
+typedef struct {
+    int32_t sum;
+    uint64_t sum_sq;
+    uint32_t count;
+} RollingStatsQ15_t;
+
+void rolling_stats_q15_add(RollingStatsQ15_t* stats, q15_t value);
+void rolling_stats_q15_remove(RollingStatsQ15_t* stats, q15_t value);
+q15_t rolling_stats_q15_mean(const RollingStatsQ15_t* stats);
+q15_t rolling_stats_q15_stddev(const RollingStatsQ15_t* stats);
+
+#endif // STATS_H
@@ -0,0 +1,88 @@
+/**
+ * Trace Reader - CSV sensor recordings for offline replay
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "trace.h"
+
+bool trace_reader_open(TraceReader_t* reader, const char* path) {
+    memset(reader, 0, sizeof(TraceReader_t));
+
+    if (strcmp(path, "-") == 0) {
+        reader->file = stdin;
+    } else {
+        reader->file = fopen(path, "r");
+    }
+    if (reader->file == NULL) {
+        return false;
+    }
+
+    // Large reads keep replay throughput bound by parsing, not syscalls
+    setvbuf(reader->file, NULL, _IOFBF, TRACE_READ_BUFFER_SIZE);
+    return true;
+}
+
+// Parse "timestamp,<channel>,..." without sscanf (this is the replay hot path).
+// Channels follow the channel table order; trailing channels missing from
+// older recordings take their nominal value.
+static bool parse_line(const char* line, SensorData_t* sample) {
+    char* end;
+    const char* p = line;
+
+    unsigned long ts = strtoul(p, &end, 10);
+    if (end == p || *end != ',') return false;
+    p = end + 1;
+
+    uint32_t ch = 0;
+    for (; ch < CHANNEL_COUNT; ch++) {
+        sample->values[ch] = strtof(p, &end);
+        if (end == p) return false;
+        if (*end != ',') {
+            ch++;
+            break;
+        }
+        p = end + 1;
+    }
+
+    for (; ch < CHANNEL_COUNT; ch++) {
+        sample->values[ch] = sensor_channels[ch].nominal;
+    }
+
+    sample->timestamp = (uint32_t)ts;
+    return true;
+}
+
+bool trace_reader_next(TraceReader_t* reader, SensorData_t* sample) {
+    char line[TRACE_LINE_MAX];
+
+    while (fgets(line, sizeof(line), reader->file) != NULL) {
+        reader->line++;
+
+        const char* p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        if (parse_line(p, sample)) {
+            reader->samples++;
+            return true;
+        }
+
+        // Header row is expected on line 1; anything else is malformed
+        if (!isalpha((unsigned char)*p) || reader->line > 1) {
+            reader->skipped++;
+        }
+    }
+
+    return false;
+}
+
+void trace_reader_close(TraceReader_t* reader) {
+    if (reader->file != NULL && reader->file != stdin) {
+        fclose(reader->file);
+    }
+    reader->file = NULL;
+}
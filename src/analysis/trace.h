@@ -0,0 +1,28 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sensor_types.h"
+
+// Recorded sensor traces are CSV, one sample per line:
+//   timestamp,vibration,temperature,rpm,current[,...]
+// Value columns follow SENSOR_CHANNEL_TABLE order; missing trailing channels
+// default to their nominal value. Blank lines, '#' comments and the header
+// row are skipped.
+#define TRACE_LINE_MAX 256
+#define TRACE_READ_BUFFER_SIZE (64 * 1024)
+
+typedef struct {
+    FILE* file;
+    uint32_t line;          // Current line number (for diagnostics)
+    uint32_t samples;       // Samples returned so far
+    uint32_t skipped;       // Malformed lines skipped
+} TraceReader_t;
+
+bool trace_reader_open(TraceReader_t* reader, const char* path);   // "-" reads stdin
+bool trace_reader_next(TraceReader_t* reader, SensorData_t* sample);
+void trace_reader_close(TraceReader_t* reader);
+
+#endif // TRACE_H
@@ -0,0 +1,102 @@
+/**
+ * Trend - Exponentially weighted least-squares slope and time to limit
+ */
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include "trend.h"
+
+const float trend_time_constant_s[TREND_SCALES] = {
+    600.0f, 4.0f * 3600.0f, 3.0f * 86400.0f
+};
+
+const char* const trend_scale_names[TREND_SCALES] = {
+    "minutes", "hours", "days"
+};
+
+void trend_init(TrendEstimator_t* trend, float time_constant_s) {
+    memset(trend, 0, sizeof(*trend));
+    trend->time_constant_s = time_constant_s;
+    trend->bucket_s = time_constant_s / TREND_BUCKETS_PER_WINDOW;
+    trend->result.hours_to_limit = TREND_NO_CROSSING;
+}
+
+static void refresh_result(TrendEstimator_t* trend, float low, float high) {
+    TrendResult_t* result = &trend->result;
+    float n_eff = trend->weight_sq > 0.0f ? trend->weight * trend->weight / trend->weight_sq : 0.0f;
+
+    result->valid = n_eff >= TREND_MIN_POINTS && trend->c_tt > 0.0f;
+    result->hours_to_limit = TREND_NO_CROSSING;
+    if (!result->valid) {
+        result->level = trend->mean_y;
+        result->slope_per_h = 0.0f;
+        result->slope_stderr = 0.0f;
+        return;
+    }
+
+    // Slope and the fitted value at t = 0 (now)
+    float slope = trend->c_ty / trend->c_tt;
+    float level = trend->mean_y - slope * trend->mean_t;
+
+    // Residual variance with n_eff - 2 degrees of freedom
+    float residual = trend->c_yy - slope * trend->c_ty;
+    float stderr_s = sqrtf(fmaxf(residual, 0.0f) / ((n_eff - 2.0f) * trend->c_tt));
+
+    result->level = level;
+    result->slope_per_h = slope * 3600.0f;
+    result->slope_stderr = stderr_s * 3600.0f;
+
+    // Project only a significant slope toward a finite limit
+    if (fabsf(slope) < TREND_SIGNIFICANCE * stderr_s) {
+        return;
+    }
+    float limit = slope > 0.0f ? high : low;
+    if (limit >= FLT_MAX || limit <= -FLT_MAX) {
+        return;
+    }
+    float seconds = (limit - level) / slope;
+    result->hours_to_limit = seconds > 0.0f ? seconds / 3600.0f : 0.0f;
+}
+
+// Fold one bucket mean, centered age_s/2 before now, into the regression
+static void add_point(TrendEstimator_t* trend, float age_s, float y) {
+    // Older points fade with the elapsed time; time shifts so that now is 0
+    float decay = expf(-age_s / trend->time_constant_s);
+    trend->weight *= decay;
+    trend->weight_sq *= decay * decay;
+    trend->c_tt *= decay;
+    trend->c_ty *= decay;
+    trend->c_yy *= decay;
+    trend->mean_t -= age_s;
+
+    // Weighted running update (co-moments are shift invariant)
+    float t = -0.5f * age_s;
+    trend->weight += 1.0f;
+    trend->weight_sq += 1.0f;
+    float a = 1.0f / trend->weight;
+    float dt = t - trend->mean_t;
+    float dy = y - trend->mean_y;
+    trend->mean_t += a * dt;
+    trend->mean_y += a * dy;
+    trend->c_tt += dt * (t - trend->mean_t);
+    trend->c_ty += dt * (y - trend->mean_y);
+    trend->c_yy += dy * (y - trend->mean_y);
+}
+
+bool trend_update(TrendEstimator_t* trend, float dt_s, float value, float low, float high) {
+    trend->bucket_sum += value;
+    trend->bucket_count++;
+    trend->bucket_age_s += dt_s;
+
+    if (trend->bucket_age_s < trend->bucket_s) {
+        return false;
+    }
+
+    add_point(trend, trend->bucket_age_s, trend->bucket_sum / (float)trend->bucket_count);
+    trend->bucket_sum = 0.0f;
+    trend->bucket_count = 0;
+    trend->bucket_age_s = 0.0f;
+    refresh_result(trend, low, high);
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef TREND_H
+#define TREND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Streaming least-squares trend of one signal over an exponential window.
+// Inputs are first averaged into buckets of TREND_BUCKETS_PER_WINDOW per time
+// constant; each bucket is one point of a weighted regression kept as running
+// means and co-moments, so memory and work are O(1) at any time scale.
+#define TREND_SCALES                3
+#define TREND_BUCKETS_PER_WINDOW    64
+#define TREND_MIN_POINTS            8.0f    // Effective points before a slope is reported
+#define TREND_SIGNIFICANCE          2.0f    // |slope| / stderr needed to project a crossing
+#define TREND_NO_CROSSING           (-1.0f)
+
+typedef enum {
+    TREND_MINUTES = 0,      // 10 min time constant
+    TREND_HOURS,            // 4 h
+    TREND_DAYS              // 3 days
+} TrendScale_t;
+
+extern const float trend_time_constant_s[TREND_SCALES];
+extern const char* const trend_scale_names[TREND_SCALES];
+
+typedef struct {
+    float level;            // Fitted value at the end of the latest bucket
+    float slope_per_h;      // Units per hour
+    float slope_stderr;     // Standard error of the slope, units per hour
+    float hours_to_limit;   // From the latest bucket until the fitted line crosses
+                            // the limit it heads for, TREND_NO_CROSSING if none
+                            // or the slope is not significant
+    bool valid;             // Enough points for a slope
+} TrendResult_t;
+
+typedef struct {
+    float time_constant_s;
+    float bucket_s;
+
+    // Bucket being filled
+    float bucket_sum;
+    uint32_t bucket_count;
+    float bucket_age_s;
+
+    // Weighted regression of bucket means on time; time is seconds relative
+    // to the latest bucket, so the co-moments stay small at every scale
+    float weight;           // Sum of weights
+    float weight_sq;        // Sum of squared weights, for the effective count
+    float mean_t;
+    float mean_y;
+    float c_tt, c_ty, c_yy;
+
+    TrendResult_t result;   // Refreshed when a bucket closes
+} TrendEstimator_t;
+
+void trend_init(TrendEstimator_t* trend, float time_constant_s);
+
+// Add a value observed dt_s seconds after the previous one. low/high are the
+// limits a crossing is projected to (-FLT_MAX/FLT_MAX for none). Returns true
+// when a bucket closed and the result was refreshed.
+bool trend_update(TrendEstimator_t* trend, float dt_s, float value, float low, float high);
+
+#endif // TREND_H
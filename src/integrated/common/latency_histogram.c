@@ -0,0 +1,95 @@
+/**
+ * Latency Histogram - Fixed-size log-bucketed latency recorder
+ *
+ * O(1) record with no allocation, so it can be fed from a task loop for every
+ * item; percentiles are only computed when a summary is published.
+ */
+
+#include <string.h>
+#include "latency_histogram.h"
+
+#define SUB_BUCKETS     (1U << LATENCY_HIST_SUB_BITS)
+
+static uint32_t highest_bit(uint32_t value) {
+    uint32_t msb = 0;
+    while (value >>= 1) {
+        msb++;
+    }
+    return msb;
+}
+
+static uint32_t bucket_index(uint32_t value) {
+    if (value > LATENCY_HIST_MAX_US) {
+        return LATENCY_HIST_BUCKETS - 1;
+    }
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+
+    uint32_t msb = highest_bit(value);
+    uint32_t sub = (value >> (msb - LATENCY_HIST_SUB_BITS)) & (SUB_BUCKETS - 1);
+    return ((msb - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS) + sub;
+}
+
+// Largest value that maps to the bucket
+static uint32_t bucket_upper_bound(uint32_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    uint32_t msb = (index >> LATENCY_HIST_SUB_BITS) + LATENCY_HIST_SUB_BITS - 1;
+    uint32_t sub = index & (SUB_BUCKETS - 1);
+    uint32_t width = 1U << (msb - LATENCY_HIST_SUB_BITS);
+    return (1U << msb) + (sub + 1) * width - 1;
+}
+
+void latency_histogram_init(LatencyHistogram_t* hist) {
+    memset(hist, 0, sizeof(LatencyHistogram_t));
+    hist->min_us = UINT32_MAX;
+}
+
+void latency_histogram_record(LatencyHistogram_t* hist, uint32_t latency_us) {
+    hist->buckets[bucket_index(latency_us)]++;
+    hist->count++;
+    hist->sum_us += latency_us;
+
+    if (latency_us < hist->min_us) {
+        hist->min_us = latency_us;
+    }
+    if (latency_us > hist->max_us) {
+        hist->max_us = latency_us;
+    }
+}
+
+uint32_t latency_histogram_percentile(const LatencyHistogram_t* hist, uint32_t percent) {
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    // Rank of the sample at the requested percentile (1-based, rounded up)
+    uint64_t rank = ((uint64_t)hist->count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t value = bucket_upper_bound(i);
+            if (value > hist->max_us) value = hist->max_us;
+            if (value < hist->min_us) value = hist->min_us;
+            return value;
+        }
+    }
+    return hist->max_us;
+}
+
+void latency_histogram_summary(const LatencyHistogram_t* hist, LatencySummary_t* summary) {
+    summary->count = hist->count;
+    summary->min_us = hist->count > 0 ? hist->min_us : 0;
+    summary->max_us = hist->max_us;
+    summary->p50_us = latency_histogram_percentile(hist, 50);
+    summary->p99_us = latency_histogram_percentile(hist, 99);
+    summary->avg_us = hist->count > 0 ? (uint32_t)(hist->sum_us / hist->count) : 0;
+}
@@ -0,0 +1,39 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+// Log2 buckets with 4 linear sub-buckets per power of two (~25% resolution).
+// Values 0-3µs get exact buckets; anything above LATENCY_HIST_MAX_US lands in
+// the last bucket.
+#define LATENCY_HIST_SUB_BITS   2
+#define LATENCY_HIST_MAX_MSB    23      // 2^24µs ~ 16.7s
+#define LATENCY_HIST_BUCKETS    ((LATENCY_HIST_MAX_MSB - LATENCY_HIST_SUB_BITS + 2) << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_US     ((1UL << (LATENCY_HIST_MAX_MSB + 1)) - 1)
+
+typedef struct {
+    uint32_t buckets[LATENCY_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+} LatencyHistogram_t;
+
+// Snapshot published to the dashboard and telemetry
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t avg_us;
+} LatencySummary_t;
+
+void latency_histogram_init(LatencyHistogram_t* hist);
+void latency_histogram_record(LatencyHistogram_t* hist, uint32_t latency_us);
+
+// Percentiles report the upper edge of the bucket, clamped to [min, max]
+uint32_t latency_histogram_percentile(const LatencyHistogram_t* hist, uint32_t percent);
+void latency_histogram_summary(const LatencyHistogram_t* hist, LatencySummary_t* summary);
+
+#endif // LATENCY_HISTOGRAM_H
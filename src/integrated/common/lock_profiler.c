@@ -0,0 +1,263 @@
+/**
+ * Lock Profiler - Per call site wait/hold histograms for FreeRTOS mutexes
+ *
+ * PROFILED_TAKE/PROFILED_GIVE record where each lock was taken, how long the
+ * caller waited, how long it was held and whether a higher-priority waiter
+ * forced priority inheritance on the holder. Take counts and wait/hold
+ * histograms are only written while the site's mutex is held, so they need no
+ * extra locking. Slot allocation, contention and timeout counts (written
+ * whether or not the take succeeded) and inheritance counts (charged to
+ * another site) use a critical section.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "lock_profiler.h"
+
+extern unsigned long ulGetRunTimeCounterValue(void);  // Microsecond run-time counter (main.c)
+
+typedef struct {
+    SemaphoreHandle_t mutex;
+    const char* name;
+    int32_t holder_site;        // Site currently holding the lock, -1 if free
+    uint32_t acquired_us;
+} TrackedMutex_t;
+
+typedef struct {
+    const char* file;
+    uint32_t line;
+    SemaphoreHandle_t mutex;
+    const char* mutex_name;
+    uint32_t takes;
+    uint32_t contended;
+    uint32_t timeouts;
+    uint32_t inheritance_events;
+    LockHistogram_t wait;
+    LockHistogram_t hold;
+} LockSite_t;
+
+static TrackedMutex_t tracked_mutexes[LOCK_PROFILER_MAX_MUTEXES];
+static uint32_t tracked_count = 0;
+static LockSite_t sites[LOCK_PROFILER_MAX_SITES];
+
+static inline uint32_t now_us(void) {
+    return (uint32_t)ulGetRunTimeCounterValue();
+}
+
+static void histogram_record(LockHistogram_t* hist, uint32_t value_us) {
+    uint32_t bucket = 0;
+    while (value_us >> bucket && bucket < LOCK_HIST_BUCKETS - 1) {
+        bucket++;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->total_us += value_us;
+    if (value_us > hist->max_us) {
+        hist->max_us = value_us;
+    }
+}
+
+// Upper edge of the bucket holding the percentile, clamped to the max seen
+static uint32_t histogram_percentile(const LockHistogram_t* hist, uint32_t percent) {
+    if (hist->count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = ((uint64_t)hist->count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LOCK_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = i == 0 ? 0 : (1U << i) - 1;
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+static TrackedMutex_t* find_mutex(SemaphoreHandle_t mutex) {
+    for (uint32_t i = 0; i < tracked_count; i++) {
+        if (tracked_mutexes[i].mutex == mutex) {
+            return &tracked_mutexes[i];
+        }
+    }
+    return NULL;
+}
+
+static bool site_matches(const LockSite_t* site, SemaphoreHandle_t mutex,
+                         const char* file, uint32_t line) {
+    return site->line == line && site->mutex == mutex &&
+           (site->file == file || strcmp(site->file, file) == 0);
+}
+
+// Open-addressed lookup keyed on the line number; new sites are claimed in a
+// critical section since several tasks may hit unseen sites at once
+static int32_t find_or_add_site(const TrackedMutex_t* tracked, const char* file, uint32_t line) {
+    uint32_t start = line % LOCK_PROFILER_MAX_SITES;
+
+    for (uint32_t probe = 0; probe < LOCK_PROFILER_MAX_SITES; probe++) {
+        uint32_t index = (start + probe) % LOCK_PROFILER_MAX_SITES;
+        LockSite_t* site = &sites[index];
+
+        if (site->file == NULL) {
+            int32_t claimed = -1;
+            taskENTER_CRITICAL();
+            if (site->file == NULL) {
+                site->file = file;
+                site->line = line;
+                site->mutex = tracked->mutex;
+                site->mutex_name = tracked->name;
+                claimed = (int32_t)index;
+            } else if (site_matches(site, tracked->mutex, file, line)) {
+                claimed = (int32_t)index;
+            }
+            taskEXIT_CRITICAL();
+
+            if (claimed >= 0) {
+                return claimed;
+            }
+            continue;   // Slot went to another site - keep probing
+        }
+
+        if (site_matches(site, tracked->mutex, file, line)) {
+            return (int32_t)index;
+        }
+    }
+    return -1;  // Table full - site goes unprofiled
+}
+
+void lock_profiler_register(SemaphoreHandle_t mutex, const char* name) {
+    if (mutex == NULL || tracked_count >= LOCK_PROFILER_MAX_MUTEXES || find_mutex(mutex) != NULL) {
+        return;
+    }
+
+    TrackedMutex_t* tracked = &tracked_mutexes[tracked_count];
+    tracked->mutex = mutex;
+    tracked->name = name;
+    tracked->holder_site = -1;
+    tracked->acquired_us = 0;
+    tracked_count++;
+}
+
+BaseType_t lock_profiler_take(SemaphoreHandle_t mutex, TickType_t timeout,
+                              const char* file, uint32_t line) {
+    TrackedMutex_t* tracked = find_mutex(mutex);
+    if (tracked == NULL) {
+        return xSemaphoreTake(mutex, timeout);
+    }
+
+    int32_t site_index = find_or_add_site(tracked, file, line);
+
+    // A lower-priority holder will be boosted to our priority while we block
+    TaskHandle_t holder = xSemaphoreGetMutexHolder(mutex);
+    int32_t holder_site = tracked->holder_site;
+    bool contended = holder != NULL;
+    bool inheritance = contended && holder != xTaskGetCurrentTaskHandle() &&
+                       uxTaskPriorityGet(holder) < uxTaskPriorityGet(NULL);
+
+    uint32_t start = now_us();
+    BaseType_t result = xSemaphoreTake(mutex, timeout);
+    uint32_t acquired = now_us();
+
+    if (site_index < 0) {
+        if (result == pdTRUE) {
+            tracked->holder_site = -1;
+        }
+        return result;
+    }
+
+    LockSite_t* site = &sites[site_index];
+
+    // Written without the lock if the take timed out. Inheritance is charged to
+    // the site that held the lock, even if our take then timed out.
+    taskENTER_CRITICAL();
+    if (contended) {
+        site->contended++;
+    }
+    if (result != pdTRUE) {
+        site->timeouts++;
+    }
+    if (inheritance && holder_site >= 0) {
+        sites[holder_site].inheritance_events++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (result == pdTRUE) {
+        site->takes++;
+        histogram_record(&site->wait, acquired - start);
+        tracked->holder_site = site_index;
+        tracked->acquired_us = acquired;
+    }
+
+    return result;
+}
+
+BaseType_t lock_profiler_give(SemaphoreHandle_t mutex) {
+    TrackedMutex_t* tracked = find_mutex(mutex);
+
+    if (tracked != NULL && tracked->holder_site >= 0) {
+        LockSite_t* site = &sites[tracked->holder_site];
+        histogram_record(&site->hold, now_us() - tracked->acquired_us);
+        tracked->holder_site = -1;
+    }
+
+    return xSemaphoreGive(mutex);
+}
+
+static void site_to_stats(const LockSite_t* site, LockSiteStats_t* stats) {
+    const char* base = strrchr(site->file, '/');
+    base = base ? base + 1 : site->file;
+
+    snprintf(stats->site, LOCK_SITE_NAME_LEN, "%s:%lu", base, (unsigned long)site->line);
+    stats->mutex_name = site->mutex_name;
+    stats->takes = site->takes;
+    stats->contended = site->contended;
+    stats->timeouts = site->timeouts;
+    stats->inheritance_events = site->inheritance_events;
+    stats->wait_p99_us = histogram_percentile(&site->wait, 99);
+    stats->wait_max_us = site->wait.max_us;
+    stats->hold_p50_us = histogram_percentile(&site->hold, 50);
+    stats->hold_p99_us = histogram_percentile(&site->hold, 99);
+    stats->hold_max_us = site->hold.max_us;
+    stats->hold_total_us = site->hold.total_us;
+}
+
+uint32_t lock_profiler_top_sites(LockSiteStats_t* out, uint32_t max) {
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < LOCK_PROFILER_MAX_SITES; i++) {
+        LockSite_t snapshot;
+
+        // Counters are updated by their lock owners; copy each site atomically
+        taskENTER_CRITICAL();
+        snapshot = sites[i];
+        taskEXIT_CRITICAL();
+
+        if (snapshot.file == NULL || snapshot.takes == 0) {
+            continue;
+        }
+
+        LockSiteStats_t stats;
+        site_to_stats(&snapshot, &stats);
+
+        // Insertion into the sorted output, dropping the smallest when full
+        uint32_t pos = count;
+        while (pos > 0 && out[pos - 1].hold_total_us < stats.hold_total_us) {
+            if (pos < max) {
+                out[pos] = out[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < max) {
+            out[pos] = stats;
+            if (count < max) {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
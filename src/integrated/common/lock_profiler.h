@@ -0,0 +1,61 @@
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+// Build with -DLOCK_PROFILING=0 to compile the wrappers down to plain takes/gives
+#ifndef LOCK_PROFILING
+#define LOCK_PROFILING 1
+#endif
+
+#define LOCK_PROFILER_MAX_MUTEXES   4
+#define LOCK_PROFILER_MAX_SITES     48
+#define LOCK_HIST_BUCKETS           16      // Bucket 0: <1µs, bucket i: [2^(i-1), 2^i) µs
+#define LOCK_SITE_NAME_LEN          24
+
+// Compact log2 histogram (one per site for wait time and for hold time)
+typedef struct {
+    uint32_t buckets[LOCK_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+} LockHistogram_t;
+
+// Per call site report, sorted by total hold time
+typedef struct {
+    char site[LOCK_SITE_NAME_LEN];      // "sensor_task.c:112"
+    const char* mutex_name;
+    uint32_t takes;
+    uint32_t contended;                 // Mutex was already held when the take started
+    uint32_t timeouts;
+    uint32_t inheritance_events;        // A higher-priority task blocked while this site held the lock
+    uint32_t wait_p99_us;
+    uint32_t wait_max_us;
+    uint32_t hold_p50_us;
+    uint32_t hold_p99_us;
+    uint32_t hold_max_us;
+    uint64_t hold_total_us;
+} LockSiteStats_t;
+
+#if LOCK_PROFILING
+#define PROFILED_TAKE(mutex, timeout)   lock_profiler_take((mutex), (timeout), __FILE__, __LINE__)
+#define PROFILED_GIVE(mutex)            lock_profiler_give(mutex)
+#else
+#define PROFILED_TAKE(mutex, timeout)   xSemaphoreTake((mutex), (timeout))
+#define PROFILED_GIVE(mutex)            xSemaphoreGive(mutex)
+#endif
+
+// Register a mutex after creation; unregistered mutexes pass straight through
+void lock_profiler_register(SemaphoreHandle_t mutex, const char* name);
+
+BaseType_t lock_profiler_take(SemaphoreHandle_t mutex, TickType_t timeout,
+                              const char* file, uint32_t line);
+BaseType_t lock_profiler_give(SemaphoreHandle_t mutex);
+
+// Copy up to `max` sites, worst total hold time first. Returns the number copied.
+uint32_t lock_profiler_top_sites(LockSiteStats_t* out, uint32_t max);
+
+#endif // LOCK_PROFILER_H
@@ -0,0 +1,167 @@
+/**
+ * Metrics Export - g_system_state into the shared-memory metrics segment
+ */
+
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "system_state.h"
+#include "lock_profiler.h"
+#include "metrics_export.h"
+
+extern SemaphoreHandle_t xSystemStateMutex;
+
+#if METRICS_SHM
+
+// Every tracked task and stack fits, so the lists are never cut short
+#if MAX_TASKS_TRACKED > METRICS_MAX_TASKS || MAX_STACK_MONITORED_TASKS > METRICS_MAX_STACKS
+#error "Raise METRICS_MAX_TASKS / METRICS_MAX_STACKS (and METRICS_SHM_VERSION) in metrics_shm.h"
+#endif
+
+static MetricsSegment_t* segment;
+
+bool metrics_export_init(void) {
+    segment = metrics_shm_create(METRICS_SHM_NAME);
+    return segment != NULL;
+}
+
+static void copy_name(char* out, const char* name) {
+    strncpy(out, name, METRICS_NAME_LEN - 1);
+    out[METRICS_NAME_LEN - 1] = '\0';
+}
+
+static void copy_latency(MetricsLatency_t* out, const LatencySummary_t* summary) {
+    out->p50_us = summary->p50_us;
+    out->p99_us = summary->p99_us;
+    out->max_us = summary->max_us;
+}
+
+// Runs inside the seqlock with the state mutex held
+static void fill_snapshot(MetricsSnapshot_t* s, const SystemState_t* state) {
+    s->tick = (uint32_t)xTaskGetTickCount();
+    s->uptime_seconds = state->uptime_seconds;
+    s->emergency_stop = state->emergency_stop;
+    s->network_connected = state->network_connected;
+    
+    s->channel_count = CHANNEL_COUNT < METRICS_MAX_CHANNELS ? CHANNEL_COUNT : METRICS_MAX_CHANNELS;
+    for (uint32_t ch = 0; ch < s->channel_count; ch++) {
+        s->sensors[ch] = state->sensors.values[ch];
+    }
+    s->sensor_timestamp = state->sensors.timestamp;
+    s->anomaly_flags = state->anomalies.anomaly_flags;
+    s->health_score = state->anomalies.health_score;
+    s->anomaly_count = state->anomalies.anomaly_count;
+    
+    s->task_count = state->task_count < METRICS_MAX_TASKS ? state->task_count : METRICS_MAX_TASKS;
+    for (uint32_t i = 0; i < s->task_count; i++) {
+        const TaskStats_t* task = &state->tasks[i];
+        MetricsTask_t* out = &s->tasks[i];
+        copy_name(out->name, task->name);
+        out->priority = (uint32_t)task->priority;
+        out->state = (uint32_t)task->state;
+        out->cpu_usage_percent = task->cpu_usage_percent;
+        out->stack_usage_percent = task->stack_usage_percent;
+        out->runtime = task->runtime;
+        out->context_switches = task->context_switches;
+    }
+    s->context_switch_count = state->context_switch_count;
+    s->cpu_usage_percent = state->cpu_usage_percent;
+    s->idle_time_percent = state->idle_time_percent;
+    s->sampler_samples = state->sampler.samples;
+    s->sampler_suspended_us = state->sampler.last_suspended_us;
+    s->sampler_max_suspended_us = state->sampler.max_suspended_us;
+    
+    s->isr_interrupts = state->isr_stats.interrupt_count;
+    s->isr_processed = state->isr_stats.processed_count;
+    s->isr_last_latency_us = state->isr_stats.last_latency_us;
+    copy_latency(&s->isr_latency, &state->isr_stats.latency);
+    
+    const MutexStats_t* mutex = &state->mutex_stats;
+    s->system_mutex_takes = mutex->system_mutex_takes;
+    s->system_mutex_gives = mutex->system_mutex_gives;
+    s->system_mutex_timeouts = mutex->system_mutex_timeouts;
+    s->threshold_mutex_takes = mutex->threshold_mutex_takes;
+    s->threshold_mutex_gives = mutex->threshold_mutex_gives;
+    s->threshold_mutex_timeouts = mutex->threshold_mutex_timeouts;
+    
+    const MemoryStats_t* memory = &state->memory_stats;
+    s->allocations = memory->allocations;
+    s->deallocations = memory->deallocations;
+    s->allocation_failures = memory->allocation_failures;
+    s->active_allocations = memory->active_allocations;
+    s->bytes_allocated = (uint32_t)memory->bytes_allocated;
+    s->peak_usage = (uint32_t)memory->peak_usage;
+    s->heap_free = (uint32_t)memory->current_heap_free;
+    s->minimum_heap_free = (uint32_t)memory->minimum_heap_free;
+    
+    const StackMonitoringSystem_t* stacks = &state->stack_monitoring;
+    s->stack_count = stacks->monitored_count < METRICS_MAX_STACKS ? stacks->monitored_count
+                                                                  : METRICS_MAX_STACKS;
+    for (uint32_t i = 0; i < s->stack_count; i++) {
+        const TaskStackMonitor_t* task = &stacks->tasks[i];
+        MetricsStack_t* out = &s->stacks[i];
+        copy_name(out->name, task->task_name);
+        out->stack_size_words = (uint32_t)task->stack_size_words;
+        out->free_words = (uint32_t)task->current_high_water;
+        out->minimum_free_words = (uint32_t)task->minimum_high_water;
+        out->usage_percent = task->usage_percent;
+        out->peak_usage_percent = task->peak_usage_percent;
+    }
+    s->stack_warnings = stacks->global_stats.warnings_issued;
+    s->stack_high_usage_events = stacks->global_stats.high_usage_events;
+    s->stack_critical_usage_events = stacks->global_stats.critical_usage_events;
+    s->stack_overflow_events = stacks->global_stats.overflow_events;
+    
+    const PowerStats_t* power = &state->power_stats;
+    s->idle_entries = power->idle_entries;
+    s->sleep_entries = power->sleep_entries;
+    s->total_sleep_time_ms = power->total_sleep_time_ms;
+    s->power_savings_percent = power->power_savings_percent;
+    s->wake_events = power->wake_events;
+}
+
+void metrics_export_publish(void) {
+    if (segment == NULL) {
+        return;
+    }
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        g_system_state.mutex_stats.system_mutex_takes++;
+        fill_snapshot(metrics_shm_begin(segment), &g_system_state);
+        metrics_shm_end(segment);
+        g_system_state.mutex_stats.system_mutex_gives++;
+        PROFILED_GIVE(xSystemStateMutex);
+    } else {
+        g_system_state.mutex_stats.system_mutex_timeouts++;
+    }
+}
+
+const MetricsSegment_t* metrics_export_segment(void) {
+    return segment;
+}
+
+void metrics_export_close(void) {
+    if (segment != NULL) {
+        metrics_shm_close(segment);
+        metrics_shm_unlink(METRICS_SHM_NAME);
+        segment = NULL;
+    }
+}
+
+#else
+
+bool metrics_export_init(void) {
+    return false;
+}
+
+void metrics_export_publish(void) {
+}
+
+const MetricsSegment_t* metrics_export_segment(void) {
+    return NULL;
+}
+
+void metrics_export_close(void) {
+}
+
+#endif // METRICS_SHM
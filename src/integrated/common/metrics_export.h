@@ -0,0 +1,27 @@
+#ifndef METRICS_EXPORT_H
+#define METRICS_EXPORT_H
+
+#include <stdbool.h>
+#include "metrics_shm.h"
+
+// Build with -DMETRICS_SHM=0 (CMake option METRICS_SHM) to leave the
+// shared-memory segment out
+#ifndef METRICS_SHM
+#define METRICS_SHM 1
+#endif
+
+// Create METRICS_SHM_NAME before the scheduler starts; false if it could not be
+bool metrics_export_init(void);
+
+// Copy g_system_state into the segment (src/net/metrics_shm.h). A mutex
+// take and a few hundred bytes of stores; no formatting, no system calls.
+void metrics_export_publish(void);
+
+// The segment for in-process readers (metrics_shm_read), NULL if there is none
+const MetricsSegment_t* metrics_export_segment(void);
+
+// After the scheduler has ended: unmap and remove METRICS_SHM_NAME, so no
+// reader attaches to a segment nothing writes any more
+void metrics_export_close(void);
+
+#endif // METRICS_EXPORT_H
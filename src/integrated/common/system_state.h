@@ -5,21 +5,25 @@
 #include <stdbool.h>
 #include "FreeRTOS.h"
 #include "task.h"
+#include "sensor_types.h"
+#include "detector.h"
+#include "envelope.h"
+#include "order_tracker.h"
+#include "feature_extractor.h"
+#include "rollup.h"
+#include "history.h"
+#include "checkpoint.h"
+#include "transport.h"
+#include "link_emulator.h"
+#include "mqtt.h"
+#include "status_http.h"
+#include "latency_histogram.h"
 
 // System Constants
 #define MAX_TASK_NAME_LEN 16
-#define MAX_TASKS_TRACKED 10
+#define MAX_TASKS_TRACKED 12
 #define PREEMPTION_HISTORY_SIZE 10
 
-// Sensor Data Structure
-typedef struct {
-    float vibration;      // mm/s
-    float temperature;    // Celsius
-    float rpm;           // Rotations per minute
-    float current;       // Amps
-    uint32_t timestamp;  // System ticks
-} SensorData_t;
-
 // Task Statistics
 typedef struct {
     char name[MAX_TASK_NAME_LEN];
@@ -40,20 +44,12 @@ typedef struct {
     const char* reason;  // "Priority", "Yield", "Block"
 } PreemptionEvent_t;
 
-// Anomaly Detection Results
-typedef struct {
-    bool vibration_anomaly;
-    bool temperature_anomaly;
-    bool rpm_anomaly;
-    float health_score;      // 0-100%
-    uint32_t anomaly_count;
-} AnomalyResults_t;
-
 // ISR Statistics (Capability 2)
 typedef struct {
     uint32_t interrupt_count;
     uint32_t processed_count;
     uint32_t last_latency_us;
+    LatencySummary_t latency;   // ISR-to-task latency distribution since boot
 } ISRStats_t;
 
 // Mutex Statistics (Capability 4)
@@ -111,7 +107,7 @@ typedef struct {
     TickType_t last_check_time;        // When last checked
 } TaskStackMonitor_t;
 
-#define MAX_STACK_MONITORED_TASKS 8
+#define MAX_STACK_MONITORED_TASKS MAX_TASKS_TRACKED   // Every task the sampler sees
 typedef struct {
     TaskStackMonitor_t tasks[MAX_STACK_MONITORED_TASKS];
     uint32_t monitored_count;
@@ -128,27 +124,198 @@ typedef struct {
     char last_wake_source[16];          // Last wake source description
 } PowerStats_t;
 
-// ISR Sensor Data
+// Bearing envelope analysis (anomaly task, raw vibration via stream buffer)
+typedef struct {
+    EnvelopeResult_t result;
+    uint32_t last_cycle_us;         // Envelope work in the latest anomaly cycle
+    uint32_t max_cycle_us;          // Worst cycle since boot (includes the FFT)
+    uint32_t dropped_samples;       // Vibration samples the stream buffer had no room for
+} EnvelopeStats_t;
+
+// Order tracking / time-synchronous averaging (anomaly task, same raw stream)
+typedef struct {
+    OrderTrackerResult_t result;
+    float blade_pass_amplitude;     // TSA amplitude at ORDER_BLADE_PASS
+    uint32_t last_cycle_us;
+    uint32_t max_cycle_us;
+} OrderStats_t;
+
+// Feature vector of the latest anomaly cycle's raw vibration block
+typedef struct {
+    FeatureVector_t vector;
+    uint32_t blocks;                // Blocks with raw samples since boot
+    uint32_t last_cycle_us;
+    uint32_t max_cycle_us;
+} FeatureStats_t;
+
+// Emergency transmit lane (network_task.c): emergency stops and critical
+// alerts skip the 1Hz telemetry cycle and pre-empt bulk transfers
+typedef enum {
+    EMERGENCY_STOP = 0,
+    EMERGENCY_CRITICAL_ALERT
+} EmergencyReason_t;
+
+typedef struct {
+    EmergencyReason_t reason;
+    uint32_t channel;           // Channel index, CHANNEL_COUNT if none
+    float value;
+    uint32_t raised_us;         // Run-time counter when raised
+} EmergencyEvent_t;
+
+typedef struct {
+    uint32_t raised;            // Events queued
+    uint32_t dropped;           // Lane queue full
+    uint32_t sent;              // Acknowledged by the cloud end
+    uint32_t resent;            // Frames sent again for want of an ack
+    uint32_t failed;            // Still unacknowledged at EMERGENCY_DEADLINE_MS
+    uint32_t deferred;          // Sent after waiting out a link outage
+    uint32_t bulk_preemptions;  // Bulk packets that yielded the link mid-transfer
+    uint32_t last_latency_us;   // Raised to off the link at the cloud end
+    LatencySummary_t latency;
+} EmergencyLaneStats_t;
+
+// Why the network task woke from its queue set
 typedef struct {
-    float vibration;
+    uint32_t scheduled;         // Timeout: next transmission due
+    uint32_t alerts;            // xAnomalyAlertQueue
+    uint32_t telemetry;         // xTelemetryReadySemaphore (rollup closed)
+    uint32_t commands;          // xNetworkCommandQueue
+    uint32_t retransmit;        // Timeout: a transport retransmission due
+    uint32_t link;              // Timeout: a frame or ack due off the emulated link
+    LatencySummary_t alert_latency;     // Alert queued to dequeued
+} NetworkWakeStats_t;
+
+// Named profile of the emulated uplink (src/net/link_emulator.c), set by CMake
+#ifndef NETWORK_LINK_PROFILE
+#define NETWORK_LINK_PROFILE    "cellular"
+#endif
+
+// Reliable bulk transport (src/net/transport.h)
+typedef struct {
+    TransportStats_t stats;
+    uint32_t in_flight;         // Frames sent, not yet acknowledged
+    uint32_t srtt_ms;
+    uint32_t rto_ms;
+    uint32_t window_stalls;     // Scheduled packets skipped, window full
+    LinkStats_t uplink;         // The emulated link the frames cross
+} TransportStatus_t;
+
+// Telemetry over MQTT instead of the transport (CMake option)
+#ifndef TELEMETRY_MQTT
+#define TELEMETRY_MQTT          0
+#endif
+
+// QoS 1 publisher (src/net/mqtt.h), when TELEMETRY_MQTT is on
+typedef struct {
+    MqttStats_t stats;
+    uint32_t in_flight;         // Publishes not yet acknowledged
+    bool connected;             // CONNACK accepted
+    uint32_t acked_per_s;       // Over the last scheduled cycle
+    LatencySummary_t rtt;       // PUBLISH to PUBACK (millisecond resolution)
+} MqttStatus_t;
+
+// Bench status server over HTTP (CMake option)
+#ifndef STATUS_HTTP
+#define STATUS_HTTP             0
+#endif
+#ifndef STATUS_HTTP_PORT
+#define STATUS_HTTP_PORT        8080
+#endif
+
+// Status server (tasks/http_task.c), when STATUS_HTTP is on
+typedef struct {
+    StatusHttpStats_t stats;
+    uint32_t last_serialize_us; // Formatting the latest snapshot, once for all clients
+    uint32_t max_serialize_us;
+    uint32_t frame_bytes;       // JSON length of the latest snapshot
+} StatusHttpStatus_t;
+
+// Dashboard sparkline column: HISTORY_COLUMNS of them cover the last 2min 40s
+#define HISTORY_COLUMN_MS       5000
+
+// Task statistics sampling period (CMake option)
+#ifndef STATS_SAMPLE_MS
+#define STATS_SAMPLE_MS         1000
+#endif
+
+// Statistics sampler (tasks/stats_task.c): every task's runtime and stack
+// high water mark, copied out of the kernel with the scheduler suspended
+typedef struct {
+    uint32_t period_ms;
+    uint32_t samples;
+    uint32_t failed;            // Task list larger than MAX_TASKS_TRACKED
+    uint32_t last_suspended_us; // Scheduler suspended by the latest copy
+    uint32_t mean_suspended_us;
+    uint32_t max_suspended_us;
+    uint32_t last_sample_us;    // Copy and update of g_system_state together
+} StatsSamplerStatus_t;
+
+// Warm start from the detector checkpoint (CMake option)
+#ifndef ANOMALY_CHECKPOINT
+#define ANOMALY_CHECKPOINT      1
+#endif
+#ifndef ANOMALY_CHECKPOINT_PATH
+#define ANOMALY_CHECKPOINT_PATH "turbine_checkpoint.bin"
+#endif
+#define CHECKPOINT_PERIOD_S     60          // Save while running
+#define CHECKPOINT_MAX_AGE_S    (24 * 3600) // Older baselines no longer describe the machine
+
+// Detector checkpoint (src/analysis/checkpoint.h), read at boot and saved by
+// the anomaly task
+typedef struct {
+    CheckpointResult_t boot_result;     // Of the read at boot
+    bool restored;              // Applied to the engine
+    bool sensors_calibrated;    // Calibration carried over: skip the warm-up
+    uint32_t ready_ms;          // Boot to detection ready, 0 until then
+    uint32_t saves;
+    uint32_t save_failures;
+    uint32_t last_save_us;      // Capture and write together
+    uint32_t bytes;             // On disk
+} CheckpointStatus_t;
+
+// ISR Sensor Data - each 100Hz interrupt delivers a block of 1kHz vibration samples
+#define ISR_RATE_HZ             100
+#define VIBRATION_BLOCK_SAMPLES 10
+
+typedef struct {
+    float vibration[VIBRATION_BLOCK_SAMPLES];
     TickType_t timestamp;
+    uint32_t isr_time_us;   // Run-time counter when the ISR fired
     uint32_t sequence;
 } SensorISRData_t;
 
 // Queue Communication Structures (Capability 3)
 typedef struct {
     float severity;      // 0-10 scale
-    uint32_t type;      // 0=vibration, 1=temperature, 2=rpm
+    uint32_t type;      // Channel index (CHANNEL_VIBRATION, ...)
     TickType_t timestamp;
+    uint32_t raised_us;  // Run-time counter when queued
 } AnomalyAlert_t;
 
+// Requests to the network task (xNetworkCommandQueue)
+typedef enum {
+    NETWORK_CMD_SEND_NOW,       // Run the scheduled transmission now
+    NETWORK_CMD_RESYNC          // Next report carries every field
+} NetworkCommand_t;
+
+// Alerts at or above this severity also go out on the emergency lane
+#define CRITICAL_ALERT_SEVERITY 8.0f
+
 // System State (Shared across all tasks)
 typedef struct {
     // Sensor readings
     SensorData_t sensors;
+    Rollup_t rollup;            // 1s/1min/1h summaries of every reading
+    History_t history[CHANNEL_COUNT];   // Sparkline of every reading
     
     // Anomaly detection
     AnomalyResults_t anomalies;
+    History_t health_history;   // Sparkline of the health score
+    DetectorStats_t detectors[MAX_DETECTORS];
+    uint32_t detector_count;
+    EnvelopeStats_t envelope;
+    OrderStats_t orders;
+    FeatureStats_t features;
     
     // Task scheduling metrics
     TaskStats_t tasks[MAX_TASKS_TRACKED];
@@ -178,6 +345,15 @@ typedef struct {
     // Power Management metrics (Capability 8)
     PowerStats_t power_stats;
     
+    // Emergency transmit lane
+    EmergencyLaneStats_t emergency_lane;
+    NetworkWakeStats_t network_wakes;
+    TransportStatus_t transport;
+    MqttStatus_t mqtt;
+    StatusHttpStatus_t status_http;
+    StatsSamplerStatus_t sampler;
+    CheckpointStatus_t checkpoint;
+    
     // System metrics
     uint32_t uptime_seconds;
     uint32_t cpu_usage_percent;
@@ -192,23 +368,17 @@ typedef struct {
 // Global system state (extern declaration)
 extern SystemState_t g_system_state;
 
-// Threshold Configuration
-typedef struct {
-    float vibration_warning;     // mm/s
-    float vibration_critical;    // mm/s
-    float temperature_warning;   // Celsius
-    float temperature_critical;  // Celsius
-    float rpm_min;              // RPM
-    float rpm_max;              // RPM
-    float current_max;          // Amps
-} ThresholdConfig_t;
-
+// Threshold configuration (ThresholdConfig_t lives in sensor_types.h)
 extern ThresholdConfig_t g_thresholds;
 
 // Utility functions
 void system_state_init(void);
 void record_preemption(const char* preemptor, const char* preempted, const char* reason);
-void update_task_stats(void);
+bool emergency_lane_raise(EmergencyReason_t reason, uint32_t channel, float value);
+bool network_command(NetworkCommand_t command);
+bool anomaly_checkpoint_load(void);
+void anomaly_request_shutdown(void);
+void update_task_stats(const TaskStatus_t* task_status, UBaseType_t count, uint32_t total_runtime);
 const char* task_state_to_string(eTaskState state);
 
 #endif // SYSTEM_STATE_H
@@ -8,6 +8,8 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "../common/system_state.h"
+#include "../common/lock_profiler.h"
+#include "anomaly_engine.h"
 #include "console.h"
 
 // ANSI escape codes
@@ -25,13 +27,22 @@
 #define BG_GREEN        "\033[42m"
 #define BG_YELLOW       "\033[43m"
 
+// Lock profile rows shown in the mutex panel
+#define LOCK_PROFILE_ROWS   5
+
+// Sparklines: columns drawn (at most HISTORY_COLUMNS), and the smallest
+// span they are scaled to so that noise draws flat
+#define SPARKLINE_WIDTH     24
+#define SPARKLINE_MIN_SPAN  0.02f   // Of the channel's full scale
+#define HEALTH_MIN_SPAN     10.0f   // Health score points
+
 // Progress bar characters
 #define BLOCK_FULL      "#"
 #define BLOCK_EMPTY     "-"
 
 // External references
 extern SystemState_t g_system_state;
-extern void update_task_stats(void);
+extern ThresholdConfig_t g_thresholds;
 extern QueueHandle_t xSensorDataQueue;
 extern QueueHandle_t xAnomalyAlertQueue;
 
@@ -50,12 +61,37 @@ static void draw_progress_bar(float percentage, int width) {
 }
 
 // Get color for value based on thresholds
-static const char* get_status_color(float value, float warning, float critical) {
-    if (value >= critical) return RED;
-    if (value >= warning) return YELLOW;
+static const char* get_status_color(float value, const ChannelLimits_t* limits) {
+    if (channel_outside(value, limits->critical_low, limits->critical_high)) return RED;
+    if (channel_outside(value, limits->warning_low, limits->warning_high)) return YELLOW;
+    return GREEN;
+}
+
+// Get color for a min..max range: the worse of its two ends
+static const char* get_range_color(float min, float max, const ChannelLimits_t* limits) {
+    if (channel_outside(min, limits->critical_low, limits->critical_high) ||
+        channel_outside(max, limits->critical_low, limits->critical_high)) return RED;
+    if (channel_outside(min, limits->warning_low, limits->warning_high) ||
+        channel_outside(max, limits->warning_low, limits->warning_high)) return YELLOW;
     return GREEN;
 }
 
+// Sparkline of the newest SPARKLINE_WIDTH history columns, whose range
+// (from history_range) is lo..hi, scaled to that range widened to min_span
+static void draw_sparkline(const History_t* history, uint32_t now_ms, float reference,
+                           float lo, float hi, float min_span) {
+    char spark[SPARKLINE_WIDTH * 3 + 1];
+    float scale_lo = lo, scale_hi = hi;
+    if (scale_hi - scale_lo < min_span) {
+        float mid = (scale_lo + scale_hi) / 2.0f;
+        scale_lo = mid - min_span / 2.0f;
+        scale_hi = mid + min_span / 2.0f;
+    }
+    history_sparkline(history, now_ms, SPARKLINE_WIDTH, reference, scale_lo, scale_hi,
+                      spark, sizeof(spark));
+    printf("%s", spark);
+}
+
 // Format uptime
 static void format_uptime(uint32_t seconds, char* buffer) {
     uint32_t hours = seconds / 3600;
@@ -73,9 +109,7 @@ void console_clear(void) {
 void console_draw_dashboard(void) {
     char uptime_str[32];
     
-    // Update statistics
-    update_task_stats();
-    g_system_state.uptime_seconds = xTaskGetTickCount() / configTICK_RATE_HZ;
+    // Task statistics and uptime come from the stats task's latest sample
     format_uptime(g_system_state.uptime_seconds, uptime_str);
     
     // Clear and home cursor
@@ -118,22 +152,130 @@ void console_draw_dashboard(void) {
     printf("\n");
     
     // Sensor Readings
-    printf(BOLD "SENSOR READINGS:\n" NORMAL);
-    
-    // Vibration
-    printf("  Vibration: %s%.2f mm/s" NORMAL "   ", 
-           get_status_color(g_system_state.sensors.vibration, 5.0, 10.0),
-           g_system_state.sensors.vibration);
+    uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    char trend_label[SPARKLINE_WIDTH + 1];
+    snprintf(trend_label, sizeof(trend_label), "last %lus, %lus/column",
+             (unsigned long)(SPARKLINE_WIDTH * HISTORY_COLUMN_MS / 1000),
+             (unsigned long)(HISTORY_COLUMN_MS / 1000));
+    printf(BOLD "%-30s" NORMAL "%-*s | last min\n", "SENSOR READINGS:", SPARKLINE_WIDTH, trend_label);
+    
+    // One row per channel in table order: the mean of the last second,
+    // colored by its worst sample; its sparkline, colored by the range it
+    // spans; and the range over the last closed minute
+    const RollupBucket_t* second = rollup_bucket(&g_system_state.rollup, ROLLUP_SECOND, 0);
+    const RollupBucket_t* minute = rollup_bucket(&g_system_state.rollup, ROLLUP_MINUTE, 0);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        const ChannelInfo_t* info = &sensor_channels[ch];
+        const ChannelLimits_t* limits = &g_thresholds.channels[ch];
+        float value = g_system_state.sensors.values[ch];
+        const char* color = get_status_color(value, limits);
+        if (second != NULL) {
+            value = second->mean[ch];
+            color = get_range_color(second->min[ch], second->max[ch], limits);
+        }
+        printf("  %-12s %s%8.*f %-5s" NORMAL " ",
+               info->label, color, (int)info->decimals, value, info->unit);
+        
+        // Peaks and dips alike: each column draws its extreme farther from nominal
+        float lo, hi;
+        if (history_range(&g_system_state.history[ch], now_ms, SPARKLINE_WIDTH, &lo, &hi)) {
+            printf("%s", get_range_color(lo, hi, limits));
+            draw_sparkline(&g_system_state.history[ch], now_ms, info->nominal, lo, hi,
+                           info->full_scale * SPARKLINE_MIN_SPAN);
+            printf(NORMAL);
+        } else {
+            printf("%*s", SPARKLINE_WIDTH, "");
+        }
+        if (minute != NULL) {
+            printf(" | %.*f-%.*f", (int)info->decimals, minute->min[ch],
+                   (int)info->decimals, minute->max[ch]);
+        }
+        printf("\n");
+    }
     
-    // Temperature  
-    printf("Temperature: %s%.1f°C" NORMAL "    ",
-           get_status_color(g_system_state.sensors.temperature, 70.0, 85.0),
-           g_system_state.sensors.temperature);
+    // Detector Registry Status
+    printf("\n" BOLD "DETECTORS:\n" NORMAL);
+    for (uint32_t i = 0; i < g_system_state.detector_count; i++) {
+        DetectorStats_t* det = &g_system_state.detectors[i];
+        printf("  %-10s %s | Penalty: %5.1f | CPU: avg %luµs max %luµs | Mem: %lu bytes\n",
+               det->name,
+               det->enabled ? GREEN "ON " NORMAL : RED "OFF" NORMAL,
+               det->score,
+               (unsigned long)det->avg_cycle_us,
+               (unsigned long)det->max_cycle_us,
+               (unsigned long)det->memory_bytes);
+    }
     
-    // RPM
-    printf("RPM: %s%.1f" NORMAL "\n",
-           g_system_state.sensors.rpm < 10.0 || g_system_state.sensors.rpm > 30.0 ? YELLOW : GREEN,
-           g_system_state.sensors.rpm);
+    // Bearing envelope peaks relative to the spectrum floor
+    const EnvelopeStats_t* env = &g_system_state.envelope;
+    printf("  %-10s", "envelope");
+    if (env->result.spectra == 0) {
+        printf(" waiting for first spectrum");
+    } else {
+        for (uint32_t d = 0; d < BEARING_DEFECT_COUNT; d++) {
+            float ratio = env->result.ratio[d];
+            printf(" %s %sx%.1f" NORMAL, bearing_defect_names[d],
+                   ratio >= ENVELOPE_ALERT_RATIO ? RED :
+                   ratio >= ENVELOPE_WARNING_RATIO ? YELLOW : GREEN, ratio);
+        }
+        printf(" | shaft %.1fHz", env->result.shaft_hz);
+    }
+    printf(" | CPU: last %luµs max %luµs | Dropped: %lu\n",
+           (unsigned long)env->last_cycle_us,
+           (unsigned long)env->max_cycle_us,
+           (unsigned long)env->dropped_samples);
+    
+    // Rotor-locked content from the time-synchronous average
+    const OrderStats_t* orders = &g_system_state.orders;
+    printf("  %-10s", "orders");
+    if (orders->result.revolutions == 0) {
+        printf(" waiting for first revolution");
+    } else {
+        printf(" blade pass %.3f | peak order %lu %.3f | TSA rms %.3f | %lu revs @ %.1f rpm",
+               orders->blade_pass_amplitude,
+               (unsigned long)orders->result.peak_order,
+               orders->result.peak_amplitude,
+               orders->result.tsa_rms,
+               (unsigned long)orders->result.revolutions,
+               orders->result.rev_hz * 60.0f);
+    }
+    printf(" | CPU: last %luµs max %luµs\n",
+           (unsigned long)orders->last_cycle_us,
+           (unsigned long)orders->max_cycle_us);
+    
+    // Feature vector of the latest raw vibration block
+    const FeatureStats_t* features = &g_system_state.features;
+    printf("  %-10s", "features");
+    if (features->blocks == 0) {
+        printf(" waiting for first block");
+    } else {
+        for (uint32_t f = 0; f < FEATURE_COUNT; f++) {
+            printf(" %s %.2f", feature_names[f], features->vector.values[f]);
+        }
+    }
+    printf(" | CPU: last %luµs max %luµs\n",
+           (unsigned long)features->last_cycle_us,
+           (unsigned long)features->max_cycle_us);
+    
+    // Health trend per scale and the soonest projected limit crossing
+    const AnomalyResults_t* results = &g_system_state.anomalies;
+    printf("  %-10s health", "trend");
+    for (uint32_t scale = 0; scale < TREND_SCALES; scale++) {
+        const TrendResult_t* trend = &results->health_trend[scale];
+        if (trend->valid) {
+            printf(" %s %+.2f/h", trend_scale_names[scale], trend->slope_per_h);
+        } else {
+            printf(" %s --", trend_scale_names[scale]);
+        }
+    }
+    float limit_hours;
+    int limit_channel;
+    if (anomaly_results_earliest_limit(results, TREND_HOURS, &limit_hours, &limit_channel)) {
+        printf(" | " YELLOW "%s limit in %.1fh" NORMAL "\n",
+               limit_channel < 0 ? "health" : sensor_channels[limit_channel].name, limit_hours);
+    } else {
+        printf(" | no limit projected\n");
+    }
     
     // ISR Status (Capability 2)
     printf("\n" BOLD "ISR STATUS:\n" NORMAL);
@@ -141,6 +283,13 @@ void console_draw_dashboard(void) {
            g_system_state.isr_stats.last_latency_us,
            g_system_state.isr_stats.processed_count,
            g_system_state.isr_stats.interrupt_count);
+    printf("  Latency µs: min %lu | p50 %lu | p99 %lu | max %lu | avg %lu (n=%lu)\n",
+           (unsigned long)g_system_state.isr_stats.latency.min_us,
+           (unsigned long)g_system_state.isr_stats.latency.p50_us,
+           (unsigned long)g_system_state.isr_stats.latency.p99_us,
+           (unsigned long)g_system_state.isr_stats.latency.max_us,
+           (unsigned long)g_system_state.isr_stats.latency.avg_us,
+           (unsigned long)g_system_state.isr_stats.latency.count);
     
     // Queue Status (Capability 3)
     UBaseType_t sensor_queue_count = uxQueueMessagesWaiting(xSensorDataQueue);
@@ -149,6 +298,49 @@ void console_draw_dashboard(void) {
     printf("  Sensor[%lu/5] Anomaly[%lu/3] (Used/Size)\n",
            (unsigned long)sensor_queue_count,
            (unsigned long)anomaly_queue_count);
+    const NetworkWakeStats_t* wakes = &g_system_state.network_wakes;
+    printf("  Network wakes: Sched:%lu Alert:%lu Rollup:%lu Cmd:%lu Retx:%lu Link:%lu | Alert wait us p50:%lu p99:%lu max:%lu\n",
+           (unsigned long)wakes->scheduled, (unsigned long)wakes->alerts,
+           (unsigned long)wakes->telemetry, (unsigned long)wakes->commands,
+           (unsigned long)wakes->retransmit, (unsigned long)wakes->link,
+           (unsigned long)wakes->alert_latency.p50_us,
+           (unsigned long)wakes->alert_latency.p99_us,
+           (unsigned long)wakes->alert_latency.max_us);
+#if TELEMETRY_MQTT
+    const MqttStatus_t* mqtt = &g_system_state.mqtt;
+    printf("  MQTT: %s In flight:%lu/%d | Publishes:%lu (msgs %lu) Acked:%lu (%lu/s) Resent:%lu Abandoned:%lu Stalls:%lu | RTT ms p50:%lu p99:%lu\n",
+           mqtt->connected ? "up" : "down", (unsigned long)mqtt->in_flight, MQTT_INFLIGHT,
+           (unsigned long)mqtt->stats.publishes, (unsigned long)mqtt->stats.messages,
+           (unsigned long)mqtt->stats.acked, (unsigned long)mqtt->acked_per_s,
+           (unsigned long)mqtt->stats.resent, (unsigned long)mqtt->stats.abandoned,
+           (unsigned long)g_system_state.transport.window_stalls,
+           (unsigned long)(mqtt->rtt.p50_us / 1000), (unsigned long)(mqtt->rtt.p99_us / 1000));
+#else
+    const TransportStatus_t* transport = &g_system_state.transport;
+    printf("  Transport: In flight:%lu/%d srtt:%lums rto:%lums | Acked:%lu Retx:%lu (early %lu) Abandoned:%lu Stalls:%lu\n",
+           (unsigned long)transport->in_flight, TRANSPORT_WINDOW,
+           (unsigned long)transport->srtt_ms, (unsigned long)transport->rto_ms,
+           (unsigned long)transport->stats.frames_acked,
+           (unsigned long)transport->stats.retransmits,
+           (unsigned long)transport->stats.fast_retransmits,
+           (unsigned long)transport->stats.frames_abandoned,
+           (unsigned long)transport->window_stalls);
+    const LinkStats_t* uplink = &transport->uplink;
+    printf("  Link (" NETWORK_LINK_PROFILE "): Sent:%lu Lost:%lu (burst %lu) Outage:%lu Queue:%lu Reordered:%lu\n",
+           (unsigned long)uplink->sent, (unsigned long)uplink->lost,
+           (unsigned long)uplink->burst_lost, (unsigned long)uplink->outage_dropped,
+           (unsigned long)(uplink->queue_dropped + uplink->overflowed),
+           (unsigned long)uplink->reordered);
+#endif
+#if STATUS_HTTP
+    const StatusHttpStatus_t* http = &g_system_state.status_http;
+    printf("  HTTP :%d: Clients:%lu | Frames:%lu (%lu bytes, serialized in %luus, max %luus) | Metrics:%lu Streams:%lu | Dropped slow:%lu Rejected:%lu\n",
+           STATUS_HTTP_PORT, (unsigned long)http->stats.clients, (unsigned long)http->stats.frames,
+           (unsigned long)http->frame_bytes, (unsigned long)http->last_serialize_us,
+           (unsigned long)http->max_serialize_us, (unsigned long)http->stats.snapshots,
+           (unsigned long)http->stats.streams, (unsigned long)http->stats.dropped_slow,
+           (unsigned long)http->stats.rejected);
+#endif
     
     // Mutex Status (Capability 4)
     printf("\n" BOLD "MUTEX STATUS:\n" NORMAL);
@@ -161,6 +353,27 @@ void console_draw_dashboard(void) {
            (unsigned long)g_system_state.mutex_stats.threshold_mutex_gives,
            (unsigned long)g_system_state.mutex_stats.threshold_mutex_timeouts);
     
+    // Lock Profile - call sites holding the locks longest
+    LockSiteStats_t lock_sites[LOCK_PROFILE_ROWS];
+    uint32_t lock_site_count = lock_profiler_top_sites(lock_sites, LOCK_PROFILE_ROWS);
+    if (lock_site_count > 0) {
+        printf("  %-22s %-11s %7s %6s %9s %9s %9s %5s\n",
+               "Site", "Mutex", "Takes", "Contd", "Wait p99", "Hold p99", "Hold max", "Inh");
+        for (uint32_t i = 0; i < lock_site_count; i++) {
+            LockSiteStats_t* site = &lock_sites[i];
+            printf("  %-22s %-11s %7lu %6lu %7luµs %7luµs %7luµs %s%5lu" NORMAL "\n",
+                   site->site,
+                   site->mutex_name,
+                   (unsigned long)site->takes,
+                   (unsigned long)site->contended,
+                   (unsigned long)site->wait_p99_us,
+                   (unsigned long)site->hold_p99_us,
+                   (unsigned long)site->hold_max_us,
+                   site->inheritance_events > 0 ? YELLOW : "",
+                   (unsigned long)site->inheritance_events);
+        }
+    }
+    
     printf("\n");
     
     // Event Group Status (Capability 5)
@@ -188,6 +401,22 @@ void console_draw_dashboard(void) {
         printf("\n");
     }
     
+    // Detection readiness, warm from the checkpoint or cold
+    const CheckpointStatus_t* checkpoint = &g_system_state.checkpoint;
+    printf("  Detection: %s", checkpoint->restored ? GREEN "warm start" NORMAL : YELLOW "cold start" NORMAL);
+    if (checkpoint->ready_ms > 0) {
+        printf(", ready in %lu ms", (unsigned long)checkpoint->ready_ms);
+    }
+    printf(" | Checkpoint: %s at boot, %lu saves", checkpoint_result_names[checkpoint->boot_result],
+           (unsigned long)checkpoint->saves);
+    if (checkpoint->saves > 0) {
+        printf(" (%lu B, %lu us)", (unsigned long)checkpoint->bytes, (unsigned long)checkpoint->last_save_us);
+    }
+    if (checkpoint->save_failures > 0) {
+        printf(RED " %lu failed" NORMAL, (unsigned long)checkpoint->save_failures);
+    }
+    printf("\n");
+    
     printf("  Operations: Sets:%lu Clears:%lu Waits:%lu\n",
            (unsigned long)g_system_state.event_group_stats.bits_set_count,
            (unsigned long)g_system_state.event_group_stats.bits_cleared_count,
@@ -309,6 +538,11 @@ void console_draw_dashboard(void) {
     printf("  Task Switches/sec: %-9lu* CPU Usage: %d%%*\n",
            g_system_state.context_switch_count / (g_system_state.uptime_seconds + 1),
            g_system_state.cpu_usage_percent);
+    const StatsSamplerStatus_t* sampler = &g_system_state.sampler;
+    printf("  Sampled every %lu ms: %lu samples, %lu failed | Scheduler suspended µs: last %lu mean %lu max %lu\n",
+           (unsigned long)sampler->period_ms, (unsigned long)sampler->samples,
+           (unsigned long)sampler->failed, (unsigned long)sampler->last_suspended_us,
+           (unsigned long)sampler->mean_suspended_us, (unsigned long)sampler->max_suspended_us);
     
     // Health Status Bar
     printf("\n" BOLD "HEALTH STATUS: " NORMAL);
@@ -320,11 +554,32 @@ void console_draw_dashboard(void) {
     draw_progress_bar(health, 20);
     printf(" %s%s" NORMAL "\n", health_color, health_text);
     
+    // Health trend: each column draws its lowest score
+    float health_lo, health_hi;
+    if (history_range(&g_system_state.health_history, now_ms, SPARKLINE_WIDTH,
+                      &health_lo, &health_hi)) {
+        printf("  Trend: %s", health_lo > 80 ? GREEN : (health_lo > 50 ? YELLOW : RED));
+        draw_sparkline(&g_system_state.health_history, now_ms, 100.0f, health_lo, health_hi,
+                       HEALTH_MIN_SPAN);
+        printf(NORMAL " low %.0f%% high %.0f%% over %lus\n", health_lo, health_hi,
+               (unsigned long)(SPARKLINE_WIDTH * HISTORY_COLUMN_MS / 1000));
+    }
+    
     // Emergency Stop Warning
     if (g_system_state.emergency_stop) {
         printf("\n" BG_RED BOLD " EMERGENCY STOP ACTIVE " NORMAL "\n");
     }
     
+    // Emergency lane: raised-to-delivered latency of emergency stops and critical alerts
+    const EmergencyLaneStats_t* lane = &g_system_state.emergency_lane;
+    printf("Emergency lane: %lu acked (%lu after an outage), %lu resent, %lu failed, %lu dropped | "
+           "Bulk preempted: %lu | Delivered µs: last %lu p50 %lu p99 %lu max %lu\n",
+           (unsigned long)lane->sent, (unsigned long)lane->deferred, (unsigned long)lane->resent,
+           (unsigned long)lane->failed,
+           (unsigned long)lane->dropped, (unsigned long)lane->bulk_preemptions,
+           (unsigned long)lane->last_latency_us, (unsigned long)lane->latency.p50_us,
+           (unsigned long)lane->latency.p99_us, (unsigned long)lane->latency.max_us);
+    
     // Footer
     printf("\n----------------------------------------------------------\n");
     printf("Uptime: %s | Network: %s | Anomalies: %lu\n",
@@ -7,6 +7,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <signal.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
@@ -16,7 +18,10 @@
 #include "semphr.h"
 #include "timers.h"
 #include "event_groups.h"
+#include "stream_buffer.h"
 #include "common/system_state.h"
+#include "common/lock_profiler.h"
+#include "common/metrics_export.h"
 
 // Task Handles
 TaskHandle_t xSensorTaskHandle = NULL;
@@ -24,18 +29,27 @@ TaskHandle_t xSafetyTaskHandle = NULL;
 TaskHandle_t xAnomalyTaskHandle = NULL;
 TaskHandle_t xNetworkTaskHandle = NULL;
 TaskHandle_t xDashboardTaskHandle = NULL;
+TaskHandle_t xEmergencyLaneTaskHandle = NULL;
+TaskHandle_t xHttpTaskHandle = NULL;
+TaskHandle_t xStatsTaskHandle = NULL;
 
 // ISR Components (Capability 2)
 QueueHandle_t xSensorISRQueue = NULL;      // ISR to task communication
 TimerHandle_t xSensorTimer = NULL;         // 100Hz timer for simulated interrupts
+StreamBufferHandle_t xVibrationStream = NULL;  // Raw 1kHz vibration → Anomaly task (envelope)
 
 // Queue Components (Capability 3)
 QueueHandle_t xSensorDataQueue = NULL;     // Sensor → Anomaly detection
 QueueHandle_t xAnomalyAlertQueue = NULL;   // Anomaly → Network task
+QueueHandle_t xEmergencyQueue = NULL;      // Safety/Sensor/Anomaly → Emergency lane
+QueueHandle_t xNetworkCommandQueue = NULL; // Any task → Network task
+SemaphoreHandle_t xTelemetryReadySemaphore = NULL;  // Sensor → Network task (rollup closed)
+QueueSetHandle_t xNetworkQueueSet = NULL;  // Everything the network task waits on
 
 // Mutex Components (Capability 4)
 SemaphoreHandle_t xSystemStateMutex = NULL;    // Protects g_system_state
 SemaphoreHandle_t xThresholdsMutex = NULL;     // Protects g_thresholds
+SemaphoreHandle_t xLinkMutex = NULL;           // Simulated uplink (bulk and emergency lanes)
 
 // Event Group Components (Capability 5)
 EventGroupHandle_t xSystemReadyEvents = NULL;  // System startup synchronization
@@ -52,9 +66,11 @@ ThresholdConfig_t g_thresholds;
 
 // Task Priorities
 #define PRIORITY_SAFETY     6  // Highest - critical safety monitoring
+#define PRIORITY_EMERGENCY  5  // Emergency transmit lane - idle until an emergency
 #define PRIORITY_SENSOR     4  // High - real-time sensor data
 #define PRIORITY_ANOMALY    3  // Medium - anomaly detection
 #define PRIORITY_NETWORK    2  // Low - network transmission
+#define PRIORITY_STATS      2  // Low - task statistics, above the UI that reads them
 #define PRIORITY_DASHBOARD  1  // Lowest - UI updates
 
 // Stack Sizes
@@ -68,6 +84,9 @@ extern void vSafetyTask(void *pvParameters);
 extern void vAnomalyTask(void *pvParameters);
 extern void vNetworkTask(void *pvParameters);
 extern void vDashboardTask(void *pvParameters);
+extern void vEmergencyLaneTask(void *pvParameters);
+extern void vHttpTask(void *pvParameters);
+extern void vStatsTask(void *pvParameters);
 
 // Runtime stats timer (for CPU usage measurement)
 static unsigned long ulRunTimeStatsClock = 0;
@@ -193,18 +212,45 @@ void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
     *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
 }
 
+// Simulated bearing defect amplitude in the raw vibration (0 = healthy bearing)
+#define SIM_BEARING_DEFECT_MM_S 0.3f
+#define SIM_BLADE_PASS_MM_S     0.1f    // Order 3, tower passage of each blade
+#define SIM_GEAR_MESH_MM_S      0.1f
+#define SIM_GEAR_MESH_ORDER     24
+#define TWO_PI                  6.28318531f
+
 // Simulated Sensor ISR (called by timer at 100Hz)
 void vSimulatedSensorISR(TimerHandle_t xTimer) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     static uint32_t sequence = 0;
     
-    // Minimal ISR work - just read and queue
+    // Minimal ISR work - just read the sample block and queue it
     SensorISRData_t data = {
-        .vibration = g_system_state.sensors.vibration + ((rand() % 10 - 5) * 0.1f),
         .timestamp = xTaskGetTickCountFromISR(),
+        .isr_time_us = (uint32_t)ulGetRunTimeCounterValue(),
         .sequence = sequence++
     };
     
+    // Seeded outer-race defect: a 240Hz resonance, amplitude-modulated at BPFO.
+    // Rotor-locked blade pass and gear mesh components follow the rotor angle.
+    static float resonance_phase = 0.0f;
+    static float defect_phase = 0.0f;
+    static float rotor_angle = 0.0f;
+    float rotor_hz = g_system_state.sensors.rpm / 60.0f;
+    float resonance_step = TWO_PI * 240.0f / ENVELOPE_INPUT_RATE_HZ;
+    float defect_step = TWO_PI * BEARING_DEFAULT_BPFO_ORDER * rotor_hz * ENVELOPE_SHAFT_RATIO / ENVELOPE_INPUT_RATE_HZ;
+    float rotor_step = TWO_PI * rotor_hz / ENVELOPE_INPUT_RATE_HZ;
+    
+    for (uint32_t i = 0; i < VIBRATION_BLOCK_SAMPLES; i++) {
+        float defect = SIM_BEARING_DEFECT_MM_S * (0.5f + 0.5f * cosf(defect_phase)) * sinf(resonance_phase);
+        float rotor = SIM_BLADE_PASS_MM_S * sinf(ORDER_BLADE_PASS * rotor_angle) +
+                      SIM_GEAR_MESH_MM_S * sinf(SIM_GEAR_MESH_ORDER * rotor_angle);
+        data.vibration[i] = g_system_state.sensors.vibration + ((rand() % 10 - 5) * 0.1f) + defect + rotor;
+        resonance_phase = fmodf(resonance_phase + resonance_step, TWO_PI);
+        defect_phase = fmodf(defect_phase + defect_step, TWO_PI);
+        rotor_angle = fmodf(rotor_angle + rotor_step, TWO_PI);
+    }
+    
     // Send to deferred processing (demonstrates FromISR API)
     if (xQueueSendFromISR(xSensorISRQueue, &data, &xHigherPriorityTaskWoken) == pdTRUE) {
         g_system_state.isr_stats.interrupt_count++;
@@ -219,13 +265,7 @@ void system_state_init(void) {
     memset(&g_system_state, 0, sizeof(SystemState_t));
     
     // Initialize thresholds
-    g_thresholds.vibration_warning = 5.0;
-    g_thresholds.vibration_critical = 10.0;
-    g_thresholds.temperature_warning = 70.0;
-    g_thresholds.temperature_critical = 85.0;
-    g_thresholds.rpm_min = 10.0;
-    g_thresholds.rpm_max = 30.0;
-    g_thresholds.current_max = 100.0;
+    threshold_config_defaults(&g_thresholds);
     
     // System settings
     g_system_state.dashboard_enabled = true;
@@ -238,13 +278,18 @@ void system_state_init(void) {
     g_system_state.isr_stats.last_latency_us = 0;
     
     // Initial sensor values
-    g_system_state.sensors.vibration = 2.45;
-    g_system_state.sensors.temperature = 45.2;
-    g_system_state.sensors.rpm = 20.1;
-    g_system_state.sensors.current = 50.0;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        g_system_state.sensors.values[ch] = sensor_channels[ch].nominal;
+    }
+    rollup_init(&g_system_state.rollup);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        history_init(&g_system_state.history[ch], HISTORY_COLUMN_MS);
+    }
     
     // Initial health
     g_system_state.anomalies.health_score = 100.0;
+    history_init(&g_system_state.health_history, HISTORY_COLUMN_MS);
+    g_system_state.checkpoint.boot_result = CHECKPOINT_MISSING;   // Until one is read
     
     // Initialize memory stats (Capability 6)
     g_system_state.memory_stats.allocations = 0;
@@ -391,13 +436,10 @@ static void update_stack_monitoring(const char* task_name, UBaseType_t stack_siz
     }
 }
 
-// Update task statistics
-void update_task_stats(void) {
-    TaskStatus_t task_status[MAX_TASKS_TRACKED];
-    uint32_t total_runtime;
-    
-    // Get task information
-    g_system_state.task_count = uxTaskGetSystemState(task_status, MAX_TASKS_TRACKED, &total_runtime);
+// Update task statistics from a uxTaskGetSystemState() copy (stats task,
+// with xSystemStateMutex held)
+void update_task_stats(const TaskStatus_t* task_status, UBaseType_t count, uint32_t total_runtime) {
+    g_system_state.task_count = count;
     
     // Calculate time since last update
     TickType_t current_tick = xTaskGetTickCount();
@@ -473,7 +515,10 @@ void update_task_stats(void) {
         else if (strstr(stats->name, "Sensor")) stack_size_words = STACK_SIZE_MEDIUM;
         else if (strstr(stats->name, "Anomaly")) stack_size_words = STACK_SIZE_MEDIUM;
         else if (strstr(stats->name, "Network")) stack_size_words = STACK_SIZE_MEDIUM;
+        else if (strstr(stats->name, "Emergency")) stack_size_words = STACK_SIZE_MEDIUM;
         else if (strstr(stats->name, "Dashboard")) stack_size_words = STACK_SIZE_LARGE;
+        else if (strstr(stats->name, "Http")) stack_size_words = STACK_SIZE_MEDIUM;
+        else if (strstr(stats->name, "Stats")) stack_size_words = STACK_SIZE_MEDIUM;
         else if (strstr(stats->name, "Tmr")) stack_size_words = configTIMER_TASK_STACK_DEPTH;
         
         // Calculate real stack usage percentage
@@ -531,6 +576,16 @@ void update_task_stats(void) {
     g_system_state.context_switch_count = actual_context_switches;
 }
 
+// Ctrl+C or SIGTERM: the anomaly task saves the checkpoint and ends the
+// scheduler, and main() cleans up. A second signal takes the default action.
+static volatile sig_atomic_t shutdown_signalled = 0;
+
+static void shutdown_handler(int signum) {
+    (void)signum;
+    shutdown_signalled = 1;
+    anomaly_request_shutdown();
+}
+
 int main(void) {
     printf("\n");
     printf("==========================================================\n");
@@ -551,6 +606,15 @@ int main(void) {
     }
     printf("  [OK] ISR Queue created (size 10)\n");
     
+    // Raw vibration for envelope analysis: 1s of samples, wake on one block
+    xVibrationStream = xStreamBufferCreate(ENVELOPE_INPUT_RATE_HZ * sizeof(float),
+                                           VIBRATION_BLOCK_SAMPLES * sizeof(float));
+    if (xVibrationStream == NULL) {
+        printf("  [FAIL] Vibration Stream Buffer creation failed!\n");
+        return 1;
+    }
+    printf("  [OK] Vibration Stream Buffer created (1s @ 1kHz)\n");
+    
     // Create data flow queues (Capability 3)
     xSensorDataQueue = xQueueCreate(5, sizeof(SensorData_t));
     if (xSensorDataQueue == NULL) {
@@ -566,6 +630,33 @@ int main(void) {
     }
     printf("  [OK] Anomaly Alert Queue created (size 3)\n");
     
+    xEmergencyQueue = xQueueCreate(8, sizeof(EmergencyEvent_t));
+    if (xEmergencyQueue == NULL) {
+        printf("  [FAIL] Emergency Queue creation failed!\n");
+        return 1;
+    }
+    printf("  [OK] Emergency Queue created (size 8)\n");
+    
+    xNetworkCommandQueue = xQueueCreate(4, sizeof(NetworkCommand_t));
+    xTelemetryReadySemaphore = xSemaphoreCreateBinary();
+    if (xNetworkCommandQueue == NULL || xTelemetryReadySemaphore == NULL) {
+        printf("  [FAIL] Network Command Queue / Telemetry Semaphore creation failed!\n");
+        return 1;
+    }
+    printf("  [OK] Network Command Queue (size 4) and Telemetry Semaphore created\n");
+    
+    // The network task blocks on all three at once; the set holds one event
+    // per item they can hold (3 alerts + 1 semaphore + 4 commands)
+    xNetworkQueueSet = xQueueCreateSet(3 + 1 + 4);
+    if (xNetworkQueueSet == NULL ||
+        xQueueAddToSet(xAnomalyAlertQueue, xNetworkQueueSet) != pdPASS ||
+        xQueueAddToSet(xTelemetryReadySemaphore, xNetworkQueueSet) != pdPASS ||
+        xQueueAddToSet(xNetworkCommandQueue, xNetworkQueueSet) != pdPASS) {
+        printf("  [FAIL] Network Queue Set creation failed!\n");
+        return 1;
+    }
+    printf("  [OK] Network Queue Set created (alerts, telemetry, commands)\n");
+    
     // Create mutexes for shared resource protection (Capability 4)
     xSystemStateMutex = xSemaphoreCreateMutex();
     if (xSystemStateMutex == NULL) {
@@ -581,6 +672,18 @@ int main(void) {
     }
     printf("  [OK] Thresholds Mutex created\n");
     
+    xLinkMutex = xSemaphoreCreateMutex();
+    if (xLinkMutex == NULL) {
+        printf("  [FAIL] Link Mutex creation failed!\n");
+        return 1;
+    }
+    printf("  [OK] Link Mutex created\n");
+    
+    // Per call site wait/hold profiling for every mutex
+    lock_profiler_register(xSystemStateMutex, "SystemState");
+    lock_profiler_register(xThresholdsMutex, "Thresholds");
+    lock_profiler_register(xLinkMutex, "Link");
+    
     // Create event group for system synchronization (Capability 5)
     xSystemReadyEvents = xEventGroupCreate();
     if (xSystemReadyEvents == NULL) {
@@ -589,6 +692,31 @@ int main(void) {
     }
     printf("  [OK] System Ready Event Group created\n");
     
+#if METRICS_SHM
+    // Shared-memory snapshot for external observers (tools/metrics_reader)
+    if (metrics_export_init()) {
+        printf("  [OK] Metrics segment %s created\n", METRICS_SHM_NAME);
+    } else {
+        printf("  [FAIL] Metrics segment %s not created; external monitoring off\n", METRICS_SHM_NAME);
+    }
+#endif
+    
+#if ANOMALY_CHECKPOINT
+    // Detector baselines and calibration from the last run (warm start)
+    if (anomaly_checkpoint_load()) {
+        printf("  [OK] Checkpoint %s loaded: warm start\n", ANOMALY_CHECKPOINT_PATH);
+    } else {
+        printf("  [OK] Checkpoint %s %s: cold start\n", ANOMALY_CHECKPOINT_PATH,
+               checkpoint_result_names[g_system_state.checkpoint.boot_result]);
+    }
+#endif
+    struct sigaction shutdown_action;
+    memset(&shutdown_action, 0, sizeof(shutdown_action));
+    shutdown_action.sa_handler = shutdown_handler;
+    shutdown_action.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &shutdown_action, NULL);
+    sigaction(SIGTERM, &shutdown_action, NULL);
+    
     // Create tasks with different priorities
     xTaskCreate(vSensorTask, "SensorTask", STACK_SIZE_MEDIUM, NULL, 
                 PRIORITY_SENSOR, &xSensorTaskHandle);
@@ -606,13 +734,28 @@ int main(void) {
                 PRIORITY_NETWORK, &xNetworkTaskHandle);
     printf("  [OK] Network Task (Priority %d)\n", PRIORITY_NETWORK);
     
+    xTaskCreate(vEmergencyLaneTask, "EmergencyLane", STACK_SIZE_MEDIUM, NULL,
+                PRIORITY_EMERGENCY, &xEmergencyLaneTaskHandle);
+    printf("  [OK] Emergency Lane Task (Priority %d)\n", PRIORITY_EMERGENCY);
+    
+    xTaskCreate(vStatsTask, "StatsTask", STACK_SIZE_MEDIUM, NULL,
+                PRIORITY_STATS, &xStatsTaskHandle);
+    printf("  [OK] Stats Task (Priority %d) every %d ms\n", PRIORITY_STATS, STATS_SAMPLE_MS);
+    
     xTaskCreate(vDashboardTask, "DashboardTask", STACK_SIZE_LARGE, NULL, 
                 PRIORITY_DASHBOARD, &xDashboardTaskHandle);
     printf("  [OK] Dashboard Task (Priority %d)\n", PRIORITY_DASHBOARD);
     
+#if STATUS_HTTP
+    // Bench status page; reads the metrics segment
+    xTaskCreate(vHttpTask, "HttpTask", STACK_SIZE_MEDIUM, NULL,
+                PRIORITY_DASHBOARD, &xHttpTaskHandle);
+    printf("  [OK] HTTP Task (Priority %d) on http://127.0.0.1:%d/\n", PRIORITY_DASHBOARD, STATUS_HTTP_PORT);
+#endif
+    
     // Create 100Hz timer for simulated sensor interrupts (Capability 2)
     xSensorTimer = xTimerCreate("ISRTimer", 
-                                pdMS_TO_TICKS(10),  // 10ms = 100Hz
+                                pdMS_TO_TICKS(1000 / ISR_RATE_HZ),  // 10ms = 100Hz
                                 pdTRUE,             // Auto-reload
                                 NULL,               // Timer ID
                                 vSimulatedSensorISR); // Callback
@@ -635,7 +778,12 @@ int main(void) {
     // Start the scheduler
     vTaskStartScheduler();
     
-    // Should never reach here
+    // Only a shutdown request ends the scheduler; no task runs from here on
+    metrics_export_close();
+    if (shutdown_signalled) {
+        printf("Shutdown complete\n");
+        return 0;
+    }
     printf("Error: Scheduler returned!\n");
     return 1;
 }
@@ -1,224 +1,216 @@
 /**
- * Anomaly Detection Task - Threshold-based detection with ML-ready architecture
+ * Anomaly Detection Task - Pluggable detector registry with ML-ready architecture
  * Priority: 3 (Medium)
  * Frequency: 5Hz
  */
 
 #include <stdio.h>
-#include <math.h>
 #include <stdbool.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
 #include "semphr.h"
 #include "event_groups.h"
+#include "stream_buffer.h"
 #include "../common/system_state.h"
+#include "../common/lock_profiler.h"
+#include "anomaly_engine.h"
 
 // Detection parameters
 #define ANOMALY_CHECK_RATE_MS   200  // 5Hz
-#define HISTORY_SIZE           100
-#define BASELINE_WINDOW        20
 
 // External references
 extern SystemState_t g_system_state;
 extern ThresholdConfig_t g_thresholds;
 extern QueueHandle_t xSensorDataQueue;    // Capability 3: Receive sensor data
 extern QueueHandle_t xAnomalyAlertQueue;  // Capability 3: Send alerts
+extern StreamBufferHandle_t xVibrationStream;  // Raw 1kHz vibration from the sensor task
 extern SemaphoreHandle_t xSystemStateMutex;  // Capability 4: Mutex protection
 extern SemaphoreHandle_t xThresholdsMutex;   // Capability 4: Mutex protection
 extern EventGroupHandle_t xSystemReadyEvents;  // Capability 5: Event groups
 
 // Event bits (defined in main.c)
+#define SENSORS_CALIBRATED_BIT  (1 << 0)  // 0x01 - SensorTask ready
 #define ANOMALY_READY_BIT       (1 << 2)  // 0x04 - AnomalyTask baseline ready
 
-// Detection state
-typedef struct {
-    float vibration_history[HISTORY_SIZE];
-    float temperature_history[HISTORY_SIZE];
-    float rpm_history[HISTORY_SIZE];
-    uint32_t history_index;
-    
-    float vibration_baseline;
-    float temperature_baseline;
-    float rpm_baseline;
-    
-    float vibration_stddev;
-    float temperature_stddev;
-    float rpm_stddev;
-} DetectionState_t;
+// Run-time stats counter (microseconds, defined in main.c)
+extern unsigned long ulGetRunTimeCounterValue(void);
 
-static DetectionState_t detection_state = {0};
+// Detection pipeline (pure C, shared with the offline tools)
+static AnomalyEngine_t anomaly_engine;
 
-// Calculate mean of array
-static float calculate_mean(float* data, uint32_t size) {
-    float sum = 0;
-    for (uint32_t i = 0; i < size; i++) {
-        sum += data[i];
-    }
-    return sum / size;
+static uint32_t detector_clock_us(void) {
+    return (uint32_t)ulGetRunTimeCounterValue();
 }
 
-// Calculate standard deviation
-static float calculate_stddev(float* data, uint32_t size, float mean) {
-    float sum_sq = 0;
-    for (uint32_t i = 0; i < size; i++) {
-        float diff = data[i] - mean;
-        sum_sq += diff * diff;
-    }
-    return sqrt(sum_sq / size);
+// Detector checkpoint: read before the scheduler starts, applied once the
+// engine is initialised, then saved every CHECKPOINT_PERIOD_S and on shutdown
+static Checkpoint_t checkpoint;
+static volatile sig_atomic_t shutdown_requested = 0;
+
+bool anomaly_checkpoint_load(void) {
+    CheckpointResult_t result = CHECKPOINT_MISSING;
+#if ANOMALY_CHECKPOINT
+    result = checkpoint_read(&checkpoint, ANOMALY_CHECKPOINT_PATH, (uint32_t)time(NULL),
+                             CHECKPOINT_MAX_AGE_S);
+#endif
+    g_system_state.checkpoint.boot_result = result;
+    g_system_state.checkpoint.sensors_calibrated = result == CHECKPOINT_OK &&
+        (checkpoint.header.flags & CHECKPOINT_FLAG_SENSORS_CALIBRATED) != 0;
+    return result == CHECKPOINT_OK;
 }
 
-// Update baselines using moving average
-static void update_baselines(void) {
-    uint32_t start_idx = 0;
-    uint32_t count = BASELINE_WINDOW;
-    
-    if (detection_state.history_index < BASELINE_WINDOW) {
-        count = detection_state.history_index;
-    } else {
-        start_idx = detection_state.history_index - BASELINE_WINDOW;
-    }
-    
-    if (count > 0) {
-        // Calculate baselines
-        detection_state.vibration_baseline = calculate_mean(
-            &detection_state.vibration_history[start_idx], count);
-        detection_state.temperature_baseline = calculate_mean(
-            &detection_state.temperature_history[start_idx], count);
-        detection_state.rpm_baseline = calculate_mean(
-            &detection_state.rpm_history[start_idx], count);
-        
-        // Calculate standard deviations
-        detection_state.vibration_stddev = calculate_stddev(
-            &detection_state.vibration_history[start_idx], count, 
-            detection_state.vibration_baseline);
-        detection_state.temperature_stddev = calculate_stddev(
-            &detection_state.temperature_history[start_idx], count,
-            detection_state.temperature_baseline);
-        detection_state.rpm_stddev = calculate_stddev(
-            &detection_state.rpm_history[start_idx], count,
-            detection_state.rpm_baseline);
-    }
+// Async-signal-safe: at its next cycle the task saves the checkpoint and
+// ends the scheduler, so main() shuts down with no task running
+void anomaly_request_shutdown(void) {
+    shutdown_requested = 1;
 }
 
-// Detect anomalies using threshold method
-static void detect_anomalies(void) {
-    // Get current readings (protected)
-    float vib = 0, temp = 0, rpm = 0;
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+#if ANOMALY_CHECKPOINT
+// Capture the engine and write it out; only this task touches the engine
+static bool save_checkpoint(void) {
+    uint32_t flags = (xEventGroupGetBits(xSystemReadyEvents) & SENSORS_CALIBRATED_BIT)
+                     ? CHECKPOINT_FLAG_SENSORS_CALIBRATED : 0;
+    uint32_t start_us = detector_clock_us();
+    checkpoint_capture(&checkpoint, &anomaly_engine, flags, (uint32_t)time(NULL));
+    bool written = checkpoint_write(&checkpoint, ANOMALY_CHECKPOINT_PATH);
+    uint32_t elapsed_us = detector_clock_us() - start_us;
+    
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
-        vib = g_system_state.sensors.vibration;
-        temp = g_system_state.sensors.temperature;
-        rpm = g_system_state.sensors.rpm;
+        CheckpointStatus_t* status = &g_system_state.checkpoint;
+        if (written) {
+            status->saves++;
+        } else {
+            status->save_failures++;
+        }
+        status->last_save_us = elapsed_us;
+        status->bytes = checkpoint_bytes(&checkpoint);
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
-    
-    // Store in history
-    uint32_t idx = detection_state.history_index % HISTORY_SIZE;
-    detection_state.vibration_history[idx] = vib;
-    detection_state.temperature_history[idx] = temp;
-    detection_state.rpm_history[idx] = rpm;
-    detection_state.history_index++;
-    
-    // Update baselines
-    update_baselines();
-    
-    // Detect anomalies (3-sigma rule) - protected write
-    bool vib_anomaly = false, temp_anomaly = false, rpm_anomaly = false;
-    uint32_t anomaly_count = 0;
-    
+    return written;
+}
+#endif
+
+// Run the enabled detectors over the samples fed since the last cycle
+static void detect_anomalies(void) {
     // Get threshold values (protected)
-    float vib_warning = 5.0, temp_warning = 70.0, rpm_min = 10.0, rpm_max = 30.0;
-    if (xSemaphoreTake(xThresholdsMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    ThresholdConfig_t thresholds;
+    threshold_config_defaults(&thresholds);
+    if (PROFILED_TAKE(xThresholdsMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.threshold_mutex_takes++;
-        vib_warning = g_thresholds.vibration_warning;
-        temp_warning = g_thresholds.temperature_warning;
-        rpm_min = g_thresholds.rpm_min;
-        rpm_max = g_thresholds.rpm_max;
+        thresholds = g_thresholds;
         g_system_state.mutex_stats.threshold_mutex_gives++;
-        xSemaphoreGive(xThresholdsMutex);
+        PROFILED_GIVE(xThresholdsMutex);
     } else {
         g_system_state.mutex_stats.threshold_mutex_timeouts++;
     }
     
-    if (detection_state.history_index > BASELINE_WINDOW) {
-        // Vibration anomaly
-        float vib_deviation = fabs(vib - detection_state.vibration_baseline);
-        if (vib_deviation > 3.0 * detection_state.vibration_stddev ||
-            vib > vib_warning) {
-            vib_anomaly = true;
-            anomaly_count++;
-        }
-        
-        // Temperature anomaly
-        float temp_deviation = fabs(temp - detection_state.temperature_baseline);
-        if (temp_deviation > 3.0 * detection_state.temperature_stddev ||
-            temp > temp_warning) {
-            temp_anomaly = true;
-            anomaly_count++;
-        }
-        
-        // RPM anomaly
-        float rpm_deviation = fabs(rpm - detection_state.rpm_baseline);
-        if (rpm_deviation > 3.0 * detection_state.rpm_stddev ||
-            rpm < rpm_min || rpm > rpm_max) {
-            rpm_anomaly = true;
-            anomaly_count++;
-        }
-    }
-    
-    // Calculate health score (0-100%)
-    float health = 100.0;
-    
-    // Reduce health based on deviations
-    if (detection_state.vibration_stddev > 0) {
-        float vib_score = fabs(vib - detection_state.vibration_baseline) / 
-                         (detection_state.vibration_stddev * 3.0);
-        health -= fmin(vib_score * 20.0, 30.0);  // Max 30% reduction
-    }
-    
-    if (detection_state.temperature_stddev > 0) {
-        float temp_score = fabs(temp - detection_state.temperature_baseline) / 
-                          (detection_state.temperature_stddev * 3.0);
-        health -= fmin(temp_score * 15.0, 25.0);  // Max 25% reduction
-    }
-    
-    if (detection_state.rpm_stddev > 0) {
-        float rpm_score = fabs(rpm - detection_state.rpm_baseline) / 
-                         (detection_state.rpm_stddev * 3.0);
-        health -= fmin(rpm_score * 15.0, 25.0);  // Max 25% reduction
-    }
-    
     // Check emergency stop status
     bool emergency = false;
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         emergency = g_system_state.emergency_stop;
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
     
-    if (emergency) {
-        health = 0;
-    }
+    // Evaluate detectors and fuse their scores into a health score (0-100%)
+    anomaly_engine_evaluate(&anomaly_engine, &thresholds, emergency);
     
     // Update anomaly results in protected section
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        g_system_state.mutex_stats.system_mutex_takes++;
+        g_system_state.anomalies = anomaly_engine.results;
+        history_add(&g_system_state.health_history, anomaly_engine.results.health_score,
+                    xTaskGetTickCount() * portTICK_PERIOD_MS);
+        g_system_state.detector_count = detector_registry_get_stats(
+            &anomaly_engine.registry, g_system_state.detectors, MAX_DETECTORS);
+        g_system_state.mutex_stats.system_mutex_gives++;
+        PROFILED_GIVE(xSystemStateMutex);
+    } else {
+        g_system_state.mutex_stats.system_mutex_timeouts++;
+    }
+}
+
+// Raw vibration stages: bearing envelope, rotor order tracking, block features
+static EnvelopeAnalyzer_t envelope;
+static OrderTracker_t order_tracker;
+static FeatureExtractor_t feature_extractor;
+
+// Drain the raw vibration that arrived since the last cycle into every stage
+static void analyze_vibration(const SensorData_t* reading) {
+    float block[VIBRATION_BLOCK_SAMPLES * 4];
+    float rpm = reading->rpm;
+    float shaft_hz = rpm / 60.0f * ENVELOPE_SHAFT_RATIO;
+    bool envelope_ready = false;
+    bool orders_ready = false;
+    uint32_t envelope_us = 0;
+    uint32_t orders_us = 0;
+    uint32_t features_us = 0;
+    size_t received;
+    
+    while ((received = xStreamBufferReceive(xVibrationStream, block, sizeof(block), 0)) > 0) {
+        uint32_t count = (uint32_t)(received / sizeof(float));
+        uint32_t t0 = detector_clock_us();
+        envelope_ready |= envelope_push(&envelope, block, count, shaft_hz);
+        uint32_t t1 = detector_clock_us();
+        orders_ready |= order_tracker_push(&order_tracker, block, count, rpm / 60.0f);
+        uint32_t t2 = detector_clock_us();
+        feature_accumulate(&feature_extractor, block, count);
+        envelope_us += t1 - t0;
+        orders_us += t2 - t1;
+        features_us += detector_clock_us() - t2;
+    }
+    
+    // One feature vector per cycle, whatever the number of raw samples
+    FeatureVector_t features;
+    uint32_t t0 = detector_clock_us();
+    bool features_ready = feature_finish(&feature_extractor, reading,
+                                         ANOMALY_CHECK_RATE_MS / 1000.0f, &features);
+    features_us += detector_clock_us() - t0;
+    
+    // Publish cost every cycle, results when a stage has new output (protected)
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
-        g_system_state.anomalies.vibration_anomaly = vib_anomaly;
-        g_system_state.anomalies.temperature_anomaly = temp_anomaly;
-        g_system_state.anomalies.rpm_anomaly = rpm_anomaly;
-        if (anomaly_count > 0) {
-            g_system_state.anomalies.anomaly_count += anomaly_count;
+        EnvelopeStats_t* env = &g_system_state.envelope;
+        env->last_cycle_us = envelope_us;
+        if (envelope_us > env->max_cycle_us) {
+            env->max_cycle_us = envelope_us;
+        }
+        if (envelope_ready) {
+            env->result = envelope.result;
+        }
+        
+        OrderStats_t* orders = &g_system_state.orders;
+        orders->last_cycle_us = orders_us;
+        if (orders_us > orders->max_cycle_us) {
+            orders->max_cycle_us = orders_us;
+        }
+        if (orders_ready) {
+            orders->result = order_tracker.result;
+            orders->blade_pass_amplitude = order_tracker_amplitude(&order_tracker, ORDER_BLADE_PASS);
+        }
+        
+        FeatureStats_t* stats = &g_system_state.features;
+        stats->last_cycle_us = features_us;
+        if (features_us > stats->max_cycle_us) {
+            stats->max_cycle_us = features_us;
+        }
+        if (features_ready) {
+            stats->vector = features;
+            stats->blocks++;
         }
-        g_system_state.anomalies.health_score = fmax(health, 0.0);
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
@@ -232,6 +224,32 @@ void vAnomalyTask(void *pvParameters) {
     
     uint32_t cycle_count = 0;
     bool anomaly_ready = false;
+    uint32_t critical_raised = 0;       // Channels whose critical alert is out
+    
+    anomaly_engine_init(&anomaly_engine, detector_clock_us);
+    
+    // Warm start: baselines from the last run, ready at the first evaluation
+    if (g_system_state.checkpoint.boot_result == CHECKPOINT_OK &&
+        checkpoint_apply(&checkpoint, &anomaly_engine) == CHECKPOINT_OK) {
+        g_system_state.checkpoint.restored = true;
+        printf("[ANOMALY] Restored %lu detector states (%lu samples) from %s\n",
+               (unsigned long)checkpoint.header.detector_count,
+               (unsigned long)checkpoint.header.samples_seen, ANOMALY_CHECKPOINT_PATH);
+    }
+#if ANOMALY_CHECKPOINT
+    uint32_t last_save_s = 0;
+#endif
+    
+    BearingGeometry_t geometry;
+    bearing_geometry_defaults(&geometry);
+    envelope_init(&envelope, &geometry);
+    order_tracker_init(&order_tracker);
+    feature_extractor_init(&feature_extractor);
+    SensorData_t latest_reading;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        latest_reading.values[ch] = sensor_channels[ch].nominal;
+    }
+    latest_reading.timestamp = 0;
     
     while (1) {
         // Wait for the next cycle
@@ -251,34 +269,45 @@ void vAnomalyTask(void *pvParameters) {
                xQueueReceive(xSensorDataQueue, &sensor_data, 0) == pdTRUE) {
             items_processed++;
             // Keep the latest data for processing (protected)
-            if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                 g_system_state.mutex_stats.system_mutex_takes++;
                 g_system_state.sensors = sensor_data;
                 g_system_state.mutex_stats.system_mutex_gives++;
-                xSemaphoreGive(xSystemStateMutex);
+                PROFILED_GIVE(xSystemStateMutex);
             } else {
                 g_system_state.mutex_stats.system_mutex_timeouts++;
             }
+            
+            // Feed every received sample to the detectors
+            anomaly_engine_feed(&anomaly_engine, &sensor_data);
+            latest_reading = sensor_data;
         }
         
+        // Raw vibration stages run every cycle on whatever has arrived
+        analyze_vibration(&latest_reading);
+        
         // If we got any data, run anomaly detection
         if (items_processed > 0) {
-            // Perform anomaly detection on latest data
+            // Evaluate the detectors on this batch
             detect_anomalies();
             
             // Check if anomaly detection is ready (after baseline window filled) - Capability 5
-            if (!anomaly_ready && detection_state.history_index >= BASELINE_WINDOW) {
+            if (!anomaly_ready && anomaly_engine_ready(&anomaly_engine)) {
                 anomaly_ready = true;
                 // Set the anomaly ready bit in event group
                 xEventGroupSetBits(xSystemReadyEvents, ANOMALY_READY_BIT);
+                uint32_t ready_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+                printf("[ANOMALY] Detection ready after %lu ms (%s start)\n",
+                       (unsigned long)ready_ms, g_system_state.checkpoint.restored ? "warm" : "cold");
                 
                 // Update statistics (protected)
-                if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+                if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                     g_system_state.mutex_stats.system_mutex_takes++;
                     g_system_state.event_group_stats.bits_set_count++;
                     g_system_state.event_group_stats.current_event_bits |= ANOMALY_READY_BIT;
+                    g_system_state.checkpoint.ready_ms = ready_ms;
                     g_system_state.mutex_stats.system_mutex_gives++;
-                    xSemaphoreGive(xSystemStateMutex);
+                    PROFILED_GIVE(xSystemStateMutex);
                 } else {
                     g_system_state.mutex_stats.system_mutex_timeouts++;
                 }
@@ -288,35 +317,73 @@ void vAnomalyTask(void *pvParameters) {
             // Send every 2nd cycle when anomaly detected (2.5Hz)
             bool send_alert = false;
             AnomalyAlert_t alert;
+            uint32_t anomaly_flags = 0;
+            float values[CHANNEL_COUNT];
             
-            if (cycle_count % 2 == 0) {
-                // Check anomaly status (protected)
-                if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                    g_system_state.mutex_stats.system_mutex_takes++;
-                    if (g_system_state.anomalies.vibration_anomaly || 
-                        g_system_state.anomalies.temperature_anomaly) {
+            // Check anomaly status (protected)
+            if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+                g_system_state.mutex_stats.system_mutex_takes++;
+                // First anomalous channel that raises alerts, in table order
+                for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+                    if (!g_system_state.anomalies.channel_anomaly[ch] ||
+                        sensor_channels[ch].alert_severity <= 0) {
+                        continue;
+                    }
+                    anomaly_flags |= CHANNEL_FLAG(ch);
+                    if (!send_alert) {
                         send_alert = true;
-                        alert.severity = g_system_state.anomalies.vibration_anomaly ? 8.0 : 5.0;
-                        alert.type = g_system_state.anomalies.vibration_anomaly ? 0 : 1;
+                        alert.severity = sensor_channels[ch].alert_severity;
+                        alert.type = ch;
                         alert.timestamp = xTaskGetTickCount();
+                        alert.raised_us = (uint32_t)ulGetRunTimeCounterValue();
                     }
-                    g_system_state.mutex_stats.system_mutex_gives++;
-                    xSemaphoreGive(xSystemStateMutex);
-                } else {
-                    g_system_state.mutex_stats.system_mutex_timeouts++;
                 }
+                memcpy(values, g_system_state.sensors.values, sizeof(values));
+                g_system_state.mutex_stats.system_mutex_gives++;
+                PROFILED_GIVE(xSystemStateMutex);
+            } else {
+                g_system_state.mutex_stats.system_mutex_timeouts++;
             }
             
-            if (send_alert) {
+            // Critical alerts skip the batch: once per episode, straight to the lane
+            for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+                if ((anomaly_flags & ~critical_raised & CHANNEL_FLAG(ch)) &&
+                    sensor_channels[ch].alert_severity >= CRITICAL_ALERT_SEVERITY) {
+                    emergency_lane_raise(EMERGENCY_CRITICAL_ALERT, ch, values[ch]);
+                    critical_raised |= CHANNEL_FLAG(ch);
+                }
+            }
+            critical_raised &= anomaly_flags;
+            
+            if (send_alert && cycle_count % 2 == 0) {
                 
                 // Send alert (non-blocking)
                 xQueueSend(xAnomalyAlertQueue, &alert, 0);
             }
         } else {
-            // No data in queue - still run detection with current state
+            // No data in queue - re-evaluate the current baselines
             detect_anomalies();
         }
         
+#if ANOMALY_CHECKPOINT
+        // Only baselines worth restoring are saved: a cold start beats a
+        // half-filled window
+        uint32_t uptime_s = xTaskGetTickCount() / configTICK_RATE_HZ;
+        if (anomaly_ready && uptime_s - last_save_s >= CHECKPOINT_PERIOD_S) {
+            save_checkpoint();
+            last_save_s = uptime_s;
+        }
+#endif
+        if (shutdown_requested) {
+#if ANOMALY_CHECKPOINT
+            const char* outcome = !anomaly_ready ? "not saved (baselines not ready)"
+                                : save_checkpoint() ? "saved to " ANOMALY_CHECKPOINT_PATH
+                                : "write failed";
+            printf("\n[ANOMALY] Shutdown: checkpoint %s\n", outcome);
+#endif
+            vTaskEndScheduler();
+        }
+        
         // Occasionally yield to demonstrate scheduling
         if (cycle_count % 5 == 0) {
             taskYIELD();
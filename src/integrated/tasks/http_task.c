@@ -0,0 +1,107 @@
+/**
+ * HTTP Task - Bench status page, /metrics JSON and /stream Server-Sent Events
+ * Priority: 1 (Lowest)
+ * Frequency: 50Hz socket polling; one serialization per published snapshot
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "../common/system_state.h"
+#include "../common/lock_profiler.h"
+#include "../common/metrics_export.h"
+#include "status_http.h"
+
+// HTTP parameters
+#define HTTP_POLL_MS            20
+
+// External references
+extern SystemState_t g_system_state;
+extern SemaphoreHandle_t xSystemStateMutex;
+extern unsigned long ulGetRunTimeCounterValue(void);  // Microsecond run-time counter (main.c)
+
+// GET /: renders every /stream event
+static const char index_html[] =
+    "<!DOCTYPE html><html><head><meta charset=\"utf-8\"><title>Turbine Monitor</title>"
+    "<style>body{font:14px monospace;margin:1em}table{border-collapse:collapse;margin:.5em 0}"
+    "td,th{padding:2px 10px;text-align:right}th{text-align:left}.bad{color:#c00}</style></head>"
+    "<body><h3>Turbine Monitor <span id=\"state\">connecting</span></h3>"
+    "<div id=\"summary\"></div><table id=\"sensors\"></table><table id=\"tasks\"></table>"
+    "<script>"
+    "const row=(c,h)=>'<tr>'+c.map(v=>h?'<th>'+v+'</th>':'<td>'+v+'</td>').join('')+'</tr>';"
+    "const es=new EventSource('/stream');"
+    "es.onerror=()=>{document.getElementById('state').textContent='disconnected'};"
+    "es.onmessage=e=>{const m=JSON.parse(e.data);"
+    "document.getElementById('state').textContent=m.emergency_stop?'EMERGENCY STOP':'';"
+    "document.getElementById('summary').textContent='up '+m.uptime_s+'s | health '+m.health+"
+    "'% | cpu '+m.cpu+'% | heap free '+m.heap.free+' (min '+m.heap.min_free+') | isr p99 '+"
+    "m.isr.p99_us+'us | '+(m.network_connected?'online':'offline');"
+    "let s=row(['Sensor','Value'],1),i=0;"
+    "for(const k in m.sensors){s+='<tr'+((m.anomaly_flags>>i++)&1?' class=\"bad\"':'')+'><th>'+k+"
+    "'</th><td>'+m.sensors[k]+'</td></tr>'}"
+    "document.getElementById('sensors').innerHTML=s;"
+    "let t=row(['Task','Prio','CPU%','Stack%'],1);"
+    "for(const k of m.tasks){t+=row([k.name,k.priority,k.cpu,k.stack])}"
+    "document.getElementById('tasks').innerHTML=t}"
+    "</script></body></html>";
+
+static const char* channel_names[CHANNEL_COUNT];
+
+// Bench status server: reads the metrics segment like any other observer,
+// formats each new snapshot once into the server's shared frame, and fans
+// it out to every client
+void vHttpTask(void *pvParameters) {
+    (void)pvParameters;
+    
+    static StatusHttp_t server;
+    static MetricsSnapshot_t snapshot;
+    uint32_t published = 0;
+    uint32_t serialize_us = 0;
+    uint32_t max_serialize_us = 0;
+    
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        channel_names[ch] = sensor_channels[ch].name;
+    }
+    if (!status_http_open(&server, STATUS_HTTP_PORT, index_html)) {
+        printf("[HTTP] Cannot listen on 127.0.0.1:%d; status server off\n", STATUS_HTTP_PORT);
+        vTaskDelete(NULL);
+        return;
+    }
+    
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    while (1) {
+        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(HTTP_POLL_MS));
+        
+        // A new snapshot: one serialization whatever the client count
+        const MetricsSegment_t* segment = metrics_export_segment();
+        if (segment != NULL && metrics_shm_publishes(segment) != published &&
+            metrics_shm_read(segment, &snapshot, 0, NULL)) {
+            published = metrics_shm_publishes(segment);
+            uint32_t capacity;
+            char* frame = status_http_begin(&server, &capacity);
+            uint32_t start_us = (uint32_t)ulGetRunTimeCounterValue();
+            uint32_t length = metrics_snapshot_json(&snapshot, channel_names, frame, capacity);
+            serialize_us = (uint32_t)ulGetRunTimeCounterValue() - start_us;
+            if (serialize_us > max_serialize_us) {
+                max_serialize_us = serialize_us;
+            }
+            status_http_commit(&server, length);
+        }
+        
+        status_http_poll(&server, (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+        
+        // Update server statistics (protected)
+        if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            g_system_state.mutex_stats.system_mutex_takes++;
+            g_system_state.status_http.stats = server.stats;
+            g_system_state.status_http.last_serialize_us = serialize_us;
+            g_system_state.status_http.max_serialize_us = max_serialize_us;
+            g_system_state.status_http.frame_bytes = server.json_length;
+            g_system_state.mutex_stats.system_mutex_gives++;
+            PROFILED_GIVE(xSystemStateMutex);
+        } else {
+            g_system_state.mutex_stats.system_mutex_timeouts++;
+        }
+    }
+}
@@ -1,9 +1,11 @@
 /**
  * Network Task - Simulates data transmission to cloud
  * Priority: 2 (Low)
- * Frequency: 1Hz
+ * Frequency: 1Hz scheduled, plus alerts, closed rollups and commands as they arrive
  */
 
+#include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,39 +16,106 @@
 #include "semphr.h"
 #include "event_groups.h"
 #include "../common/system_state.h"
+#include "../common/lock_profiler.h"
+#include "anomaly_engine.h"
+#include "exception_report.h"
+#include "transport.h"
+#include "link_emulator.h"
+#include "mqtt.h"
 
 // Network parameters
 #define NETWORK_SEND_RATE_MS    1000  // 1Hz
 #define PACKET_SIZE            256
-#define TRANSMISSION_TIME_MS    50    // Simulated network latency
+#define HEARTBEAT_INTERVAL_S    10
+
+// Simulated uplink, shared by the bulk (this task) and emergency lanes. Bulk
+// packets go out LINK_CHUNK_BYTES at a time and release the link between
+// chunks, so an emergency waits at most one chunk (8ms) for the wire. Past
+// the radio, the emulated link (NETWORK_LINK_PROFILE) loses, delays and
+// reorders frames.
+#define LINK_BYTES_PER_MS       8     // 64 kbit/s
+#define LINK_CHUNK_BYTES        64
+#define LINK_SEED               1     // Uplink; downlink and emergency path follow
+#define EMERGENCY_PACKET_SIZE   96
+#define EMERGENCY_ID_SIZE       4     // Event id ahead of the packet; the ack is the id alone
+#define EMERGENCY_ACK_SLACK_MS  20    // Ack timeout: a worst-case round trip plus this
+#define EMERGENCY_RETRIES       3     // Immediate resends of an unacknowledged emergency packet
+#define EMERGENCY_BACKOFF_MS    50    // Then wait with the link free, doubling...
+#define EMERGENCY_BACKOFF_MAX_MS 1000 // ...up to this, and try again
+#define EMERGENCY_DEADLINE_MS   30000 // Undelivered this long after the first try: failed
+
+// Report by exception (CMake option): send only the fields that left their
+// deadband, a heartbeat after HEARTBEAT_INTERVAL_S of silence
+#ifndef TELEMETRY_REPORT_BY_EXCEPTION
+#define TELEMETRY_REPORT_BY_EXCEPTION 0
+#endif
+
+// MQTT (TELEMETRY_MQTT): publish every bulk packet at QoS 1 to a broker on
+// this host (tools/mqtt_broker, or any MQTT 3.1.1 broker) over TCP, in place
+// of the sequenced transport over the emulated link
+#ifndef MQTT_BROKER_PORT
+#define MQTT_BROKER_PORT        1883
+#endif
+#define MQTT_CLIENT_ID          "TURBINE_001"   // Mirrors DEVICE_ID in app_config.h
+#define MQTT_TOPIC_ROOT         "turbine/" MQTT_CLIENT_ID "/"
+#define MQTT_KEEPALIVE_S        60
+#define MQTT_POLL_MS            10      // Socket checked this often while the broker owes a reply
+#define MQTT_COALESCE_MAX       PACKET_EXCEPTION_SIZE   // Larger packets are never batched
+
+#if TELEMETRY_MQTT
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#define UPLINK_HEADROOM         MQTT_HEADROOM
+#else
+#define UPLINK_HEADROOM         TRANSPORT_HEADER_SIZE
+#endif
 
 // External references
 extern SystemState_t g_system_state;
 extern void record_preemption(const char* preemptor, const char* preempted, const char* reason);
 extern QueueHandle_t xAnomalyAlertQueue;  // Capability 3: Receive anomaly alerts
+extern QueueHandle_t xNetworkCommandQueue;  // NetworkCommand_t from any task
+extern SemaphoreHandle_t xTelemetryReadySemaphore;  // Given when a rollup closes
+extern QueueSetHandle_t xNetworkQueueSet;   // The three above
 extern SemaphoreHandle_t xSystemStateMutex;  // Capability 4: Mutex protection
 extern EventGroupHandle_t xSystemReadyEvents;  // Capability 5: Event groups
+extern QueueHandle_t xEmergencyQueue;       // Emergency stops and critical alerts
+extern SemaphoreHandle_t xLinkMutex;        // The simulated uplink
+extern unsigned long ulGetRunTimeCounterValue(void);  // Microsecond run-time counter (main.c)
 
 // Event bits (defined in main.c)
 #define NETWORK_CONNECTED_BIT   (1 << 1)  // 0x02 - NetworkTask connected
 
 // Dynamic packet sizes (Capability 6: Memory Management)
 #define PACKET_HEARTBEAT_SIZE   64   // Small heartbeat packets
-#define PACKET_SENSOR_SIZE      256  // Medium sensor data packets  
+#define PACKET_SENSOR_SIZE      480  // Medium sensor data packets  
 #define PACKET_ANOMALY_SIZE     512  // Large anomaly report packets
+#define PACKET_ROLLUP_SIZE      256  // Closed 1min/1h rollup buckets
+#define PACKET_EXCEPTION_SIZE   160  // Fields that left their deadband
+#define PACKET_ALERT_SIZE       96   // One anomaly alert
+#define PACKET_BATCH_SIZE       512  // Small packets coalesced while the MQTT window is full
 
 // Packet types
 typedef enum {
     PACKET_TYPE_HEARTBEAT,
     PACKET_TYPE_SENSOR_DATA,
-    PACKET_TYPE_ANOMALY_REPORT
+    PACKET_TYPE_ANOMALY_REPORT,
+    PACKET_TYPE_ROLLUP,
+    PACKET_TYPE_EXCEPTION,
+    PACKET_TYPE_ALERT,
+    PACKET_TYPE_BATCH
 } PacketType_t;
 
-// Dynamic packet buffer structure
+// Dynamic packet buffer structure. header and data together are the
+// transport frame (or MQTT PUBLISH); the buffer is held until it is acknowledged.
 typedef struct {
     PacketType_t type;
     uint32_t size;
     uint32_t timestamp;
+    uint8_t header[UPLINK_HEADROOM];
     char data[];  // Flexible array member
 } PacketBuffer_t;
 
@@ -57,14 +126,57 @@ typedef struct {
     uint32_t bytes_sent;
     uint32_t anomaly_alerts_sent;
     uint32_t last_transmission_time;
+    uint32_t window_stalls;     // Scheduled packets skipped, window full
     bool transmission_in_progress;
 } NetworkStats_t;
 
 static NetworkStats_t network_stats = {0};
 
+// Rollup buckets already sent, per tier (closed counts from rollup_merge_since)
+static uint32_t rollup_sent[ROLLUP_TIERS];
+
+// Emergency events the lane queue had no room for
+static uint32_t emergency_dropped;
+
+// Sequenced, acknowledged delivery of every bulk packet over the emulated
+// link. The cloud end is simulated here: it takes frames off the uplink when
+// they are due and acknowledges them over the downlink.
+static TransportSender_t transport;
+static TransportReceiver_t cloud_receiver;
+static LinkEmulator_t uplink;
+static LinkEmulator_t downlink;
+static bool frame_abandoned;    // Every retry lost: the link is down
+
+// The emergency lane's own path and the acks coming back, same profile. The
+// cloud end acknowledges every emergency frame with its id; only a missing
+// ack tells the lane a frame was lost.
+static LinkEmulator_t emergency_link;
+static LinkEmulator_t emergency_ack_link;
+static uint32_t emergency_ack_timeout_ms;
+static uint32_t emergency_id;
+static uint32_t emergency_cloud_id;         // Newest event the cloud end has received
+static uint32_t emergency_delivered_us;     // When it came off the link
+
+#if TELEMETRY_MQTT
+// QoS 1 publishes to the broker. Small packets that find the window full are
+// coalesced into one batch packet, published when an acknowledgement frees a slot.
+static MqttPublisher_t mqtt;
+static MqttBatch_t mqtt_batch;
+static int mqtt_socket = -1;
+static LatencyHistogram_t mqtt_rtt;
+static uint32_t mqtt_acked_last_cycle;
+static uint32_t mqtt_acked_per_s;
+#endif
+
+#if TELEMETRY_REPORT_BY_EXCEPTION
+// What the receiver last got, for report by exception
+static ExceptionReporter_t exception_reporter;
+static uint32_t last_sent_s;
+#endif
+
 // Memory tracking helper functions (Capability 6)
 static void update_memory_stats_alloc(size_t size) {
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         g_system_state.memory_stats.allocations++;
         g_system_state.memory_stats.active_allocations++;
@@ -93,14 +205,14 @@ static void update_memory_stats_alloc(size_t size) {
         }
         
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
 }
 
 static void update_memory_stats_free(size_t size) {
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         g_system_state.memory_stats.deallocations++;
         g_system_state.memory_stats.active_allocations--;
@@ -124,42 +236,48 @@ static void update_memory_stats_free(size_t size) {
         }
         
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
 }
 
 static void update_memory_stats_failure() {
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         g_system_state.memory_stats.allocation_failures++;
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
 }
 
-// Dynamic packet allocation functions (Capability 6)
-static PacketBuffer_t* allocate_packet(PacketType_t type) {
-    size_t packet_size;
-    
-    // Determine packet size based on type
+// Payload capacity of each packet type
+static uint32_t packet_data_size(PacketType_t type) {
     switch (type) {
         case PACKET_TYPE_HEARTBEAT:
-            packet_size = sizeof(PacketBuffer_t) + PACKET_HEARTBEAT_SIZE;
-            break;
+            return PACKET_HEARTBEAT_SIZE;
         case PACKET_TYPE_SENSOR_DATA:
-            packet_size = sizeof(PacketBuffer_t) + PACKET_SENSOR_SIZE;
-            break;
+            return PACKET_SENSOR_SIZE;
         case PACKET_TYPE_ANOMALY_REPORT:
-            packet_size = sizeof(PacketBuffer_t) + PACKET_ANOMALY_SIZE;
-            break;
+            return PACKET_ANOMALY_SIZE;
+        case PACKET_TYPE_ROLLUP:
+            return PACKET_ROLLUP_SIZE;
+        case PACKET_TYPE_EXCEPTION:
+            return PACKET_EXCEPTION_SIZE;
+        case PACKET_TYPE_ALERT:
+            return PACKET_ALERT_SIZE;
+        case PACKET_TYPE_BATCH:
+            return PACKET_BATCH_SIZE;
         default:
-            packet_size = sizeof(PacketBuffer_t) + PACKET_SENSOR_SIZE;
-            break;
+            return PACKET_SENSOR_SIZE;
     }
+}
+
+// Dynamic packet allocation functions (Capability 6)
+static PacketBuffer_t* allocate_packet(PacketType_t type) {
+    size_t packet_size = sizeof(PacketBuffer_t) + packet_data_size(type);
     
     // Allocate memory for packet
     PacketBuffer_t* packet = (PacketBuffer_t*)pvPortMalloc(packet_size);
@@ -184,112 +302,468 @@ static void free_packet(PacketBuffer_t* packet) {
     }
 }
 
+// Append to a packet under construction; a full buffer makes later appends no-ops
+static void packet_append(char* buffer, uint32_t max_size, uint32_t* len, const char* fmt, ...) {
+    if (*len >= max_size) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buffer + *len, max_size - *len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += (uint32_t)n;
+    }
+}
+
+// Readings since the previous call (merged 1s rollups), health and flags
+static void read_report_input(ReportInput_t* input) {
+    input->window.count = 0;
+    input->time_s = xTaskGetTickCount() / configTICK_RATE_HZ;
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        g_system_state.mutex_stats.system_mutex_takes++;
+        rollup_sent[ROLLUP_SECOND] = rollup_merge_since(&g_system_state.rollup, ROLLUP_SECOND,
+                                                        rollup_sent[ROLLUP_SECOND], &input->window);
+        input->health_score = g_system_state.anomalies.health_score;
+        input->anomaly_flags = g_system_state.anomalies.anomaly_flags;
+        g_system_state.mutex_stats.system_mutex_gives++;
+        PROFILED_GIVE(xSystemStateMutex);
+    } else {
+        input->health_score = g_system_state.anomalies.health_score;
+        input->anomaly_flags = g_system_state.anomalies.anomaly_flags;
+        g_system_state.mutex_stats.system_mutex_timeouts++;
+    }
+}
+
 // Simulate network packet creation
-static uint32_t create_packet(char* buffer, uint32_t max_size) {
-    // Create JSON-like packet
-    int len = snprintf(buffer, max_size,
-        "{"
-        "\"timestamp\":%u,"
-        "\"vibration\":%.2f,"
-        "\"temperature\":%.2f,"
-        "\"rpm\":%.2f,"
-        "\"current\":%.2f,"
-        "\"health_score\":%.1f,"
-        "\"anomalies\":{"
-            "\"vibration\":%s,"
-            "\"temperature\":%s,"
-            "\"rpm\":%s"
+static uint32_t create_packet(char* buffer, uint32_t max_size, const ReportInput_t* input) {
+    // Create JSON-like packet; sensor and anomaly keys follow the channel table
+    uint32_t len = 0;
+
+    // Channels are [min,mean,max] over every second since the previous packet,
+    // so spikes between packets are not lost
+    const RollupBucket_t* seconds = &input->window;
+
+    packet_append(buffer, max_size, &len, "{\"timestamp\":%u,",
+                  (unsigned int)g_system_state.sensors.timestamp);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (seconds->count > 0) {
+            packet_append(buffer, max_size, &len, "\"%s\":[%.2f,%.2f,%.2f],", sensor_channels[ch].name,
+                          seconds->min[ch], seconds->mean[ch], seconds->max[ch]);
+        } else {
+            float value = g_system_state.sensors.values[ch];
+            packet_append(buffer, max_size, &len, "\"%s\":[%.2f,%.2f,%.2f],",
+                          sensor_channels[ch].name, value, value, value);
+        }
+    }
+    packet_append(buffer, max_size, &len, "\"health_score\":%.1f,\"anomalies\":{",
+                  g_system_state.anomalies.health_score);
+
+    const char* sep = "";
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (sensor_channels[ch].detectors == 0) {
+            continue;
+        }
+        packet_append(buffer, max_size, &len, "%s\"%s\":%s", sep, sensor_channels[ch].name,
+                      g_system_state.anomalies.channel_anomaly[ch] ? "true" : "false");
+        sep = ",";
+    }
+
+    // Health trend per scale and the soonest projected limit (hours and days scales)
+    const AnomalyResults_t* results = &g_system_state.anomalies;
+    packet_append(buffer, max_size, &len, "},\"trend\":{\"health_per_h\":[");
+    for (uint32_t scale = 0; scale < TREND_SCALES; scale++) {
+        packet_append(buffer, max_size, &len, "%s%.3f", scale > 0 ? "," : "",
+                      results->health_trend[scale].slope_per_h);
+    }
+    float limit_hours;
+    int limit_channel;
+    if (anomaly_results_earliest_limit(results, TREND_HOURS, &limit_hours, &limit_channel)) {
+        packet_append(buffer, max_size, &len, "],\"limit_h\":%.1f,\"limit\":\"%s\"",
+                      limit_hours,
+                      limit_channel < 0 ? "health" : sensor_channels[limit_channel].name);
+    } else {
+        packet_append(buffer, max_size, &len, "]");
+    }
+
+    packet_append(buffer, max_size, &len,
         "},"
-        "\"emergency_stop\":%s"
+        "\"emergency_stop\":%s,"
+        "\"isr_latency_us\":{\"p50\":%u,\"p99\":%u,\"max\":%u}"
         "}",
-        (unsigned int)g_system_state.sensors.timestamp,
-        g_system_state.sensors.vibration,
-        g_system_state.sensors.temperature,
-        g_system_state.sensors.rpm,
-        g_system_state.sensors.current,
-        g_system_state.anomalies.health_score,
-        g_system_state.anomalies.vibration_anomaly ? "true" : "false",
-        g_system_state.anomalies.temperature_anomaly ? "true" : "false",
-        g_system_state.anomalies.rpm_anomaly ? "true" : "false",
-        g_system_state.emergency_stop ? "true" : "false"
+        g_system_state.emergency_stop ? "true" : "false",
+        (unsigned int)g_system_state.isr_stats.latency.p50_us,
+        (unsigned int)g_system_state.isr_stats.latency.p99_us,
+        (unsigned int)g_system_state.isr_stats.latency.max_us
     );
     
-    return (uint32_t)len;
+    return len < max_size ? len : max_size - 1;
+}
+
+// Finest 1min/1h tier with a closed bucket not sent yet
+static bool rollup_pending(RollupTier_t* tier) {
+    for (uint32_t t = ROLLUP_MINUTE; t < ROLLUP_TIERS; t++) {
+        if (g_system_state.rollup.tiers[t].closed != rollup_sent[t]) {
+            *tier = (RollupTier_t)t;
+            return true;
+        }
+    }
+    return false;
 }
 
-// Simulate network transmission
-static bool transmit_packet(const char* packet, uint32_t size) {
+// One closed rollup bucket: start (s of sample time), sample count, [min,mean,max] per channel.
+// The bucket stays pending until the caller advances rollup_sent; a packet the
+// uplink refused is rebuilt. *found is false if no bucket could be read.
+static uint32_t create_rollup_packet(char* buffer, uint32_t max_size, RollupTier_t tier,
+                                     bool* found) {
+    RollupBucket_t bucket;
+    uint32_t len = 0;
+    *found = false;
+
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        g_system_state.mutex_stats.system_mutex_takes++;
+        uint32_t closed = g_system_state.rollup.tiers[tier].closed;
+        if (closed - rollup_sent[tier] > ROLLUP_RING_LENGTH) {
+            rollup_sent[tier] = closed - ROLLUP_RING_LENGTH;    // Older ones were overwritten
+        }
+        const RollupBucket_t* oldest = rollup_bucket(&g_system_state.rollup, tier,
+                                                     closed - 1 - rollup_sent[tier]);
+        if (oldest != NULL) {
+            bucket = *oldest;
+            *found = true;
+        }
+        g_system_state.mutex_stats.system_mutex_gives++;
+        PROFILED_GIVE(xSystemStateMutex);
+    } else {
+        g_system_state.mutex_stats.system_mutex_timeouts++;
+    }
+
+    if (!*found) {
+        packet_append(buffer, max_size, &len, "{\"rollup\":\"%s\"}", rollup_tier_names[tier]);
+        return len < max_size ? len : max_size - 1;
+    }
+
+    packet_append(buffer, max_size, &len, "{\"rollup\":\"%s\",\"start\":%u,\"n\":%u",
+                  rollup_tier_names[tier], (unsigned int)bucket.start_s, (unsigned int)bucket.count);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        packet_append(buffer, max_size, &len, ",\"%s\":[%.2f,%.2f,%.2f]", sensor_channels[ch].name,
+                      bucket.min[ch], bucket.mean[ch], bucket.max[ch]);
+    }
+    packet_append(buffer, max_size, &len, "}");
+
+    return len < max_size ? len : max_size - 1;
+}
+
+static uint32_t link_now_ms(void) {
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+}
+
+// Transport output: simulate network transmission of one frame
+static void link_output(void* context, const uint8_t* frame, uint32_t size) {
+    (void)context;
     network_stats.transmission_in_progress = true;
     
-    // Simulate transmission delay
-    vTaskDelay(pdMS_TO_TICKS(TRANSMISSION_TIME_MS));
+    // Simulate transmission delay, one chunk at a time; the emergency lane
+    // (higher priority, waiting on the link) takes over between chunks
+    for (uint32_t offset = 0; offset < size; offset += LINK_CHUNK_BYTES) {
+        uint32_t chunk = size - offset < LINK_CHUNK_BYTES ? size - offset : LINK_CHUNK_BYTES;
+        PROFILED_TAKE(xLinkMutex, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS((chunk + LINK_BYTES_PER_MS - 1) / LINK_BYTES_PER_MS));
+        PROFILED_GIVE(xLinkMutex);
+    }
     
-    // Simulate occasional network failures (5% failure rate)
-    bool success = (rand() % 100) >= 5;
+    network_stats.transmission_in_progress = false;
+    network_stats.last_transmission_time = xTaskGetTickCount();
     
-    if (success) {
-        network_stats.packets_sent++;
-        network_stats.bytes_sent += size;
-        
-        // Track anomaly alerts
-        if (g_system_state.anomalies.vibration_anomaly ||
-            g_system_state.anomalies.temperature_anomaly ||
-            g_system_state.anomalies.rpm_anomaly) {
-            network_stats.anomaly_alerts_sent++;
+    // The emulated link drops it or delivers it later; the transport
+    // resends what is lost
+    if (!link_emulator_send(&uplink, frame, size, link_now_ms())) {
+        network_stats.packets_failed++;
+        return;
+    }
+    network_stats.packets_sent++;
+    network_stats.bytes_sent += size;
+    
+    // Track anomaly alerts
+    if (g_system_state.anomalies.anomaly_flags != 0) {
+        network_stats.anomaly_alerts_sent++;
+    }
+}
+
+// Transport release: the frame's packet goes back to the heap
+static void link_release(void* context, uint8_t* frame, bool delivered) {
+    (void)context;
+    free_packet((PacketBuffer_t*)(frame - offsetof(PacketBuffer_t, header)));
+    if (!delivered) {
+        frame_abandoned = true;
+    }
+}
+
+// Start both directions of the emulated link from the configured profile
+static void link_init(void) {
+    LinkConfig_t config;
+    if (!link_profile(NETWORK_LINK_PROFILE, &config)) {
+        link_profile("lossy", &config);
+    }
+    config.seed = LINK_SEED;
+    link_emulator_init(&uplink, &config);
+    config.seed = LINK_SEED + 1;
+    link_emulator_init(&downlink, &config);
+}
+
+// The cloud end acknowledges every frame due off the uplink; the acks due off
+// the downlink go to the transport (which may resend). Returns the
+// milliseconds until the next frame or ack is due, LINK_EMULATOR_IDLE if none.
+static uint32_t link_service(void) {
+    static uint8_t frame[LINK_EMULATOR_MTU];
+    uint8_t ack[TRANSPORT_ACK_SIZE];
+    uint32_t now = link_now_ms();
+    uint32_t length;
+    
+    while ((length = link_emulator_receive(&uplink, now, frame, sizeof(frame))) > 0) {
+        const uint8_t* payload;
+        uint32_t payload_length;
+        uint32_t ack_length = transport_receive(&cloud_receiver, frame, length, ack,
+                                                &payload, &payload_length);
+        if (ack_length > 0) {
+            link_emulator_send(&downlink, ack, ack_length, now);
         }
+    }
+    while ((length = link_emulator_receive(&downlink, now, ack, sizeof(ack))) > 0) {
+        transport_on_ack(&transport, ack, length, now);
+    }
+    
+    now = link_now_ms();
+    uint32_t up = link_emulator_next_due(&uplink, now);
+    uint32_t down = link_emulator_next_due(&downlink, now);
+    return up < down ? up : down;
+}
+
+#if TELEMETRY_MQTT
+static const char* packet_topic(PacketType_t type) {
+    switch (type) {
+        case PACKET_TYPE_HEARTBEAT:      return MQTT_TOPIC_ROOT "heartbeat";
+        case PACKET_TYPE_ANOMALY_REPORT: return MQTT_TOPIC_ROOT "anomaly";
+        case PACKET_TYPE_ROLLUP:         return MQTT_TOPIC_ROOT "rollup";
+        case PACKET_TYPE_EXCEPTION:      return MQTT_TOPIC_ROOT "exception";
+        case PACKET_TYPE_ALERT:          return MQTT_TOPIC_ROOT "alert";
+        case PACKET_TYPE_BATCH:          return MQTT_TOPIC_ROOT "batch";
+        default:                         return MQTT_TOPIC_ROOT "sensor";
+    }
+}
+
+// Publisher output: the whole packet onto the socket. A packet cut short
+// would corrupt the broker's framing, so a failed send closes the socket at
+// once; the publisher is mid-call here, so mqtt_abort runs from link_down.
+static void mqtt_output(void* context, const uint8_t* data, uint32_t size) {
+    (void)context;
+    while (size > 0 && mqtt_socket >= 0) {
+        ssize_t n = send(mqtt_socket, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;   // The port's tick signal; nothing was written
+        }
+        if (n <= 0) {
+            close(mqtt_socket);
+            mqtt_socket = -1;
+            frame_abandoned = true;
+            return;
+        }
+        network_stats.bytes_sent += (uint32_t)n;
+        data += n;
+        size -= (uint32_t)n;
+    }
+    if (size == 0) {
+        network_stats.last_transmission_time = xTaskGetTickCount();
+    }
+}
+
+// Publisher release: acknowledged (the round trip recorded) or abandoned
+static void mqtt_release(void* context, uint8_t* buffer, bool delivered, uint32_t rtt_ms) {
+    (void)context;
+    free_packet((PacketBuffer_t*)(buffer - offsetof(PacketBuffer_t, header)));
+    if (delivered) {
+        network_stats.packets_sent++;
+        latency_histogram_record(&mqtt_rtt, rtt_ms * 1000);
     } else {
         network_stats.packets_failed++;
-        
-        // Update connection state (protected) and clear event bit
-        if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-            g_system_state.mutex_stats.system_mutex_takes++;
-            g_system_state.network_connected = false;
-            g_system_state.event_group_stats.bits_cleared_count++;
-            g_system_state.event_group_stats.current_event_bits &= ~NETWORK_CONNECTED_BIT;
-            g_system_state.mutex_stats.system_mutex_gives++;
-            xSemaphoreGive(xSystemStateMutex);
-        } else {
-            g_system_state.mutex_stats.system_mutex_timeouts++;
+        frame_abandoned = true;
+    }
+}
+
+// TCP to the broker, then CONNECT; publishing starts with the CONNACK
+static void mqtt_open(void) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(MQTT_BROKER_PORT);
+    
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return;
+    }
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return;     // No broker; the next scheduled cycle tries again
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    mqtt_socket = fd;
+    mqtt_connect(&mqtt, MQTT_CLIENT_ID, MQTT_KEEPALIVE_S, link_now_ms());
+}
+
+// Connection lost: every publish in flight and the open batch are dropped
+static void mqtt_close(void) {
+    mqtt_abort(&mqtt);
+    if (mqtt_batch.buffer != NULL) {
+        free_packet((PacketBuffer_t*)(mqtt_batch.buffer - offsetof(PacketBuffer_t, header)));
+        mqtt_batch.buffer = NULL;
+    }
+    if (mqtt_socket >= 0) {
+        close(mqtt_socket);
+        mqtt_socket = -1;
+    }
+}
+
+// Replies from the broker, then the batch if the window has room. Returns
+// the milliseconds until the socket should be checked again.
+static uint32_t mqtt_service(void) {
+    uint8_t data[256];
+    while (mqtt_socket >= 0) {
+        ssize_t n = recv(mqtt_socket, data, sizeof(data), MSG_DONTWAIT);
+        if (n > 0) {
+            mqtt_input(&mqtt, data, (uint32_t)n, link_now_ms());
+            continue;
         }
-        
-        // Clear network connected bit in event group
-        xEventGroupClearBits(xSystemReadyEvents, NETWORK_CONNECTED_BIT);
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            frame_abandoned = true;     // Broker closed the connection
+        }
+        break;
+    }
+    if (mqtt_socket >= 0 ? mqtt.parser.failed || mqtt.connack_code != 0
+                         : g_system_state.network_connected) {
+        frame_abandoned = true;     // Malformed reply, CONNECT refused or no broker
     }
     
-    network_stats.transmission_in_progress = false;
-    network_stats.last_transmission_time = xTaskGetTickCount();
+    mqtt_batch_flush(&mqtt, &mqtt_batch, packet_topic(PACKET_TYPE_BATCH), link_now_ms());
+    bool waiting = mqtt.in_flight > 0 || !mqtt.connected;
+    return mqtt_socket >= 0 && waiting ? MQTT_POLL_MS : LINK_EMULATOR_IDLE;
+}
+
+// Publish a built packet; the publisher frees it once acknowledged. While the
+// window is full, a small packet is coalesced into the batch instead. Returns
+// false if the packet was dropped.
+static bool send_packet(PacketBuffer_t* packet, uint32_t content_size) {
+    uint32_t now = link_now_ms();
+    if (mqtt_batch_flush(&mqtt, &mqtt_batch, packet_topic(PACKET_TYPE_BATCH), now) &&
+        mqtt_publish(&mqtt, packet->header, packet_topic(packet->type), content_size, 1, now)) {
+        return true;
+    }
+    if (mqtt.connected && content_size <= MQTT_COALESCE_MAX) {
+        if (mqtt_batch.buffer == NULL) {
+            PacketBuffer_t* batch = allocate_packet(PACKET_TYPE_BATCH);
+            if (batch != NULL) {
+                mqtt_batch_open(&mqtt_batch, batch->header, PACKET_BATCH_SIZE);
+            }
+        }
+        if (mqtt_batch_add(&mqtt_batch, packet->data, content_size)) {
+            free_packet(packet);
+            return true;
+        }
+    }
+    network_stats.window_stalls++;
+    free_packet(packet);
+    return false;
+}
+
+// Room for a packet of up to max_size: a free publish slot, or room in the batch
+static bool uplink_ready(uint32_t max_size) {
+    if (mqtt_can_publish(&mqtt)) {
+        return true;
+    }
+    return mqtt.connected && max_size <= MQTT_COALESCE_MAX &&
+           (mqtt_batch.buffer == NULL || mqtt_batch.length + 1 + max_size <= mqtt_batch.capacity);
+}
+#else
+// Hand a built packet to the transport, which frees it once acknowledged
+static bool send_packet(PacketBuffer_t* packet, uint32_t content_size) {
+    if (!transport_send(&transport, packet->header, content_size, link_now_ms())) {
+        free_packet(packet);    // Window full; callers check uplink_ready
+        return false;
+    }
+    return true;
+}
+
+static bool uplink_ready(uint32_t max_size) {
+    (void)max_size;
+    return transport_can_send(&transport);
+}
+#endif
+
+// A frame abandoned after every retry: the link is down. Drop what is in
+// flight; the receiver's picture is no longer known.
+static void link_down(void) {
+#if TELEMETRY_MQTT
+    mqtt_close();
+#else
+    transport_abort(&transport);
+#endif
+    frame_abandoned = false;
+#if TELEMETRY_REPORT_BY_EXCEPTION
+    exception_report_resync(&exception_reporter);
+#endif
+    
+    // Update connection state (protected) and clear event bit
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        g_system_state.mutex_stats.system_mutex_takes++;
+        g_system_state.network_connected = false;
+        g_system_state.event_group_stats.bits_cleared_count++;
+        g_system_state.event_group_stats.current_event_bits &= ~NETWORK_CONNECTED_BIT;
+        g_system_state.mutex_stats.system_mutex_gives++;
+        PROFILED_GIVE(xSystemStateMutex);
+    } else {
+        g_system_state.mutex_stats.system_mutex_timeouts++;
+    }
     
-    return success;
+    // Clear network connected bit in event group
+    xEventGroupClearBits(xSystemReadyEvents, NETWORK_CONNECTED_BIT);
 }
 
-// Simulate network reconnection
+// Simulate network reconnection (MQTT: reconnect to the broker)
 static void check_network_reconnect(void) {
     bool was_connected = false;
     bool is_connected = false;
     
     // Get current connection state (protected)
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         was_connected = g_system_state.network_connected;
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
     
     if (!was_connected) {
+#if TELEMETRY_MQTT
+        // Up once the broker has accepted the CONNECT sent on an earlier cycle
+        if (mqtt_socket < 0) {
+            mqtt_open();
+        }
+        is_connected = mqtt.connected;
+#else
         // Try to reconnect (50% chance each attempt)
-        if (rand() % 100 < 50) {
-            is_connected = true;
-            
+        is_connected = rand() % 100 < 50;
+#endif
+        if (is_connected) {
             // Update connection state (protected)
-            if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                 g_system_state.mutex_stats.system_mutex_takes++;
                 g_system_state.network_connected = true;
                 g_system_state.event_group_stats.bits_set_count++;
                 g_system_state.event_group_stats.current_event_bits |= NETWORK_CONNECTED_BIT;
                 g_system_state.mutex_stats.system_mutex_gives++;
-                xSemaphoreGive(xSystemStateMutex);
+                PROFILED_GIVE(xSystemStateMutex);
             } else {
                 g_system_state.mutex_stats.system_mutex_timeouts++;
             }
@@ -300,72 +774,307 @@ static void check_network_reconnect(void) {
     }
 }
 
+// Every closed 1min/1h bucket not sent yet, oldest first, while the window has room
+static void send_rollups(void) {
+    RollupTier_t tier;
+    while (g_system_state.network_connected && uplink_ready(PACKET_ROLLUP_SIZE) &&
+           rollup_pending(&tier)) {
+        PacketBuffer_t* packet = allocate_packet(PACKET_TYPE_ROLLUP);
+        if (packet == NULL) {
+            return;
+        }
+        bool found;
+        uint32_t content_size = create_rollup_packet(packet->data, PACKET_ROLLUP_SIZE, tier, &found);
+        if (!found) {
+            free_packet(packet);    // State mutex busy; the next cycle retries
+            return;
+        }
+        if (!send_packet(packet, content_size)) {
+            return;
+        }
+        rollup_sent[tier]++;
+    }
+}
+
+// An anomaly alert, sent as soon as it is dequeued
+static void send_alert(const AnomalyAlert_t* alert) {
+    if (!g_system_state.network_connected || !uplink_ready(PACKET_ALERT_SIZE)) {
+        return;     // The next scheduled anomaly report covers it
+    }
+    PacketBuffer_t* packet = allocate_packet(PACKET_TYPE_ALERT);
+    if (packet == NULL) {
+        return;
+    }
+    int length = snprintf(packet->data, PACKET_ALERT_SIZE,
+                          "{\"alert\":\"%s\",\"severity\":%.1f,\"tick\":%u}",
+                          alert->type < CHANNEL_COUNT ? sensor_channels[alert->type].name : "none",
+                          alert->severity, (unsigned int)alert->timestamp);
+    uint32_t content_size = length < PACKET_ALERT_SIZE ? (uint32_t)length : PACKET_ALERT_SIZE - 1;
+    send_packet(packet, content_size);
+}
+
+// The periodic packet: anomaly report, sensor data or exception report,
+// rollup or heartbeat. Returns false if a packet was due but not handed to
+// the uplink, so pending alerts are reported next cycle.
+static bool send_scheduled(uint32_t cycle_count, bool alert_pending) {
+    // Check network connection
+    if (!g_system_state.network_connected) {
+        check_network_reconnect();
+        if (!g_system_state.network_connected) {
+            return false;  // Skip transmission if not connected
+        }
+    }
+    
+    // Determine packet type based on system state and cycle (Capability 6)
+    PacketType_t packet_type;
+    RollupTier_t rollup_tier = ROLLUP_MINUTE;
+    bool rollup_found = false;
+    ReportInput_t input;
+    bool anomaly_condition = g_system_state.emergency_stop ||
+                             g_system_state.anomalies.health_score < 50.0 || alert_pending;
+#if TELEMETRY_REPORT_BY_EXCEPTION
+    // Every cycle checks the readings since the last one against the deadbands
+    uint32_t present = 0;
+    read_report_input(&input);
+    if (anomaly_condition) {
+        // Emergency or anomaly conditions require large anomaly report packet
+        packet_type = PACKET_TYPE_ANOMALY_REPORT;
+    } else if ((present = exception_report_due(&exception_reporter, &input)) != 0) {
+        // Only the fields that moved, anomaly flags as soon as they change
+        packet_type = PACKET_TYPE_EXCEPTION;
+    } else if (rollup_pending(&rollup_tier)) {
+        packet_type = PACKET_TYPE_ROLLUP;
+    } else if (input.time_s - last_sent_s >= HEARTBEAT_INTERVAL_S) {
+        // Nothing moved for a while; tell the receiver we are alive
+        packet_type = PACKET_TYPE_HEARTBEAT;
+    } else {
+        return true;  // Receiver is up to date
+    }
+#else
+    if (cycle_count % 10 == 0) {
+        // Every 10 seconds, send heartbeat packet (small)
+        packet_type = PACKET_TYPE_HEARTBEAT;
+    } else if (anomaly_condition) {
+        // Emergency or anomaly conditions require large anomaly report packet
+        packet_type = PACKET_TYPE_ANOMALY_REPORT;
+    } else if (rollup_pending(&rollup_tier)) {
+        // A 1min or 1h rollup closed; the next sensor packet still covers these seconds
+        packet_type = PACKET_TYPE_ROLLUP;
+    } else {
+        // Normal operation uses medium sensor data packet
+        packet_type = PACKET_TYPE_SENSOR_DATA;
+    }
+#endif
+    
+    // Frames still unacknowledged fill the window; wait for them (MQTT:
+    // unless this packet is small enough to join the batch)
+    if (!uplink_ready(packet_data_size(packet_type))) {
+        network_stats.window_stalls++;
+        return false;
+    }
+#if !TELEMETRY_REPORT_BY_EXCEPTION
+    if (packet_type == PACKET_TYPE_ANOMALY_REPORT || packet_type == PACKET_TYPE_SENSOR_DATA) {
+        read_report_input(&input);
+    }
+#endif
+    
+    // Allocate dynamic packet based on type
+    PacketBuffer_t* packet = allocate_packet(packet_type);
+    if (packet == NULL) {
+        return false;  // Skip this cycle if allocation failed
+    }
+    
+    // Create packet content based on type
+    uint32_t content_size;
+    if (packet_type == PACKET_TYPE_HEARTBEAT) {
+        content_size = snprintf(packet->data, PACKET_HEARTBEAT_SIZE, "{\"heartbeat\":%u}", packet->timestamp);
+    } else if (packet_type == PACKET_TYPE_ROLLUP) {
+        content_size = create_rollup_packet(packet->data, PACKET_ROLLUP_SIZE, rollup_tier,
+                                            &rollup_found);
+#if TELEMETRY_REPORT_BY_EXCEPTION
+    } else if (packet_type == PACKET_TYPE_EXCEPTION) {
+        content_size = exception_report_encode(&exception_reporter, present, &input,
+                                               packet->data, PACKET_EXCEPTION_SIZE);
+#endif
+    } else {
+        content_size = create_packet(packet->data, 
+            (packet_type == PACKET_TYPE_ANOMALY_REPORT) ? PACKET_ANOMALY_SIZE : PACKET_SENSOR_SIZE,
+            &input);
+    }
+    
+    // Transmit packet; the transport frees it once acknowledged
+    if (!send_packet(packet, content_size)) {
+        return false;
+    }
+    if (rollup_found) {
+        rollup_sent[rollup_tier]++;     // Only now is the bucket off the pending list
+    }
+#if TELEMETRY_REPORT_BY_EXCEPTION
+    last_sent_s = xTaskGetTickCount() / configTICK_RATE_HZ;
+    
+    // A full packet the reporter did not encode leaves the receiver with
+    // other values than the reporter assumes (lost reports are resent)
+    if (packet_type == PACKET_TYPE_ANOMALY_REPORT) {
+        exception_report_resync(&exception_reporter);
+    }
+#endif
+    return true;
+}
+
+// Requests from other tasks; never blocks
+bool network_command(NetworkCommand_t command) {
+    return xQueueSend(xNetworkCommandQueue, &command, 0) == pdTRUE;
+}
+
+// Blocks on one queue set (alerts, closed rollups, commands) with a timeout
+// of the next scheduled transmission or retransmission, so an alert goes out
+// as soon as it is queued and an idle link costs one wakeup per second
 void vNetworkTask(void *pvParameters) {
     (void)pvParameters;
     
-    TickType_t xLastWakeTime = xTaskGetTickCount();
     const TickType_t xFrequency = pdMS_TO_TICKS(NETWORK_SEND_RATE_MS);
+    TickType_t xNextSend = xTaskGetTickCount() + xFrequency;
     
     uint32_t cycle_count = 0;
+    uint32_t alerts_pending = 0;    // Alerts since the last scheduled packet
+    static LatencyHistogram_t alert_latency;
+    latency_histogram_init(&alert_latency);
+#if TELEMETRY_REPORT_BY_EXCEPTION
+    exception_report_init(&exception_reporter);
+#endif
+    transport_sender_init(&transport, link_output, link_release, NULL);
+    transport_receiver_init(&cloud_receiver);
+    link_init();
+#if TELEMETRY_MQTT
+    mqtt_publisher_init(&mqtt, mqtt_output, mqtt_release, NULL);
+    latency_histogram_init(&mqtt_rtt);
+#endif
     
     while (1) {
-        // Wait for the next cycle
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
-        
-        cycle_count++;
+        // Frames and acks due off the link, then resend the frames that
+        // timed out, or give up on the link
+#if TELEMETRY_MQTT
+        // MQTT: replies off the socket, then resends and keepalive
+        uint32_t link_ms = mqtt_service();
+        uint32_t retransmit_ms = mqtt_poll(&mqtt, link_now_ms());
+#else
+        uint32_t link_ms = link_service();
+        uint32_t retransmit_ms = transport_poll(&transport, link_now_ms());
+#endif
+        if (frame_abandoned) {
+            link_down();
+            retransmit_ms = TRANSPORT_NO_TIMER;
+        }
         
-        // Process anomaly alerts from queue (Capability 3)
-        AnomalyAlert_t alert;
-        int alerts_processed = 0;
-        // Process only 1 alert per cycle (1Hz) to let queue build up
-        if (xQueueReceive(xAnomalyAlertQueue, &alert, 0) == pdTRUE) {
-            alerts_processed = 1;
-            // In real system, would send alert immediately
-            // Here we just count them
-            network_stats.anomaly_alerts_sent++;
+        // Wait for the first event, the next cycle, the next retransmission
+        // or the next frame due off the link
+        TickType_t xWait = xNextSend - xTaskGetTickCount();
+        if (xWait > xFrequency) {
+            xWait = 0;      // Already due (the subtraction wrapped)
+        }
+        if (retransmit_ms != TRANSPORT_NO_TIMER && pdMS_TO_TICKS(retransmit_ms) < xWait) {
+            xWait = pdMS_TO_TICKS(retransmit_ms);
         }
+        bool link_due = false;
+        if (link_ms != LINK_EMULATOR_IDLE && pdMS_TO_TICKS(link_ms) < xWait) {
+            xWait = pdMS_TO_TICKS(link_ms);
+            link_due = true;
+        }
+        QueueSetMemberHandle_t xMember = xQueueSelectFromSet(xNetworkQueueSet, xWait);
         
-        // Check network connection
-        if (!g_system_state.network_connected) {
-            check_network_reconnect();
-            if (!g_system_state.network_connected) {
-                continue;  // Skip transmission if not connected
+        // The set holds one event per item, so each receive below succeeds
+        NetworkWakeStats_t wake = {0};
+        bool scheduled = false;
+        if (xMember == xAnomalyAlertQueue) {
+            // Process anomaly alerts from queue (Capability 3)
+            AnomalyAlert_t alert;
+            xQueueReceive(xAnomalyAlertQueue, &alert, 0);
+            latency_histogram_record(&alert_latency,
+                                     (uint32_t)ulGetRunTimeCounterValue() - alert.raised_us);
+            network_stats.anomaly_alerts_sent++;
+            alerts_pending++;
+            wake.alerts = 1;
+            send_alert(&alert);
+        } else if (xMember == xTelemetryReadySemaphore) {
+            xSemaphoreTake(xTelemetryReadySemaphore, 0);
+            wake.telemetry = 1;
+            send_rollups();
+        } else if (xMember == xNetworkCommandQueue) {
+            NetworkCommand_t command;
+            xQueueReceive(xNetworkCommandQueue, &command, 0);
+            wake.commands = 1;
+            if (command == NETWORK_CMD_SEND_NOW) {
+                scheduled = true;
+                xNextSend = xTaskGetTickCount();
             }
+#if TELEMETRY_REPORT_BY_EXCEPTION
+            if (command == NETWORK_CMD_RESYNC) {
+                exception_report_resync(&exception_reporter);
+            }
+#endif
+        } else {
+            // Timed out: the scheduled transmission, a retransmission or a
+            // frame off the link is due
+            TickType_t xEarly = xNextSend - xTaskGetTickCount();
+            scheduled = xEarly == 0 || xEarly > xFrequency;
+            wake.scheduled = scheduled ? 1 : 0;
+            wake.link = !scheduled && link_due ? 1 : 0;
+            wake.retransmit = !scheduled && !link_due ? 1 : 0;
         }
         
-        // Determine packet type based on system state and cycle (Capability 6)
-        PacketType_t packet_type;
-        if (cycle_count % 10 == 0) {
-            // Every 10 seconds, send heartbeat packet (small)
-            packet_type = PACKET_TYPE_HEARTBEAT;
-        } else if (g_system_state.emergency_stop || g_system_state.anomalies.health_score < 50.0 || alerts_processed > 0) {
-            // Emergency or anomaly conditions require large anomaly report packet
-            packet_type = PACKET_TYPE_ANOMALY_REPORT;
+        // Update wake statistics (protected)
+        latency_histogram_summary(&alert_latency, &wake.alert_latency);
+#if TELEMETRY_MQTT
+        LatencySummary_t mqtt_rtt_summary;
+        latency_histogram_summary(&mqtt_rtt, &mqtt_rtt_summary);
+#endif
+        if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            g_system_state.mutex_stats.system_mutex_takes++;
+            NetworkWakeStats_t* wakes = &g_system_state.network_wakes;
+            wakes->scheduled += wake.scheduled;
+            wakes->alerts += wake.alerts;
+            wakes->telemetry += wake.telemetry;
+            wakes->commands += wake.commands;
+            wakes->retransmit += wake.retransmit;
+            wakes->link += wake.link;
+            wakes->alert_latency = wake.alert_latency;
+            g_system_state.transport.stats = transport.stats;
+            g_system_state.transport.in_flight = transport_in_flight(&transport);
+            g_system_state.transport.srtt_ms = (uint32_t)transport.srtt_ms;
+            g_system_state.transport.rto_ms = transport.rto_ms;
+            g_system_state.transport.window_stalls = network_stats.window_stalls;
+            g_system_state.transport.uplink = uplink.stats;
+#if TELEMETRY_MQTT
+            g_system_state.mqtt.stats = mqtt.stats;
+            g_system_state.mqtt.in_flight = mqtt.in_flight;
+            g_system_state.mqtt.connected = mqtt.connected;
+            g_system_state.mqtt.acked_per_s = mqtt_acked_per_s;
+            g_system_state.mqtt.rtt = mqtt_rtt_summary;
+#endif
+            g_system_state.mutex_stats.system_mutex_gives++;
+            PROFILED_GIVE(xSystemStateMutex);
         } else {
-            // Normal operation uses medium sensor data packet
-            packet_type = PACKET_TYPE_SENSOR_DATA;
+            g_system_state.mutex_stats.system_mutex_timeouts++;
         }
         
-        // Allocate dynamic packet based on type
-        PacketBuffer_t* packet = allocate_packet(packet_type);
-        if (packet == NULL) {
-            continue;  // Skip this cycle if allocation failed
+        if (!scheduled) {
+            continue;
         }
         
-        // Create packet content based on type
-        uint32_t content_size;
-        if (packet_type == PACKET_TYPE_HEARTBEAT) {
-            content_size = snprintf(packet->data, PACKET_HEARTBEAT_SIZE, "{\"heartbeat\":%u}", packet->timestamp);
-        } else {
-            content_size = create_packet(packet->data, 
-                (packet_type == PACKET_TYPE_ANOMALY_REPORT) ? PACKET_ANOMALY_SIZE : PACKET_SENSOR_SIZE);
+        // Next deadline a period on, without drift; a late cycle does not burst
+        xNextSend += xFrequency;
+        if ((TickType_t)(xNextSend - xTaskGetTickCount()) > xFrequency) {
+            xNextSend = xTaskGetTickCount() + xFrequency;
         }
         
-        // Transmit packet and free memory
-        bool success = transmit_packet(packet->data, content_size);
-        
-        // Free the dynamically allocated packet
-        free_packet(packet);
+        cycle_count++;
+#if TELEMETRY_MQTT
+        mqtt_acked_per_s = mqtt.stats.acked - mqtt_acked_last_cycle;
+        mqtt_acked_last_cycle = mqtt.stats.acked;
+#endif
+        if (send_scheduled(cycle_count, alerts_pending > 0)) {
+            alerts_pending = 0;     // Otherwise the next anomaly report covers them
+        }
         
         // Priority transmission for critical events  
         bool priority_transmission = false;
@@ -394,3 +1103,193 @@ void vNetworkTask(void *pvParameters) {
         }
     }
 }
+
+// Queue an emergency stop or critical alert for the emergency lane. Never
+// blocks and takes no mutex, so callers may hold the system state mutex.
+bool emergency_lane_raise(EmergencyReason_t reason, uint32_t channel, float value) {
+    EmergencyEvent_t event = {
+        .reason = reason,
+        .channel = channel,
+        .value = value,
+        .raised_us = (uint32_t)ulGetRunTimeCounterValue(),
+    };
+    if (xQueueSend(xEmergencyQueue, &event, 0) != pdTRUE) {
+        taskENTER_CRITICAL();
+        emergency_dropped++;
+        taskEXIT_CRITICAL();
+        return false;
+    }
+    return true;
+}
+
+static void emergency_put_id(uint8_t* out, uint32_t id) {
+    for (uint32_t i = 0; i < EMERGENCY_ID_SIZE; i++) {
+        out[i] = (uint8_t)(id >> (8 * i));
+    }
+}
+
+static uint32_t emergency_get_id(const uint8_t* in) {
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < EMERGENCY_ID_SIZE; i++) {
+        id |= (uint32_t)in[i] << (8 * i);
+    }
+    return id;
+}
+
+// The simulated cloud end acks every emergency frame due off the path; the
+// lane reads the acks due back. Returns true once the ack for id is in, and
+// sets *wait_ms to the time until the next frame or ack is due.
+static bool emergency_service(uint32_t id, uint32_t* wait_ms) {
+    uint8_t frame[EMERGENCY_ID_SIZE + EMERGENCY_PACKET_SIZE];
+    uint32_t now = link_now_ms();
+    uint32_t length;
+    bool acked = false;
+    
+    while ((length = link_emulator_receive(&emergency_link, now, frame, sizeof(frame))) > 0) {
+        if (length < EMERGENCY_ID_SIZE) {
+            continue;
+        }
+        uint32_t received = emergency_get_id(frame);
+        if ((int32_t)(received - emergency_cloud_id) > 0) {
+            // First copy of this event off the link: it is delivered now
+            emergency_cloud_id = received;
+            emergency_delivered_us = (uint32_t)ulGetRunTimeCounterValue();
+        }
+        link_emulator_send(&emergency_ack_link, frame, EMERGENCY_ID_SIZE, now);
+    }
+    while ((length = link_emulator_receive(&emergency_ack_link, now, frame, sizeof(frame))) > 0) {
+        if (length == EMERGENCY_ID_SIZE && emergency_get_id(frame) == id) {
+            acked = true;   // Acks of earlier events or attempts are ignored
+        }
+    }
+    
+    uint32_t up = link_emulator_next_due(&emergency_link, now);
+    uint32_t down = link_emulator_next_due(&emergency_ack_link, now);
+    *wait_ms = up < down ? up : down;
+    return acked;
+}
+
+// Wait with the link free for the ack of id, up to the ack timeout
+static bool emergency_wait_ack(uint32_t id) {
+    const TickType_t timeout = pdMS_TO_TICKS(emergency_ack_timeout_ms);
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        uint32_t wait_ms;
+        if (emergency_service(id, &wait_ms)) {
+            return true;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            return false;
+        }
+        TickType_t wait = timeout - elapsed;
+        if (wait_ms != LINK_EMULATOR_IDLE && pdMS_TO_TICKS(wait_ms) < wait) {
+            wait = pdMS_TO_TICKS(wait_ms);
+        }
+        vTaskDelay(wait > 0 ? wait : 1);
+    }
+}
+
+// Emergency lane: blocks on xEmergencyQueue, so an event wakes it at once and,
+// being above every task but safety, it runs as soon as it is raised. It
+// skips telemetry batching and holds the link for its whole (small) packet,
+// then waits for the ack with the link free.
+void vEmergencyLaneTask(void *pvParameters) {
+    (void)pvParameters;
+    
+    static LatencyHistogram_t wire_latency;
+    latency_histogram_init(&wire_latency);
+    
+    LinkConfig_t config;
+    if (!link_profile(NETWORK_LINK_PROFILE, &config)) {
+        link_profile("lossy", &config);
+    }
+    config.seed = LINK_SEED + 2;
+    link_emulator_init(&emergency_link, &config);
+    config.seed = LINK_SEED + 3;
+    link_emulator_init(&emergency_ack_link, &config);
+    emergency_ack_timeout_ms = 2 * (config.delay_ms + 2 * config.jitter_ms) + EMERGENCY_ACK_SLACK_MS;
+    
+    while (1) {
+        EmergencyEvent_t event;
+        if (xQueueReceive(xEmergencyQueue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        
+        uint8_t frame[EMERGENCY_ID_SIZE + EMERGENCY_PACKET_SIZE];
+        char* packet = (char*)frame + EMERGENCY_ID_SIZE;
+        uint32_t id = ++emergency_id;
+        emergency_put_id(frame, id);
+        int length = snprintf(packet, EMERGENCY_PACKET_SIZE,
+                              "{\"emergency\":\"%s\",\"channel\":\"%s\",\"value\":%.2f,\"tick\":%u}",
+                              event.reason == EMERGENCY_STOP ? "stop" : "critical",
+                              event.channel < CHANNEL_COUNT ? sensor_channels[event.channel].name : "none",
+                              event.value, (unsigned int)xTaskGetTickCount());
+        uint32_t size = EMERGENCY_ID_SIZE +
+                        (length < EMERGENCY_PACKET_SIZE ? (uint32_t)length : EMERGENCY_PACKET_SIZE - 1);
+        
+        bool preempted_bulk = network_stats.transmission_in_progress;
+        uint32_t latency_us = 0;
+        uint32_t resent = 0;
+        TickType_t first_try = xTaskGetTickCount();
+        uint32_t backoff_ms = EMERGENCY_BACKOFF_MS;
+        bool deferred = false;
+        
+        // A missing ack is all the lane learns of a loss. Immediate resends
+        // cover loss; an outage outlasts them, so the event is kept and
+        // retried with backoff until it is acknowledged or the deadline passes.
+        bool success = false;
+        while (1) {
+            for (uint32_t attempt = 0; attempt <= EMERGENCY_RETRIES && !success; attempt++) {
+                // Owning the link: a bulk packet in flight yields it at its next chunk
+                PROFILED_TAKE(xLinkMutex, portMAX_DELAY);
+                vTaskDelay(pdMS_TO_TICKS((size + LINK_BYTES_PER_MS - 1) / LINK_BYTES_PER_MS));
+                link_emulator_send(&emergency_link, frame, size, link_now_ms());
+                PROFILED_GIVE(xLinkMutex);
+                resent += attempt > 0 || deferred ? 1 : 0;
+                success = emergency_wait_ack(id);
+            }
+            if (success) {
+                // Off the link at the cloud end, however long the outage
+                // held it; the ack proves it got there
+                latency_us = emergency_delivered_us - event.raised_us;
+            }
+            if (success || xTaskGetTickCount() - first_try >= pdMS_TO_TICKS(EMERGENCY_DEADLINE_MS)) {
+                break;
+            }
+            deferred = true;
+            vTaskDelay(pdMS_TO_TICKS(backoff_ms));
+            backoff_ms = backoff_ms * 2 < EMERGENCY_BACKOFF_MAX_MS ? backoff_ms * 2 : EMERGENCY_BACKOFF_MAX_MS;
+        }
+        
+        // The receiver's picture after an emergency should be complete
+        network_command(NETWORK_CMD_RESYNC);
+        
+        // A failed event was never delivered; it counts as failed, not as fast
+        if (success) {
+            latency_histogram_record(&wire_latency, latency_us);
+        }
+        LatencySummary_t summary;
+        latency_histogram_summary(&wire_latency, &summary);
+        
+        if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            g_system_state.mutex_stats.system_mutex_takes++;
+            EmergencyLaneStats_t* lane = &g_system_state.emergency_lane;
+            lane->raised++;
+            lane->dropped = emergency_dropped;
+            lane->sent += success ? 1 : 0;
+            lane->resent += resent;
+            lane->failed += success ? 0 : 1;
+            lane->deferred += deferred && success ? 1 : 0;
+            lane->bulk_preemptions += preempted_bulk ? 1 : 0;
+            if (success) {
+                lane->last_latency_us = latency_us;
+            }
+            lane->latency = summary;
+            g_system_state.mutex_stats.system_mutex_gives++;
+            PROFILED_GIVE(xSystemStateMutex);
+        } else {
+            g_system_state.mutex_stats.system_mutex_timeouts++;
+        }
+    }
+}
@@ -11,6 +11,7 @@
 #include "semphr.h"
 #include "event_groups.h"
 #include "../common/system_state.h"
+#include "../common/lock_profiler.h"
 
 // Safety parameters
 #define SAFETY_CHECK_RATE_MS    20   // 50Hz for critical monitoring
@@ -32,10 +33,8 @@ extern void record_preemption(const char* preemptor, const char* preempted, cons
 
 // Safety state
 typedef struct {
-    bool vibration_alarm;
-    bool temperature_alarm;
-    bool rpm_alarm;
-    bool current_alarm;
+    bool alarm[CHANNEL_COUNT];      // Per channel, outside its critical limits
+    SensorData_t sensors;           // Readings of the latest check
     TickType_t emergency_stop_time;
     uint32_t alarm_count;
 } SafetyState_t;
@@ -47,78 +46,44 @@ static bool check_critical_conditions(void) {
     bool critical = false;
     
     // Get sensor values and thresholds (protected)
-    float vib = 0, temp = 0, rpm = 0, current = 0;
-    float vib_crit = 10.0, temp_crit = 85.0, rpm_min = 10.0, rpm_max = 30.0, current_max = 100.0;
+    SensorData_t sensors = {0};
+    ThresholdConfig_t limits;
+    threshold_config_defaults(&limits);
     
     // Get sensor data (protected)
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
-        vib = g_system_state.sensors.vibration;
-        temp = g_system_state.sensors.temperature;
-        rpm = g_system_state.sensors.rpm;
-        current = g_system_state.sensors.current;
+        sensors = g_system_state.sensors;
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
     
     // Get threshold values (protected)
-    if (xSemaphoreTake(xThresholdsMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xThresholdsMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.threshold_mutex_takes++;
-        vib_crit = g_thresholds.vibration_critical;
-        temp_crit = g_thresholds.temperature_critical;
-        rpm_min = g_thresholds.rpm_min;
-        rpm_max = g_thresholds.rpm_max;
-        current_max = g_thresholds.current_max;
+        limits = g_thresholds;
         g_system_state.mutex_stats.threshold_mutex_gives++;
-        xSemaphoreGive(xThresholdsMutex);
+        PROFILED_GIVE(xThresholdsMutex);
     } else {
         g_system_state.mutex_stats.threshold_mutex_timeouts++;
     }
     
-    // Check vibration
-    if (vib > vib_crit) {
-        if (!safety_state.vibration_alarm) {
-            safety_state.vibration_alarm = true;
-            safety_state.alarm_count++;
-            critical = true;
-        }
-    } else {
-        safety_state.vibration_alarm = false;
-    }
-    
-    // Check temperature
-    if (temp > temp_crit) {
-        if (!safety_state.temperature_alarm) {
-            safety_state.temperature_alarm = true;
-            safety_state.alarm_count++;
-            critical = true;
-        }
-    } else {
-        safety_state.temperature_alarm = false;
-    }
-    
-    // Check RPM
-    if (rpm < rpm_min || rpm > rpm_max) {
-        if (!safety_state.rpm_alarm) {
-            safety_state.rpm_alarm = true;
-            safety_state.alarm_count++;
-            critical = true;
-        }
-    } else {
-        safety_state.rpm_alarm = false;
-    }
+    safety_state.sensors = sensors;
     
-    // Check current
-    if (current > current_max) {
-        if (!safety_state.current_alarm) {
-            safety_state.current_alarm = true;
-            safety_state.alarm_count++;
-            critical = true;
+    // Check every channel against its critical limits
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        const ChannelLimits_t* lim = &limits.channels[ch];
+        if (channel_outside(sensors.values[ch], lim->critical_low, lim->critical_high)) {
+            if (!safety_state.alarm[ch]) {
+                safety_state.alarm[ch] = true;
+                safety_state.alarm_count++;
+                critical = true;
+            }
+        } else {
+            safety_state.alarm[ch] = false;
         }
-    } else {
-        safety_state.current_alarm = false;
     }
     
     return critical;
@@ -126,16 +91,26 @@ static bool check_critical_conditions(void) {
 
 // Trigger emergency stop
 static void trigger_emergency_stop(void) {
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    bool was_stopped = false;   // Unreadable state: report the stop rather than lose it
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
+        was_stopped = g_system_state.emergency_stop;
         g_system_state.emergency_stop = true;
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
     safety_state.emergency_stop_time = xTaskGetTickCount();
     
+    // A new stop goes straight to the emergency lane, naming the first alarm
+    if (!was_stopped) {
+        uint32_t ch = 0;
+        while (ch < CHANNEL_COUNT && !safety_state.alarm[ch]) ch++;
+        emergency_lane_raise(EMERGENCY_STOP, ch,
+                             ch < CHANNEL_COUNT ? safety_state.sensors.values[ch] : 0.0f);
+    }
+    
     // Record this critical event
     record_preemption("SafetyTask", "ALL", "EMERGENCY");
 }
@@ -143,11 +118,11 @@ static void trigger_emergency_stop(void) {
 // Clear emergency stop after timeout
 static void check_emergency_clear(void) {
     bool emergency = false;
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         emergency = g_system_state.emergency_stop;
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
@@ -157,14 +132,16 @@ static void check_emergency_clear(void) {
         if (elapsed > pdMS_TO_TICKS(EMERGENCY_STOP_DURATION)) {
             // Clear emergency stop if conditions are safe
             if (!check_critical_conditions()) {
-                if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+                if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                     g_system_state.mutex_stats.system_mutex_takes++;
                     g_system_state.emergency_stop = false;
                     g_system_state.mutex_stats.system_mutex_gives++;
-                    xSemaphoreGive(xSystemStateMutex);
+                    PROFILED_GIVE(xSystemStateMutex);
                 } else {
                     g_system_state.mutex_stats.system_mutex_timeouts++;
                 }
+                // Report the recovery now rather than at the next scheduled send
+                network_command(NETWORK_CMD_SEND_NOW);
             }
         }
     }
@@ -191,12 +168,12 @@ void vSafetyTask(void *pvParameters) {
     );
     
     // Update event group statistics (protected)
-    if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
         g_system_state.mutex_stats.system_mutex_takes++;
         g_system_state.event_group_stats.wait_operations++;
         g_system_state.event_group_stats.system_ready_time = xTaskGetTickCount();
         g_system_state.mutex_stats.system_mutex_gives++;
-        xSemaphoreGive(xSystemStateMutex);
+        PROFILED_GIVE(xSystemStateMutex);
     } else {
         g_system_state.mutex_stats.system_mutex_timeouts++;
     }
@@ -219,10 +196,9 @@ void vSafetyTask(void *pvParameters) {
         if (critical) {
             // Multiple alarms = emergency stop
             uint32_t active_alarms = 0;
-            if (safety_state.vibration_alarm) active_alarms++;
-            if (safety_state.temperature_alarm) active_alarms++;
-            if (safety_state.rpm_alarm) active_alarms++;
-            if (safety_state.current_alarm) active_alarms++;
+            for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+                if (safety_state.alarm[ch]) active_alarms++;
+            }
             
             if (active_alarms >= 2) {
                 trigger_emergency_stop();
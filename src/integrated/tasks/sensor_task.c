@@ -1,7 +1,8 @@
 /**
  * Sensor Task - Simulates reading data from wind turbine sensors
  * Priority: 4 (High)
- * Frequency: 10Hz
+ * Frequency: 10Hz analysis rate; channels acquired at their own rates
+ * (vibration 1kHz in ISR blocks, decimated to 10Hz)
  */
 
 #include <stdio.h>
@@ -12,10 +13,14 @@
 #include "queue.h"
 #include "semphr.h"
 #include "event_groups.h"
+#include "stream_buffer.h"
 #include "../common/system_state.h"
+#include "../common/lock_profiler.h"
+#include "multirate.h"
 
 // Sensor simulation parameters
 #define SENSOR_READ_RATE_MS     100  // 10Hz
+#define SENSOR_ANALYSIS_RATE_HZ (1000 / SENSOR_READ_RATE_MS)
 #define VIBRATION_NOISE         0.5
 #define TEMPERATURE_DRIFT       0.1
 #define RPM_VARIATION          0.5
@@ -24,8 +29,11 @@
 extern SystemState_t g_system_state;
 extern QueueHandle_t xSensorISRQueue;
 extern QueueHandle_t xSensorDataQueue;  // Capability 3: Queue communication
+extern StreamBufferHandle_t xVibrationStream;  // Raw vibration for envelope analysis
 extern SemaphoreHandle_t xSystemStateMutex;  // Capability 4: Mutex protection
+extern SemaphoreHandle_t xTelemetryReadySemaphore;  // A rollup closed, wakes the network task
 extern EventGroupHandle_t xSystemReadyEvents;  // Capability 5: Event groups
+extern unsigned long ulGetRunTimeCounterValue(void);  // Microsecond run-time counter (main.c)
 
 // Event bits (defined in main.c)
 #define SENSORS_CALIBRATED_BIT  (1 << 0)  // 0x01 - SensorTask ready
@@ -60,6 +68,16 @@ void vSensorTask(void *pvParameters) {
     
     uint32_t cycle_count = 0;
     bool sensors_calibrated = false;
+    // The checkpoint carries calibration over from the last run (read in main)
+    uint32_t calibration_cycles = g_system_state.checkpoint.sensors_calibrated ? 1 : 20;
+    
+    // ISR-to-task latency distribution (owned by this task, summary published)
+    static LatencyHistogram_t isr_latency;
+    latency_histogram_init(&isr_latency);
+    
+    // Per-channel acquisition schedule and decimators (rates from the channel table)
+    static MultiRate_t acquisition;
+    configASSERT(multirate_init(&acquisition, SENSOR_ANALYSIS_RATE_HZ));
     
     while (1) {
         // Wait for the next cycle
@@ -67,100 +85,155 @@ void vSensorTask(void *pvParameters) {
         
         cycle_count++;
         
-        // Check if sensors are calibrated (after 20 readings) - Capability 5
-        if (!sensors_calibrated && cycle_count >= 20) {
+        // Check if sensors are calibrated (after 20 readings, 1 on a warm start) - Capability 5
+        if (!sensors_calibrated && cycle_count >= calibration_cycles) {
             sensors_calibrated = true;
             // Set the sensors calibrated bit in event group
             xEventGroupSetBits(xSystemReadyEvents, SENSORS_CALIBRATED_BIT);
             
             // Update statistics (protected)
-            if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                 g_system_state.mutex_stats.system_mutex_takes++;
                 g_system_state.event_group_stats.bits_set_count++;
                 g_system_state.event_group_stats.current_event_bits |= SENSORS_CALIBRATED_BIT;
                 g_system_state.mutex_stats.system_mutex_gives++;
-                xSemaphoreGive(xSystemStateMutex);
+                PROFILED_GIVE(xSystemStateMutex);
             } else {
                 g_system_state.mutex_stats.system_mutex_timeouts++;
             }
         }
         
+        // Channels due this period (vibration arrives in ISR blocks regardless)
+        uint32_t due[CHANNEL_COUNT];
+        multirate_begin_period(&acquisition, due);
+        
         // Process ALL ISR data in queue (Capability 2: Deferred Processing)
         SensorISRData_t isr_data;
         int items_processed = 0;
-        TickType_t min_latency = UINT32_MAX;
+        uint32_t dropped_samples = 0;
+        uint32_t latency_us = 0;
         
         // Process all available items to prevent queue buildup
         while (xQueueReceive(xSensorISRQueue, &isr_data, 0) == pdTRUE) {
             items_processed++;
             
-            // Calculate ISR latency for this item
-            TickType_t latency_ticks = xTaskGetTickCount() - isr_data.timestamp;
-            if (latency_ticks < min_latency) {
-                min_latency = latency_ticks;
-            }
+            // ISR-to-task latency for this item (unsigned math handles counter wrap)
+            latency_us = (uint32_t)ulGetRunTimeCounterValue() - isr_data.isr_time_us;
+            latency_histogram_record(&isr_latency, latency_us);
+            
+            // Decimate the 1kHz vibration block toward the analysis rate
+            multirate_push(&acquisition, CHANNEL_VIBRATION, isr_data.vibration, VIBRATION_BLOCK_SAMPLES);
             
-            // Use the latest ISR vibration data
-            base_vibration = isr_data.vibration;
+            // Forward the raw block to the anomaly task's envelope stage (never block)
+            size_t sent = xStreamBufferSend(xVibrationStream, isr_data.vibration,
+                                            sizeof(isr_data.vibration), 0);
+            dropped_samples += (uint32_t)((sizeof(isr_data.vibration) - sent) / sizeof(float));
             
-            // Check for emergency condition (protected)
-            if (isr_data.vibration > 80.0) {
-                if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            // Check for emergency condition on the raw samples (protected)
+            float block_peak = 0.0f;
+            for (uint32_t i = 0; i < VIBRATION_BLOCK_SAMPLES; i++) {
+                if (isr_data.vibration[i] > block_peak) block_peak = isr_data.vibration[i];
+            }
+            if (block_peak > 80.0) {
+                bool was_stopped = true;
+                if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                     g_system_state.mutex_stats.system_mutex_takes++;
+                    was_stopped = g_system_state.emergency_stop;
                     g_system_state.emergency_stop = true;
                     g_system_state.mutex_stats.system_mutex_gives++;
-                    xSemaphoreGive(xSystemStateMutex);
+                    PROFILED_GIVE(xSystemStateMutex);
                 } else {
                     g_system_state.mutex_stats.system_mutex_timeouts++;
                 }
+                if (!was_stopped) {
+                    emergency_lane_raise(EMERGENCY_STOP, CHANNEL_VIBRATION, block_peak);
+                }
             }
             
             // Update ISR stats (protected)
-            if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                 g_system_state.mutex_stats.system_mutex_takes++;
                 g_system_state.isr_stats.processed_count++;
                 g_system_state.mutex_stats.system_mutex_gives++;
-                xSemaphoreGive(xSystemStateMutex);
+                PROFILED_GIVE(xSystemStateMutex);
             } else {
                 g_system_state.mutex_stats.system_mutex_timeouts++;
             }
         }
         
-        // Update latency metric with best case (minimum latency seen)
+        // Publish the latest latency and the distribution since boot
         if (items_processed > 0) {
-            // Realistic latency: typically under 1ms in simulation
-            if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            LatencySummary_t latency_summary;
+            latency_histogram_summary(&isr_latency, &latency_summary);
+            
+            if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
                 g_system_state.mutex_stats.system_mutex_takes++;
-                if (min_latency <= 1) {
-                    g_system_state.isr_stats.last_latency_us = 250;  // 250µs typical
-                } else {
-                    g_system_state.isr_stats.last_latency_us = min_latency * 1000;  // Convert ms to µs
-                }
+                g_system_state.isr_stats.last_latency_us = latency_us;
+                g_system_state.isr_stats.latency = latency_summary;
+                g_system_state.envelope.dropped_samples += dropped_samples;
                 g_system_state.mutex_stats.system_mutex_gives++;
-                xSemaphoreGive(xSystemStateMutex);
+                PROFILED_GIVE(xSystemStateMutex);
             } else {
                 g_system_state.mutex_stats.system_mutex_timeouts++;
             }
         }
         
-        // Update sensor readings (ISR provides vibration, others simulated)
+        // Read the slow channels that are due (ISR provides vibration, others simulated)
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            if (ch == CHANNEL_VIBRATION) {
+                continue;
+            }
+            for (uint32_t n = 0; n < due[ch]; n++) {
+                float sample;
+                switch (ch) {
+                    case CHANNEL_TEMPERATURE:
+                        sample = read_sensor_with_noise(base_temperature, TEMPERATURE_DRIFT);
+                        break;
+                    case CHANNEL_RPM:
+                        sample = read_sensor_with_noise(base_rpm, RPM_VARIATION);
+                        break;
+                    case CHANNEL_CURRENT:
+                        sample = read_sensor_with_noise(base_current, 2.0);
+                        break;
+                    default:
+                        // Channels added to the table without a model read nominal plus noise
+                        sample = read_sensor_with_noise(sensor_channels[ch].nominal,
+                                                        sensor_channels[ch].full_scale * 0.002f);
+                        break;
+                }
+                multirate_push(&acquisition, ch, &sample, 1);
+            }
+        }
+        
+        // Analysis-rate snapshot: decimated fast channels, latest (held) slow channels
         SensorData_t current_reading;
-        current_reading.vibration = base_vibration;
-        current_reading.temperature = read_sensor_with_noise(base_temperature, TEMPERATURE_DRIFT);
-        current_reading.rpm = read_sensor_with_noise(base_rpm, RPM_VARIATION);
-        current_reading.current = read_sensor_with_noise(base_current, 2.0);
+        multirate_output(&acquisition, &current_reading);
         current_reading.timestamp = xTaskGetTickCount();
+        base_vibration = current_reading.vibration;
         
         // Update global state for dashboard display (protected)
-        if (xSemaphoreTake(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        bool telemetry_ready = false;
+        if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
             g_system_state.mutex_stats.system_mutex_takes++;
             g_system_state.sensors = current_reading;
+            uint32_t closed = g_system_state.rollup.tiers[ROLLUP_MINUTE].closed;
+            rollup_add(&g_system_state.rollup, &current_reading);
+            for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+                history_add(&g_system_state.history[ch], current_reading.values[ch],
+                            current_reading.timestamp * portTICK_PERIOD_MS);
+            }
+            telemetry_ready = g_system_state.rollup.tiers[ROLLUP_MINUTE].closed != closed;
             g_system_state.mutex_stats.system_mutex_gives++;
-            xSemaphoreGive(xSystemStateMutex);
+            PROFILED_GIVE(xSystemStateMutex);
         } else {
             g_system_state.mutex_stats.system_mutex_timeouts++;
         }
         
+        // A closed minute (and any hour closing with it) goes out without waiting
+        if (telemetry_ready) {
+            xSemaphoreGive(xTelemetryReadySemaphore);
+        }
+        
         // Send sensor data via queue (Capability 3)
         if (xQueueSend(xSensorDataQueue, &current_reading, pdMS_TO_TICKS(10)) != pdTRUE) {
             // Queue full - data dropped (could track this)
@@ -0,0 +1,79 @@
+/**
+ * Stats Task - Task statistics sampling, independent of the dashboard
+ * Priority: 2 (Low)
+ * Frequency: STATS_SAMPLE_MS (1Hz by default)
+ */
+
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "../common/system_state.h"
+#include "../common/lock_profiler.h"
+#include "../common/metrics_export.h"
+
+// External references
+extern SystemState_t g_system_state;
+extern SemaphoreHandle_t xSystemStateMutex;
+extern unsigned long ulGetRunTimeCounterValue(void);  // Microsecond run-time counter (main.c)
+
+// Filled by the kernel with the scheduler suspended; static to keep it off
+// the task stack
+static TaskStatus_t task_status[MAX_TASKS_TRACKED];
+
+void vStatsTask(void *pvParameters) {
+    (void)pvParameters;
+
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    const TickType_t xFrequency = pdMS_TO_TICKS(STATS_SAMPLE_MS);
+
+    uint32_t samples = 0;
+    uint32_t failed = 0;
+    uint32_t max_suspended_us = 0;
+    uint64_t total_suspended_us = 0;
+
+    while (1) {
+        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+
+        // uxTaskGetSystemState suspends the scheduler for the whole copy; time
+        // just that, since it delays every task that becomes ready meanwhile
+        uint32_t total_runtime;
+        uint32_t start_us = (uint32_t)ulGetRunTimeCounterValue();
+        UBaseType_t count = uxTaskGetSystemState(task_status, MAX_TASKS_TRACKED, &total_runtime);
+        uint32_t suspended_us = (uint32_t)ulGetRunTimeCounterValue() - start_us;
+
+        samples++;
+        total_suspended_us += suspended_us;
+        if (suspended_us > max_suspended_us) {
+            max_suspended_us = suspended_us;
+        }
+        if (count == 0) {
+            failed++;   // More tasks than MAX_TASKS_TRACKED: nothing was copied
+        }
+
+        // Publish the sample (protected); readers never call into the kernel
+        if (PROFILED_TAKE(xSystemStateMutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+            g_system_state.mutex_stats.system_mutex_takes++;
+            if (count > 0) {
+                update_task_stats(task_status, count, total_runtime);
+            }
+            g_system_state.uptime_seconds = xTaskGetTickCount() / configTICK_RATE_HZ;
+
+            StatsSamplerStatus_t* sampler = &g_system_state.sampler;
+            sampler->period_ms = STATS_SAMPLE_MS;
+            sampler->samples = samples;
+            sampler->failed = failed;
+            sampler->last_suspended_us = suspended_us;
+            sampler->mean_suspended_us = (uint32_t)(total_suspended_us / samples);
+            sampler->max_suspended_us = max_suspended_us;
+            sampler->last_sample_us = (uint32_t)ulGetRunTimeCounterValue() - start_us;
+            g_system_state.mutex_stats.system_mutex_gives++;
+            PROFILED_GIVE(xSystemStateMutex);
+        } else {
+            g_system_state.mutex_stats.system_mutex_timeouts++;
+        }
+
+        // External observers read the shared-memory snapshot of this sample
+        metrics_export_publish();
+    }
+}
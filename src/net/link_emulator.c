@@ -0,0 +1,241 @@
+/**
+ * Link Emulator - Seeded burst loss, bandwidth, latency and outages for one link direction
+ */
+
+#include <math.h>
+#include <string.h>
+#include "link_emulator.h"
+
+#define JITTER_TAIL_CAP     8.0f    // Exponential jitter is cut at this many means
+
+const char* const link_profile_names[LINK_PROFILE_COUNT] = {
+    "ideal", "lossy", "bursty", "cellular", "satellite"
+};
+
+bool link_profile(const char* name, LinkConfig_t* config) {
+    memset(config, 0, sizeof(*config));
+    config->seed = 1;
+
+    if (strcmp(name, "ideal") == 0) {
+        config->delay_ms = 20;
+    } else if (strcmp(name, "lossy") == 0) {
+        // Independent loss: the model the RTOS build used to have
+        config->loss = 0.05f;
+        config->delay_ms = 50;
+        config->jitter_ms = 30;
+    } else if (strcmp(name, "bursty") == 0) {
+        // Same average loss as "lossy" (about 5%), arriving in runs of ~8 frames
+        config->loss = 0.005f;
+        config->burst_loss = 0.6f;
+        config->p_enter_burst = 0.01f;
+        config->p_exit_burst = 0.125f;
+        config->delay_ms = 50;
+        config->jitter_ms = 30;
+    } else if (strcmp(name, "cellular") == 0) {
+        // Rural backhaul: bursts, 64 kbit/s, long latency tail, 5 s out every 60 s
+        config->loss = 0.01f;
+        config->burst_loss = 0.5f;
+        config->p_enter_burst = 0.02f;
+        config->p_exit_burst = 0.2f;
+        config->delay_ms = 60;
+        config->jitter_ms = 40;
+        config->jitter = LINK_JITTER_EXPONENTIAL;
+        config->rate_bytes_per_s = 8000;
+        config->bucket_bytes = 2048;
+        config->max_queue_ms = 2000;
+        config->outage_period_ms = 60000;
+        config->outage_ms = 5000;
+        config->outage_start_ms = 30000;
+    } else if (strcmp(name, "satellite") == 0) {
+        config->loss = 0.01f;
+        config->delay_ms = 300;
+        config->jitter_ms = 20;
+        config->in_order = true;
+        config->rate_bytes_per_s = 32000;
+        config->bucket_bytes = 4096;
+        config->max_queue_ms = 1000;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// xorshift32: small, fast and the same sequence on every platform
+static uint32_t next_random(LinkEmulator_t* link) {
+    uint32_t x = link->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    link->rng = x;
+    return x;
+}
+
+// Uniform in [0, 1)
+static float next_uniform(LinkEmulator_t* link) {
+    return (float)(next_random(link) >> 8) / 16777216.0f;
+}
+
+void link_emulator_init(LinkEmulator_t* link, const LinkConfig_t* config) {
+    memset(link, 0, sizeof(*link));
+    link->config = *config;
+    link->rng = config->seed != 0 ? config->seed : 0x9E3779B9u;
+    link->tokens = (float)config->bucket_bytes;
+}
+
+bool link_emulator_in_outage(const LinkEmulator_t* link, uint32_t now_ms) {
+    const LinkConfig_t* c = &link->config;
+    if (c->outage_period_ms == 0 || (int32_t)(now_ms - c->outage_start_ms) < 0) {
+        return false;
+    }
+    return (now_ms - c->outage_start_ms) % c->outage_period_ms < c->outage_ms;
+}
+
+// Step the Gilbert-Elliott chain and draw this frame's loss
+static bool lost(LinkEmulator_t* link) {
+    const LinkConfig_t* c = &link->config;
+    if (link->burst) {
+        if (next_uniform(link) < c->p_exit_burst) {
+            link->burst = false;
+        }
+    } else if (next_uniform(link) < c->p_enter_burst) {
+        link->burst = true;
+        link->stats.bursts++;
+    }
+
+    if (next_uniform(link) >= (link->burst ? c->burst_loss : c->loss)) {
+        return false;
+    }
+    link->stats.lost++;
+    if (link->burst) {
+        link->stats.burst_lost++;
+    }
+    return true;
+}
+
+// Token bucket shaper: the frame waits behind the frames already queued, then
+// for enough tokens. Returns false, changing nothing, when the wait is too long.
+static bool shape(LinkEmulator_t* link, uint32_t length, uint32_t now_ms, uint32_t* depart_ms) {
+    const LinkConfig_t* c = &link->config;
+    if (c->rate_bytes_per_s == 0) {
+        *depart_ms = now_ms;
+        return true;
+    }
+
+    uint32_t start = (int32_t)(link->tokens_ms - now_ms) > 0 ? link->tokens_ms : now_ms;
+    float tokens = link->tokens + (float)(start - link->tokens_ms) * (float)c->rate_bytes_per_s / 1000.0f;
+    if (tokens > (float)c->bucket_bytes) {
+        tokens = (float)c->bucket_bytes;
+    }
+
+    uint32_t wait = 0;
+    if (tokens < (float)length) {
+        wait = (uint32_t)ceilf(((float)length - tokens) * 1000.0f / (float)c->rate_bytes_per_s);
+        tokens += (float)wait * (float)c->rate_bytes_per_s / 1000.0f;
+    }
+    uint32_t depart = start + wait;
+    if (c->max_queue_ms > 0 && depart - now_ms > c->max_queue_ms) {
+        return false;
+    }
+
+    link->tokens = tokens - (float)length;
+    link->tokens_ms = depart;
+    *depart_ms = depart;
+    return true;
+}
+
+static uint32_t jitter(LinkEmulator_t* link) {
+    const LinkConfig_t* c = &link->config;
+    if (c->jitter_ms == 0) {
+        return 0;
+    }
+    if (c->jitter == LINK_JITTER_EXPONENTIAL) {
+        float j = -(float)c->jitter_ms * logf(1.0f - next_uniform(link));
+        float cap = JITTER_TAIL_CAP * (float)c->jitter_ms;
+        return (uint32_t)(j < cap ? j : cap);
+    }
+    return next_random(link) % (c->jitter_ms + 1);
+}
+
+bool link_emulator_send(LinkEmulator_t* link, const uint8_t* frame, uint32_t length, uint32_t now_ms) {
+    uint32_t index = link->next_index++;
+    link->stats.sent++;
+
+    if (link_emulator_in_outage(link, now_ms)) {
+        link->stats.outage_dropped++;
+        return false;
+    }
+    if (lost(link)) {
+        return false;
+    }
+    if (link->count >= LINK_EMULATOR_DEPTH || length > LINK_EMULATOR_MTU) {
+        link->stats.overflowed++;
+        return false;
+    }
+    uint32_t depart_ms;
+    if (!shape(link, length, now_ms, &depart_ms)) {
+        link->stats.queue_dropped++;
+        return false;
+    }
+
+    uint32_t due = depart_ms + link->config.delay_ms + jitter(link);
+    if (link->config.in_order && link->count > 0 && (int32_t)(link->last_due_ms - due) > 0) {
+        due = link->last_due_ms;
+    }
+    link->last_due_ms = due;
+
+    LinkFrame_t* slot = &link->frames[link->count++];
+    slot->due_ms = due;
+    slot->index = index;
+    slot->length = length;
+    memcpy(slot->data, frame, length);
+    return true;
+}
+
+// Earliest due frame (the lower index on a tie), -1 if empty
+static int earliest(const LinkEmulator_t* link, uint32_t now_ms) {
+    int best = -1;
+    int32_t best_wait = 0;
+    for (uint32_t i = 0; i < link->count; i++) {
+        int32_t wait = (int32_t)(link->frames[i].due_ms - now_ms);
+        if (best < 0 || wait < best_wait ||
+            (wait == best_wait && link->frames[i].index < link->frames[best].index)) {
+            best = (int)i;
+            best_wait = wait;
+        }
+    }
+    return best;
+}
+
+uint32_t link_emulator_receive(LinkEmulator_t* link, uint32_t now_ms, uint8_t* out, uint32_t max_length) {
+    int i = earliest(link, now_ms);
+    if (i < 0 || (int32_t)(link->frames[i].due_ms - now_ms) > 0) {
+        return 0;
+    }
+
+    LinkFrame_t* frame = &link->frames[i];
+    uint32_t length = frame->length < max_length ? frame->length : max_length;
+    memcpy(out, frame->data, length);
+
+    if (link->stats.delivered > 0 && frame->index < link->last_delivered) {
+        link->stats.reordered++;
+    } else {
+        link->last_delivered = frame->index;
+    }
+    link->stats.delivered++;
+
+    // Order in transit does not matter; fill the hole with the last frame
+    link->count--;
+    if ((uint32_t)i != link->count) {
+        *frame = link->frames[link->count];
+    }
+    return length;
+}
+
+uint32_t link_emulator_next_due(const LinkEmulator_t* link, uint32_t now_ms) {
+    int i = earliest(link, now_ms);
+    if (i < 0) {
+        return LINK_EMULATOR_IDLE;
+    }
+    int32_t wait = (int32_t)(link->frames[i].due_ms - now_ms);
+    return wait > 0 ? (uint32_t)wait : 0;
+}
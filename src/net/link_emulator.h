@@ -0,0 +1,110 @@
+#ifndef LINK_EMULATOR_H
+#define LINK_EMULATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// One direction of a datagram link, for testing the transport and telemetry
+// offline and for the simulated uplink of the RTOS build. A frame goes
+// through, in order:
+//   outage     - scheduled windows in which every frame is dropped
+//   loss       - Gilbert-Elliott: a good and a bad (burst) state, each with its
+//                own loss probability, switching state once per frame
+//   bandwidth  - token bucket shaper; frames wait for tokens, and a frame that
+//                would wait longer than max_queue_ms is dropped (tail drop)
+//   latency    - fixed delay plus uniform or exponential jitter; unless
+//                in_order is set, a frame with less jitter overtakes another
+// Every draw comes from the seeded generator, so a run is reproducible.
+#define LINK_EMULATOR_DEPTH     64      // Frames in transit
+#define LINK_EMULATOR_MTU       640     // Longest frame
+#define LINK_EMULATOR_IDLE      UINT32_MAX
+
+typedef enum {
+    LINK_JITTER_UNIFORM = 0,    // 0..jitter_ms
+    LINK_JITTER_EXPONENTIAL     // Mean jitter_ms, capped at 8x: the long tail of radio links
+} LinkJitter_t;
+
+typedef struct {
+    // Gilbert-Elliott loss
+    float loss;                 // Loss probability in the good state
+    float burst_loss;           // Loss probability in the bad state
+    float p_enter_burst;        // Good -> bad, per frame
+    float p_exit_burst;         // Bad -> good, per frame (mean burst 1/p frames)
+
+    // Latency
+    uint32_t delay_ms;          // One-way minimum
+    uint32_t jitter_ms;
+    LinkJitter_t jitter;
+    bool in_order;              // Never deliver a frame before an earlier one
+
+    // Bandwidth (0 = unlimited)
+    uint32_t rate_bytes_per_s;
+    uint32_t bucket_bytes;      // Burst allowance
+    uint32_t max_queue_ms;      // Shaper backlog beyond which frames are dropped (0 = no limit)
+
+    // Outages: outage_ms of every outage_period_ms, from outage_start_ms
+    uint32_t outage_period_ms;  // 0 = none
+    uint32_t outage_ms;
+    uint32_t outage_start_ms;
+
+    uint32_t seed;
+} LinkConfig_t;
+
+typedef struct {
+    uint32_t due_ms;
+    uint32_t index;             // Order sent, to count reordering
+    uint32_t length;
+    uint8_t data[LINK_EMULATOR_MTU];
+} LinkFrame_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t lost;              // Random loss, both states
+    uint32_t burst_lost;        // Of which in the bad state
+    uint32_t bursts;            // Entries into the bad state
+    uint32_t outage_dropped;
+    uint32_t queue_dropped;     // Shaper backlog too long
+    uint32_t overflowed;        // No room in transit, or longer than the MTU
+    uint32_t delivered;
+    uint32_t reordered;         // Delivered after a frame sent later
+} LinkStats_t;
+
+typedef struct {
+    LinkConfig_t config;
+    uint32_t rng;
+    bool burst;                 // In the bad state
+
+    // Token bucket: tokens as of tokens_ms, the time the shaper frees up
+    float tokens;
+    uint32_t tokens_ms;
+    uint32_t last_due_ms;       // For in_order
+
+    LinkFrame_t frames[LINK_EMULATOR_DEPTH];
+    uint32_t count;
+    uint32_t next_index;
+    uint32_t last_delivered;    // Highest index delivered
+    LinkStats_t stats;
+} LinkEmulator_t;
+
+// Named link profiles ("ideal", "lossy", "bursty", "cellular", "satellite")
+#define LINK_PROFILE_COUNT      5
+extern const char* const link_profile_names[LINK_PROFILE_COUNT];
+
+// Fill config with a named profile. Returns false for an unknown name.
+bool link_profile(const char* name, LinkConfig_t* config);
+
+void link_emulator_init(LinkEmulator_t* link, const LinkConfig_t* config);
+
+// True while a scheduled outage is on
+bool link_emulator_in_outage(const LinkEmulator_t* link, uint32_t now_ms);
+
+// Put a frame on the link. Returns false when it is dropped.
+bool link_emulator_send(LinkEmulator_t* link, const uint8_t* frame, uint32_t length, uint32_t now_ms);
+
+// Take the earliest frame due by now_ms into out. Returns its length, 0 if none is due.
+uint32_t link_emulator_receive(LinkEmulator_t* link, uint32_t now_ms, uint8_t* out, uint32_t max_length);
+
+// Milliseconds until the next frame is due, LINK_EMULATOR_IDLE when empty
+uint32_t link_emulator_next_due(const LinkEmulator_t* link, uint32_t now_ms);
+
+#endif // LINK_EMULATOR_H
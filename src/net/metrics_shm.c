@@ -0,0 +1,228 @@
+/**
+ * Metrics Shared Memory - Seqlock-protected state snapshot for external observers
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "metrics_shm.h"
+
+MetricsSegment_t* metrics_shm_create(const char* name) {
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, sizeof(MetricsSegment_t)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, sizeof(MetricsSegment_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    // A reader that attaches mid-way sees no magic, or an even sequence and
+    // an empty snapshot
+    MetricsSegment_t* segment = map;
+    segment->magic = 0;
+    atomic_thread_fence(memory_order_release);
+    memset(&segment->snapshot, 0, sizeof(segment->snapshot));
+    segment->version = METRICS_SHM_VERSION;
+    segment->snapshot_size = sizeof(MetricsSnapshot_t);
+    atomic_store_explicit(&segment->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    segment->magic = METRICS_SHM_MAGIC;
+    return segment;
+}
+
+MetricsSnapshot_t* metrics_shm_begin(MetricsSegment_t* segment) {
+    uint32_t sequence = atomic_load_explicit(&segment->sequence, memory_order_relaxed);
+    atomic_store_explicit(&segment->sequence, sequence + 1, memory_order_relaxed);
+    // The odd sequence is visible before any of the snapshot changes
+    atomic_thread_fence(memory_order_release);
+    return &segment->snapshot;
+}
+
+void metrics_shm_end(MetricsSegment_t* segment) {
+    uint32_t sequence = atomic_load_explicit(&segment->sequence, memory_order_relaxed);
+    atomic_store_explicit(&segment->sequence, sequence + 1, memory_order_release);
+}
+
+const MetricsSegment_t* metrics_shm_open(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MetricsSegment_t)) {
+        close(fd);
+        return NULL;
+    }
+    void* map = mmap(NULL, sizeof(MetricsSegment_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const MetricsSegment_t* segment = map;
+    if (segment->magic != METRICS_SHM_MAGIC || segment->version != METRICS_SHM_VERSION ||
+        segment->snapshot_size != sizeof(MetricsSnapshot_t)) {
+        munmap(map, sizeof(MetricsSegment_t));
+        return NULL;
+    }
+    return segment;
+}
+
+#define READ_YIELDS     16          // Then sleep between attempts
+#define READ_SLEEP_NS   50000
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+bool metrics_shm_read(const MetricsSegment_t* segment, MetricsSnapshot_t* snapshot,
+                      uint32_t timeout_ms, uint32_t* retries) {
+    uint64_t deadline = timeout_ms > 0 ? monotonic_ns() + (uint64_t)timeout_ms * 1000000u : 0;
+    for (uint32_t attempt = 0; ; attempt++) {
+        uint32_t before = atomic_load_explicit(&segment->sequence, memory_order_acquire);
+        if ((before & 1) == 0) {
+            memcpy(snapshot, &segment->snapshot, sizeof(*snapshot));
+            // The copy completes before the sequence is checked again
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&segment->sequence, memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        if (retries != NULL) {
+            (*retries)++;
+        }
+        if (deadline == 0 || monotonic_ns() >= deadline) {
+            return false;
+        }
+        // Mid-write: let the writer run; a sequence that moved is retried at once
+        if ((before & 1) != 0) {
+            if (attempt < READ_YIELDS) {
+                sched_yield();
+            } else {
+                struct timespec pause = { 0, READ_SLEEP_NS };
+                nanosleep(&pause, NULL);
+            }
+        }
+    }
+}
+
+// vsnprintf onto the end of out; past capacity, the rest is dropped
+static void json_append(char* out, uint32_t capacity, uint32_t* length, const char* format, ...) {
+    if (*length >= capacity) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(out + *length, capacity - *length, format, args);
+    va_end(args);
+    *length += n > 0 ? (uint32_t)n : 0;
+}
+
+// Task names come from the kernel; keep them inside the quotes
+static void json_name(char* out, uint32_t capacity, uint32_t* length, const char* name) {
+    char clean[METRICS_NAME_LEN];
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < METRICS_NAME_LEN && name[i] != '\0'; i++) {
+        if (name[i] >= ' ' && name[i] != '"' && name[i] != '\\') {
+            clean[n++] = name[i];
+        }
+    }
+    json_append(out, capacity, length, "\"%.*s\"", (int)n, clean);
+}
+
+uint32_t metrics_snapshot_json(const MetricsSnapshot_t* s, const char* const* channel_names,
+                               char* out, uint32_t capacity) {
+    uint32_t len = 0;
+    if (capacity == 0) {
+        return 0;
+    }
+    json_append(out, capacity, &len,
+                "{\"tick\":%u,\"uptime_s\":%u,\"emergency_stop\":%s,\"network_connected\":%s,"
+                "\"health\":%.1f,\"anomaly_flags\":%u,\"anomaly_count\":%u,\"sensors\":%c",
+                s->tick, s->uptime_seconds, s->emergency_stop ? "true" : "false",
+                s->network_connected ? "true" : "false", s->health_score, s->anomaly_flags,
+                s->anomaly_count, channel_names != NULL ? '{' : '[');
+    uint32_t channels = s->channel_count < METRICS_MAX_CHANNELS ? s->channel_count : METRICS_MAX_CHANNELS;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        if (channel_names != NULL) {
+            json_append(out, capacity, &len, "%s\"%s\":%.3f", ch > 0 ? "," : "",
+                        channel_names[ch], s->sensors[ch]);
+        } else {
+            json_append(out, capacity, &len, "%s%.3f", ch > 0 ? "," : "", s->sensors[ch]);
+        }
+    }
+
+    json_append(out, capacity, &len,
+                "%c,\"cpu\":%u,\"idle\":%u,\"context_switches\":%u,"
+                "\"sampler\":{\"samples\":%u,\"suspended_us\":%u,\"max_suspended_us\":%u},\"tasks\":[",
+                channel_names != NULL ? '}' : ']', s->cpu_usage_percent, s->idle_time_percent,
+                s->context_switch_count, s->sampler_samples, s->sampler_suspended_us,
+                s->sampler_max_suspended_us);
+    for (uint32_t i = 0; i < s->task_count && i < METRICS_MAX_TASKS; i++) {
+        const MetricsTask_t* t = &s->tasks[i];
+        json_append(out, capacity, &len, "%s{\"name\":", i > 0 ? "," : "");
+        json_name(out, capacity, &len, t->name);
+        json_append(out, capacity, &len,
+                    ",\"priority\":%u,\"state\":%u,\"cpu\":%u,\"stack\":%u,\"runtime\":%u}",
+                    t->priority, t->state, t->cpu_usage_percent, t->stack_usage_percent, t->runtime);
+    }
+
+    json_append(out, capacity, &len,
+                "],\"isr\":{\"interrupts\":%u,\"processed\":%u,\"last_us\":%u,\"p50_us\":%u,"
+                "\"p99_us\":%u,\"max_us\":%u},"
+                "\"mutex\":{\"system\":[%u,%u,%u],\"threshold\":[%u,%u,%u]},"
+                "\"heap\":{\"allocations\":%u,\"deallocations\":%u,\"failures\":%u,\"active\":%u,"
+                "\"bytes\":%u,\"peak\":%u,\"free\":%u,\"min_free\":%u},\"stacks\":[",
+                s->isr_interrupts, s->isr_processed, s->isr_last_latency_us, s->isr_latency.p50_us,
+                s->isr_latency.p99_us, s->isr_latency.max_us,
+                s->system_mutex_takes, s->system_mutex_gives, s->system_mutex_timeouts,
+                s->threshold_mutex_takes, s->threshold_mutex_gives, s->threshold_mutex_timeouts,
+                s->allocations, s->deallocations, s->allocation_failures, s->active_allocations,
+                s->bytes_allocated, s->peak_usage, s->heap_free, s->minimum_heap_free);
+    for (uint32_t i = 0; i < s->stack_count && i < METRICS_MAX_STACKS; i++) {
+        const MetricsStack_t* t = &s->stacks[i];
+        json_append(out, capacity, &len, "%s{\"name\":", i > 0 ? "," : "");
+        json_name(out, capacity, &len, t->name);
+        json_append(out, capacity, &len,
+                    ",\"words\":%u,\"free\":%u,\"min_free\":%u,\"used\":%u,\"peak\":%u}",
+                    t->stack_size_words, t->free_words, t->minimum_free_words, t->usage_percent,
+                    t->peak_usage_percent);
+    }
+    json_append(out, capacity, &len,
+                "],\"stack_events\":{\"warnings\":%u,\"high\":%u,\"critical\":%u,\"overflow\":%u},"
+                "\"power\":{\"idle_entries\":%u,\"sleep_entries\":%u,\"sleep_ms\":%u,"
+                "\"savings\":%u,\"wakes\":%u}}",
+                s->stack_warnings, s->stack_high_usage_events, s->stack_critical_usage_events,
+                s->stack_overflow_events, s->idle_entries, s->sleep_entries, s->total_sleep_time_ms,
+                s->power_savings_percent, s->wake_events);
+
+    return len < capacity ? len : capacity - 1;
+}
+
+uint32_t metrics_shm_publishes(const MetricsSegment_t* segment) {
+    return atomic_load_explicit(&segment->sequence, memory_order_relaxed) / 2;
+}
+
+void metrics_shm_close(const MetricsSegment_t* segment) {
+    munmap((void*)segment, sizeof(MetricsSegment_t));
+}
+
+void metrics_shm_unlink(const char* name) {
+    shm_unlink(name);
+}
@@ -0,0 +1,154 @@
+#ifndef METRICS_SHM_H
+#define METRICS_SHM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Versioned, fixed-layout snapshot of the monitor's state in a POSIX shared
+// memory segment. One writer fills the snapshot in place between two
+// increments of a sequence counter (a seqlock): odd while a write is under
+// way. Readers copy it out and retry if the counter moved, so any number of
+// them can attach at any rate without ever blocking the writer, and the
+// writer makes no system call after the segment is created.
+//
+// Every field is fixed width, so tools built without the kernel headers read
+// the same layout. Bump METRICS_SHM_VERSION on any change to it.
+#define METRICS_SHM_NAME        "/turbine_metrics"
+#define METRICS_SHM_MAGIC       0x4D425754u     // "TWBM"
+#define METRICS_SHM_VERSION     3
+#define METRICS_NAME_LEN        16
+#define METRICS_MAX_CHANNELS    16      // Room for CHANNEL_COUNT to grow
+#define METRICS_MAX_TASKS       16      // Room for MAX_TASKS_TRACKED to grow
+#define METRICS_MAX_STACKS      16      // Room for MAX_STACK_MONITORED_TASKS to grow
+#define METRICS_READ_TIMEOUT_MS 100     // Then the writer is taken to be stuck mid-write
+
+typedef struct {
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} MetricsLatency_t;
+
+typedef struct {
+    char name[METRICS_NAME_LEN];
+    uint32_t priority;
+    uint32_t state;             // eTaskState
+    uint32_t cpu_usage_percent;
+    uint32_t stack_usage_percent;
+    uint32_t runtime;
+    uint32_t context_switches;
+} MetricsTask_t;
+
+typedef struct {
+    char name[METRICS_NAME_LEN];
+    uint32_t stack_size_words;
+    uint32_t free_words;
+    uint32_t minimum_free_words;
+    uint32_t usage_percent;
+    uint32_t peak_usage_percent;
+} MetricsStack_t;
+
+typedef struct {
+    uint32_t tick;              // Kernel tick of the snapshot
+    uint32_t uptime_seconds;
+    uint32_t emergency_stop;
+    uint32_t network_connected;
+
+    // Sensors and anomalies
+    float sensors[METRICS_MAX_CHANNELS];   // Channel table order
+    uint32_t channel_count;
+    uint32_t sensor_timestamp;
+    uint32_t anomaly_flags;     // CHANNEL_FLAG bits
+    float health_score;
+    uint32_t anomaly_count;
+
+    // Scheduling
+    MetricsTask_t tasks[METRICS_MAX_TASKS];
+    uint32_t task_count;
+    uint32_t context_switch_count;
+    uint32_t cpu_usage_percent;
+    uint32_t idle_time_percent;
+    uint32_t sampler_samples;   // Task statistics samples taken
+    uint32_t sampler_suspended_us;      // Scheduler suspended by the latest one
+    uint32_t sampler_max_suspended_us;
+
+    // ISR
+    uint32_t isr_interrupts;
+    uint32_t isr_processed;
+    uint32_t isr_last_latency_us;
+    MetricsLatency_t isr_latency;
+
+    // Mutexes
+    uint32_t system_mutex_takes;
+    uint32_t system_mutex_gives;
+    uint32_t system_mutex_timeouts;
+    uint32_t threshold_mutex_takes;
+    uint32_t threshold_mutex_gives;
+    uint32_t threshold_mutex_timeouts;
+
+    // Heap
+    uint32_t allocations;
+    uint32_t deallocations;
+    uint32_t allocation_failures;
+    uint32_t active_allocations;
+    uint32_t bytes_allocated;
+    uint32_t peak_usage;
+    uint32_t heap_free;
+    uint32_t minimum_heap_free;
+
+    // Stacks
+    MetricsStack_t stacks[METRICS_MAX_STACKS];
+    uint32_t stack_count;
+    uint32_t stack_warnings;
+    uint32_t stack_high_usage_events;
+    uint32_t stack_critical_usage_events;
+    uint32_t stack_overflow_events;
+
+    // Power
+    uint32_t idle_entries;
+    uint32_t sleep_entries;
+    uint32_t total_sleep_time_ms;
+    uint32_t power_savings_percent;
+    uint32_t wake_events;
+} MetricsSnapshot_t;
+
+typedef struct {
+    uint32_t magic;             // Written last by the creator
+    uint32_t version;
+    uint32_t snapshot_size;     // sizeof(MetricsSnapshot_t) of the writer
+    _Atomic uint32_t sequence;  // Odd while the writer is inside the snapshot
+    MetricsSnapshot_t snapshot;
+} MetricsSegment_t;
+
+// Create (or take over) the segment and map it for writing; NULL on failure
+MetricsSegment_t* metrics_shm_create(const char* name);
+
+// Writer: the snapshot to fill in place, then publish it. Never blocks.
+MetricsSnapshot_t* metrics_shm_begin(MetricsSegment_t* segment);
+void metrics_shm_end(MetricsSegment_t* segment);
+
+// Map an existing segment read-only. NULL if it is missing, or its magic,
+// version or size does not match this build.
+const MetricsSegment_t* metrics_shm_open(const char* name);
+
+// Copy out a consistent snapshot. While a write is under way (the writer may
+// be preempted mid-write) the reader yields, then sleeps, between attempts,
+// for up to timeout_ms; 0 gives one attempt. Returns false if the writer was
+// still mid-write by then. retries (optional) counts the repeated attempts.
+bool metrics_shm_read(const MetricsSegment_t* segment, MetricsSnapshot_t* snapshot,
+                      uint32_t timeout_ms, uint32_t* retries);
+
+// The snapshot as one line of JSON. channel_names (channel_count of them)
+// key the sensors; NULL gives an array. Returns the length, cut at capacity - 1.
+uint32_t metrics_snapshot_json(const MetricsSnapshot_t* snapshot, const char* const* channel_names,
+                               char* out, uint32_t capacity);
+
+// Snapshots published since the segment was created
+uint32_t metrics_shm_publishes(const MetricsSegment_t* segment);
+
+void metrics_shm_close(const MetricsSegment_t* segment);
+
+// Remove the name; mappings stay valid until closed
+void metrics_shm_unlink(const char* name);
+
+#endif // METRICS_SHM_H
@@ -0,0 +1,373 @@
+/**
+ * MQTT - 3.1.1 QoS 1 publisher with a bounded inflight window, and a stream parser
+ */
+
+#include <string.h>
+#include "mqtt.h"
+
+#define FLAG_DUP            0x08
+#define FLAG_QOS1           0x02
+#define CONNECT_CLEAN       0x02
+#define PROTOCOL_LEVEL      4       // 3.1.1
+
+// Remaining length: 7 bits per byte, least significant first, at most 4 bytes
+static uint32_t encode_length(uint8_t* out, uint32_t value) {
+    uint32_t n = 0;
+    do {
+        uint8_t byte = (uint8_t)(value & 0x7F);
+        value >>= 7;
+        out[n++] = value > 0 ? (uint8_t)(byte | 0x80) : byte;
+    } while (value > 0 && n < 4);
+    return n;
+}
+
+static void put_u16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 8);       // MQTT is big-endian
+    p[1] = (uint8_t)v;
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+void mqtt_parser_init(MqttParser_t* parser) {
+    parser->start = 0;
+    parser->length = 0;
+    parser->failed = false;
+}
+
+uint32_t mqtt_parser_feed(MqttParser_t* parser, const uint8_t* data, uint32_t length) {
+    if (parser->start > 0) {
+        memmove(parser->buffer, parser->buffer + parser->start, parser->length - parser->start);
+        parser->length -= parser->start;
+        parser->start = 0;
+    }
+    uint32_t room = (uint32_t)sizeof(parser->buffer) - parser->length;
+    uint32_t n = length < room ? length : room;
+    memcpy(parser->buffer + parser->length, data, n);
+    parser->length += n;
+    return n;
+}
+
+bool mqtt_parser_next(MqttParser_t* parser, MqttPacket_t* packet) {
+    const uint8_t* p = parser->buffer + parser->start;
+    uint32_t available = parser->length - parser->start;
+    if (parser->failed || available < 2) {
+        return false;
+    }
+
+    uint32_t remaining = 0;
+    uint32_t header = 0;
+    for (uint32_t i = 1; i <= 4; i++) {
+        if (i >= available) {
+            return false;       // Length not complete yet
+        }
+        remaining |= (uint32_t)(p[i] & 0x7F) << (7 * (i - 1));
+        if ((p[i] & 0x80) == 0) {
+            header = i + 1;
+            break;
+        }
+    }
+    if (header == 0 || remaining > MQTT_PACKET_MAX) {
+        parser->failed = true;
+        return false;
+    }
+    if (available < header + remaining) {
+        return false;
+    }
+
+    packet->type = (MqttPacketType_t)(p[0] >> 4);
+    packet->flags = p[0] & 0x0F;
+    packet->body = p + header;
+    packet->body_length = remaining;
+    parser->start += header + remaining;
+    return true;
+}
+
+bool mqtt_decode_publish(const MqttPacket_t* packet, MqttPublish_t* publish) {
+    if (packet->type != MQTT_PUBLISH || packet->body_length < 2) {
+        return false;
+    }
+    uint32_t topic_length = get_u16(packet->body);
+    uint32_t offset = 2 + topic_length;
+    publish->qos = (packet->flags >> 1) & 0x03;
+    publish->dup = (packet->flags & FLAG_DUP) != 0;
+    if (publish->qos > 0) {
+        offset += 2;
+    }
+    if (offset > packet->body_length || publish->qos > 2) {
+        return false;
+    }
+    publish->topic = (const char*)packet->body + 2;
+    publish->topic_length = topic_length;
+    publish->id = publish->qos > 0 ? get_u16(packet->body + 2 + topic_length) : 0;
+    publish->payload = packet->body + offset;
+    publish->payload_length = packet->body_length - offset;
+    return true;
+}
+
+uint32_t mqtt_encode_connect(uint8_t* out, uint32_t max_length, const char* client_id,
+                             uint16_t keepalive_s) {
+    uint32_t id_length = (uint32_t)strlen(client_id);
+    uint32_t remaining = 10 + 2 + id_length;
+    uint8_t length[4];
+    uint32_t header = 1 + encode_length(length, remaining);
+    if (id_length > 0xFFFF || header + remaining > max_length) {
+        return 0;
+    }
+    uint8_t* p = out;
+    *p++ = (uint8_t)(MQTT_CONNECT << 4);
+    memcpy(p, length, header - 1);
+    p += header - 1;
+    put_u16(p, 4);
+    memcpy(p + 2, "MQTT", 4);
+    p += 6;
+    *p++ = PROTOCOL_LEVEL;
+    *p++ = CONNECT_CLEAN;
+    put_u16(p, keepalive_s);
+    put_u16(p + 2, id_length);
+    memcpy(p + 4, client_id, id_length);
+    return header + remaining;
+}
+
+uint32_t mqtt_encode_connack(uint8_t* out, uint32_t max_length, uint8_t return_code) {
+    if (max_length < 4) {
+        return 0;
+    }
+    out[0] = (uint8_t)(MQTT_CONNACK << 4);
+    out[1] = 2;
+    out[2] = 0;         // No session present
+    out[3] = return_code;
+    return 4;
+}
+
+uint32_t mqtt_encode_puback(uint8_t* out, uint32_t max_length, uint16_t id) {
+    if (max_length < 4) {
+        return 0;
+    }
+    out[0] = (uint8_t)(MQTT_PUBACK << 4);
+    out[1] = 2;
+    put_u16(out + 2, id);
+    return 4;
+}
+
+uint32_t mqtt_encode_simple(uint8_t* out, uint32_t max_length, MqttPacketType_t type) {
+    if (max_length < 2) {
+        return 0;
+    }
+    out[0] = (uint8_t)(type << 4);
+    out[1] = 0;
+    return 2;
+}
+
+static void emit(MqttPublisher_t* pub, const uint8_t* data, uint32_t length, uint32_t now_ms) {
+    pub->output(pub->context, data, length);
+    pub->stats.bytes_sent += length;
+    pub->last_sent_ms = now_ms;
+}
+
+void mqtt_publisher_init(MqttPublisher_t* pub, MqttOutput_t output, MqttRelease_t release,
+                         void* context) {
+    memset(pub, 0, sizeof(*pub));
+    mqtt_parser_init(&pub->parser);
+    pub->next_id = 1;
+    pub->output = output;
+    pub->release = release;
+    pub->context = context;
+}
+
+void mqtt_connect(MqttPublisher_t* pub, const char* client_id, uint16_t keepalive_s, uint32_t now_ms) {
+    uint8_t packet[128];
+    uint32_t length = mqtt_encode_connect(packet, sizeof(packet), client_id, keepalive_s);
+    mqtt_parser_init(&pub->parser);
+    pub->connected = false;
+    pub->connack_code = 0;
+    pub->keepalive_s = keepalive_s;
+    if (length > 0) {
+        emit(pub, packet, length, now_ms);
+    }
+}
+
+bool mqtt_can_publish(const MqttPublisher_t* pub) {
+    return pub->connected && pub->in_flight < MQTT_INFLIGHT;
+}
+
+static MqttInflight_t* find_slot(MqttPublisher_t* pub, uint16_t id) {
+    for (uint32_t i = 0; i < MQTT_INFLIGHT; i++) {
+        if (pub->inflight[i].buffer != NULL && pub->inflight[i].id == id) {
+            return &pub->inflight[i];
+        }
+    }
+    return NULL;
+}
+
+// Next packet identifier: never 0, never one still in flight
+static uint16_t allocate_id(MqttPublisher_t* pub) {
+    do {
+        pub->next_id = pub->next_id == 0xFFFF ? 1 : (uint16_t)(pub->next_id + 1);
+    } while (find_slot(pub, pub->next_id) != NULL);
+    return pub->next_id;
+}
+
+bool mqtt_publish(MqttPublisher_t* pub, uint8_t* buffer, const char* topic,
+                  uint32_t payload_length, uint32_t messages, uint32_t now_ms) {
+    uint32_t topic_length = (uint32_t)strlen(topic);
+    if (!mqtt_can_publish(pub) || topic_length == 0 || topic_length > MQTT_TOPIC_MAX ||
+        2 + topic_length + 2 + payload_length > MQTT_PACKET_MAX) {
+        return false;
+    }
+
+    MqttInflight_t* slot = NULL;
+    for (uint32_t i = 0; i < MQTT_INFLIGHT && slot == NULL; i++) {
+        if (pub->inflight[i].buffer == NULL) {
+            slot = &pub->inflight[i];
+        }
+    }
+    uint16_t id = allocate_id(pub);
+
+    // The header is built backwards from the payload, so the packet is contiguous
+    uint8_t length[4];
+    uint32_t length_bytes = encode_length(length, 2 + topic_length + 2 + payload_length);
+    uint32_t header = 1 + length_bytes + 2 + topic_length + 2;
+    uint8_t* p = buffer + MQTT_HEADROOM - header;
+    p[0] = (uint8_t)((MQTT_PUBLISH << 4) | FLAG_QOS1);
+    memcpy(p + 1, length, length_bytes);
+    put_u16(p + 1 + length_bytes, topic_length);
+    memcpy(p + 3 + length_bytes, topic, topic_length);
+    put_u16(p + 3 + length_bytes + topic_length, id);
+
+    slot->buffer = buffer;
+    slot->packet = p;
+    slot->length = header + payload_length;
+    slot->id = id;
+    slot->published_ms = now_ms;
+    slot->sent_ms = now_ms;
+    slot->retries = 0;
+    pub->in_flight++;
+    pub->stats.publishes++;
+    pub->stats.messages += messages;
+    emit(pub, slot->packet, slot->length, now_ms);
+    return true;
+}
+
+static void release_slot(MqttPublisher_t* pub, MqttInflight_t* slot, bool delivered, uint32_t now_ms) {
+    uint8_t* buffer = slot->buffer;
+    if (delivered) {
+        pub->stats.acked++;
+    } else {
+        pub->stats.abandoned++;
+    }
+    slot->buffer = NULL;
+    pub->in_flight--;
+    pub->release(pub->context, buffer, delivered, delivered ? now_ms - slot->published_ms : 0);
+}
+
+void mqtt_input(MqttPublisher_t* pub, const uint8_t* data, uint32_t length, uint32_t now_ms) {
+    while (length > 0) {
+        uint32_t n = mqtt_parser_feed(&pub->parser, data, length);
+        data += n;
+        length -= n;
+
+        MqttPacket_t packet;
+        while (mqtt_parser_next(&pub->parser, &packet)) {
+            if (packet.type == MQTT_CONNACK && packet.body_length >= 2) {
+                pub->connack_code = packet.body[1];
+                pub->connected = packet.body[1] == 0;
+            } else if (packet.type == MQTT_PUBACK && packet.body_length >= 2) {
+                MqttInflight_t* slot = find_slot(pub, get_u16(packet.body));
+                if (slot != NULL) {
+                    release_slot(pub, slot, true, now_ms);
+                }
+            }
+            // PINGRESP needs nothing: any traffic shows the broker is there
+        }
+        if (n == 0 || pub->parser.failed) {
+            return;
+        }
+    }
+}
+
+uint32_t mqtt_poll(MqttPublisher_t* pub, uint32_t now_ms) {
+    uint32_t next = MQTT_NO_TIMER;
+    if (!pub->connected) {
+        return next;
+    }
+
+    for (uint32_t i = 0; i < MQTT_INFLIGHT; i++) {
+        MqttInflight_t* slot = &pub->inflight[i];
+        if (slot->buffer == NULL) {
+            continue;
+        }
+        if (now_ms - slot->sent_ms >= MQTT_ACK_TIMEOUT_MS) {
+            if (slot->retries >= MQTT_MAX_RETRIES) {
+                release_slot(pub, slot, false, now_ms);
+                continue;
+            }
+            slot->packet[0] |= FLAG_DUP;
+            slot->retries++;
+            slot->sent_ms = now_ms;
+            pub->stats.resent++;
+            emit(pub, slot->packet, slot->length, now_ms);
+        }
+        uint32_t left = MQTT_ACK_TIMEOUT_MS - (now_ms - slot->sent_ms);
+        if (left < next) {
+            next = left;
+        }
+    }
+
+    // Ping at half the keepalive so the broker never sees it lapse
+    if (pub->keepalive_s > 0) {
+        uint32_t interval = pub->keepalive_s * 1000u / 2;
+        if (now_ms - pub->last_sent_ms >= interval) {
+            uint8_t ping[2];
+            emit(pub, ping, mqtt_encode_simple(ping, sizeof(ping), MQTT_PINGREQ), now_ms);
+        }
+        uint32_t left = interval - (now_ms - pub->last_sent_ms);
+        if (left < next) {
+            next = left;
+        }
+    }
+    return next;
+}
+
+void mqtt_abort(MqttPublisher_t* pub) {
+    for (uint32_t i = 0; i < MQTT_INFLIGHT; i++) {
+        if (pub->inflight[i].buffer != NULL) {
+            release_slot(pub, &pub->inflight[i], false, 0);
+        }
+    }
+    pub->connected = false;
+}
+
+void mqtt_batch_open(MqttBatch_t* batch, uint8_t* buffer, uint32_t capacity) {
+    batch->buffer = buffer;
+    batch->capacity = capacity;
+    batch->length = 0;
+    batch->messages = 0;
+}
+
+bool mqtt_batch_add(MqttBatch_t* batch, const void* message, uint32_t length) {
+    uint32_t separator = batch->messages > 0 ? 1 : 0;
+    if (batch->buffer == NULL || batch->length + separator + length > batch->capacity) {
+        return false;
+    }
+    uint8_t* p = batch->buffer + MQTT_HEADROOM + batch->length;
+    if (separator) {
+        *p++ = '\n';
+    }
+    memcpy(p, message, length);
+    batch->length += separator + length;
+    batch->messages++;
+    return true;
+}
+
+bool mqtt_batch_flush(MqttPublisher_t* pub, MqttBatch_t* batch, const char* topic, uint32_t now_ms) {
+    if (batch->buffer == NULL || batch->messages == 0) {
+        return true;
+    }
+    if (!mqtt_publish(pub, batch->buffer, topic, batch->length, batch->messages, now_ms)) {
+        return false;
+    }
+    batch->buffer = NULL;
+    return true;
+}
@@ -0,0 +1,159 @@
+#ifndef MQTT_H
+#define MQTT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// MQTT 3.1.1 over any byte stream: a QoS 1 publisher that pipelines up to
+// MQTT_INFLIGHT unacknowledged PUBLISHes held in caller-owned buffers, a
+// stream parser shared with the broker side, and the encoders both need.
+// Nothing here touches a socket; bytes go out through a callback and come
+// in through mqtt_input.
+#define MQTT_INFLIGHT           8       // Unacknowledged QoS 1 publishes
+#define MQTT_TOPIC_MAX          48
+#define MQTT_HEADROOM           (1 + 4 + 2 + MQTT_TOPIC_MAX + 2)    // Reserved before every payload
+#define MQTT_PACKET_MAX         2048    // Longest packet the parser accepts
+#define MQTT_ACK_TIMEOUT_MS     2000    // Then the PUBLISH is resent with DUP set
+#define MQTT_MAX_RETRIES        4       // Then it is abandoned
+#define MQTT_NO_TIMER           UINT32_MAX
+
+// Control packet types (the high nibble of the first byte)
+typedef enum {
+    MQTT_CONNECT = 1,
+    MQTT_CONNACK = 2,
+    MQTT_PUBLISH = 3,
+    MQTT_PUBACK = 4,
+    MQTT_PINGREQ = 12,
+    MQTT_PINGRESP = 13,
+    MQTT_DISCONNECT = 14
+} MqttPacketType_t;
+
+// One complete packet from the parser; body points into the parser and is
+// valid until the next mqtt_parser_ call
+typedef struct {
+    MqttPacketType_t type;
+    uint8_t flags;              // Low nibble of the first byte
+    const uint8_t* body;        // Variable header and payload
+    uint32_t body_length;
+} MqttPacket_t;
+
+typedef struct {
+    uint8_t buffer[MQTT_PACKET_MAX + 5];
+    uint32_t start;             // First unparsed byte
+    uint32_t length;            // Bytes buffered
+    bool failed;                // Malformed or oversized packet: drop the connection
+} MqttParser_t;
+
+// A PUBLISH taken apart
+typedef struct {
+    const char* topic;          // Not terminated
+    uint32_t topic_length;
+    uint16_t id;                // 0 for QoS 0
+    uint8_t qos;
+    bool dup;
+    const uint8_t* payload;
+    uint32_t payload_length;
+} MqttPublish_t;
+
+// Writes bytes to the stream. It must not call back into the publisher.
+typedef void (*MqttOutput_t)(void* context, const uint8_t* data, uint32_t length);
+// Hands a buffer back: acknowledged after rtt_ms, or abandoned (delivered false)
+typedef void (*MqttRelease_t)(void* context, uint8_t* buffer, bool delivered, uint32_t rtt_ms);
+
+typedef struct {
+    uint8_t* buffer;            // NULL when the slot is free
+    uint8_t* packet;            // The PUBLISH, inside buffer
+    uint32_t length;
+    uint16_t id;
+    uint32_t published_ms;      // First send, for the round trip
+    uint32_t sent_ms;           // Latest send
+    uint8_t retries;
+} MqttInflight_t;
+
+typedef struct {
+    uint32_t publishes;         // PUBLISH packets, first sends
+    uint32_t messages;          // Messages in them (coalesced ones counted singly)
+    uint32_t acked;
+    uint32_t resent;            // DUP resends after MQTT_ACK_TIMEOUT_MS
+    uint32_t abandoned;
+    uint32_t bytes_sent;        // Every packet, resends included
+} MqttStats_t;
+
+typedef struct {
+    MqttInflight_t inflight[MQTT_INFLIGHT];
+    uint32_t in_flight;
+    uint16_t next_id;
+    bool connected;             // CONNACK accepted
+    uint8_t connack_code;       // Last CONNACK return code
+    uint16_t keepalive_s;
+    uint32_t last_sent_ms;      // For PINGREQ
+    MqttParser_t parser;
+    MqttOutput_t output;
+    MqttRelease_t release;
+    void* context;
+    MqttStats_t stats;
+} MqttPublisher_t;
+
+// Small messages packed into one PUBLISH, newline separated, while the
+// window is full. buffer is laid out like any publish buffer.
+typedef struct {
+    uint8_t* buffer;            // NULL when no batch is open
+    uint32_t capacity;          // Payload bytes after MQTT_HEADROOM
+    uint32_t length;
+    uint32_t messages;
+} MqttBatch_t;
+
+void mqtt_parser_init(MqttParser_t* parser);
+
+// Buffer up to length bytes. Returns the bytes taken; call mqtt_parser_next
+// until it returns false, then feed the rest.
+uint32_t mqtt_parser_feed(MqttParser_t* parser, const uint8_t* data, uint32_t length);
+
+// The next complete packet, if one is buffered
+bool mqtt_parser_next(MqttParser_t* parser, MqttPacket_t* packet);
+
+bool mqtt_decode_publish(const MqttPacket_t* packet, MqttPublish_t* publish);
+
+// Encoders; each returns the packet length, 0 if it does not fit in max_length
+uint32_t mqtt_encode_connect(uint8_t* out, uint32_t max_length, const char* client_id,
+                             uint16_t keepalive_s);
+uint32_t mqtt_encode_connack(uint8_t* out, uint32_t max_length, uint8_t return_code);
+uint32_t mqtt_encode_puback(uint8_t* out, uint32_t max_length, uint16_t id);
+uint32_t mqtt_encode_simple(uint8_t* out, uint32_t max_length, MqttPacketType_t type);
+
+void mqtt_publisher_init(MqttPublisher_t* pub, MqttOutput_t output, MqttRelease_t release,
+                         void* context);
+
+// Send CONNECT (clean session); publishing waits for the CONNACK
+void mqtt_connect(MqttPublisher_t* pub, const char* client_id, uint16_t keepalive_s, uint32_t now_ms);
+
+bool mqtt_can_publish(const MqttPublisher_t* pub);
+
+// Publish buffer[MQTT_HEADROOM..] (payload_length bytes) at QoS 1. The buffer
+// stays with the publisher until it is released. Returns false, leaving the
+// buffer with the caller, when not connected or the window is full. messages
+// is how many messages the payload carries.
+bool mqtt_publish(MqttPublisher_t* pub, uint8_t* buffer, const char* topic,
+                  uint32_t payload_length, uint32_t messages, uint32_t now_ms);
+
+// Bytes from the broker
+void mqtt_input(MqttPublisher_t* pub, const uint8_t* data, uint32_t length, uint32_t now_ms);
+
+// Resend what timed out, keep the connection alive. Returns the milliseconds
+// until the next timer, MQTT_NO_TIMER if none.
+uint32_t mqtt_poll(MqttPublisher_t* pub, uint32_t now_ms);
+
+// Connection lost: release every publish in flight as not delivered
+void mqtt_abort(MqttPublisher_t* pub);
+
+// Open a batch in buffer, which has room for capacity payload bytes
+void mqtt_batch_open(MqttBatch_t* batch, uint8_t* buffer, uint32_t capacity);
+
+// Append one message. Returns false, changing nothing, when it does not fit.
+bool mqtt_batch_add(MqttBatch_t* batch, const void* message, uint32_t length);
+
+// Publish the open batch, which closes it. Returns false while the window is
+// full; true once nothing is left to send.
+bool mqtt_batch_flush(MqttPublisher_t* pub, MqttBatch_t* batch, const char* topic, uint32_t now_ms);
+
+#endif // MQTT_H
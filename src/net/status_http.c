@@ -0,0 +1,276 @@
+/**
+ * Status HTTP - /metrics JSON and /stream Server-Sent Events from one shared frame
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "status_http.h"
+
+#define SSE_PREFIX          "data: "
+#define SSE_PREFIX_LENGTH   6
+#define SSE_SUFFIX_LENGTH   2       // "\n\n" ends the event
+
+static const char not_found_text[] = "Not found\n";
+static const char no_snapshot_text[] = "No snapshot yet\n";
+static const char bad_method_text[] = "Only GET\n";
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+bool status_http_open(StatusHttp_t* server, uint16_t port, const char* index_html) {
+    memset(server, 0, sizeof(*server));
+    server->listener = -1;
+    for (uint32_t i = 0; i < STATUS_HTTP_MAX_CLIENTS; i++) {
+        server->clients[i].fd = -1;
+    }
+    server->index_html = index_html;
+    memcpy(server->frame, SSE_PREFIX, SSE_PREFIX_LENGTH);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fd, STATUS_HTTP_MAX_CLIENTS) != 0) {
+        close(fd);
+        return false;
+    }
+    set_nonblocking(fd);
+    server->listener = fd;
+    return true;
+}
+
+static void close_client(StatusHttp_t* server, StatusClient_t* client) {
+    close(client->fd);
+    client->fd = -1;
+    client->state = STATUS_CLIENT_FREE;
+    server->stats.clients--;
+}
+
+static void respond(StatusClient_t* client, const char* status, const char* type,
+                    const char* body, uint32_t length, bool body_is_frame) {
+    int head = snprintf(client->head, sizeof(client->head),
+                        "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                        "Cache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\n"
+                        "Connection: close\r\n\r\n",
+                        status, type, (unsigned)length);
+    client->head_length = head < (int)sizeof(client->head) ? (uint32_t)head : sizeof(client->head) - 1;
+    client->head_sent = 0;
+    client->body = body;
+    client->body_length = length;
+    client->body_sent = 0;
+    client->body_is_frame = body_is_frame;
+    client->state = STATUS_CLIENT_RESPONSE;
+}
+
+// SSE: the headers and the current frame now, every later frame as committed
+static void start_stream(StatusHttp_t* server, StatusClient_t* client) {
+    int head = snprintf(client->head, sizeof(client->head),
+                        "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                        "Cache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\n"
+                        "Connection: keep-alive\r\n\r\n");
+    client->head_length = (uint32_t)head;
+    client->head_sent = 0;
+    client->body = server->frame;
+    client->body_length = server->json_length > 0
+                          ? SSE_PREFIX_LENGTH + server->json_length + SSE_SUFFIX_LENGTH : 0;
+    client->body_sent = 0;
+    client->body_is_frame = true;
+    client->state = STATUS_CLIENT_STREAM;
+}
+
+static void handle_request(StatusHttp_t* server, StatusClient_t* client) {
+    server->stats.requests++;
+    const char* line = client->request;
+    if (strncmp(line, "GET ", 4) != 0) {
+        respond(client, "405 Method Not Allowed", "text/plain", bad_method_text,
+                sizeof(bad_method_text) - 1, false);
+        return;
+    }
+    const char* path = line + 4;
+    size_t path_length = strcspn(path, " ?\r\n");
+
+    if (path_length == 8 && strncmp(path, "/metrics", 8) == 0) {
+        if (server->json_length == 0) {
+            respond(client, "503 Service Unavailable", "text/plain", no_snapshot_text,
+                    sizeof(no_snapshot_text) - 1, false);
+            return;
+        }
+        server->stats.snapshots++;
+        respond(client, "200 OK", "application/json", server->frame + SSE_PREFIX_LENGTH,
+                server->json_length, true);
+    } else if (path_length == 7 && strncmp(path, "/stream", 7) == 0) {
+        server->stats.streams++;
+        start_stream(server, client);
+    } else if (path_length == 1 && server->index_html != NULL) {
+        respond(client, "200 OK", "text/html; charset=utf-8", server->index_html,
+                (uint32_t)strlen(server->index_html), false);
+    } else {
+        server->stats.not_found++;
+        respond(client, "404 Not Found", "text/plain", not_found_text,
+                sizeof(not_found_text) - 1, false);
+    }
+}
+
+// Request bytes until the blank line; anything a client sends later is
+// discarded, but its end of stream closes the connection. Returns false if
+// the client is gone.
+static bool read_client(StatusHttp_t* server, StatusClient_t* client) {
+    char discard[256];
+    while (1) {
+        bool reading = client->state == STATUS_CLIENT_REQUEST;
+        char* into = reading ? client->request + client->request_length : discard;
+        uint32_t room = reading ? STATUS_HTTP_REQUEST_MAX - 1 - client->request_length : sizeof(discard);
+        if (room == 0) {
+            server->stats.rejected++;     // Request too large
+            close_client(server, client);
+            return false;
+        }
+        ssize_t n = recv(client->fd, into, room, MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            server->stats.disconnects++;
+            close_client(server, client);
+            return false;
+        }
+        if (n < 0) {
+            return true;
+        }
+        if (reading) {
+            client->request_length += (uint32_t)n;
+            client->request[client->request_length] = '\0';
+            if (strstr(client->request, "\r\n\r\n") != NULL) {
+                handle_request(server, client);
+            }
+        }
+    }
+}
+
+// As much of the header and body as the socket takes. Returns false if the
+// client is gone (a one-shot response is closed once complete).
+static bool write_client(StatusHttp_t* server, StatusClient_t* client) {
+    while (client->head_sent < client->head_length || client->body_sent < client->body_length) {
+        bool head = client->head_sent < client->head_length;
+        const char* data = head ? client->head + client->head_sent : client->body + client->body_sent;
+        uint32_t length = head ? client->head_length - client->head_sent
+                               : client->body_length - client->body_sent;
+        ssize_t n = send(client->fd, data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;    // Socket full; the next poll or frame decides
+        }
+        if (n <= 0) {
+            server->stats.disconnects++;
+            close_client(server, client);
+            return false;
+        }
+        server->stats.bytes_sent += (uint64_t)n;
+        if (head) {
+            client->head_sent += (uint32_t)n;
+        } else {
+            client->body_sent += (uint32_t)n;
+        }
+    }
+    if (client->state == STATUS_CLIENT_RESPONSE) {
+        close_client(server, client);
+        return false;
+    }
+    return true;
+}
+
+void status_http_poll(StatusHttp_t* server, uint32_t now_ms) {
+    if (server->listener < 0) {
+        return;
+    }
+
+    int fd;
+    while ((fd = accept(server->listener, NULL, NULL)) >= 0) {
+        StatusClient_t* slot = NULL;
+        for (uint32_t i = 0; i < STATUS_HTTP_MAX_CLIENTS && slot == NULL; i++) {
+            slot = server->clients[i].state == STATUS_CLIENT_FREE ? &server->clients[i] : NULL;
+        }
+        if (slot == NULL) {
+            server->stats.rejected++;
+            close(fd);
+            continue;
+        }
+        set_nonblocking(fd);
+        slot->fd = fd;
+        slot->state = STATUS_CLIENT_REQUEST;
+        slot->opened_ms = now_ms;
+        slot->request_length = 0;
+        server->stats.clients++;
+    }
+
+    for (uint32_t i = 0; i < STATUS_HTTP_MAX_CLIENTS; i++) {
+        StatusClient_t* client = &server->clients[i];
+        if (client->state == STATUS_CLIENT_FREE || !read_client(server, client)) {
+            continue;
+        }
+        if (client->state == STATUS_CLIENT_REQUEST) {
+            if (now_ms - client->opened_ms > STATUS_HTTP_REQUEST_TIMEOUT_MS) {
+                server->stats.rejected++;
+                close_client(server, client);
+            }
+            continue;
+        }
+        write_client(server, client);
+    }
+}
+
+char* status_http_begin(StatusHttp_t* server, uint32_t* capacity) {
+    for (uint32_t i = 0; i < STATUS_HTTP_MAX_CLIENTS; i++) {
+        StatusClient_t* client = &server->clients[i];
+        bool behind = client->head_sent < client->head_length || client->body_sent < client->body_length;
+        if (client->state != STATUS_CLIENT_FREE && client->state != STATUS_CLIENT_REQUEST &&
+            client->body_is_frame && behind) {
+            server->stats.dropped_slow++;
+            close_client(server, client);
+        }
+    }
+    *capacity = STATUS_HTTP_FRAME_MAX - SSE_PREFIX_LENGTH - SSE_SUFFIX_LENGTH;
+    return server->frame + SSE_PREFIX_LENGTH;
+}
+
+void status_http_commit(StatusHttp_t* server, uint32_t length) {
+    uint32_t capacity = STATUS_HTTP_FRAME_MAX - SSE_PREFIX_LENGTH - SSE_SUFFIX_LENGTH;
+    length = length < capacity ? length : capacity;
+    memcpy(server->frame + SSE_PREFIX_LENGTH + length, "\n\n", SSE_SUFFIX_LENGTH);
+    server->json_length = length;
+    server->stats.frames++;
+
+    for (uint32_t i = 0; i < STATUS_HTTP_MAX_CLIENTS; i++) {
+        StatusClient_t* client = &server->clients[i];
+        if (client->state == STATUS_CLIENT_STREAM) {
+            client->body = server->frame;
+            client->body_length = SSE_PREFIX_LENGTH + length + SSE_SUFFIX_LENGTH;
+            client->body_sent = 0;
+            write_client(server, client);
+        }
+    }
+}
+
+void status_http_close(StatusHttp_t* server) {
+    for (uint32_t i = 0; i < STATUS_HTTP_MAX_CLIENTS; i++) {
+        if (server->clients[i].state != STATUS_CLIENT_FREE) {
+            close_client(server, &server->clients[i]);
+        }
+    }
+    if (server->listener >= 0) {
+        close(server->listener);
+        server->listener = -1;
+    }
+}
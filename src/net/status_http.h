@@ -0,0 +1,84 @@
+#ifndef STATUS_HTTP_H
+#define STATUS_HTTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Minimal HTTP/1.1 status server on non-blocking sockets, for a browser on
+// the bench. GET /metrics answers with the latest JSON snapshot, GET /stream
+// is a Server-Sent Events stream of every snapshot after it, and GET / serves
+// index_html. The snapshot is formatted once per update, straight into one
+// shared frame, and every client is written from that frame, so the cost
+// per update does not grow with the client count. A client that has not
+// taken the whole previous frame when the next is published is dropped: no
+// client is ever waited for, and none holds a copy.
+//
+// Single-threaded: call status_http_poll often, and begin/commit from the
+// same thread.
+#define STATUS_HTTP_MAX_CLIENTS     8
+#define STATUS_HTTP_FRAME_MAX       8192    // JSON snapshot, SSE framing included
+#define STATUS_HTTP_REQUEST_MAX     1024
+#define STATUS_HTTP_HEAD_MAX        192     // Per-client response header
+#define STATUS_HTTP_REQUEST_TIMEOUT_MS 5000 // A request not complete by then is dropped
+
+typedef enum {
+    STATUS_CLIENT_FREE,
+    STATUS_CLIENT_REQUEST,      // Reading the request
+    STATUS_CLIENT_RESPONSE,     // One reply, then close
+    STATUS_CLIENT_STREAM        // SSE: every frame until it disconnects
+} StatusClientState_t;
+
+typedef struct {
+    int fd;
+    StatusClientState_t state;
+    uint32_t opened_ms;
+    char request[STATUS_HTTP_REQUEST_MAX];
+    uint32_t request_length;
+    char head[STATUS_HTTP_HEAD_MAX];    // Status line and headers
+    uint32_t head_length;
+    uint32_t head_sent;
+    const char* body;           // The shared frame, index_html or an error text
+    uint32_t body_length;
+    uint32_t body_sent;
+    bool body_is_frame;         // Invalidated by the next frame
+} StatusClient_t;
+
+typedef struct {
+    uint32_t requests;          // Complete requests parsed
+    uint32_t snapshots;         // GET /metrics answered
+    uint32_t streams;           // GET /stream accepted
+    uint32_t frames;            // Snapshots committed
+    uint32_t not_found;
+    uint32_t rejected;          // No free client slot, oversized or timed-out request
+    uint32_t dropped_slow;      // Still behind on the previous frame
+    uint32_t disconnects;       // Closed by the client or by a send error
+    uint32_t clients;           // Connected now
+    uint64_t bytes_sent;
+} StatusHttpStats_t;
+
+typedef struct {
+    int listener;               // -1 when not open
+    StatusClient_t clients[STATUS_HTTP_MAX_CLIENTS];
+    // "data: " JSON "\n\n"; /metrics sends the JSON alone
+    char frame[STATUS_HTTP_FRAME_MAX];
+    uint32_t json_length;       // 0 until the first commit
+    const char* index_html;     // Page for GET /, NULL for 404
+    StatusHttpStats_t stats;
+} StatusHttp_t;
+
+// Listen on 127.0.0.1:port. Returns false if the port cannot be bound.
+bool status_http_open(StatusHttp_t* server, uint16_t port, const char* index_html);
+
+// Accept, read requests and write what the sockets take; never blocks
+void status_http_poll(StatusHttp_t* server, uint32_t now_ms);
+
+// Where to format the next snapshot (capacity bytes). Drops the clients still
+// sending the current one, whose bytes are about to be overwritten.
+char* status_http_begin(StatusHttp_t* server, uint32_t* capacity);
+
+// Publish the length bytes formatted at status_http_begin to every client
+void status_http_commit(StatusHttp_t* server, uint32_t length);
+
+void status_http_close(StatusHttp_t* server);
+
+#endif // STATUS_HTTP_H
@@ -0,0 +1,305 @@
+/**
+ * Transport - Sliding window, selective acknowledgement and adaptive timeouts
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "transport.h"
+
+// Data frame: 'D', flags, payload length (16), sequence (32), sender base (32)
+// Ack frame:  'A', 0, next expected sequence (32), held bitmap (32)
+#define FRAME_DATA  'D'
+#define FRAME_ACK   'A'
+
+static void put_u16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_u16(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Sequence comparison that survives wraparound
+static int32_t seq_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+void transport_sender_init(TransportSender_t* tx, TransportOutput_t output,
+                           TransportRelease_t release, void* context) {
+    memset(tx, 0, sizeof(*tx));
+    tx->rto_ms = TRANSPORT_RTO_INITIAL_MS;
+    tx->output = output;
+    tx->release = release;
+    tx->context = context;
+}
+
+uint32_t transport_in_flight(const TransportSender_t* tx) {
+    return tx->next_seq - tx->base;
+}
+
+bool transport_can_send(const TransportSender_t* tx) {
+    return transport_in_flight(tx) < TRANSPORT_WINDOW;
+}
+
+static TransportSlot_t* slot_of(TransportSender_t* tx, uint32_t seq) {
+    return &tx->slots[seq % TRANSPORT_WINDOW];
+}
+
+// (Re)send a frame; the header carries the current base so the receiver
+// can skip gaps the sender has given up on
+static void output_frame(TransportSender_t* tx, TransportSlot_t* slot, uint32_t now_ms) {
+    put_u32(slot->frame + 8, tx->base);
+    slot->sent_ms = now_ms;
+    tx->output(tx->context, slot->frame, slot->length);
+}
+
+// RFC 6298: smoothed round trip and its variation set the timeout
+static void rtt_sample(TransportSender_t* tx, uint32_t rtt_ms) {
+    float r = (float)rtt_ms;
+    if (!tx->rtt_valid) {
+        tx->srtt_ms = r;
+        tx->rttvar_ms = r / 2.0f;
+        tx->rtt_valid = true;
+    } else {
+        float err = tx->srtt_ms > r ? tx->srtt_ms - r : r - tx->srtt_ms;
+        tx->rttvar_ms = 0.75f * tx->rttvar_ms + 0.25f * err;
+        tx->srtt_ms = 0.875f * tx->srtt_ms + 0.125f * r;
+    }
+    float rto = tx->srtt_ms + (4.0f * tx->rttvar_ms > 1.0f ? 4.0f * tx->rttvar_ms : 1.0f);
+    if (rto < TRANSPORT_RTO_MIN_MS) {
+        rto = TRANSPORT_RTO_MIN_MS;
+    } else if (rto > TRANSPORT_RTO_MAX_MS) {
+        rto = TRANSPORT_RTO_MAX_MS;
+    }
+    tx->rto_ms = (uint32_t)rto;
+}
+
+// Hand a frame back and free its slot
+static void release_slot(TransportSender_t* tx, TransportSlot_t* slot, bool delivered, uint32_t now_ms) {
+    uint8_t* frame = slot->frame;
+    if (delivered) {
+        // Karn's rule: a resent frame's ack could belong to either copy. The
+        // latest-sent frame known delivered is kept for loss detection by time.
+        if (slot->retries == 0) {
+            rtt_sample(tx, now_ms - slot->sent_ms);
+            if (!tx->rack_valid || (int32_t)(slot->sent_ms - tx->rack_sent_ms) > 0) {
+                tx->rack_sent_ms = slot->sent_ms;
+                tx->rack_rtt_ms = now_ms - slot->sent_ms;
+                tx->rack_valid = true;
+            }
+        }
+        tx->stats.frames_acked++;
+        tx->stats.payload_acked += slot->length - TRANSPORT_HEADER_SIZE;
+    } else {
+        tx->stats.frames_abandoned++;
+    }
+    slot->frame = NULL;
+    tx->release(tx->context, frame, delivered);
+}
+
+// Advance base past the released frames
+static void slide(TransportSender_t* tx) {
+    while (tx->base != tx->next_seq && slot_of(tx, tx->base)->frame == NULL) {
+        tx->base++;
+    }
+}
+
+// A frame sent before one that was delivered is lost, not late, once it has
+// had that frame's round trip plus a reordering allowance. Returns the time
+// until the next such frame is due, TRANSPORT_NO_TIMER if none.
+static uint32_t reorder_deadline(const TransportSender_t* tx, const TransportSlot_t* slot,
+                                 uint32_t now_ms) {
+    if (!tx->rack_valid || slot->frame == NULL || (int32_t)(tx->rack_sent_ms - slot->sent_ms) <= 0) {
+        return TRANSPORT_NO_TIMER;
+    }
+    uint32_t wait = tx->rack_rtt_ms + (uint32_t)(tx->srtt_ms * TRANSPORT_REORDER_FRACTION);
+    uint32_t elapsed = now_ms - slot->sent_ms;
+    return elapsed < wait ? wait - elapsed : 0;
+}
+
+// Selective early resend of the frames reorder_deadline finds lost. A resend
+// is newer than every acked frame, so it is not resent early again until a
+// frame sent after it is acked.
+static void resend_lost(TransportSender_t* tx, uint32_t now_ms) {
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        TransportSlot_t* slot = slot_of(tx, seq);
+        if (reorder_deadline(tx, slot, now_ms) == 0) {
+            slot->retries++;
+            tx->stats.retransmits++;
+            tx->stats.fast_retransmits++;
+            output_frame(tx, slot, now_ms);
+        }
+    }
+}
+
+bool transport_send(TransportSender_t* tx, uint8_t* frame, uint32_t payload_length, uint32_t now_ms) {
+    if (!transport_can_send(tx) || payload_length > 0xFFFF) {
+        return false;
+    }
+    uint32_t seq = tx->next_seq++;
+    TransportSlot_t* slot = slot_of(tx, seq);
+    frame[0] = FRAME_DATA;
+    frame[1] = 0;
+    put_u16(frame + 2, payload_length);
+    put_u32(frame + 4, seq);
+    slot->frame = frame;
+    slot->length = TRANSPORT_HEADER_SIZE + payload_length;
+    slot->retries = 0;
+    tx->stats.frames_sent++;
+    output_frame(tx, slot, now_ms);
+    return true;
+}
+
+void transport_on_ack(TransportSender_t* tx, const uint8_t* ack, uint32_t length, uint32_t now_ms) {
+    if (length < TRANSPORT_ACK_SIZE || ack[0] != FRAME_ACK) {
+        return;
+    }
+    uint32_t expected = get_u32(ack + 2);
+    uint32_t held = get_u32(ack + 6);
+
+    // An ack from before an abort, or for frames never sent, is stale
+    if (seq_diff(expected, tx->next_seq) > 0) {
+        return;
+    }
+
+    // Everything below expected arrived, as did each frame in the bitmap
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        TransportSlot_t* slot = slot_of(tx, seq);
+        if (slot->frame == NULL) {
+            continue;
+        }
+        int32_t ahead = seq_diff(seq, expected);
+        if (ahead < 0 || (ahead > 0 && ahead <= 32 && (held & (1u << (ahead - 1))))) {
+            release_slot(tx, slot, true, now_ms);
+        }
+    }
+    slide(tx);
+
+    resend_lost(tx, now_ms);
+}
+
+uint32_t transport_poll(TransportSender_t* tx, uint32_t now_ms) {
+    resend_lost(tx, now_ms);
+
+    bool expired = false;
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        TransportSlot_t* slot = slot_of(tx, seq);
+        if (slot->frame == NULL || now_ms - slot->sent_ms < tx->rto_ms) {
+            continue;
+        }
+        if (slot->retries >= TRANSPORT_MAX_RETRIES) {
+            release_slot(tx, slot, false, now_ms);
+            continue;
+        }
+        slot->retries++;
+        tx->stats.retransmits++;
+        output_frame(tx, slot, now_ms);
+        expired = true;
+    }
+    slide(tx);
+
+    // Back off once per expiry, not once per frame
+    if (expired) {
+        tx->rto_ms = tx->rto_ms * 2 < TRANSPORT_RTO_MAX_MS ? tx->rto_ms * 2 : TRANSPORT_RTO_MAX_MS;
+    }
+
+    uint32_t next = TRANSPORT_NO_TIMER;
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        TransportSlot_t* slot = slot_of(tx, seq);
+        if (slot->frame != NULL) {
+            uint32_t elapsed = now_ms - slot->sent_ms;
+            uint32_t left = elapsed < tx->rto_ms ? tx->rto_ms - elapsed : 0;
+            uint32_t reorder = reorder_deadline(tx, slot, now_ms);
+            if (reorder < left) {
+                left = reorder;
+            }
+            if (left < next) {
+                next = left;
+            }
+        }
+    }
+    return next;
+}
+
+void transport_abort(TransportSender_t* tx) {
+    for (uint32_t seq = tx->base; seq != tx->next_seq; seq++) {
+        TransportSlot_t* slot = slot_of(tx, seq);
+        if (slot->frame != NULL) {
+            release_slot(tx, slot, false, 0);
+        }
+    }
+    tx->base = tx->next_seq;
+    tx->rto_ms = TRANSPORT_RTO_INITIAL_MS;
+    tx->rtt_valid = false;
+    tx->rack_valid = false;
+}
+
+void transport_receiver_init(TransportReceiver_t* rx) {
+    memset(rx, 0, sizeof(*rx));
+}
+
+// Move past expected; returns whether the new expected had already arrived
+static bool receiver_step(TransportReceiver_t* rx) {
+    bool arrived = (rx->held & 1u) != 0;
+    rx->held >>= 1;
+    rx->expected++;
+    return arrived;
+}
+
+uint32_t transport_receive(TransportReceiver_t* rx, const uint8_t* frame, uint32_t length,
+                           uint8_t* ack, const uint8_t** payload, uint32_t* payload_length) {
+    *payload = NULL;
+    *payload_length = 0;
+    if (length < TRANSPORT_HEADER_SIZE || frame[0] != FRAME_DATA ||
+        get_u16(frame + 2) != length - TRANSPORT_HEADER_SIZE) {
+        return 0;
+    }
+    uint32_t seq = get_u32(frame + 4);
+    uint32_t base = get_u32(frame + 8);
+
+    // The sender gave up on everything below its base; stop waiting for it
+    while (seq_diff(base, rx->expected) > 0) {
+        rx->skipped++;
+        while (receiver_step(rx)) {
+        }
+    }
+
+    int32_t ahead = seq_diff(seq, rx->expected);
+    bool fresh = false;
+    if (ahead == 0) {
+        fresh = true;
+        while (receiver_step(rx)) {
+        }
+    } else if (ahead > 0 && ahead <= 32 && !(rx->held & (1u << (ahead - 1)))) {
+        fresh = true;
+        rx->held |= 1u << (ahead - 1);
+        rx->out_of_order++;
+    } else if (ahead <= 32) {
+        rx->duplicates++;
+    }
+    // Beyond the bitmap: not acked, so the sender resends it later
+
+    if (fresh) {
+        rx->delivered++;
+        *payload = frame + TRANSPORT_HEADER_SIZE;
+        *payload_length = length - TRANSPORT_HEADER_SIZE;
+    }
+
+    ack[0] = FRAME_ACK;
+    ack[1] = 0;
+    put_u32(ack + 2, rx->expected);
+    put_u32(ack + 6, rx->held);
+    return TRANSPORT_ACK_SIZE;
+}
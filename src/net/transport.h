@@ -0,0 +1,108 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sequenced frames over a lossy datagram link. The sender keeps up to
+// TRANSPORT_WINDOW unacknowledged frames in caller-owned buffers, and the
+// receiver acknowledges cumulatively plus a bitmap of the out-of-order frames
+// it holds, so only the frames that were lost are resent: early, once a later
+// frame is known delivered (time-based, as RACK), or when the retransmission
+// timeout, which follows the measured round trip (RFC 6298, Karn's rule), expires.
+#define TRANSPORT_WINDOW            16      // Frames in flight (at most 32, the SACK bitmap)
+#define TRANSPORT_HEADER_SIZE       12      // Reserved at the start of every data frame
+#define TRANSPORT_ACK_SIZE          10
+#define TRANSPORT_RTO_INITIAL_MS    1000
+#define TRANSPORT_RTO_MIN_MS        50
+#define TRANSPORT_RTO_MAX_MS        8000
+#define TRANSPORT_MAX_RETRIES       6       // Then the frame is abandoned
+#define TRANSPORT_REORDER_FRACTION  0.25f   // Of the round trip, allowed for reordering
+#define TRANSPORT_NO_TIMER          UINT32_MAX
+
+// Sends a frame on the link. It must not call back into the transport: an
+// ack that comes back at once is kept and passed to transport_on_ack afterwards.
+typedef void (*TransportOutput_t)(void* context, const uint8_t* frame, uint32_t length);
+// Hands a frame buffer back: acknowledged, or abandoned after the last retry
+typedef void (*TransportRelease_t)(void* context, uint8_t* frame, bool delivered);
+
+typedef struct {
+    uint8_t* frame;         // NULL when the slot is free
+    uint32_t length;        // Header included
+    uint32_t sent_ms;       // Latest (re)transmission
+    uint8_t retries;
+} TransportSlot_t;
+
+typedef struct {
+    uint32_t frames_sent;       // New frames
+    uint32_t retransmits;       // Timeouts and early resends
+    uint32_t fast_retransmits;  // Resent before their timeout, a later frame being acked
+    uint32_t frames_acked;
+    uint32_t frames_abandoned;
+    uint32_t payload_acked;     // Bytes, headers excluded
+} TransportStats_t;
+
+typedef struct {
+    // Indexed by sequence % TRANSPORT_WINDOW. A frame the receiver holds,
+    // even out of order, is released at once; base waits for the oldest gap.
+    TransportSlot_t slots[TRANSPORT_WINDOW];
+    uint32_t base;              // Oldest sequence not yet released
+    uint32_t next_seq;
+
+    // Round trip estimate, milliseconds
+    float srtt_ms;
+    float rttvar_ms;
+    uint32_t rto_ms;
+    bool rtt_valid;
+
+    // Most recently sent frame known delivered and its round trip
+    uint32_t rack_sent_ms;
+    uint32_t rack_rtt_ms;
+    bool rack_valid;
+
+    TransportOutput_t output;
+    TransportRelease_t release;
+    void* context;
+    TransportStats_t stats;
+} TransportSender_t;
+
+typedef struct {
+    uint32_t expected;          // Next in-order sequence
+    uint32_t held;              // Bit i: expected + 1 + i arrived
+    uint32_t delivered;         // New frames passed up
+    uint32_t duplicates;
+    uint32_t out_of_order;      // Arrived ahead of a gap
+    uint32_t skipped;           // Gaps the sender abandoned
+} TransportReceiver_t;
+
+void transport_sender_init(TransportSender_t* tx, TransportOutput_t output,
+                           TransportRelease_t release, void* context);
+
+bool transport_can_send(const TransportSender_t* tx);
+uint32_t transport_in_flight(const TransportSender_t* tx);
+
+// Send frame[TRANSPORT_HEADER_SIZE..] (payload_length bytes). The buffer stays
+// with the transport until it is released. Returns false, leaving the buffer
+// with the caller, when the window is full.
+bool transport_send(TransportSender_t* tx, uint8_t* frame, uint32_t payload_length, uint32_t now_ms);
+
+// Process an acknowledgement from the receiver
+void transport_on_ack(TransportSender_t* tx, const uint8_t* ack, uint32_t length, uint32_t now_ms);
+
+// Resend the frames whose timeout has passed. Returns the milliseconds until
+// the next timeout, TRANSPORT_NO_TIMER with nothing in flight.
+uint32_t transport_poll(TransportSender_t* tx, uint32_t now_ms);
+
+// Release every frame in flight as not delivered (link reset)
+void transport_abort(TransportSender_t* tx);
+
+void transport_receiver_init(TransportReceiver_t* rx);
+
+// Take a data frame and write the acknowledgement to send back into ack
+// (TRANSPORT_ACK_SIZE bytes). Returns the acknowledgement length, 0 for a
+// malformed frame. *payload is the frame's payload when it is new, NULL for a
+// duplicate. Payloads are passed up in arrival order, not sequence order.
+uint32_t transport_receive(TransportReceiver_t* rx, const uint8_t* frame, uint32_t length,
+                           uint8_t* ack, const uint8_t** payload, uint32_t* payload_length);
+
+#endif // TRANSPORT_H
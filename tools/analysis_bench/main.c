@@ -0,0 +1,1118 @@
+/**
+ * Analysis Bench - Equivalence and cost comparison of analysis code paths
+ *
+ * Runs the float and Q15 fixed-point 3-sigma detectors side by side over the
+ * same samples, reports how often their verdicts agree and how far their
+ * health penalties drift apart, then times each path per sample. Also
+ * measures the vibration decimator's frequency response and cost, checks
+ * that the envelope stage finds a seeded bearing defect within its budget, and
+ * that order tracking recovers rotor-locked orders while the speed wanders,
+ * that the single-pass feature extractor matches a two-pass reference, that
+ * the trend estimator recovers a slow ramp at every time scale, that the
+ * rollup tiers match a direct recomputation of each bucket, and how much
+ * uplink report-by-exception telemetry saves.
+ *
+ * Usage: analysis_bench [-n samples] [-s seed] [-r repeats] [-a min_agreement]
+ *                       [trace.csv]
+ *   -n N   Synthetic samples when no trace is given (default 200000)
+ *   -s N   Seed for the synthetic signal (default 1)
+ *   -r N   Timing repetitions, best run is reported (default 5)
+ *   -a P   Fail (exit 1) if flag agreement drops below P percent (default 99)
+ *
+ * Every section also has its own pass limits; the bench exits 1 if any is
+ * missed, naming it on stderr.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "anomaly_engine.h"
+#include "decimator.h"
+#include "detector.h"
+#include "envelope.h"
+#include "exception_report.h"
+#include "feature_extractor.h"
+#include "mahalanobis.h"
+#include "order_tracker.h"
+#include "rollup.h"
+#include "trace.h"
+#include "trend.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER 1
+static inline uint64_t read_cycles(void) { return __rdtsc(); }
+#else
+#define HAVE_CYCLE_COUNTER 0
+static inline uint64_t read_cycles(void) { return 0; }
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Synthetic signal shaped like the sensor task: slow drift, noise, injected spikes
+static SensorData_t* generate_samples(uint32_t count, uint32_t seed) {
+    SensorData_t* samples = malloc(count * sizeof(SensorData_t));
+    if (samples == NULL) {
+        return NULL;
+    }
+
+    srand(seed);
+    float vibration = 2.5f;
+    float temperature = 45.0f;
+    float target_vibration = 2.5f;
+    float target_temperature = 45.0f;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (i % 50 == 0 && rand() % 100 < 30) {
+            target_vibration = 1.0f + (float)(rand() % 80) / 10.0f;
+            target_temperature = 40.0f + (float)(rand() % 400) / 10.0f;
+        }
+        vibration += (target_vibration - vibration) * 0.02f;
+        temperature += (target_temperature - temperature) * 0.01f;
+
+        float spike = (i % 50 == 0 && rand() % 100 < 40) ? 3.0f : 0.0f;
+        float rpm = 15.0f + (sinf(i * 0.01f) * 0.5f + 0.5f) * 10.0f;
+
+        samples[i].vibration = vibration + spike + ((rand() % 1000) / 1000.0f - 0.5f);
+        samples[i].temperature = temperature + ((rand() % 1000) / 1000.0f - 0.5f) * 0.2f;
+        samples[i].rpm = rpm + ((rand() % 1000) / 1000.0f - 0.5f);
+        samples[i].current = 40.0f + rpm * 2.0f + ((rand() % 1000) / 1000.0f - 0.5f) * 4.0f;
+        samples[i].timestamp = i * 100;
+
+        // Channels without a model above hover around their nominal value
+        for (uint32_t ch = CHANNEL_CURRENT + 1; ch < CHANNEL_COUNT; ch++) {
+            samples[i].values[ch] = sensor_channels[ch].nominal *
+                                    (1.0f + ((rand() % 1000) / 1000.0f - 0.5f) * 0.02f);
+        }
+    }
+    return samples;
+}
+
+static SensorData_t* load_trace(const char* path, uint32_t* count) {
+    TraceReader_t reader;
+    if (!trace_reader_open(&reader, path)) {
+        return NULL;
+    }
+
+    uint32_t capacity = 65536;
+    SensorData_t* samples = malloc(capacity * sizeof(SensorData_t));
+    *count = 0;
+
+    while (samples != NULL && trace_reader_next(&reader, &samples[*count])) {
+        if (++(*count) == capacity) {
+            capacity *= 2;
+            SensorData_t* grown = realloc(samples, capacity * sizeof(SensorData_t));
+            if (grown == NULL) {
+                free(samples);
+                samples = NULL;
+            }
+            samples = grown;
+        }
+    }
+
+    trace_reader_close(&reader);
+    return samples;
+}
+
+// Float vs Q15: evaluate after every sample and compare the verdicts
+static double compare_detectors(const SensorData_t* samples, uint32_t count,
+                                const ThresholdConfig_t* thresholds) {
+    static DetectorRegistry_t reference;
+    static DetectorRegistry_t fixed;
+    uint32_t channel_mismatch[CHANNEL_COUNT] = {0};
+    uint32_t cycles_agree = 0;
+    double health_diff_sum = 0.0;
+    float health_diff_max = 0.0f;
+
+    detector_registry_init(&reference, NULL);
+    detector_registry_init(&fixed, NULL);
+    detector_registry_add(&reference, &sigma_detector_ops, 1.0f, true);
+    detector_registry_add(&fixed, &sigma_q15_detector_ops, 1.0f, true);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t ref_flags = 0;
+        uint32_t fix_flags = 0;
+
+        detector_registry_update(&reference, &samples[i]);
+        detector_registry_update(&fixed, &samples[i]);
+        float ref_health = detector_registry_evaluate(&reference, thresholds, &ref_flags);
+        float fix_health = detector_registry_evaluate(&fixed, thresholds, &fix_flags);
+
+        // The fixed build's sigma3q15 also covers the Mahalanobis channels
+        uint32_t diff = (ref_flags ^ fix_flags) & sensor_channel_mask(DETECTOR_SET_SIGMA);
+        if (diff == 0) {
+            cycles_agree++;
+        }
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            if (diff & CHANNEL_FLAG(ch)) channel_mismatch[ch]++;
+        }
+
+        float health_diff = fabsf(ref_health - fix_health);
+        health_diff_sum += health_diff;
+        if (health_diff > health_diff_max) {
+            health_diff_max = health_diff;
+        }
+    }
+
+    double agreement = count > 0 ? 100.0 * cycles_agree / count : 100.0;
+    printf("equivalence (float vs q15):\n");
+    printf("  flags agree %.3f%% of %u cycles | mismatches", agreement, count);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (sensor_channels[ch].detectors & DETECTOR_SET_SIGMA) {
+            printf(" %s:%u", sensor_channels[ch].name, channel_mismatch[ch]);
+        }
+    }
+    printf("\n");
+    printf("  health difference max %.3f mean %.4f points\n",
+           health_diff_max, count > 0 ? health_diff_sum / count : 0.0);
+    return agreement;
+}
+
+// Share of cycles in which a detector raised mask, over fault and clean cycles
+static void flag_rates(const DetectorOps_t* ops, const SensorData_t* samples, const bool* fault,
+                       uint32_t count, const ThresholdConfig_t* thresholds, uint32_t mask,
+                       double* fault_pct, double* clean_pct) {
+    static DetectorRegistry_t reg;
+    uint32_t fault_cycles = 0, fault_hits = 0, clean_cycles = 0, clean_hits = 0;
+
+    detector_registry_init(&reg, NULL);
+    detector_registry_add(&reg, ops, 1.0f, true);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t flags = 0;
+        detector_registry_update(&reg, &samples[i]);
+        detector_registry_evaluate(&reg, thresholds, &flags);
+        if (fault[i]) {
+            fault_cycles++;
+            fault_hits += (flags & mask) != 0;
+        } else {
+            clean_cycles++;
+            clean_hits += (flags & mask) != 0;
+        }
+    }
+    *fault_pct = fault_cycles > 0 ? 100.0 * fault_hits / fault_cycles : 0.0;
+    *clean_pct = clean_cycles > 0 ? 100.0 * clean_hits / clean_cycles : 0.0;
+}
+
+// Small dense inverse by Gauss-Jordan with partial pivoting (reference only)
+static void invert(double a[MAHALANOBIS_MAX_DIM][MAHALANOBIS_MAX_DIM], uint32_t d,
+                   double inv[MAHALANOBIS_MAX_DIM][MAHALANOBIS_MAX_DIM]) {
+    for (uint32_t i = 0; i < d; i++) {
+        for (uint32_t j = 0; j < d; j++) {
+            inv[i][j] = i == j ? 1.0 : 0.0;
+        }
+    }
+    for (uint32_t c = 0; c < d; c++) {
+        uint32_t pivot = c;
+        for (uint32_t r = c + 1; r < d; r++) {
+            if (fabs(a[r][c]) > fabs(a[pivot][c])) pivot = r;
+        }
+        for (uint32_t j = 0; j < d; j++) {
+            double t = a[c][j]; a[c][j] = a[pivot][j]; a[pivot][j] = t;
+            t = inv[c][j]; inv[c][j] = inv[pivot][j]; inv[pivot][j] = t;
+        }
+        double scale = 1.0 / a[c][c];
+        for (uint32_t j = 0; j < d; j++) {
+            a[c][j] *= scale;
+            inv[c][j] *= scale;
+        }
+        for (uint32_t r = 0; r < d; r++) {
+            if (r != c) {
+                double f = a[r][c];
+                for (uint32_t j = 0; j < d; j++) {
+                    a[r][j] -= f * a[c][j];
+                    inv[r][j] -= f * inv[c][j];
+                }
+            }
+        }
+    }
+}
+
+// Coupling fault the per-channel rules cannot see, and drift of the
+// Sherman-Morrison inverse against a refactorized double-precision covariance.
+// Cold start: the fault is there from the first sample after BASELINE_WINDOW,
+// with no warm-up beforehand. Returns false if either fault is missed, clean
+// cycles are flagged, or the inverse drifts. A cold model has learned its
+// covariance from 2s of data, so it flags clean cycles for a while after the
+// fault as the RPM wanders beyond what it has seen; it gets a looser limit.
+static bool bench_mahalanobis(const SensorData_t* samples, uint32_t count,
+                              const ThresholdConfig_t* thresholds) {
+    const float offset = 8.0f;                  // Amps, inside every current limit
+    const uint32_t every = 2000, length = 50;   // 5s of fault every 200s
+    const double min_fault_pct = 90.0;
+    const double max_clean_pct = 1.0, max_cold_clean_pct = 15.0;
+    const double max_drift = 1e-2;
+    SensorData_t* faulty = malloc(count * sizeof(SensorData_t));
+    bool* fault = malloc(count * sizeof(bool));
+    if (faulty == NULL || fault == NULL || count < every) {
+        free(faulty);
+        free(fault);
+        return true;
+    }
+
+    // Cold start: the first fault as soon as the baseline window has passed
+    for (uint32_t i = 0; i < every; i++) {
+        faulty[i] = samples[i];
+        fault[i] = i >= BASELINE_WINDOW && i < BASELINE_WINDOW + length;
+        if (fault[i]) {
+            faulty[i].current += offset;
+        }
+    }
+    double cold_fault, cold_clean;
+    flag_rates(&mahalanobis_detector_ops, faulty, fault, every, thresholds,
+               CHANNEL_FLAG(CHANNEL_CURRENT), &cold_fault, &cold_clean);
+
+    // Inject after the baseline has formed
+    for (uint32_t i = 0; i < count; i++) {
+        faulty[i] = samples[i];
+        fault[i] = i >= every / 2 && i % every < length;
+        if (fault[i]) {
+            faulty[i].current += offset;
+        }
+    }
+
+    double mahal_fault, mahal_clean, sigma_fault, sigma_clean, q15_fault, q15_clean;
+    flag_rates(&mahalanobis_detector_ops, faulty, fault, count, thresholds,
+               CHANNEL_FLAG(CHANNEL_CURRENT), &mahal_fault, &mahal_clean);
+    flag_rates(&sigma_detector_ops, faulty, fault, count, thresholds,
+               CHANNEL_FLAG(CHANNEL_CURRENT), &sigma_fault, &sigma_clean);
+    flag_rates(&sigma_q15_detector_ops, faulty, fault, count, thresholds,
+               CHANNEL_FLAG(CHANNEL_CURRENT), &q15_fault, &q15_clean);
+    free(faulty);
+    free(fault);
+
+    // Same recursion in double, inverting the covariance from scratch every sample
+    const uint32_t window = 500;
+    const float gate = 13.82f;                  // Chi-square p = 0.999, 2 dof
+    uint32_t channel[MAHALANOBIS_MAX_DIM];
+    float mean[MAHALANOBIS_MAX_DIM], variance[MAHALANOBIS_MAX_DIM];
+    double ref_mean[MAHALANOBIS_MAX_DIM];
+    double cov[MAHALANOBIS_MAX_DIM][MAHALANOBIS_MAX_DIM] = { { 0 } };
+    uint32_t d = 0;
+    uint32_t mask = sensor_channel_mask(DETECTOR_SET_MAHALANOBIS);
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (mask & CHANNEL_FLAG(ch)) {
+            float sigma = 0.01f * sensor_channels[ch].full_scale;
+            channel[d] = ch;
+            mean[d] = sensor_channels[ch].nominal;
+            variance[d] = sigma * sigma;
+            ref_mean[d] = mean[d];
+            cov[d][d] = variance[d];
+            d++;
+        }
+    }
+    MahalanobisModel_t model;
+    mahalanobis_init(&model, d, mean, variance, window, BASELINE_WINDOW, gate);
+
+    double worst = 0.0;
+    uint32_t n = 0, rejected = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        float x[MAHALANOBIS_MAX_DIM];
+        double delta[MAHALANOBIS_MAX_DIM];
+        double work[MAHALANOBIS_MAX_DIM][MAHALANOBIS_MAX_DIM];
+        double inv[MAHALANOBIS_MAX_DIM][MAHALANOBIS_MAX_DIM];
+        for (uint32_t a = 0; a < d; a++) {
+            x[a] = samples[i].values[channel[a]];
+            delta[a] = x[a] - ref_mean[a];
+            for (uint32_t b = 0; b < d; b++) work[a][b] = cov[a][b];
+        }
+        invert(work, d, inv);
+        double ref = 0.0;
+        for (uint32_t a = 0; a < d; a++) {
+            for (uint32_t b = 0; b < d; b++) ref += delta[a] * inv[a][b] * delta[b];
+        }
+
+        float distance = mahalanobis_update(&model, x, NULL);
+        double error = fabs(distance - ref) / fmax(ref, 1.0);
+        if (error > worst) worst = error;
+
+        if (n == 0) {
+            for (uint32_t a = 0; a < d; a++) ref_mean[a] = x[a];
+            n = 1;
+            continue;
+        }
+        bool outlier = n >= BASELINE_WINDOW && ref > gate;
+        if (outlier && ++rejected < window) {
+            continue;
+        }
+        if (!outlier) rejected = 0;
+        if (n < window - 1) n++;
+        double alpha = 1.0 / (n + 1);
+        for (uint32_t a = 0; a < d; a++) {
+            for (uint32_t b = 0; b < d; b++) {
+                cov[a][b] = (1.0 - alpha) * (cov[a][b] + alpha * delta[a] * delta[b]);
+            }
+            ref_mean[a] += alpha * delta[a];
+        }
+    }
+
+    printf("mahalanobis (%u channels, current +%.0f A for its RPM, %u of every %u cycles):\n",
+           d, offset, length, every);
+    printf("  current flagged: mahalanobis %.1f%% of fault cycles, %.2f%% of clean | "
+           "sigma3 %.1f%% / %.2f%% | sigma3q15 %.1f%% / %.2f%%\n", mahal_fault, mahal_clean,
+           sigma_fault, sigma_clean, q15_fault, q15_clean);
+    printf("  cold start, fault from sample %u: mahalanobis %.1f%% of fault cycles, %.2f%% of clean\n",
+           BASELINE_WINDOW, cold_fault, cold_clean);
+    printf("  distance vs refactorized double reference: max relative error %.1e over %u samples\n",
+           worst, count);
+
+    bool passed = true;
+    if (mahal_fault < min_fault_pct || cold_fault < min_fault_pct) {
+        fprintf(stderr, "analysis_bench: mahalanobis caught %.1f%% of the fault (%.1f%% cold), "
+                        "below %.0f%%\n", mahal_fault, cold_fault, min_fault_pct);
+        passed = false;
+    }
+    if (mahal_clean > max_clean_pct || cold_clean > max_cold_clean_pct) {
+        fprintf(stderr, "analysis_bench: mahalanobis flagged %.2f%% of clean cycles (%.2f%% cold), "
+                        "above %.0f%% (%.0f%% cold)\n", mahal_clean, cold_clean, max_clean_pct,
+                max_cold_clean_pct);
+        passed = false;
+    }
+    if (worst > max_drift) {
+        fprintf(stderr, "analysis_bench: mahalanobis drifted %.1e from the reference, above %.0e\n",
+                worst, max_drift);
+        passed = false;
+    }
+    return passed;
+}
+
+// Best-of-N cost per sample for one detector: update every sample, evaluate
+// once per anomaly cycle (two 10Hz samples per 5Hz cycle, as the task does)
+#define SAMPLES_PER_CYCLE       2
+
+static void time_detector(const DetectorOps_t* ops, const SensorData_t* samples, uint32_t count,
+                          const ThresholdConfig_t* thresholds, uint32_t repeats) {
+    static DetectorRegistry_t reg;
+    double best_s = 0.0;
+    uint64_t best_cycles = 0;
+    volatile uint32_t sink = 0;
+
+    for (uint32_t r = 0; r < repeats; r++) {
+        detector_registry_init(&reg, NULL);
+        detector_registry_add(&reg, ops, 1.0f, true);
+
+        double start = now_seconds();
+        uint64_t start_cycles = read_cycles();
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t flags = 0;
+            detector_registry_update(&reg, &samples[i]);
+            if (i % SAMPLES_PER_CYCLE == SAMPLES_PER_CYCLE - 1) {
+                detector_registry_evaluate(&reg, thresholds, &flags);
+                sink += flags;
+            }
+        }
+        uint64_t cycles = read_cycles() - start_cycles;
+        double elapsed = now_seconds() - start;
+
+        if (r == 0 || elapsed < best_s) {
+            best_s = elapsed;
+            best_cycles = cycles;
+        }
+    }
+    (void)sink;
+
+    printf("  %-12s %8.1f ns/sample", ops->name, best_s * 1e9 / count);
+    if (HAVE_CYCLE_COUNTER) {
+        printf(" %8.0f cycles/sample", (double)best_cycles / count);
+    }
+    printf("  state %zu bytes\n", ops->state_size);
+}
+
+// Gain in dB of a tone through the decimator, measured after the filter settles
+static double decimator_gain_db(uint32_t rate_hz, uint32_t factor, double tone_hz) {
+    static Decimator_t dec;
+    decimator_init(&dec, factor);
+
+    const uint32_t block = 1000;
+    const uint32_t blocks = 40;
+    float in[1000];
+    float out[1000];
+    double peak = 0.0;
+
+    for (uint32_t b = 0; b < blocks; b++) {
+        for (uint32_t i = 0; i < block; i++) {
+            double t = (double)(b * block + i) / rate_hz;
+            in[i] = (float)cos(2.0 * M_PI * tone_hz * t);
+        }
+        uint32_t produced = decimator_push(&dec, in, block, out, block);
+        for (uint32_t i = 0; b >= blocks / 2 && i < produced; i++) {
+            if (fabs(out[i]) > peak) peak = fabs(out[i]);
+        }
+    }
+    return 20.0 * log10(peak > 1e-9 ? peak : 1e-9);
+}
+
+// Passband up to 2Hz within 1dB; from 15Hz, which would alias into 0-5Hz,
+// at least 60dB down
+static bool bench_decimator(uint32_t repeats) {
+    const uint32_t rate_hz = sensor_channels[CHANNEL_VIBRATION].rate_hz;
+    const uint32_t factor = rate_hz / 10;
+    const double tones[] = { 0.0, 2.0, 4.0, 6.0, 15.0, 60.0, 250.0 };
+    const double passband_hz = 2.0, max_passband_loss_db = 1.0;
+    const double stopband_hz = 15.0, min_stopband_db = 60.0;
+
+    Decimator_t dec;
+    if (factor < 2 || !decimator_init(&dec, factor)) {
+        return true;
+    }
+
+    bool passed = true;
+    printf("vibration decimator (%u Hz -> 10 Hz, %u stages):\n", rate_hz, dec.stage_count);
+    printf("  gain");
+    for (uint32_t i = 0; i < sizeof(tones) / sizeof(tones[0]); i++) {
+        double gain = decimator_gain_db(rate_hz, factor, tones[i]);
+        printf(" %gHz:%.1fdB", tones[i], gain);
+        if ((tones[i] <= passband_hz && fabs(gain) > max_passband_loss_db) ||
+            (tones[i] >= stopband_hz && gain > -min_stopband_db)) {
+            fprintf(stderr, "analysis_bench: decimator gain %.1fdB at %gHz out of limits\n",
+                    gain, tones[i]);
+            passed = false;
+        }
+    }
+    printf("\n");
+
+    const uint32_t count = 1000000;
+    float* in = malloc(count * sizeof(float));
+    float out[64];
+    if (in == NULL) {
+        return passed;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        in[i] = 2.5f + ((rand() % 1000) / 1000.0f - 0.5f);
+    }
+
+    double best = 1e30;
+    volatile float sink = 0.0f;
+    for (uint32_t r = 0; r < repeats; r++) {
+        decimator_reset(&dec);
+        double start = now_seconds();
+        for (uint32_t i = 0; i < count; i += 1000) {
+            uint32_t produced = decimator_push(&dec, &in[i], 1000, out, 64);
+            sink += out[produced - 1];
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    (void)sink;
+    free(in);
+
+    printf("  cost %.1f ns/input sample  state %zu bytes\n", best / count * 1e9, sizeof(dec));
+    return passed;
+}
+
+// 1kHz vibration: level plus noise, optionally an outer-race defect modulating
+// a 240Hz resonance at BPFO
+static void synth_vibration(float* out, uint32_t count, float shaft_hz, float fault) {
+    BearingGeometry_t geometry;
+    bearing_geometry_defaults(&geometry);
+    double bpfo = geometry.order[BEARING_BPFO] * shaft_hz;
+
+    for (uint32_t i = 0; i < count; i++) {
+        double t = (double)i / ENVELOPE_INPUT_RATE_HZ;
+        double modulation = 0.5 + 0.5 * cos(2.0 * M_PI * bpfo * t);
+        out[i] = 2.5f + ((rand() % 1000) / 1000.0f - 0.5f) +
+                 (float)(fault * modulation * sin(2.0 * M_PI * 240.0 * t));
+    }
+}
+
+// Healthy: no defect reaches the warning ratio. Faulty: BPFO reaches the alert
+// ratio and nothing else the warning. The FFT period must fit the 200ms cycle.
+static bool bench_envelope(uint32_t repeats) {
+    const float shaft_hz = 20.0f / 60.0f * ENVELOPE_SHAFT_RATIO;    // 20 rpm rotor
+    const uint32_t period = ENVELOPE_INPUT_RATE_HZ / 5;             // Anomaly task, 200ms
+    const uint32_t count = ENVELOPE_INPUT_RATE_HZ * 60;
+    const float faults[] = { 0.0f, 0.3f };
+    const double budget_s = 0.2;
+
+    float* in = malloc(count * sizeof(float));
+    static EnvelopeAnalyzer_t env;
+    BearingGeometry_t geometry;
+    bool passed = true;
+    if (in == NULL) {
+        return true;
+    }
+    bearing_geometry_defaults(&geometry);
+
+    printf("envelope (%u Hz in, %u-point FFT at %.2f Hz/bin, shaft %.2f Hz):\n",
+           ENVELOPE_INPUT_RATE_HZ, ENVELOPE_FFT_SIZE, envelope_bin_hz(), shaft_hz);
+
+    for (uint32_t f = 0; f < sizeof(faults) / sizeof(faults[0]); f++) {
+        synth_vibration(in, count, shaft_hz, faults[f]);
+        envelope_init(&env, &geometry);
+        for (uint32_t i = 0; i < count; i += period) {
+            envelope_push(&env, &in[i], period, shaft_hz);
+        }
+        printf("  %s fault %.1f mm/s:", f == 0 ? "no    " : "outer ", faults[f]);
+        for (uint32_t d = 0; d < BEARING_DEFECT_COUNT; d++) {
+            float ratio = env.result.ratio[d];
+            bool expected = faults[f] > 0.0f && d == BEARING_BPFO;
+            printf(" %s x%.1f", bearing_defect_names[d], ratio);
+            if (expected ? ratio < ENVELOPE_ALERT_RATIO : ratio >= ENVELOPE_WARNING_RATIO) {
+                fprintf(stderr, "analysis_bench: envelope %s x%.1f with %.1f mm/s outer fault\n",
+                        bearing_defect_names[d], ratio, faults[f]);
+                passed = false;
+            }
+        }
+        printf("\n");
+    }
+
+    // Cost per input sample, and the worst 200ms period (the one with an FFT)
+    double best = 1e30;
+    double worst_period = 0.0;
+    for (uint32_t r = 0; r < repeats; r++) {
+        envelope_init(&env, &geometry);
+        double start = now_seconds();
+        for (uint32_t i = 0; i < count; i += period) {
+            double t0 = now_seconds();
+            envelope_push(&env, &in[i], period, shaft_hz);
+            double dt = now_seconds() - t0;
+            if (dt > worst_period) worst_period = dt;
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    free(in);
+
+    printf("  cost %.1f ns/input sample, worst period %.1f us of 200000 us budget, state %zu bytes\n",
+           best / count * 1e9, worst_period * 1e6, sizeof(env));
+    if (worst_period > budget_s) {
+        fprintf(stderr, "analysis_bench: envelope period took %.0f us, over its budget\n",
+                worst_period * 1e6);
+        passed = false;
+    }
+    return passed;
+}
+
+// Two-pass double-precision reference for one block's vibration features
+static void reference_features(const float* x, uint32_t n, double level, double out[FEATURE_COUNT]) {
+    double mean = 0.0, m2 = 0.0, m3 = 0.0, m4 = 0.0, peak = 0.0;
+    uint32_t crossings = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        mean += x[i];
+    }
+    mean /= n;
+    for (uint32_t i = 0; i < n; i++) {
+        double d = x[i] - mean;
+        m2 += d * d;
+        m3 += d * d * d;
+        m4 += d * d * d * d;
+        if (fabs(d) > peak) peak = fabs(d);
+        if (i > 0 && (x[i] < level) != (x[i - 1] < level)) crossings++;
+    }
+    m2 /= n;
+    m3 /= n;
+    m4 /= n;
+
+    out[FEATURE_VIBRATION_MEAN] = mean;
+    out[FEATURE_VIBRATION_RMS] = sqrt(m2);
+    out[FEATURE_VIBRATION_PEAK] = peak;
+    out[FEATURE_CREST_FACTOR] = peak / sqrt(m2);
+    out[FEATURE_SKEWNESS] = m3 / (m2 * sqrt(m2));
+    out[FEATURE_KURTOSIS] = m4 / (m2 * m2);
+    out[FEATURE_ZERO_CROSSING_RATE] = (double)crossings * FEATURE_INPUT_RATE_HZ / n;
+}
+
+// Every feature within 1e-5 of the reference, skewness (near zero, so its
+// relative error is inflated) within 1e-2, crossing counts exact
+static bool bench_features(uint32_t repeats) {
+    const uint32_t period = FEATURE_INPUT_RATE_HZ / 5;              // Anomaly task, 200ms
+    const uint32_t chunk = 40;                                      // Anomaly task drain size
+    const uint32_t count = FEATURE_INPUT_RATE_HZ * 60;
+    const float shaft_hz = 20.0f / 60.0f * ENVELOPE_SHAFT_RATIO;
+    const double max_error = 1e-5, max_skewness_error = 1e-2;
+
+    float* in = malloc(count * sizeof(float));
+    FeatureExtractor_t fx;
+    FeatureVector_t features;
+    SensorData_t reading;
+    double worst[FEATURE_COUNT] = { 0 };
+    if (in == NULL) {
+        return true;
+    }
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        reading.values[ch] = sensor_channels[ch].nominal;
+    }
+
+    // Impulsive signal (seeded bearing defect) so skewness and kurtosis move
+    synth_vibration(in, count, shaft_hz, 0.3f);
+
+    // Arrives in stream-buffer sized chunks; compare each block to the reference.
+    // Crossings are counted against the previous block's mean, the first block
+    // against its first sample, and the first sample of a block against the
+    // last of the previous one, so the reference starts at the second block.
+    feature_extractor_init(&fx);
+    for (uint32_t i = 0; i < count; i += period) {
+        for (uint32_t j = 0; j < period; j += chunk) {
+            feature_accumulate(&fx, &in[i + j], chunk);
+        }
+        float level = fx.reference;
+        feature_finish(&fx, &reading, 0.2f, &features);
+        if (i == 0) {
+            continue;
+        }
+
+        double ref[FEATURE_COUNT];
+        reference_features(&in[i], period, level, ref);
+        if ((in[i] < level) != (in[i - 1] < level)) {
+            ref[FEATURE_ZERO_CROSSING_RATE] += (double)FEATURE_INPUT_RATE_HZ / period;
+        }
+        for (uint32_t f = 0; f <= FEATURE_ZERO_CROSSING_RATE; f++) {
+            double error = fabs(features.values[f] - ref[f]) / fmax(fabs(ref[f]), 1e-6);
+            if (error > worst[f]) worst[f] = error;
+        }
+    }
+
+    double best = 1e30;
+    for (uint32_t r = 0; r < repeats; r++) {
+        feature_extractor_init(&fx);
+        double start = now_seconds();
+        for (uint32_t i = 0; i < count; i += period) {
+            for (uint32_t j = 0; j < period; j += chunk) {
+                feature_accumulate(&fx, &in[i + j], chunk);
+            }
+            feature_finish(&fx, &reading, 0.2f, &features);
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    free(in);
+
+    printf("features (single pass vs two-pass double reference, %u-sample blocks):\n", period);
+    printf("  max relative error");
+    for (uint32_t f = 0; f <= FEATURE_ZERO_CROSSING_RATE; f++) {
+        printf(" %s:%.1e", feature_names[f], worst[f]);
+    }
+    printf("\n  last block");
+    for (uint32_t f = 0; f < FEATURE_COUNT; f++) {
+        printf(" %s:%.3g", feature_names[f], features.values[f]);
+    }
+    printf("\n  cost %.1f ns/input sample, state %zu bytes, no sample buffer\n",
+           best / count * 1e9, sizeof(fx));
+
+    bool passed = true;
+    for (uint32_t f = 0; f <= FEATURE_ZERO_CROSSING_RATE; f++) {
+        double limit = f == FEATURE_ZERO_CROSSING_RATE ? 0.0 :
+                       f == FEATURE_SKEWNESS ? max_skewness_error : max_error;
+        if (worst[f] > limit) {
+            fprintf(stderr, "analysis_bench: feature %s off the reference by %.1e\n",
+                    feature_names[f], worst[f]);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+// Temperature ramp with noise: slope and time to the critical limit per scale.
+// Every scale must recover the slope to within 5% or three standard errors,
+// whichever is wider, and project a crossing.
+static bool bench_trend(uint32_t repeats) {
+    const float rate_hz = 5.0f;                 // Anomaly task cycle
+    const float hours = 48.0f;
+    const float ramp_per_h = 0.25f;
+    const float start = 45.0f, limit = 85.0f;
+    const uint32_t count = (uint32_t)(hours * 3600.0f * rate_hz);
+    TrendEstimator_t trend[TREND_SCALES];
+    bool passed = true;
+
+    float* in = malloc(count * sizeof(float));
+    if (in == NULL) {
+        return true;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        float t_h = i / rate_hz / 3600.0f;
+        in[i] = start + ramp_per_h * t_h + ((rand() % 1000) / 1000.0f - 0.5f);
+    }
+
+    double best = 1e30;
+    for (uint32_t r = 0; r < repeats; r++) {
+        for (uint32_t s = 0; s < TREND_SCALES; s++) {
+            trend_init(&trend[s], trend_time_constant_s[s]);
+        }
+        double t0 = now_seconds();
+        for (uint32_t i = 0; i < count; i++) {
+            for (uint32_t s = 0; s < TREND_SCALES; s++) {
+                trend_update(&trend[s], 1.0f / rate_hz, in[i], -FLT_MAX, limit);
+            }
+        }
+        double elapsed = now_seconds() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+    free(in);
+
+    float level = start + ramp_per_h * hours;
+    printf("trend (%.0fh at %.0f Hz, ramp %.2f/h, limit %.0f reached in %.0f h):\n",
+           hours, rate_hz, ramp_per_h, limit, (limit - level) / ramp_per_h);
+    for (uint32_t s = 0; s < TREND_SCALES; s++) {
+        const TrendResult_t* result = &trend[s].result;
+        printf("  %-8s level %6.2f  slope %+.3f/h +- %.4f  ", trend_scale_names[s],
+               result->level, result->slope_per_h, result->slope_stderr);
+        if (result->hours_to_limit == TREND_NO_CROSSING) {
+            printf("no crossing projected\n");
+        } else {
+            printf("limit in %.0f h\n", result->hours_to_limit);
+        }
+
+        float tolerance = fmaxf(0.05f * ramp_per_h, 3.0f * result->slope_stderr);
+        if (fabsf(result->slope_per_h - ramp_per_h) > tolerance ||
+            result->hours_to_limit == TREND_NO_CROSSING) {
+            fprintf(stderr, "analysis_bench: %s trend slope %+.3f/h for a %.2f/h ramp\n",
+                    trend_scale_names[s], result->slope_per_h, ramp_per_h);
+            passed = false;
+        }
+    }
+    printf("  cost %.1f ns/update, state %zu bytes per scale, no raw history\n",
+           best / count / TREND_SCALES * 1e9, sizeof(TrendEstimator_t));
+    return passed;
+}
+
+// Every closed 1min/1h bucket left in the rings against a double-precision
+// recomputation from the samples in its period. Counts and extremes must match
+// exactly, means to float rounding.
+static bool bench_rollup(const SensorData_t* samples, uint32_t count, uint32_t repeats) {
+    const double max_mean_error = 1e-5;
+    static Rollup_t rollup;
+    bool passed = true;
+
+    double best = 1e30;
+    for (uint32_t r = 0; r < repeats; r++) {
+        rollup_init(&rollup);
+        double t0 = now_seconds();
+        for (uint32_t i = 0; i < count; i++) {
+            rollup_add(&rollup, &samples[i]);
+        }
+        double elapsed = now_seconds() - t0;
+        if (elapsed < best) best = elapsed;
+    }
+
+    printf("rollup (%u samples into 1s/1m/1h tiers, %u buckets kept per tier):\n",
+           count, ROLLUP_RING_LENGTH);
+    for (uint32_t tier = ROLLUP_MINUTE; tier < ROLLUP_TIERS; tier++) {
+        uint32_t checked = 0, extreme_mismatches = 0, count_mismatches = 0;
+        double max_error = 0.0;
+        const RollupBucket_t* bucket;
+
+        for (uint32_t age = 0; (bucket = rollup_bucket(&rollup, tier, age)) != NULL; age++) {
+            uint32_t end_s = bucket->start_s + rollup_period_s[tier];
+            double sum[CHANNEL_COUNT] = {0};
+            float lo[CHANNEL_COUNT] = {0}, hi[CHANNEL_COUNT] = {0};
+            uint32_t n = 0;
+
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t t_s = samples[i].timestamp / ROLLUP_TIMESTAMP_HZ;
+                if (t_s < bucket->start_s || t_s >= end_s) {
+                    continue;
+                }
+                for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+                    float x = samples[i].values[ch];
+                    if (n == 0 || x < lo[ch]) lo[ch] = x;
+                    if (n == 0 || x > hi[ch]) hi[ch] = x;
+                    sum[ch] += x;
+                }
+                n++;
+            }
+
+            checked++;
+            if (n != bucket->count) {
+                count_mismatches++;
+                continue;
+            }
+            for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+                if (lo[ch] != bucket->min[ch] || hi[ch] != bucket->max[ch]) {
+                    extreme_mismatches++;
+                }
+                double mean = sum[ch] / n;
+                double error = fabs(bucket->mean[ch] - mean) / fmax(fabs(mean), 1e-9);
+                if (error > max_error) max_error = error;
+            }
+        }
+        printf("  %s  %u buckets | count mismatches %u | min/max mismatches %u | "
+               "mean max relative error %.1e\n", rollup_tier_names[tier], checked,
+               count_mismatches, extreme_mismatches, max_error);
+        if (count_mismatches > 0 || extreme_mismatches > 0 || max_error > max_mean_error) {
+            fprintf(stderr, "analysis_bench: %s rollup buckets disagree with the samples\n",
+                    rollup_tier_names[tier]);
+            passed = false;
+        }
+    }
+    printf("  cost %.1f ns/sample, state %zu bytes\n", best / count * 1e9, sizeof(rollup));
+    return passed;
+}
+
+// Uplink of the network task's 1Hz cycle: every field every second against
+// report by exception, with a heartbeat after 10s of silence. Returns the
+// percentage saved.
+#define UPLINK_HEARTBEAT_S      10
+
+static double uplink_volume(const char* label, const SensorData_t* samples, uint32_t count,
+                          const ThresholdConfig_t* thresholds) {
+    static AnomalyEngine_t engine;
+    static Rollup_t rollup;
+    ExceptionReporter_t periodic, exception;
+    ReportInput_t input;
+    char buffer[256];
+    uint64_t periodic_bytes = 0, exception_bytes = 0;
+    uint32_t reports = 0, heartbeats = 0, sent_s = 0, seconds_merged = 0;
+    uint32_t flags = 0;
+
+    anomaly_engine_init(&engine, NULL);
+    rollup_init(&rollup);
+    exception_report_init(&periodic);
+    exception_report_init(&exception);
+
+    for (uint32_t i = 0; i < count; i++) {
+        anomaly_engine_feed(&engine, &samples[i]);
+        rollup_add(&rollup, &samples[i]);
+        if (i % 2 == 1) {
+            flags = anomaly_engine_evaluate(&engine, thresholds, false);
+        }
+        if (i % 10 != 9) {
+            continue;
+        }
+
+        input.time_s = samples[i].timestamp / ROLLUP_TIMESTAMP_HZ;
+        seconds_merged = rollup_merge_since(&rollup, ROLLUP_SECOND, seconds_merged, &input.window);
+        input.health_score = engine.results.health_score;
+        input.anomaly_flags = flags;
+
+        exception_report_resync(&periodic);
+        periodic_bytes += exception_report_encode(&periodic, REPORT_ALL_FIELDS, &input,
+                                                  buffer, sizeof(buffer));
+
+        uint32_t present = exception_report_due(&exception, &input);
+        if (present != 0) {
+            exception_bytes += exception_report_encode(&exception, present, &input,
+                                                       buffer, sizeof(buffer));
+            reports++;
+            sent_s = input.time_s;
+        } else if (input.time_s - sent_s >= UPLINK_HEARTBEAT_S) {
+            exception_bytes += (uint32_t)snprintf(buffer, sizeof(buffer), "{\"heartbeat\":%u}",
+                                                  (unsigned int)input.time_s);
+            heartbeats++;
+            sent_s = input.time_s;
+        }
+    }
+
+    double hours = count / 10.0 / 3600.0;
+    double saved = 100.0 * (1.0 - (double)exception_bytes / (double)periodic_bytes);
+    printf("  %-8s every second %6.1f kB/h | by exception %5.1f kB/h, %u reports %u heartbeats"
+           " | %.1f%% less\n", label, periodic_bytes / hours / 1000.0,
+           exception_bytes / hours / 1000.0, reports, heartbeats, saved);
+    return saved;
+}
+
+// A steady turbine must save at least 80%; no input may cost more than
+// sending every field every second
+static bool bench_exception_report(const SensorData_t* samples, uint32_t count,
+                                   const ThresholdConfig_t* thresholds) {
+    const uint32_t steady_count = 3600 * 10;    // One hour at 10Hz
+    const double min_steady_saved_pct = 80.0;
+
+    // Steady turbine: nominal values with the sensor task's noise levels
+    SensorData_t* steady = malloc(steady_count * sizeof(SensorData_t));
+    if (steady == NULL) {
+        return true;
+    }
+    for (uint32_t i = 0; i < steady_count; i++) {
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            steady[i].values[ch] = sensor_channels[ch].nominal;
+        }
+        steady[i].vibration += ((rand() % 1000) / 1000.0f - 0.5f) * 0.5f;
+        steady[i].temperature += ((rand() % 1000) / 1000.0f - 0.5f) * 0.2f;
+        steady[i].rpm += ((rand() % 1000) / 1000.0f - 0.5f);
+        steady[i].current += ((rand() % 1000) / 1000.0f - 0.5f) * 4.0f;
+        steady[i].timestamp = i * 100;
+    }
+
+    printf("uplink (1Hz telemetry, compact encoding, channel deadbands from the table):\n");
+    double steady_saved = uplink_volume("steady", steady, steady_count, thresholds);
+    double input_saved = uplink_volume("input", samples, count, thresholds);
+    free(steady);
+
+    if (steady_saved < min_steady_saved_pct || input_saved < 0.0) {
+        fprintf(stderr, "analysis_bench: report by exception saved %.1f%% steady, %.1f%% on input\n",
+                steady_saved, input_saved);
+        return false;
+    }
+    return true;
+}
+
+// Rotor speed following the sensor task's 15-25 rpm sine (10Hz cycles)
+static float synth_rpm(double t) {
+    return 15.0f + (float)(sin(t * 10.0 * 0.01) * 0.5 + 0.5) * 10.0f;
+}
+
+// Both seeded orders within 20% of their amplitude, no other order above half
+// the smaller one
+static bool bench_order_tracker(uint32_t repeats) {
+    const uint32_t period = ORDER_INPUT_RATE_HZ / 5;               // Anomaly task, 200ms
+    const uint32_t count = ORDER_INPUT_RATE_HZ * 120;
+    const uint32_t gear_order = 24;
+    const float blade_amplitude = 0.2f;
+    const float gear_amplitude = 0.1f;
+    const float max_amplitude_error = 0.2f;
+
+    float* in = malloc(count * sizeof(float));
+    static OrderTracker_t ot;
+    if (in == NULL) {
+        return true;
+    }
+
+    // Rotor-locked blade pass and gear mesh, a 7Hz tone that is not, and noise
+    double angle = 0.0;
+    for (uint32_t i = 0; i < count; i++) {
+        double t = (double)i / ORDER_INPUT_RATE_HZ;
+        angle += 2.0 * M_PI * synth_rpm(t) / 60.0 / ORDER_INPUT_RATE_HZ;
+        in[i] = 2.5f + blade_amplitude * (float)sin(ORDER_BLADE_PASS * angle) +
+                gear_amplitude * (float)sin(gear_order * angle) +
+                0.2f * (float)sin(2.0 * M_PI * 7.0 * t) +
+                ((rand() % 1000) / 1000.0f - 0.5f);
+    }
+
+    double best = 1e30;
+    double worst_period = 0.0;
+    for (uint32_t r = 0; r < repeats; r++) {
+        order_tracker_init(&ot);
+        double start = now_seconds();
+        for (uint32_t i = 0; i < count; i += period) {
+            float rev_hz = synth_rpm((double)(i + period) / ORDER_INPUT_RATE_HZ) / 60.0f;
+            double t0 = now_seconds();
+            order_tracker_push(&ot, &in[i], period, rev_hz);
+            double dt = now_seconds() - t0;
+            if (dt > worst_period) worst_period = dt;
+        }
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    free(in);
+
+    // Largest order that is not one of the two seeded ones
+    float other = 0.0f;
+    uint32_t other_order = 0;
+    for (uint32_t k = 1; k < ORDER_SAMPLES_PER_REV / 2; k++) {
+        if (k != ORDER_BLADE_PASS && k != gear_order && order_tracker_amplitude(&ot, k) > other) {
+            other = order_tracker_amplitude(&ot, k);
+            other_order = k;
+        }
+    }
+
+    printf("order tracking (%u samples/rev, TSA memory ~%u revs, rotor 15-25 rpm):\n",
+           ORDER_SAMPLES_PER_REV, ORDER_TSA_AVERAGES);
+    printf("  %u revs | order %u: %.3f (seeded %.3f) | order %u: %.3f (seeded %.3f) | "
+           "largest other: order %u %.3f\n",
+           ot.result.revolutions, ORDER_BLADE_PASS, order_tracker_amplitude(&ot, ORDER_BLADE_PASS),
+           blade_amplitude, gear_order, order_tracker_amplitude(&ot, gear_order), gear_amplitude,
+           other_order, other);
+    printf("  cost %.1f ns/input sample, worst period %.1f us of 200000 us budget, state %zu bytes\n",
+           best / count * 1e9, worst_period * 1e6, sizeof(ot));
+
+    float blade = order_tracker_amplitude(&ot, ORDER_BLADE_PASS);
+    float gear = order_tracker_amplitude(&ot, gear_order);
+    if (fabsf(blade - blade_amplitude) > max_amplitude_error * blade_amplitude ||
+        fabsf(gear - gear_amplitude) > max_amplitude_error * gear_amplitude ||
+        other > 0.5f * gear_amplitude) {
+        fprintf(stderr, "analysis_bench: order tracking recovered %.3f / %.3f, other order %u %.3f\n",
+                blade, gear, other_order, other);
+        return false;
+    }
+    return true;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-n samples] [-s seed] [-r repeats] [-a min_agreement] "
+                    "[trace.csv]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t count = 200000;
+    uint32_t seed = 1;
+    uint32_t repeats = 5;
+    double min_agreement = 99.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:r:a:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                count = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                repeats = (uint32_t)strtoul(optarg, NULL, 10);
+                if (repeats == 0) repeats = 1;
+                break;
+            case 'a':
+                min_agreement = strtod(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    SensorData_t* samples;
+    if (optind < argc) {
+        samples = load_trace(argv[optind], &count);
+        if (samples == NULL) {
+            fprintf(stderr, "analysis_bench: cannot read %s\n", argv[optind]);
+            return 1;
+        }
+        printf("samples: %u from %s\n", count, argv[optind]);
+    } else {
+        samples = generate_samples(count, seed);
+        if (samples == NULL) {
+            fprintf(stderr, "analysis_bench: out of memory\n");
+            return 1;
+        }
+        printf("samples: %u synthetic (seed %u)\n", count, seed);
+    }
+
+    if (count == 0) {
+        fprintf(stderr, "analysis_bench: no samples\n");
+        free(samples);
+        return 1;
+    }
+
+    ThresholdConfig_t thresholds;
+    threshold_config_defaults(&thresholds);
+
+    double agreement = compare_detectors(samples, count, &thresholds);
+
+    printf("cost (update per sample + evaluate per %u-sample cycle, best of %u):\n",
+           SAMPLES_PER_CYCLE, repeats);
+    time_detector(&sigma_detector_ops, samples, count, &thresholds, repeats);
+    time_detector(&sigma_q15_detector_ops, samples, count, &thresholds, repeats);
+    time_detector(&mahalanobis_detector_ops, samples, count, &thresholds, repeats);
+
+    bool passed = bench_mahalanobis(samples, count, &thresholds);
+
+    passed = bench_decimator(repeats) && passed;
+    passed = bench_envelope(repeats) && passed;
+    passed = bench_order_tracker(repeats) && passed;
+    passed = bench_features(repeats) && passed;
+    passed = bench_trend(repeats) && passed;
+    passed = bench_rollup(samples, count, repeats) && passed;
+    passed = bench_exception_report(samples, count, &thresholds) && passed;
+
+    free(samples);
+
+    if (agreement < min_agreement) {
+        fprintf(stderr, "analysis_bench: agreement %.3f%% below %.3f%%\n",
+                agreement, min_agreement);
+        passed = false;
+    }
+    return passed ? 0 : 1;
+}
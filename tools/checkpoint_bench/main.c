@@ -0,0 +1,390 @@
+/**
+ * Checkpoint Bench - Warm start from persisted baselines vs a cold start
+ *
+ * Runs the anomaly engine over a synthetic signal for a number of minutes,
+ * checkpoints it to a file and restores the file into a fresh engine, as a
+ * reboot would. The restored engine and the one that never stopped are then
+ * fed the same samples, with a vibration step inside the warning limits
+ * shortly after the restart; their flags and health must match cycle for
+ * cycle, while a cold engine is still filling its baseline window. Then
+ * times capture, write, read and apply, checks that damaged, foreign and
+ * stale files are rejected, and models the boot of the monitor's sensor and
+ * anomaly tasks to report the time to detection ready, cold and warm.
+ *
+ * Usage: checkpoint_bench [-m minutes] [-s seed] [-r repeats] [-f path]
+ *   -m N   Minutes of signal before the restart (default 5)
+ *   -s N   Seed for the synthetic signal (default 1)
+ *   -r N   Timing repetitions, best run is reported (default 200)
+ *   -f P   Checkpoint file, removed on exit (default checkpoint_bench.bin)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "anomaly_engine.h"
+#include "checkpoint.h"
+#include "detector.h"
+
+#define SAMPLE_PERIOD_MS    100     // Sensor task, 10Hz
+#define ANOMALY_PERIOD_MS   200     // Anomaly task, 5Hz
+#define SENSOR_QUEUE_DEPTH  5       // xSensorDataQueue
+#define COLD_CALIBRATION    20      // Sensor task cycles before SENSORS_CALIBRATED
+#define WARM_CALIBRATION    1
+#define TIMELINE_MS         10000
+#define MAX_AGE_S           (24 * 3600)     // As the monitor (CHECKPOINT_MAX_AGE_S)
+
+#define AFTER_SAMPLES       300     // Compared after the restart (30s)
+#define FAULT_OFFSET        10      // Samples after the restart
+#define FAULT_SAMPLES       40
+#define FAULT_STEP          1.0f    // mm/s: far outside 3 sigma, inside the warning limit
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Every channel near its nominal value with 1% noise, and a vibration step
+static SensorData_t* generate_samples(uint32_t count, uint32_t seed, uint32_t fault_start) {
+    SensorData_t* samples = malloc(count * sizeof(SensorData_t));
+    if (samples == NULL) {
+        return NULL;
+    }
+    srand(seed);
+    for (uint32_t i = 0; i < count; i++) {
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            samples[i].values[ch] = sensor_channels[ch].nominal *
+                                    (1.0f + ((rand() % 1000) / 1000.0f - 0.5f) * 0.02f);
+        }
+        if (i >= fault_start && i < fault_start + FAULT_SAMPLES) {
+            samples[i].vibration += FAULT_STEP;
+        }
+        samples[i].timestamp = i * SAMPLE_PERIOD_MS;
+    }
+    return samples;
+}
+
+typedef struct {
+    uint32_t flags;
+    float health;
+} CycleResult_t;
+
+// The anomaly task's consumption: 2 samples, then 1, alternately, with an
+// evaluation after each batch. Returns the cycles run.
+static uint32_t drive(AnomalyEngine_t* engine, const ThresholdConfig_t* thresholds,
+                      const SensorData_t* samples, uint32_t count, CycleResult_t* out) {
+    uint32_t cycles = 0;
+    for (uint32_t i = 0; i < count; cycles++) {
+        uint32_t batch = (cycles + 1) % 2 == 0 ? 1 : 2;
+        for (uint32_t n = 0; n < batch && i < count; n++) {
+            anomaly_engine_feed(engine, &samples[i++]);
+        }
+        uint32_t flags = anomaly_engine_evaluate(engine, thresholds, false);
+        if (out != NULL) {
+            out[cycles].flags = flags;
+            out[cycles].health = engine->results.health_score;
+        }
+    }
+    return cycles;
+}
+
+typedef struct {
+    uint32_t first;             // Cycle of the first vibration flag, UINT32_MAX if none
+    uint32_t flagged;           // Cycles with the vibration flag
+} Detection_t;
+
+static Detection_t vibration_detection(const CycleResult_t* results, uint32_t cycles) {
+    Detection_t d = { UINT32_MAX, 0 };
+    for (uint32_t c = 0; c < cycles; c++) {
+        if (results[c].flags & CHANNEL_FLAG(CHANNEL_VIBRATION)) {
+            d.flagged++;
+            if (d.first == UINT32_MAX) {
+                d.first = c;
+            }
+        }
+    }
+    return d;
+}
+
+static void print_detection(const char* label, Detection_t d, uint32_t mismatches, uint32_t cycles) {
+    printf("  %-11s", label);
+    if (d.first == UINT32_MAX) {
+        printf(" fault missed             ");
+    } else {
+        printf(" fault flagged at %5u ms ", d.first * ANOMALY_PERIOD_MS);
+    }
+    printf("%3u cycles flagged  %3u/%u cycles differ from continuous\n", d.flagged, mismatches, cycles);
+}
+
+// Continuous, restored and cold engines over the same samples after the restart
+static bool compare_engines(const SensorData_t* samples, uint32_t before, const char* path,
+                            const ThresholdConfig_t* thresholds, Checkpoint_t* cp) {
+    static AnomalyEngine_t continuous, restored, cold;
+    static CycleResult_t expected[AFTER_SAMPLES], warm_results[AFTER_SAMPLES], cold_results[AFTER_SAMPLES];
+
+    anomaly_engine_init(&continuous, NULL);
+    drive(&continuous, thresholds, samples, before, NULL);
+
+    checkpoint_capture(cp, &continuous, CHECKPOINT_FLAG_SENSORS_CALIBRATED, (uint32_t)time(NULL));
+    if (!checkpoint_write(cp, path)) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    anomaly_engine_init(&restored, NULL);
+    CheckpointResult_t read = checkpoint_read(cp, path, (uint32_t)time(NULL), 0);
+    CheckpointResult_t applied = read == CHECKPOINT_OK ? checkpoint_apply(cp, &restored) : read;
+    if (applied != CHECKPOINT_OK) {
+        fprintf(stderr, "Restore failed: %s\n", checkpoint_result_names[applied]);
+        return false;
+    }
+    anomaly_engine_init(&cold, NULL);
+
+    const SensorData_t* after = samples + before;
+    uint32_t cycles = drive(&continuous, thresholds, after, AFTER_SAMPLES, expected);
+    drive(&restored, thresholds, after, AFTER_SAMPLES, warm_results);
+    drive(&cold, thresholds, after, AFTER_SAMPLES, cold_results);
+
+    uint32_t warm_mismatches = 0;
+    uint32_t cold_mismatches = 0;
+    for (uint32_t c = 0; c < cycles; c++) {
+        warm_mismatches += expected[c].flags != warm_results[c].flags ||
+                           expected[c].health != warm_results[c].health;
+        cold_mismatches += expected[c].flags != cold_results[c].flags ||
+                           expected[c].health != cold_results[c].health;
+    }
+
+    printf("Warm start equivalence (%u samples before the restart, %u after;\n"
+           "vibration +%.1f mm/s for %u samples from %u ms after the restart):\n",
+           before, AFTER_SAMPLES, FAULT_STEP, FAULT_SAMPLES, FAULT_OFFSET * SAMPLE_PERIOD_MS);
+    print_detection("continuous", vibration_detection(expected, cycles), 0, cycles);
+    print_detection("warm", vibration_detection(warm_results, cycles), warm_mismatches, cycles);
+    print_detection("cold", vibration_detection(cold_results, cycles), cold_mismatches, cycles);
+    printf("  Restored engine %s\n\n", warm_mismatches == 0 ? "identical to the continuous one" : "DIVERGED");
+    return warm_mismatches == 0;
+}
+
+static void report_cost(const AnomalyEngine_t* engine, const char* path, uint32_t repeats) {
+    static Checkpoint_t cp;
+    static AnomalyEngine_t target;
+    double best[4] = { 1e9, 1e9, 1e9, 1e9 };
+
+    for (uint32_t r = 0; r < repeats; r++) {
+        double t0 = now_seconds();
+        checkpoint_capture(&cp, engine, 0, 0);
+        double t1 = now_seconds();
+        checkpoint_write(&cp, path);
+        double t2 = now_seconds();
+        checkpoint_read(&cp, path, 0, 0);
+        double t3 = now_seconds();
+        anomaly_engine_init(&target, NULL);
+        double t4 = now_seconds();
+        checkpoint_apply(&cp, &target);
+        double t5 = now_seconds();
+        double spans[4] = { t1 - t0, t2 - t1, t3 - t2, t5 - t4 };
+        for (uint32_t i = 0; i < 4; i++) {
+            best[i] = spans[i] < best[i] ? spans[i] : best[i];
+        }
+    }
+
+    printf("Checkpoint cost (best of %u):\n", repeats);
+    printf("  Size:    %u bytes (%u header, %u payload, %u detectors)\n", checkpoint_bytes(&cp),
+           (unsigned)sizeof(cp.header), cp.header.payload_bytes, cp.header.detector_count);
+    for (uint32_t i = 0; i < cp.header.detector_count; i++) {
+        printf("           %-*s %5u bytes\n", DETECTOR_NAME_LEN, cp.header.detectors[i].name,
+               cp.header.detectors[i].state_size);
+    }
+    printf("  Capture: %7.1f us\n", best[0] * 1e6);
+    printf("  Write:   %7.1f us (temporary file and rename)\n", best[1] * 1e6);
+    printf("  Read:    %7.1f us (checksum included)\n", best[2] * 1e6);
+    printf("  Apply:   %7.1f us\n\n", best[3] * 1e6);
+}
+
+// Overwrite length bytes at offset, or cut the file there if data is NULL
+static bool damage_file(const char* path, long offset, const void* data, size_t length) {
+    if (data == NULL) {
+        return truncate(path, offset) == 0;
+    }
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = fseek(file, offset, SEEK_SET) == 0 && fwrite(data, 1, length, file) == length;
+    return fclose(file) == 0 && ok;
+}
+
+static bool expect(const char* label, CheckpointResult_t got, CheckpointResult_t expected) {
+    printf("  %-34s %-13s %s\n", label, checkpoint_result_names[got], got == expected ? "ok" : "UNEXPECTED");
+    return got == expected;
+}
+
+static bool check_rejection(const Checkpoint_t* good, const char* path) {
+    static Checkpoint_t cp;
+    static AnomalyEngine_t other;
+    uint32_t saved_s = good->header.saved_s;
+    bool ok = true;
+    uint8_t flipped = (uint8_t)(good->payload[100] ^ 0x40);
+
+    printf("Validation:\n");
+    checkpoint_write(good, path);
+    ok &= expect("Intact file", checkpoint_read(&cp, path, saved_s, MAX_AGE_S), CHECKPOINT_OK);
+
+    ok &= expect("No file", checkpoint_read(&cp, "/nonexistent/checkpoint.bin", saved_s, 0),
+                 CHECKPOINT_MISSING);
+
+    damage_file(path, (long)sizeof(good->header) + 100, &flipped, 1);
+    ok &= expect("One payload bit flipped", checkpoint_read(&cp, path, saved_s, 0), CHECKPOINT_CORRUPT);
+
+    checkpoint_write(good, path);
+    damage_file(path, (long)checkpoint_bytes(good) / 2, NULL, 0);
+    ok &= expect("Cut short (power loss mid-write)", checkpoint_read(&cp, path, saved_s, 0),
+                 CHECKPOINT_CORRUPT);
+
+    cp = *good;
+    cp.header.version = CHECKPOINT_VERSION + 1;
+    checkpoint_write(&cp, path);
+    ok &= expect("Newer format version", checkpoint_read(&cp, path, saved_s, 0), CHECKPOINT_INCOMPATIBLE);
+
+    checkpoint_write(good, path);
+    ok &= expect("Older than the age limit", checkpoint_read(&cp, path, saved_s + MAX_AGE_S + 1,
+                                                             MAX_AGE_S), CHECKPOINT_STALE);
+
+    // A build with a different detector set
+    anomaly_engine_init(&other, NULL);
+    detector_registry_init(&other.registry, NULL);
+    detector_registry_add(&other.registry, &sigma_detector_ops, 1.0f, true);
+    checkpoint_read(&cp, path, saved_s, 0);
+    ok &= expect("Applied to another detector set", checkpoint_apply(&cp, &other), CHECKPOINT_INCOMPATIBLE);
+    printf("\n");
+    return ok;
+}
+
+typedef struct {
+    uint32_t calibrated_ms;
+    uint32_t anomaly_ready_ms;
+    uint32_t consumed;          // Samples fed before detection was ready
+    uint32_t dropped;           // Sensor queue full
+} BootTimeline_t;
+
+// The sensor task (priority 4, every 100ms) queues a sample per cycle and
+// sets SENSORS_CALIBRATED after its calibration cycles. The anomaly task
+// (priority 3, every 200ms) takes 2 or 1 of them alternately and sets
+// ANOMALY_READY once the engine's baselines are established. The network
+// connection, the third bit of ALL_SYSTEMS_READY, is left out.
+static BootTimeline_t model_boot(const SensorData_t* samples, uint32_t count,
+                                 const Checkpoint_t* cp, const ThresholdConfig_t* thresholds) {
+    static AnomalyEngine_t engine;
+    BootTimeline_t timeline = { 0, 0, 0, 0 };
+    uint32_t calibration = cp != NULL ? WARM_CALIBRATION : COLD_CALIBRATION;
+    uint32_t queue_head = 0, queue_length = 0;
+    uint32_t produced = 0, sensor_cycles = 0, anomaly_cycles = 0;
+
+    anomaly_engine_init(&engine, NULL);
+    if (cp != NULL) {
+        checkpoint_apply(cp, &engine);
+    }
+
+    for (uint32_t t = SAMPLE_PERIOD_MS; t <= TIMELINE_MS && produced < count; t += SAMPLE_PERIOD_MS) {
+        // Same tick: the higher-priority sensor task runs first
+        sensor_cycles++;
+        if (timeline.calibrated_ms == 0 && sensor_cycles >= calibration) {
+            timeline.calibrated_ms = t;
+        }
+        if (queue_length < SENSOR_QUEUE_DEPTH) {
+            queue_length++;
+        } else {
+            timeline.dropped += timeline.anomaly_ready_ms == 0;
+        }
+        produced++;
+
+        if (t % ANOMALY_PERIOD_MS != 0) {
+            continue;
+        }
+        anomaly_cycles++;
+        uint32_t batch = anomaly_cycles % 2 == 0 ? 1 : 2;
+        uint32_t taken = 0;
+        for (; taken < batch && queue_length > 0; taken++, queue_length--) {
+            anomaly_engine_feed(&engine, &samples[queue_head++]);
+            timeline.consumed += timeline.anomaly_ready_ms == 0;
+        }
+        anomaly_engine_evaluate(&engine, thresholds, false);
+        if (taken > 0 && timeline.anomaly_ready_ms == 0 && anomaly_engine_ready(&engine)) {
+            timeline.anomaly_ready_ms = t;
+        }
+    }
+    return timeline;
+}
+
+static void report_timeline(const SensorData_t* samples, const Checkpoint_t* cp,
+                            const ThresholdConfig_t* thresholds) {
+    uint32_t count = TIMELINE_MS / SAMPLE_PERIOD_MS;
+    BootTimeline_t cold = model_boot(samples, count, NULL, thresholds);
+    BootTimeline_t warm = model_boot(samples, count, cp, thresholds);
+    uint32_t cold_ready = cold.calibrated_ms > cold.anomaly_ready_ms ? cold.calibrated_ms : cold.anomaly_ready_ms;
+    uint32_t warm_ready = warm.calibrated_ms > warm.anomaly_ready_ms ? warm.calibrated_ms : warm.anomaly_ready_ms;
+
+    printf("Time to detection ready after boot (task periods of the monitor):\n");
+    printf("                     %10s %10s\n", "cold", "warm");
+    printf("  Sensors calibrated %7u ms %7u ms\n", cold.calibrated_ms, warm.calibrated_ms);
+    printf("  Baselines ready    %7u ms %7u ms\n", cold.anomaly_ready_ms, warm.anomaly_ready_ms);
+    printf("  Detection ready    %7u ms %7u ms  (%.1fx sooner)\n", cold_ready, warm_ready,
+           warm_ready > 0 ? (double)cold_ready / warm_ready : 0.0);
+    printf("  Samples to ready   %10u %10u\n", cold.consumed, warm.consumed);
+    printf("  Dropped meanwhile  %10u %10u  (sensor queue full)\n", cold.dropped, warm.dropped);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t minutes = 5;
+    uint32_t seed = 1;
+    uint32_t repeats = 200;
+    const char* path = "checkpoint_bench.bin";
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:s:r:f:h")) != -1) {
+        switch (opt) {
+            case 'm': minutes = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'r': repeats = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'f': path = optarg; break;
+            default:
+                fprintf(stderr, "Usage: %s [-m minutes] [-s seed] [-r repeats] [-f path]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (minutes == 0 || repeats == 0) {
+        fprintf(stderr, "Minutes and repeats must be positive\n");
+        return 1;
+    }
+
+    uint32_t before = minutes * 60 * (1000 / SAMPLE_PERIOD_MS);
+    SensorData_t* samples = generate_samples(before + AFTER_SAMPLES, seed, before + FAULT_OFFSET);
+    if (samples == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    ThresholdConfig_t thresholds;
+    threshold_config_defaults(&thresholds);
+    static Checkpoint_t cp;
+
+    printf("Checkpoint Bench - %u channels, baseline window %u, history %u\n\n",
+           CHANNEL_COUNT, BASELINE_WINDOW, HISTORY_SIZE);
+    bool ok = compare_engines(samples, before, path, &thresholds, &cp);
+
+    static AnomalyEngine_t engine;
+    anomaly_engine_init(&engine, NULL);
+    drive(&engine, &thresholds, samples, before, NULL);
+    report_cost(&engine, path, repeats);
+
+    checkpoint_capture(&cp, &engine, CHECKPOINT_FLAG_SENSORS_CALIBRATED, (uint32_t)time(NULL));
+    ok &= check_rejection(&cp, path);
+
+    // The boot sees the signal after the restart
+    report_timeline(samples + before, &cp, &thresholds);
+
+    remove(path);
+    free(samples);
+    return ok ? 0 : 1;
+}
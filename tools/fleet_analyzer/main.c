@@ -0,0 +1,434 @@
+/**
+ * Fleet Analyzer - Multi-core batch replay of turbine trace archives
+ *
+ * Shards trace files across a pthread worker pool. Each worker owns a deque of
+ * files (largest first) and steals from the most loaded peer when it runs dry,
+ * so a few huge recordings cannot leave the other cores idle. Every file runs
+ * through the same AnomalyEngine_t as the RTOS anomaly task; the per-file
+ * summaries are merged per turbine once all workers have finished.
+ *
+ * Archive layout: <archive>/<turbine_id>/<period>.csv
+ *
+ * Usage: fleet_analyzer [-j workers] [-b samples_per_cycle] [-f]
+ *                       [-t channel.limit=value ...] path [path ...]
+ *   -j N   Worker threads (default: online CPUs)
+ *   -b N   Evaluate the detectors every N samples (default 1)
+ *   -f     Take the turbine id from the file-name prefix before the first '_'
+ *          instead of the parent directory
+ *   -t     Override a channel limit, e.g. vibration.warning_high=6
+ *          (limits: warning_low, warning_high, critical_low, critical_high)
+ *   Directories are scanned recursively for *.csv files.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "replay.h"
+
+#define MAX_WORKERS         64
+#define TURBINE_ID_LEN      64
+#define MAX_PATH_LEN        4096
+
+// One trace file to replay
+typedef struct {
+    char* path;
+    char turbine_id[TURBINE_ID_LEN];
+    uint64_t size_bytes;
+    ReplaySummary_t summary;
+    bool ok;
+} TraceJob_t;
+
+// Per-worker deque of job indices: the owner pops from the front (largest
+// files first), thieves take from the back
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t* items;
+    uint32_t head;
+    uint32_t tail;
+    uint64_t bytes_remaining;
+} WorkDeque_t;
+
+typedef struct {
+    uint32_t id;
+    pthread_t thread;
+    WorkDeque_t deque;
+    uint32_t files_done;
+    uint32_t steals;
+    uint64_t bytes_done;
+    double busy_s;
+    AnomalyEngine_t engine;
+} Worker_t;
+
+// Merged result per turbine
+typedef struct {
+    char turbine_id[TURBINE_ID_LEN];
+    ReplaySummary_t summary;
+} TurbineSummary_t;
+
+static TraceJob_t* jobs = NULL;
+static uint32_t job_count = 0;
+static uint32_t job_capacity = 0;
+
+static Worker_t* workers = NULL;
+static uint32_t worker_count = 0;
+
+static ThresholdConfig_t thresholds;
+static uint32_t batch = 1;
+static bool id_from_filename = false;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Turbine id: parent directory name, or file-name prefix with -f
+static void derive_turbine_id(const char* path, char* id) {
+    const char* base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+
+    if (!id_from_filename && base != path) {
+        const char* dir_end = base - 1;
+        const char* dir_start = dir_end;
+        while (dir_start > path && *(dir_start - 1) != '/') {
+            dir_start--;
+        }
+        size_t len = (size_t)(dir_end - dir_start);
+        if (len > 0 && !(len == 1 && *dir_start == '.')) {
+            if (len >= TURBINE_ID_LEN) len = TURBINE_ID_LEN - 1;
+            memcpy(id, dir_start, len);
+            id[len] = '\0';
+            return;
+        }
+    }
+
+    size_t len = strcspn(base, "_.");
+    if (len >= TURBINE_ID_LEN) len = TURBINE_ID_LEN - 1;
+    memcpy(id, base, len);
+    id[len] = '\0';
+}
+
+static bool add_job(const char* path, uint64_t size_bytes) {
+    if (job_count == job_capacity) {
+        uint32_t new_capacity = job_capacity ? job_capacity * 2 : 256;
+        TraceJob_t* grown = realloc(jobs, new_capacity * sizeof(TraceJob_t));
+        if (grown == NULL) {
+            return false;
+        }
+        jobs = grown;
+        job_capacity = new_capacity;
+    }
+
+    TraceJob_t* job = &jobs[job_count];
+    memset(job, 0, sizeof(TraceJob_t));
+    job->path = strdup(path);
+    job->size_bytes = size_bytes;
+    derive_turbine_id(path, job->turbine_id);
+    job_count++;
+    return job->path != NULL;
+}
+
+static bool has_csv_suffix(const char* name) {
+    size_t len = strlen(name);
+    return len > 4 && strcmp(name + len - 4, ".csv") == 0;
+}
+
+// Collect trace files, descending into directories
+static void collect_path(const char* path, bool explicit_file) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "fleet_analyzer: cannot stat %s\n", path);
+        return;
+    }
+
+    if (S_ISREG(st.st_mode)) {
+        if (explicit_file || has_csv_suffix(path)) {
+            add_job(path, (uint64_t)st.st_size);
+        }
+        return;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        return;
+    }
+
+    DIR* dir = opendir(path);
+    if (dir == NULL) {
+        fprintf(stderr, "fleet_analyzer: cannot open directory %s\n", path);
+        return;
+    }
+
+    struct dirent* entry;
+    char child[MAX_PATH_LEN];
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+        collect_path(child, false);
+    }
+    closedir(dir);
+}
+
+static int compare_job_size_desc(const void* a, const void* b) {
+    const TraceJob_t* ja = (const TraceJob_t*)a;
+    const TraceJob_t* jb = (const TraceJob_t*)b;
+    if (ja->size_bytes != jb->size_bytes) {
+        return ja->size_bytes > jb->size_bytes ? -1 : 1;
+    }
+    return strcmp(ja->path, jb->path);
+}
+
+static bool deque_pop_front(WorkDeque_t* dq, uint32_t* job_index) {
+    bool found = false;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->head < dq->tail) {
+        *job_index = dq->items[dq->head++];
+        dq->bytes_remaining -= jobs[*job_index].size_bytes;
+        found = true;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+static bool deque_steal_back(WorkDeque_t* dq, uint32_t* job_index) {
+    bool found = false;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->head < dq->tail) {
+        *job_index = dq->items[--dq->tail];
+        dq->bytes_remaining -= jobs[*job_index].size_bytes;
+        found = true;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return found;
+}
+
+// Steal from the peer with the most bytes still queued
+static bool steal_work(Worker_t* self, uint32_t* job_index) {
+    while (true) {
+        Worker_t* victim = NULL;
+        uint64_t most = 0;
+
+        for (uint32_t i = 1; i < worker_count; i++) {
+            Worker_t* peer = &workers[(self->id + i) % worker_count];
+            pthread_mutex_lock(&peer->deque.lock);
+            bool has_work = peer->deque.head < peer->deque.tail;
+            uint64_t remaining = peer->deque.bytes_remaining;
+            pthread_mutex_unlock(&peer->deque.lock);
+
+            if (has_work && (victim == NULL || remaining > most)) {
+                victim = peer;
+                most = remaining;
+            }
+        }
+
+        if (victim == NULL) {
+            return false;   // Every deque is empty - no work is ever added later
+        }
+        if (deque_steal_back(&victim->deque, job_index)) {
+            self->steals++;
+            return true;
+        }
+        // Lost the race for the victim's last item - rescan
+    }
+}
+
+static void* worker_main(void* arg) {
+    Worker_t* self = (Worker_t*)arg;
+    uint32_t job_index;
+
+    while (deque_pop_front(&self->deque, &job_index) || steal_work(self, &job_index)) {
+        TraceJob_t* job = &jobs[job_index];
+
+        double start = now_seconds();
+        job->ok = replay_trace(job->path, &thresholds, batch, &self->engine, NULL, &job->summary);
+        self->busy_s += now_seconds() - start;
+
+        if (!job->ok) {
+            fprintf(stderr, "fleet_analyzer: cannot open %s\n", job->path);
+        }
+        self->files_done++;
+        self->bytes_done += job->size_bytes;
+    }
+
+    return NULL;
+}
+
+// Deal the size-sorted jobs round-robin so every deque starts with a similar load
+static bool start_workers(void) {
+    for (uint32_t w = 0; w < worker_count; w++) {
+        Worker_t* worker = &workers[w];
+        worker->id = w;
+        pthread_mutex_init(&worker->deque.lock, NULL);
+        worker->deque.items = malloc((job_count / worker_count + 1) * sizeof(uint32_t));
+        if (worker->deque.items == NULL) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < job_count; i++) {
+        WorkDeque_t* dq = &workers[i % worker_count].deque;
+        dq->items[dq->tail++] = i;
+        dq->bytes_remaining += jobs[i].size_bytes;
+    }
+
+    for (uint32_t w = 0; w < worker_count; w++) {
+        if (pthread_create(&workers[w].thread, NULL, worker_main, &workers[w]) != 0) {
+            fprintf(stderr, "fleet_analyzer: failed to start worker %u\n", w);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int compare_turbine_id(const void* a, const void* b) {
+    return strcmp(((const TraceJob_t*)a)->turbine_id, ((const TraceJob_t*)b)->turbine_id);
+}
+
+static void print_report(double elapsed_s) {
+    // Group by turbine (jobs are no longer needed in size order)
+    qsort(jobs, job_count, sizeof(TraceJob_t), compare_turbine_id);
+
+    ReplaySummary_t fleet;
+    replay_summary_init(&fleet);
+    uint64_t total_bytes = 0;
+
+    // One anomaly column per detected channel
+    printf("%-16s %6s %12s", "TURBINE", "FILES", "SAMPLES");
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        if (sensor_channels[ch].detectors != 0) {
+            printf(" %11.11s", sensor_channels[ch].name);
+        }
+    }
+    printf(" %8s %8s\n", "MIN_HP", "AVG_HP");
+
+    uint32_t i = 0;
+    while (i < job_count) {
+        TurbineSummary_t turbine;
+        strncpy(turbine.turbine_id, jobs[i].turbine_id, TURBINE_ID_LEN);
+        replay_summary_init(&turbine.summary);
+
+        for (; i < job_count && strcmp(jobs[i].turbine_id, turbine.turbine_id) == 0; i++) {
+            total_bytes += jobs[i].size_bytes;
+            if (jobs[i].ok) {
+                replay_summary_merge(&turbine.summary, &jobs[i].summary);
+            }
+        }
+
+        const ReplaySummary_t* s = &turbine.summary;
+        printf("%-16.16s %6u %12llu", turbine.turbine_id, s->files, (unsigned long long)s->samples);
+        for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+            if (sensor_channels[ch].detectors != 0) {
+                printf(" %11u", s->anomalies[ch]);
+            }
+        }
+        printf(" %8.1f %8.1f\n", s->min_health, s->cycles > 0 ? s->health_sum / s->cycles : 100.0);
+        replay_summary_merge(&fleet, s);
+    }
+
+    printf("\nFleet: %u files, %llu samples, %.1f MB in %.3fs | %.2f Msamples/s | %.1f MB/s\n",
+           fleet.files, (unsigned long long)fleet.samples, total_bytes / 1e6, elapsed_s,
+           elapsed_s > 0 ? fleet.samples / elapsed_s / 1e6 : 0.0,
+           elapsed_s > 0 ? total_bytes / elapsed_s / 1e6 : 0.0);
+
+    for (uint32_t w = 0; w < worker_count; w++) {
+        printf("  worker %2u: %5u files %8.1f MB  steals %4u  busy %5.1f%%\n",
+               w, workers[w].files_done, workers[w].bytes_done / 1e6, workers[w].steals,
+               elapsed_s > 0 ? workers[w].busy_s / elapsed_s * 100.0 : 0.0);
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-j workers] [-b samples_per_cycle] [-f] "
+                    "[-t channel.limit=value ...] path [path ...]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t requested_workers = cpus > 0 ? (uint32_t)cpus : 1;
+    int opt;
+
+    threshold_config_defaults(&thresholds);
+
+    while ((opt = getopt(argc, argv, "j:b:ft:h")) != -1) {
+        switch (opt) {
+            case 'j':
+                requested_workers = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                batch = (uint32_t)strtoul(optarg, NULL, 10);
+                if (batch == 0) batch = 1;
+                break;
+            case 'f':
+                id_from_filename = true;
+                break;
+            case 't':
+                if (!threshold_config_set(&thresholds, optarg)) {
+                    fprintf(stderr, "fleet_analyzer: unknown threshold '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = optind; i < argc; i++) {
+        collect_path(argv[i], true);
+    }
+    if (job_count == 0) {
+        fprintf(stderr, "fleet_analyzer: no trace files found\n");
+        return 1;
+    }
+
+    qsort(jobs, job_count, sizeof(TraceJob_t), compare_job_size_desc);
+
+    worker_count = requested_workers;
+    if (worker_count == 0) worker_count = 1;
+    if (worker_count > MAX_WORKERS) worker_count = MAX_WORKERS;
+    if (worker_count > job_count) worker_count = job_count;
+
+    workers = calloc(worker_count, sizeof(Worker_t));
+    if (workers == NULL) {
+        fprintf(stderr, "fleet_analyzer: out of memory\n");
+        return 1;
+    }
+
+    double start = now_seconds();
+    if (!start_workers()) {
+        return 1;
+    }
+    for (uint32_t w = 0; w < worker_count; w++) {
+        pthread_join(workers[w].thread, NULL);
+    }
+    double elapsed = now_seconds() - start;
+
+    print_report(elapsed);
+
+    uint32_t failures = 0;
+    for (uint32_t i = 0; i < job_count; i++) {
+        if (!jobs[i].ok) failures++;
+        free(jobs[i].path);
+    }
+    for (uint32_t w = 0; w < worker_count; w++) {
+        pthread_mutex_destroy(&workers[w].deque.lock);
+        free(workers[w].deque.items);
+    }
+    free(workers);
+    free(jobs);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,421 @@
+/**
+ * Link Bench - Reliable transport goodput over an emulated lossy link
+ *
+ * Offers the same stream of telemetry-sized frames twice over a seeded link
+ * with burst loss, a bandwidth cap, a latency distribution, reordering and
+ * scheduled outages: once fire-and-forget, the way the network task used to
+ * send, and once through the sliding-window transport with selective
+ * retransmission. Reports delivered frames, goodput, retransmissions, wire
+ * overhead, offer-to-delivery latency and what the link did, for each.
+ *
+ * Usage: link_bench [-P profile] [-n frames] [-p payload] [-i interval_ms]
+ *                   [-l loss_pct] [-d delay_ms] [-j jitter_ms] [-r bytes_per_s]
+ *                   [-o period_ms:length_ms] [-s seed]
+ *   -P S   Link profile: ideal, lossy, bursty, cellular, satellite (default: all)
+ *   -n N   Frames offered (default 5000)
+ *   -p N   Payload bytes per frame (default 200)
+ *   -i N   Milliseconds between offered frames (default 10)
+ *   -l P   Good-state loss percent, each direction
+ *   -d N   One-way delay in ms
+ *   -j N   Jitter in ms
+ *   -r N   Bandwidth cap in bytes/s, 0 for none
+ *   -o P:L Outage of L ms every P ms, 0:0 for none
+ *   -s N   Link seed (default 1)
+ * The options after -i override the profile.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "link_emulator.h"
+#include "transport.h"
+
+#define MAX_PAYLOAD         (LINK_EMULATOR_MTU - TRANSPORT_HEADER_SIZE)
+#define DRAIN_LIMIT_MS      600000      // Give up on a run that never drains
+
+typedef struct {
+    uint32_t frames;
+    uint32_t payload;
+    uint32_t interval_ms;
+    LinkConfig_t link;
+} BenchConfig_t;
+
+// Profile fields set on the command line
+typedef struct {
+    float loss_pct;             // Negative: keep the profile's
+    int32_t delay_ms;
+    int32_t jitter_ms;
+    int32_t rate_bytes_per_s;
+    int32_t outage_period_ms;
+    int32_t outage_ms;
+    uint32_t seed;
+} Overrides_t;
+
+typedef struct {
+    uint32_t delivered;         // Distinct frames the receiver got intact
+    uint32_t corrupt;
+    uint32_t elapsed_ms;        // First offer to last delivery
+    uint32_t wire_bytes;        // Both directions
+    uint32_t p50_ms, p99_ms;    // Offer to first delivery
+    LinkStats_t link;           // Uplink
+    TransportStats_t transport;
+    TransportReceiver_t receiver;
+    float srtt_ms;
+    uint32_t rto_ms;
+} BenchResult_t;
+
+// Frame buffers: the transport holds one per frame in flight, as the network
+// task holds packet pool buffers
+typedef struct {
+    uint8_t buffers[TRANSPORT_WINDOW][TRANSPORT_HEADER_SIZE + MAX_PAYLOAD];
+    uint8_t* free_list[TRANSPORT_WINDOW];
+    uint32_t free_count;
+    LinkEmulator_t* uplink;
+    uint32_t now_ms;
+    uint32_t wire_bytes;
+} FramePool_t;
+
+static void pool_init(FramePool_t* pool) {
+    for (uint32_t i = 0; i < TRANSPORT_WINDOW; i++) {
+        pool->free_list[i] = pool->buffers[i];
+    }
+    pool->free_count = TRANSPORT_WINDOW;
+}
+
+static void pool_output(void* context, const uint8_t* frame, uint32_t length) {
+    FramePool_t* pool = (FramePool_t*)context;
+    pool->wire_bytes += length;
+    link_emulator_send(pool->uplink, frame, length, pool->now_ms);
+}
+
+static void pool_release(void* context, uint8_t* frame, bool delivered) {
+    FramePool_t* pool = (FramePool_t*)context;
+    (void)delivered;
+    pool->free_list[pool->free_count++] = frame;
+}
+
+// Payload: frame number, then a pattern derived from it
+static void fill_payload(uint8_t* payload, uint32_t length, uint32_t number) {
+    for (uint32_t i = 0; i < length; i++) {
+        payload[i] = (uint8_t)(number * 31u + i);
+    }
+    if (length >= 4) {
+        memcpy(payload, &number, 4);
+    }
+}
+
+static bool check_payload(const uint8_t* payload, uint32_t length, uint32_t expected_length,
+                          uint32_t frames, uint32_t* number) {
+    if (length != expected_length || length < 4) {
+        return false;
+    }
+    memcpy(number, payload, 4);
+    if (*number >= frames) {
+        return false;
+    }
+    for (uint32_t i = 4; i < length; i++) {
+        if (payload[i] != (uint8_t)(*number * 31u + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Offer-to-delivery percentiles over the frames that arrived
+static void latency_percentiles(const uint32_t* offered, const uint32_t* arrived, uint32_t frames,
+                                BenchResult_t* result) {
+    uint32_t* latency = malloc(frames * sizeof(uint32_t));
+    uint32_t n = 0;
+    if (latency == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        if (arrived[i] != UINT32_MAX) {
+            latency[n++] = arrived[i] - offered[i];
+        }
+    }
+    if (n > 0) {
+        qsort(latency, n, sizeof(uint32_t), compare_u32);
+        result->p50_ms = latency[(n - 1) / 2];
+        result->p99_ms = latency[(uint32_t)((n - 1) * 0.99)];
+    }
+    free(latency);
+}
+
+// One run; reliable selects the transport over fire-and-forget
+static void run(const BenchConfig_t* config, bool reliable, BenchResult_t* result) {
+    static FramePool_t pool;
+    static LinkEmulator_t uplink, downlink;
+    static uint8_t scratch[LINK_EMULATOR_MTU];
+    TransportSender_t sender;
+    uint32_t* offered = malloc(config->frames * sizeof(uint32_t));
+    uint32_t* arrived = malloc(config->frames * sizeof(uint32_t));
+
+    memset(result, 0, sizeof(*result));
+    if (offered == NULL || arrived == NULL) {
+        free(offered);
+        free(arrived);
+        return;
+    }
+    for (uint32_t i = 0; i < config->frames; i++) {
+        arrived[i] = UINT32_MAX;
+    }
+
+    // Both runs see the same loss pattern for the same traffic
+    LinkConfig_t down = config->link;
+    down.seed = config->link.seed * 2654435761u + 1;
+    link_emulator_init(&uplink, &config->link);
+    link_emulator_init(&downlink, &down);
+    pool_init(&pool);
+    pool.uplink = &uplink;
+    pool.wire_bytes = 0;
+    transport_sender_init(&sender, pool_output, pool_release, &pool);
+    transport_receiver_init(&result->receiver);
+
+    uint32_t next = 0;
+    uint32_t last_delivery = 0;
+    for (uint32_t now = 0; now < DRAIN_LIMIT_MS; now++) {
+        pool.now_ms = now;
+
+        // Offer on schedule; a full window holds the backlog back
+        while (next < config->frames && now >= next * config->interval_ms) {
+            if (reliable) {
+                if (pool.free_count == 0 || !transport_can_send(&sender)) {
+                    break;
+                }
+                uint8_t* frame = pool.free_list[--pool.free_count];
+                fill_payload(frame + TRANSPORT_HEADER_SIZE, config->payload, next);
+                offered[next] = now;
+                transport_send(&sender, frame, config->payload, now);
+            } else {
+                fill_payload(scratch, config->payload, next);
+                offered[next] = now;
+                pool.wire_bytes += config->payload;
+                link_emulator_send(&uplink, scratch, config->payload, now);
+            }
+            next++;
+        }
+
+        // Receiver side, acknowledgements back over the downlink
+        uint32_t length;
+        while ((length = link_emulator_receive(&uplink, now, scratch, sizeof(scratch))) > 0) {
+            const uint8_t* payload = scratch;
+            uint32_t payload_length = length;
+            if (reliable) {
+                uint8_t ack[TRANSPORT_ACK_SIZE];
+                uint32_t ack_length = transport_receive(&result->receiver, scratch, length, ack,
+                                                        &payload, &payload_length);
+                if (ack_length > 0) {
+                    pool.wire_bytes += ack_length;
+                    link_emulator_send(&downlink, ack, ack_length, now);
+                }
+                if (payload == NULL) {
+                    continue;
+                }
+            }
+            uint32_t number;
+            if (!check_payload(payload, payload_length, config->payload, config->frames, &number)) {
+                result->corrupt++;
+            } else if (arrived[number] == UINT32_MAX) {
+                arrived[number] = now;
+                result->delivered++;
+                last_delivery = now;
+            }
+        }
+        if (reliable) {
+            uint8_t ack[TRANSPORT_ACK_SIZE];
+            while ((length = link_emulator_receive(&downlink, now, ack, sizeof(ack))) > 0) {
+                transport_on_ack(&sender, ack, length, now);
+            }
+            transport_poll(&sender, now);
+        }
+
+        bool drained = reliable ? transport_in_flight(&sender) == 0
+                                : link_emulator_next_due(&uplink, now) == LINK_EMULATOR_IDLE;
+        if (next == config->frames && drained) {
+            break;
+        }
+    }
+
+    result->elapsed_ms = last_delivery;
+    result->wire_bytes = pool.wire_bytes;
+    result->link = uplink.stats;
+    result->transport = sender.stats;
+    result->srtt_ms = sender.srtt_ms;
+    result->rto_ms = sender.rto_ms;
+    latency_percentiles(offered, arrived, config->frames, result);
+    free(offered);
+    free(arrived);
+}
+
+static void report(const char* label, const BenchConfig_t* config, const BenchResult_t* result,
+                   bool reliable) {
+    double seconds = result->elapsed_ms > 0 ? result->elapsed_ms / 1000.0 : 1.0;
+    double payload = (double)result->delivered * config->payload;
+    printf("  %-9s delivered %5.1f%% | goodput %6.2f kB/s | wire/payload %.2f | latency p50 %u ms p99 %u ms",
+           label, 100.0 * result->delivered / config->frames, payload / seconds / 1000.0,
+           payload > 0 ? result->wire_bytes / payload : 0.0,
+           (unsigned)result->p50_ms, (unsigned)result->p99_ms);
+    if (result->corrupt > 0) {
+        printf(" | CORRUPT %u", (unsigned)result->corrupt);
+    }
+    printf("\n");
+    printf("            link: sent %u | lost %u (in bursts %u, %u bursts) | outage %u | queue %u | overflow %u\n",
+           (unsigned)result->link.sent, (unsigned)result->link.lost, (unsigned)result->link.burst_lost,
+           (unsigned)result->link.bursts, (unsigned)result->link.outage_dropped,
+           (unsigned)result->link.queue_dropped, (unsigned)result->link.overflowed);
+    if (reliable) {
+        printf("            retransmits %u (fast %u) | abandoned %u | duplicates %u | reordered %u"
+               " | srtt %.0f ms rto %u ms\n",
+               (unsigned)result->transport.retransmits, (unsigned)result->transport.fast_retransmits,
+               (unsigned)result->transport.frames_abandoned, (unsigned)result->receiver.duplicates,
+               (unsigned)result->link.reordered, result->srtt_ms, (unsigned)result->rto_ms);
+    }
+}
+
+static void describe(const char* name, const LinkConfig_t* link) {
+    printf("%s: loss %.1f%%", name, link->loss * 100.0f);
+    if (link->p_enter_burst > 0.0f) {
+        printf(" (bursts %.1f%% of frames at %.0f%% loss)",
+               100.0f * link->p_enter_burst / (link->p_enter_burst + link->p_exit_burst),
+               link->burst_loss * 100.0f);
+    }
+    printf(", delay %u ms + %s jitter %u ms%s", (unsigned)link->delay_ms,
+           link->jitter == LINK_JITTER_EXPONENTIAL ? "exponential" : "uniform",
+           (unsigned)link->jitter_ms, link->in_order ? " in order" : "");
+    if (link->rate_bytes_per_s > 0) {
+        printf(", %.1f kB/s", link->rate_bytes_per_s / 1000.0);
+    }
+    if (link->outage_period_ms > 0) {
+        printf(", out %u ms every %u ms", (unsigned)link->outage_ms, (unsigned)link->outage_period_ms);
+    }
+    printf("\n");
+}
+
+static bool bench(const char* name, const BenchConfig_t* config) {
+    BenchResult_t raw, reliable;
+    describe(name, &config->link);
+    run(config, false, &raw);
+    run(config, true, &reliable);
+    report("raw", config, &raw, false);
+    report("transport", config, &reliable, true);
+    return raw.corrupt == 0 && reliable.corrupt == 0;
+}
+
+static void apply(const Overrides_t* overrides, LinkConfig_t* link) {
+    if (overrides->loss_pct >= 0.0f) {
+        link->loss = overrides->loss_pct / 100.0f;
+    }
+    if (overrides->delay_ms >= 0) {
+        link->delay_ms = (uint32_t)overrides->delay_ms;
+    }
+    if (overrides->jitter_ms >= 0) {
+        link->jitter_ms = (uint32_t)overrides->jitter_ms;
+    }
+    if (overrides->rate_bytes_per_s >= 0) {
+        link->rate_bytes_per_s = (uint32_t)overrides->rate_bytes_per_s;
+        if (link->bucket_bytes < LINK_EMULATOR_MTU) {
+            link->bucket_bytes = LINK_EMULATOR_MTU;
+        }
+    }
+    if (overrides->outage_period_ms >= 0) {
+        link->outage_period_ms = (uint32_t)overrides->outage_period_ms;
+        link->outage_ms = (uint32_t)overrides->outage_ms;
+    }
+    link->seed = overrides->seed;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-P profile] [-n frames] [-p payload] [-i interval_ms] [-l loss_pct] "
+                    "[-d delay_ms] [-j jitter_ms] [-r bytes_per_s] [-o period_ms:length_ms] [-s seed]\n",
+            prog);
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig_t config = {
+        .frames = 5000,
+        .payload = 200,
+        .interval_ms = 10,
+    };
+    Overrides_t overrides = { -1.0f, -1, -1, -1, -1, -1, 1 };
+    const char* profile = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "P:n:p:i:l:d:j:r:o:s:h")) != -1) {
+        switch (opt) {
+            case 'P':
+                profile = optarg;
+                break;
+            case 'n':
+                config.frames = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                config.payload = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'i':
+                config.interval_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                overrides.loss_pct = strtof(optarg, NULL);
+                break;
+            case 'd':
+                overrides.delay_ms = (int32_t)strtol(optarg, NULL, 10);
+                break;
+            case 'j':
+                overrides.jitter_ms = (int32_t)strtol(optarg, NULL, 10);
+                break;
+            case 'r':
+                overrides.rate_bytes_per_s = (int32_t)strtol(optarg, NULL, 10);
+                break;
+            case 'o': {
+                char* end;
+                overrides.outage_period_ms = (int32_t)strtol(optarg, &end, 10);
+                overrides.outage_ms = *end == ':' ? (int32_t)strtol(end + 1, NULL, 10) : 0;
+                break;
+            }
+            case 's':
+                overrides.seed = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (config.frames == 0 || config.payload < 4 || config.payload > MAX_PAYLOAD) {
+        fprintf(stderr, "link_bench: need at least 1 frame and a payload of 4-%u bytes\n",
+                (unsigned)MAX_PAYLOAD);
+        return 1;
+    }
+    if (profile != NULL && !link_profile(profile, &config.link)) {
+        fprintf(stderr, "link_bench: unknown profile '%s'\n", profile);
+        return 1;
+    }
+    if (config.interval_ms == 0) {
+        config.interval_ms = 1;
+    }
+
+    printf("frames: %u of %u bytes every %u ms (offered %.1f kB/s), window %u, seed %u\n",
+           (unsigned)config.frames, (unsigned)config.payload, (unsigned)config.interval_ms,
+           config.payload / (double)config.interval_ms, (unsigned)TRANSPORT_WINDOW,
+           (unsigned)overrides.seed);
+
+    bool ok = true;
+    for (uint32_t i = 0; i < LINK_PROFILE_COUNT; i++) {
+        const char* name = profile != NULL ? profile : link_profile_names[i];
+        link_profile(name, &config.link);
+        apply(&overrides, &config.link);
+        ok = bench(name, &config) && ok;
+        if (profile != NULL) {
+            break;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+/**
+ * Metrics Reader - The running monitor's state from shared memory
+ *
+ * Attaches read-only to the seqlock-protected snapshot the RTOS build
+ * publishes (src/net/metrics_shm.h) and prints a summary line per interval,
+ * or the full sensor, task and stack tables. Reading costs the monitor
+ * nothing: no request, no formatting on its side, no lock it could wait on.
+ *
+ * With -b it measures the segment instead: a writer thread publishes into a
+ * private segment at a range of rates, from the monitor's own to flat out,
+ * while this thread reads it as fast as it can through the seqlock. A last
+ * run copies without the seqlock. Every snapshot read is checked for a torn
+ * (half-old, half-new) copy.
+ *
+ * Usage: metrics_reader [-n name] [-i interval_ms] [-c count] [-f] [-b seconds]
+ *   -n S   Segment name (default /turbine_metrics)
+ *   -i N   Milliseconds between reads (default 1000)
+ *   -c N   Reads before exiting (default: until interrupted)
+ *   -f     Full tables: sensors, tasks, stacks
+ *   -b N   Benchmark the seqlock for N seconds per writer rate
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "metrics_shm.h"
+#include "sensor_channels.h"
+
+#define SNAPSHOT_WORDS  (sizeof(MetricsSnapshot_t) / sizeof(uint32_t))
+
+static const char* const task_states[] = {
+    "Running", "Ready", "Blocked", "Suspended", "Deleted", "Invalid"
+};
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void sleep_ms(uint32_t ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void print_summary(const MetricsSnapshot_t* s, uint32_t publishes, uint32_t retries) {
+    printf("tick %8u up %5us | health %5.1f%% flags 0x%02x anomalies %u | cpu %3u%% idle %3u%%"
+           " | heap free %u (min %u) | isr %u/%u p99 %uus | mutex timeouts %u | %s%s"
+           " | publishes %u retries %u\n",
+           s->tick, s->uptime_seconds, s->health_score, s->anomaly_flags, s->anomaly_count,
+           s->cpu_usage_percent, s->idle_time_percent, s->heap_free, s->minimum_heap_free,
+           s->isr_processed, s->isr_interrupts, s->isr_latency.p99_us,
+           s->system_mutex_timeouts + s->threshold_mutex_timeouts,
+           s->network_connected ? "online" : "offline", s->emergency_stop ? " ESTOP" : "",
+           publishes, retries);
+}
+
+static void print_full(const MetricsSnapshot_t* s) {
+    printf("  Sensors:");
+    uint32_t channels = s->channel_count < CHANNEL_COUNT ? s->channel_count : CHANNEL_COUNT;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        printf(" %s %.*f %s%s", sensor_channels[ch].label, (int)sensor_channels[ch].decimals,
+               s->sensors[ch], sensor_channels[ch].unit,
+               (s->anomaly_flags & (1u << ch)) ? " (!)" : "");
+    }
+    printf("\n  %-16s %4s %-9s %4s %6s %12s %10s\n",
+           "Task", "Prio", "State", "CPU%", "Stack%", "Runtime", "Switches");
+    for (uint32_t i = 0; i < s->task_count && i < METRICS_MAX_TASKS; i++) {
+        const MetricsTask_t* t = &s->tasks[i];
+        printf("  %-16.*s %4u %-9s %4u %6u %12u %10u\n", METRICS_NAME_LEN, t->name, t->priority,
+               task_states[t->state < 5 ? t->state : 5], t->cpu_usage_percent,
+               t->stack_usage_percent, t->runtime, t->context_switches);
+    }
+    printf("  Sampler: %u samples, scheduler suspended %u us (max %u)\n", s->sampler_samples,
+           s->sampler_suspended_us, s->sampler_max_suspended_us);
+    printf("  %-16s %6s %6s %8s %6s %6s\n", "Stack", "Words", "Free", "Min free", "Used%", "Peak%");
+    for (uint32_t i = 0; i < s->stack_count && i < METRICS_MAX_STACKS; i++) {
+        const MetricsStack_t* t = &s->stacks[i];
+        printf("  %-16.*s %6u %6u %8u %6u %6u\n", METRICS_NAME_LEN, t->name, t->stack_size_words,
+               t->free_words, t->minimum_free_words, t->usage_percent, t->peak_usage_percent);
+    }
+    printf("  Mutex: system %u/%u/%u threshold %u/%u/%u (takes/gives/timeouts)"
+           " | Heap: %u allocs %u frees %u failed %u bytes (peak %u)"
+           " | Stack events: %u warn %u high %u critical %u overflow"
+           " | Power: %u idle %u sleep %ums saved %u%%\n",
+           s->system_mutex_takes, s->system_mutex_gives, s->system_mutex_timeouts,
+           s->threshold_mutex_takes, s->threshold_mutex_gives, s->threshold_mutex_timeouts,
+           s->allocations, s->deallocations, s->allocation_failures, s->bytes_allocated,
+           s->peak_usage, s->stack_warnings, s->stack_high_usage_events,
+           s->stack_critical_usage_events, s->stack_overflow_events, s->idle_entries,
+           s->sleep_entries, s->total_sleep_time_ms, s->power_savings_percent);
+}
+
+static int watch(const char* name, uint32_t interval_ms, uint32_t count, bool full) {
+    const MetricsSegment_t* segment = metrics_shm_open(name);
+    if (segment == NULL) {
+        fprintf(stderr, "metrics_reader: no segment %s of version %d (is turbine_monitor running?)\n",
+                name, METRICS_SHM_VERSION);
+        return 1;
+    }
+    for (uint32_t n = 0; count == 0 || n < count; n++) {
+        if (n > 0) {
+            sleep_ms(interval_ms);
+        }
+        MetricsSnapshot_t snapshot;
+        uint32_t retries = 0;
+        if (!metrics_shm_read(segment, &snapshot, METRICS_READ_TIMEOUT_MS, &retries)) {
+            printf("writer stuck mid-update (%u retries in %d ms)\n", retries, METRICS_READ_TIMEOUT_MS);
+            continue;
+        }
+        print_summary(&snapshot, metrics_shm_publishes(segment), retries);
+        if (full) {
+            print_full(&snapshot);
+        }
+        fflush(stdout);
+    }
+    metrics_shm_close(segment);
+    return 0;
+}
+
+// Benchmark: the writer stamps every word of the snapshot with one counter,
+// so a consistent copy has every word equal
+typedef struct {
+    MetricsSegment_t* segment;
+    double rate_hz;             // 0: flat out
+    volatile bool stop;
+    uint64_t writes;
+} Writer_t;
+
+// Paced by spinning; sleeps are too coarse for the faster rates
+static void* writer_thread(void* arg) {
+    Writer_t* writer = arg;
+    uint32_t stamp = 0;
+    double next = now_seconds();
+    while (!writer->stop) {
+        if (writer->rate_hz > 0.0) {
+            while (now_seconds() < next && !writer->stop) {
+            }
+            next += 1.0 / writer->rate_hz;
+        }
+        uint32_t* words = (uint32_t*)metrics_shm_begin(writer->segment);
+        stamp++;
+        for (uint32_t i = 0; i < SNAPSHOT_WORDS; i++) {
+            words[i] = stamp;
+        }
+        metrics_shm_end(writer->segment);
+        writer->writes++;
+    }
+    return NULL;
+}
+
+static bool torn(const MetricsSnapshot_t* snapshot) {
+    const uint32_t* words = (const uint32_t*)snapshot;
+    for (uint32_t i = 1; i < SNAPSHOT_WORDS; i++) {
+        if (words[i] != words[0]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void bench_run(const MetricsSegment_t* reader, Writer_t* writer, double rate_hz,
+                      double seconds, bool seqlock) {
+    pthread_t thread;
+    writer->rate_hz = rate_hz;
+    writer->stop = false;
+    writer->writes = 0;
+    pthread_create(&thread, NULL, writer_thread, writer);
+
+    uint64_t reads = 0, failed = 0, torn_reads = 0;
+    uint32_t retries = 0;
+    MetricsSnapshot_t snapshot;
+    double start = now_seconds();
+    double elapsed;
+    do {
+        for (uint32_t i = 0; i < 1000; i++) {
+            if (seqlock) {
+                if (!metrics_shm_read(reader, &snapshot, METRICS_READ_TIMEOUT_MS, &retries)) {
+                    failed++;
+                    continue;
+                }
+            } else {
+                memcpy(&snapshot, (const void*)&reader->snapshot, sizeof(snapshot));
+            }
+            reads++;
+            torn_reads += torn(&snapshot) ? 1 : 0;
+        }
+        elapsed = now_seconds() - start;
+    } while (elapsed < seconds);
+
+    writer->stop = true;
+    pthread_join(thread, NULL);
+    char label[32];
+    if (rate_hz > 0.0) {
+        snprintf(label, sizeof(label), "%s, %.0f Hz", seqlock ? "seqlock" : "plain copy", rate_hz);
+    } else {
+        snprintf(label, sizeof(label), "%s, flat out", seqlock ? "seqlock" : "plain copy");
+    }
+    printf("  %-22s reads %9.0f/s (%5.0f ns) | writes %9.0f/s | retries %.4f per read | failed %llu"
+           " | torn %llu (%.2f%%)\n",
+           label, reads / elapsed, elapsed * 1e9 / (double)reads, writer->writes / elapsed,
+           (double)retries / (double)reads, (unsigned long long)failed,
+           (unsigned long long)torn_reads, 100.0 * (double)torn_reads / (double)reads);
+}
+
+static int bench(double seconds) {
+    char name[64];
+    snprintf(name, sizeof(name), "/turbine_metrics_bench.%ld", (long)getpid());
+    Writer_t writer = { .segment = metrics_shm_create(name) };
+    const MetricsSegment_t* reader = writer.segment != NULL ? metrics_shm_open(name) : NULL;
+    if (reader == NULL) {
+        fprintf(stderr, "metrics_reader: cannot create %s\n", name);
+        metrics_shm_unlink(name);
+        return 1;
+    }
+    printf("snapshot %zu bytes, reader flat out, %.0f s per writer rate\n",
+           sizeof(MetricsSnapshot_t), seconds);
+    static const double rates_hz[] = { 10.0, 1000.0, 100000.0, 0.0 };
+    for (uint32_t i = 0; i < sizeof(rates_hz) / sizeof(rates_hz[0]); i++) {
+        bench_run(reader, &writer, rates_hz[i], seconds, true);
+    }
+    bench_run(reader, &writer, 1000.0, seconds, false);
+    bench_run(reader, &writer, 0.0, seconds, false);
+
+    metrics_shm_close(reader);
+    metrics_shm_close(writer.segment);
+    metrics_shm_unlink(name);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-n name] [-i interval_ms] [-c count] [-f] [-b seconds]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    const char* name = METRICS_SHM_NAME;
+    uint32_t interval_ms = 1000;
+    uint32_t count = 0;
+    bool full = false;
+    double bench_seconds = 0.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:i:c:fb:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                name = optarg;
+                break;
+            case 'i':
+                interval_ms = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                count = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'f':
+                full = true;
+                break;
+            case 'b':
+                bench_seconds = strtod(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (bench_seconds > 0.0) {
+        return bench(bench_seconds);
+    }
+    return watch(name, interval_ms, count, full);
+}
@@ -0,0 +1,354 @@
+/**
+ * MQTT Bench - QoS 1 publish rate and broker round trip
+ *
+ * Publishes telemetry-sized messages through the same MQTT publisher as the
+ * network task, to a broker on 127.0.0.1 (tools/mqtt_broker, or any MQTT
+ * 3.1.1 broker). Each configuration is a fresh connection. Up to a window of
+ * publishes are in flight. With coalescing, messages offered while the
+ * window is full are packed into one PUBLISH, newline separated. Reports
+ * publishes/s, messages/s, PUBLISH-to-PUBACK round trip and the latency from
+ * when a message is offered to its PUBACK.
+ *
+ * Usage: mqtt_bench [-p port] [-n messages] [-m bytes] [-r rate] [-w window] [-c]
+ *   -p N   Broker port (default 1883)
+ *   -n N   Messages per configuration (default 20000)
+ *   -m N   Message bytes (default 120, an exception report)
+ *   -r N   Messages offered per second, 0 for as fast as possible (default 0)
+ *   -w N   Only this window (1-MQTT_INFLIGHT); default: sweep 1, 2, 4, 8
+ *   -c     Only with coalescing; default: each window without, then 8 with
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "mqtt.h"
+
+#define POOL_SIZE           (MQTT_INFLIGHT + 1)     // The window plus an open batch
+#define BATCH_CAPACITY      1024
+#define TOPIC               "turbine/TURBINE_001/bench"
+#define CLIENT_ID           "mqtt_bench"
+#define STALL_LIMIT_S       30      // Give up on a run that stops making progress
+
+typedef struct {
+    uint32_t window;
+    bool coalesce;
+    uint32_t messages;
+    uint32_t message_bytes;
+    uint32_t rate;
+} RunConfig_t;
+
+// Pool of publish buffers; per buffer, what it carries
+typedef struct {
+    uint8_t buffers[POOL_SIZE][MQTT_HEADROOM + BATCH_CAPACITY];
+    uint32_t free_list[POOL_SIZE];
+    uint32_t free_count;
+    uint64_t first_offer_us[POOL_SIZE];     // Oldest message in the buffer
+    uint64_t published_us[POOL_SIZE];
+    uint32_t messages[POOL_SIZE];
+    int fd;
+    // Results
+    uint32_t acked_messages;
+    uint32_t lost_messages;
+    uint32_t* rtt_us;
+    uint32_t rtt_count;
+    uint32_t* latency_us;       // Per message
+    uint32_t latency_count;
+} Bench_t;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)(ts.tv_nsec / 1000);
+}
+
+static uint32_t now_ms(void) {
+    return (uint32_t)(now_us() / 1000);
+}
+
+static uint32_t buffer_index(Bench_t* bench, const uint8_t* buffer) {
+    return (uint32_t)((buffer - bench->buffers[0]) / sizeof(bench->buffers[0]));
+}
+
+static void bench_output(void* context, const uint8_t* data, uint32_t length) {
+    Bench_t* bench = (Bench_t*)context;
+    while (length > 0) {
+        ssize_t n = send(bench->fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        data += n;
+        length -= (uint32_t)n;
+    }
+}
+
+static void bench_release(void* context, uint8_t* buffer, bool delivered, uint32_t rtt_ms) {
+    Bench_t* bench = (Bench_t*)context;
+    uint32_t i = buffer_index(bench, buffer);
+    uint64_t now = now_us();
+    (void)rtt_ms;       // Milliseconds; measured here in microseconds instead
+    if (delivered) {
+        bench->rtt_us[bench->rtt_count++] = (uint32_t)(now - bench->published_us[i]);
+        for (uint32_t m = 0; m < bench->messages[i]; m++) {
+            bench->latency_us[bench->latency_count++] = (uint32_t)(now - bench->first_offer_us[i]);
+        }
+        bench->acked_messages += bench->messages[i];
+    } else {
+        bench->lost_messages += bench->messages[i];
+    }
+    bench->free_list[bench->free_count++] = i;
+}
+
+static int connect_broker(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    return fd;
+}
+
+// Take whatever the broker sent, waiting up to wait_ms for it
+static bool pump(Bench_t* bench, MqttPublisher_t* pub, int wait_ms) {
+    struct pollfd fd = { .fd = bench->fd, .events = POLLIN };
+    if (poll(&fd, 1, wait_ms) <= 0) {
+        return true;
+    }
+    uint8_t data[4096];
+    ssize_t n = recv(bench->fd, data, sizeof(data), MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        return false;
+    }
+    if (n > 0) {
+        mqtt_input(pub, data, (uint32_t)n, now_ms());
+    }
+    return !pub->parser.failed;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint32_t percentile(uint32_t* values, uint32_t n, double p) {
+    if (n == 0) {
+        return 0;
+    }
+    qsort(values, n, sizeof(uint32_t), compare_u32);
+    return values[(uint32_t)((n - 1) * p)];
+}
+
+// Publish the open batch once the window has room
+static void flush_batch(Bench_t* bench, MqttPublisher_t* pub, MqttBatch_t* batch, uint32_t window) {
+    if (batch->buffer != NULL && pub->in_flight < window) {
+        uint32_t i = buffer_index(bench, batch->buffer);
+        bench->published_us[i] = now_us();
+        bench->messages[i] = batch->messages;
+        mqtt_batch_flush(pub, batch, TOPIC, now_ms());
+    }
+}
+
+// One message into the pipeline: its own PUBLISH while the window has room,
+// else (coalescing) into the open batch. Returns false when it has to wait.
+static bool offer(Bench_t* bench, MqttPublisher_t* pub, MqttBatch_t* batch, const RunConfig_t* config,
+                  const uint8_t* message, uint64_t offered_us) {
+    flush_batch(bench, pub, batch, config->window);
+    bool room = pub->in_flight < config->window;
+    if (batch->buffer == NULL && room && bench->free_count > 0) {
+        uint32_t i = bench->free_list[--bench->free_count];
+        memcpy(bench->buffers[i] + MQTT_HEADROOM, message, config->message_bytes);
+        bench->first_offer_us[i] = offered_us;
+        bench->published_us[i] = now_us();
+        bench->messages[i] = 1;
+        mqtt_publish(pub, bench->buffers[i], TOPIC, config->message_bytes, 1, now_ms());
+        return true;
+    }
+    if (!config->coalesce) {
+        return false;
+    }
+    if (batch->buffer == NULL) {
+        if (bench->free_count == 0) {
+            return false;
+        }
+        uint32_t i = bench->free_list[--bench->free_count];
+        mqtt_batch_open(batch, bench->buffers[i], BATCH_CAPACITY);
+        bench->first_offer_us[i] = offered_us;
+    }
+    return mqtt_batch_add(batch, message, config->message_bytes);
+}
+
+static bool run(int port, const RunConfig_t* config) {
+    static Bench_t bench;
+    static MqttPublisher_t pub;
+    MqttBatch_t batch = { 0 };
+    uint8_t message[BATCH_CAPACITY];
+
+    memset(&bench, 0, sizeof(bench));
+    for (uint32_t i = 0; i < POOL_SIZE; i++) {
+        bench.free_list[i] = i;
+    }
+    bench.free_count = POOL_SIZE;
+    bench.rtt_us = malloc(config->messages * sizeof(uint32_t));
+    bench.latency_us = malloc(config->messages * sizeof(uint32_t));
+    bench.fd = connect_broker(port);
+    if (bench.fd < 0 || bench.rtt_us == NULL || bench.latency_us == NULL) {
+        fprintf(stderr, "mqtt_bench: cannot connect to 127.0.0.1:%d: %s\n", port, strerror(errno));
+        free(bench.rtt_us);
+        free(bench.latency_us);
+        return false;
+    }
+
+    mqtt_publisher_init(&pub, bench_output, bench_release, &bench);
+    mqtt_connect(&pub, CLIENT_ID, 60, now_ms());
+    uint64_t deadline = now_us() + 2000000u;
+    while (!pub.connected && pub.connack_code == 0 && now_us() < deadline && pump(&bench, &pub, 100)) {
+    }
+
+    for (uint32_t i = 0; i < config->message_bytes; i++) {
+        message[i] = (uint8_t)('a' + i % 26);
+    }
+
+    uint64_t start = now_us();
+    uint64_t last_progress = start;
+    uint32_t offered = 0;
+    bool ok = pub.connected;
+    while (ok && bench.acked_messages + bench.lost_messages < config->messages) {
+        uint64_t now = now_us();
+        uint64_t due = config->rate > 0 ? start + (uint64_t)offered * 1000000u / config->rate : now;
+        while (offered < config->messages && now >= due &&
+               offer(&bench, &pub, &batch, config, message, config->rate > 0 ? due : now)) {
+            offered++;
+            due = config->rate > 0 ? start + (uint64_t)offered * 1000000u / config->rate : now;
+        }
+        // Everything offered: a batch still open goes out as soon as it can
+        if (offered == config->messages) {
+            flush_batch(&bench, &pub, &batch, config->window);
+        }
+
+        uint32_t acked = bench.acked_messages;
+        int wait_ms = 0;
+        if (offered < config->messages && config->rate > 0 && pub.in_flight < config->window) {
+            wait_ms = (int)((due - now_us()) / 1000);
+        } else if (pub.in_flight > 0) {
+            wait_ms = 100;
+        }
+        ok = pump(&bench, &pub, wait_ms);
+        mqtt_poll(&pub, now_ms());
+        if (bench.acked_messages != acked) {
+            last_progress = now_us();
+        } else if (now_us() - last_progress > STALL_LIMIT_S * 1000000ull) {
+            fprintf(stderr, "mqtt_bench: no progress for %d s\n", STALL_LIMIT_S);
+            ok = false;
+        }
+    }
+    double seconds = (now_us() - start) / 1e6;
+    if (!pub.connected && bench.acked_messages == 0) {
+        fprintf(stderr, "mqtt_bench: broker refused the connection (code %u)\n", (unsigned)pub.connack_code);
+    }
+
+    uint8_t disconnect[2];
+    bench_output(&bench, disconnect, mqtt_encode_simple(disconnect, sizeof(disconnect), MQTT_DISCONNECT));
+    close(bench.fd);
+
+    char label[32];
+    snprintf(label, sizeof(label), "window %u%s", (unsigned)config->window,
+             config->coalesce ? " coalesced" : "");
+    double per_publish = pub.stats.publishes > 0 ? (double)pub.stats.messages / pub.stats.publishes : 0.0;
+    printf("  %-18s %8.0f publishes/s %8.0f msg/s (%4.1f per publish) | RTT p50 %5u us p99 %5u us"
+           " | offer-to-ack p50 %5u us p99 %6u us | resent %u lost %u\n",
+           label, pub.stats.publishes / seconds, bench.acked_messages / seconds, per_publish,
+           (unsigned)percentile(bench.rtt_us, bench.rtt_count, 0.50),
+           (unsigned)percentile(bench.rtt_us, bench.rtt_count, 0.99),
+           (unsigned)percentile(bench.latency_us, bench.latency_count, 0.50),
+           (unsigned)percentile(bench.latency_us, bench.latency_count, 0.99),
+           (unsigned)pub.stats.resent, (unsigned)bench.lost_messages);
+    free(bench.rtt_us);
+    free(bench.latency_us);
+    return ok;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-p port] [-n messages] [-m bytes] [-r rate] [-w window] [-c]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    int port = 1883;
+    RunConfig_t config = { .messages = 20000, .message_bytes = 120 };
+    uint32_t only_window = 0;
+    bool only_coalesced = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:m:r:w:ch")) != -1) {
+        switch (opt) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'n':
+                config.messages = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'm':
+                config.message_bytes = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                config.rate = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'w':
+                only_window = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                only_coalesced = true;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (config.messages == 0 || config.message_bytes == 0 || config.message_bytes > BATCH_CAPACITY ||
+        only_window > MQTT_INFLIGHT) {
+        fprintf(stderr, "mqtt_bench: need at least 1 message of 1-%u bytes and a window of 1-%u\n",
+                (unsigned)BATCH_CAPACITY, (unsigned)MQTT_INFLIGHT);
+        return 1;
+    }
+
+    printf("%u messages of %u bytes, %s, to 127.0.0.1:%d\n", (unsigned)config.messages,
+           (unsigned)config.message_bytes, config.rate > 0 ? "paced" : "as fast as acknowledged", port);
+    if (config.rate > 0) {
+        printf("offered %u msg/s\n", (unsigned)config.rate);
+    }
+
+    static const uint32_t windows[] = { 1, 2, 4, MQTT_INFLIGHT };
+    bool ok = true;
+    for (uint32_t i = 0; i < sizeof(windows) / sizeof(windows[0]) && ok; i++) {
+        config.window = only_window > 0 ? only_window : windows[i];
+        if (!only_coalesced) {
+            config.coalesce = false;
+            ok = run(port, &config);
+        }
+        if (ok && (only_coalesced || config.window == MQTT_INFLIGHT)) {
+            config.coalesce = true;
+            ok = run(port, &config);
+        }
+        if (only_window > 0) {
+            break;
+        }
+    }
+    return ok ? 0 : 1;
+}
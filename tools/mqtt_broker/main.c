@@ -0,0 +1,352 @@
+/**
+ * MQTT Broker - Local stand-in for the cloud endpoint
+ *
+ * Accepts MQTT 3.1.1 clients on a TCP port, acknowledges QoS 1 publishes,
+ * answers pings and counts what arrives: publishes, the newline-separated
+ * messages coalesced into them, payload bytes and DUP resends. It can drop a
+ * share of the publishes (neither counted nor acknowledged) so a publisher's
+ * resend path can be tested, and hold every PUBACK back to stand in for a
+ * wide-area round trip. No subscriptions, no retained messages, no TLS.
+ *
+ * Usage: mqtt_broker [-p port] [-d drop_pct] [-l ack_delay_ms] [-t seconds] [-s seed] [-q]
+ *   -p N   TCP port (default 1883)
+ *   -d P   Percent of QoS 1 publishes dropped (default 0)
+ *   -l N   Milliseconds each PUBACK is held back (default 0)
+ *   -t N   Exit after N seconds (default: until interrupted)
+ *   -s N   Drop seed (default 1)
+ *   -q     Print only the totals at exit, not every second
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "mqtt.h"
+
+#define MAX_CLIENTS     16
+#define DELAYED_ACKS    4096    // PUBACKs held back at once; beyond, sent at once
+
+typedef struct {
+    int fd;                     // -1 when the slot is free
+    MqttParser_t parser;
+    bool connected;             // CONNECT seen
+} Client_t;
+
+typedef struct {
+    uint64_t publishes;
+    uint64_t messages;
+    uint64_t payload_bytes;
+    uint64_t resends;           // DUP set
+    uint64_t dropped;
+    uint64_t connects;
+} BrokerStats_t;
+
+// A PUBACK waiting for its time, oldest first
+typedef struct {
+    Client_t* client;
+    int fd;                     // The client slot may have been reused since
+    uint16_t id;
+    double due_s;
+} DelayedAck_t;
+
+static volatile sig_atomic_t stop_requested;
+static Client_t clients[MAX_CLIENTS];
+static BrokerStats_t stats;
+static DelayedAck_t delayed[DELAYED_ACKS];
+static uint32_t delayed_head;
+static uint32_t delayed_count;
+static double ack_delay_s;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// xorshift32, as the link emulator
+static uint32_t next_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void send_all(Client_t* client, const uint8_t* data, uint32_t length) {
+    while (length > 0) {
+        ssize_t n = send(client->fd, data, length, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;     // The read side notices the closed connection
+        }
+        data += n;
+        length -= (uint32_t)n;
+    }
+}
+
+static void close_client(Client_t* client) {
+    close(client->fd);
+    client->fd = -1;
+}
+
+static void send_puback(Client_t* client, uint16_t id) {
+    uint8_t reply[4];
+    send_all(client, reply, mqtt_encode_puback(reply, sizeof(reply), id));
+}
+
+// PUBACK now, or queued for ack_delay_s; the delay is the same for all, so
+// the queue stays in time order
+static void acknowledge(Client_t* client, uint16_t id) {
+    if (ack_delay_s <= 0.0 || delayed_count == DELAYED_ACKS) {
+        send_puback(client, id);
+        return;
+    }
+    DelayedAck_t* ack = &delayed[(delayed_head + delayed_count++) % DELAYED_ACKS];
+    ack->client = client;
+    ack->fd = client->fd;
+    ack->id = id;
+    ack->due_s = now_s() + ack_delay_s;
+}
+
+// Send the PUBACKs that are due. Returns milliseconds until the next, or -1.
+static int send_due_acks(void) {
+    double now = now_s();
+    while (delayed_count > 0) {
+        DelayedAck_t* ack = &delayed[delayed_head];
+        if (ack->due_s > now) {
+            return (int)((ack->due_s - now) * 1000.0) + 1;
+        }
+        if (ack->client->fd == ack->fd) {
+            send_puback(ack->client, ack->id);
+        }
+        delayed_head = (delayed_head + 1) % DELAYED_ACKS;
+        delayed_count--;
+    }
+    return -1;
+}
+
+// Returns false when the client must be disconnected
+static bool handle_packet(Client_t* client, const MqttPacket_t* packet, float drop, uint32_t* rng) {
+    uint8_t reply[4];
+    switch (packet->type) {
+        case MQTT_CONNECT:
+            client->connected = true;
+            stats.connects++;
+            send_all(client, reply, mqtt_encode_connack(reply, sizeof(reply), 0));
+            return true;
+        case MQTT_PUBLISH: {
+            MqttPublish_t publish;
+            if (!client->connected || !mqtt_decode_publish(packet, &publish)) {
+                return false;
+            }
+            if (publish.qos == 1 && (float)(next_random(rng) >> 8) / 16777216.0f < drop) {
+                stats.dropped++;
+                return true;
+            }
+            stats.publishes++;
+            stats.payload_bytes += publish.payload_length;
+            stats.resends += publish.dup ? 1 : 0;
+            stats.messages++;
+            for (uint32_t i = 0; i < publish.payload_length; i++) {
+                stats.messages += publish.payload[i] == '\n' ? 1 : 0;
+            }
+            if (publish.qos == 1) {
+                acknowledge(client, publish.id);
+            }
+            return true;
+        }
+        case MQTT_PINGREQ:
+            send_all(client, reply, mqtt_encode_simple(reply, sizeof(reply), MQTT_PINGRESP));
+            return true;
+        case MQTT_DISCONNECT:
+            return false;
+        default:
+            return true;    // Nothing else is used by the publisher
+    }
+}
+
+static void read_client(Client_t* client, float drop, uint32_t* rng) {
+    uint8_t buffer[4096];
+    ssize_t n = recv(client->fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+        close_client(client);
+        return;
+    }
+    const uint8_t* data = buffer;
+    uint32_t length = (uint32_t)n;
+    while (length > 0) {
+        uint32_t taken = mqtt_parser_feed(&client->parser, data, length);
+        data += taken;
+        length -= taken;
+        MqttPacket_t packet;
+        while (mqtt_parser_next(&client->parser, &packet)) {
+            if (!handle_packet(client, &packet, drop, rng)) {
+                close_client(client);
+                return;
+            }
+        }
+        if (client->parser.failed || taken == 0) {
+            close_client(client);
+            return;
+        }
+    }
+}
+
+static void report(const char* label, const BrokerStats_t* now, const BrokerStats_t* before,
+                   double seconds) {
+    uint32_t open = 0;
+    for (uint32_t i = 0; i < MAX_CLIENTS; i++) {
+        open += clients[i].fd >= 0 ? 1 : 0;
+    }
+    printf("%-6s clients %u | publishes %8.0f/s | messages %8.0f/s | payload %8.1f kB/s"
+           " | resends %llu | dropped %llu\n",
+           label, (unsigned)open, (now->publishes - before->publishes) / seconds,
+           (now->messages - before->messages) / seconds,
+           (now->payload_bytes - before->payload_bytes) / seconds / 1000.0,
+           (unsigned long long)(now->resends - before->resends),
+           (unsigned long long)(now->dropped - before->dropped));
+    fflush(stdout);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-p port] [-d drop_pct] [-l ack_delay_ms] [-t seconds] [-s seed] [-q]\n",
+            prog);
+}
+
+int main(int argc, char* argv[]) {
+    int port = 1883;
+    float drop = 0.0f;
+    double run_s = 0.0;
+    uint32_t rng = 1;
+    bool quiet = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:d:l:t:s:qh")) != -1) {
+        switch (opt) {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'd':
+                drop = strtof(optarg, NULL) / 100.0f;
+                break;
+            case 'l':
+                ack_delay_s = strtod(optarg, NULL) / 1000.0;
+                break;
+            case 't':
+                run_s = strtod(optarg, NULL);
+                break;
+            case 's':
+                rng = (uint32_t)strtoul(optarg, NULL, 10);
+                rng = rng != 0 ? rng : 1;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (listener >= 0) {
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    }
+    if (listener < 0 || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listener, MAX_CLIENTS) != 0) {
+        fprintf(stderr, "mqtt_broker: cannot listen on 127.0.0.1:%d: %s\n", port, strerror(errno));
+        return 1;
+    }
+    for (uint32_t i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    printf("mqtt_broker: listening on 127.0.0.1:%d, dropping %.1f%% of QoS 1 publishes,"
+           " PUBACK after %.0f ms\n", port, drop * 100.0f, ack_delay_s * 1000.0);
+    fflush(stdout);
+
+    double start = now_s();
+    double last_report = start;
+    BrokerStats_t at_last_report = stats;
+    while (!stop_requested && (run_s <= 0.0 || now_s() - start < run_s)) {
+        struct pollfd fds[MAX_CLIENTS + 1];
+        Client_t* owners[MAX_CLIENTS + 1];
+        nfds_t count = 0;
+        fds[count].fd = listener;
+        fds[count].events = POLLIN;
+        owners[count++] = NULL;
+        for (uint32_t i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].fd >= 0) {
+                fds[count].fd = clients[i].fd;
+                fds[count].events = POLLIN;
+                owners[count++] = &clients[i];
+            }
+        }
+
+        int wait_ms = send_due_acks();
+        if (poll(fds, count, wait_ms >= 0 && wait_ms < 100 ? wait_ms : 100) > 0) {
+            for (nfds_t i = 1; i < count; i++) {
+                if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                    read_client(owners[i], drop, &rng);
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                int fd = accept(listener, NULL, NULL);
+                Client_t* slot = NULL;
+                for (uint32_t i = 0; i < MAX_CLIENTS && slot == NULL; i++) {
+                    slot = clients[i].fd < 0 ? &clients[i] : NULL;
+                }
+                if (fd >= 0 && slot == NULL) {
+                    close(fd);
+                } else if (fd >= 0) {
+                    slot->fd = fd;
+                    slot->connected = false;
+                    mqtt_parser_init(&slot->parser);
+                }
+            }
+        }
+
+        double now = now_s();
+        if (!quiet && now - last_report >= 1.0) {
+            char label[16];
+            snprintf(label, sizeof(label), "%.0fs", now - start);
+            report(label, &stats, &at_last_report, now - last_report);
+            at_last_report = stats;
+            last_report = now;
+        }
+    }
+
+    BrokerStats_t zero = {0};
+    double elapsed = now_s() - start;
+    report("total", &stats, &zero, elapsed > 0.0 ? elapsed : 1.0);
+    printf("       %llu connects, %llu publishes, %llu messages\n",
+           (unsigned long long)stats.connects, (unsigned long long)stats.publishes,
+           (unsigned long long)stats.messages);
+    for (uint32_t i = 0; i < MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            close_client(&clients[i]);
+        }
+    }
+    close(listener);
+    return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * Status Bench - Status server serialization and fan-out cost per client count
+ *
+ * Runs the status HTTP server from src/net in-process on 127.0.0.1, with a
+ * synthetic snapshot, and connects a number of /stream (Server-Sent Events)
+ * clients to it. Each frame is formatted once into the server's shared frame
+ * and committed to every client. Reports the time to serialize and the time
+ * to fan out per frame, and the events each client received, for a range of
+ * client counts. A last run adds a client that connects and never reads,
+ * which the server must drop without the others missing a frame.
+ *
+ * Usage: status_bench [-p port] [-n frames]
+ *   -p N   Port (default 18080)
+ *   -n N   Frames per run (default 2000)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "metrics_shm.h"
+#include "sensor_channels.h"
+#include "status_http.h"
+
+#define STALLED_RCVBUF  4096    // Small, so the stalled client's window closes early
+
+typedef struct {
+    int fd;
+    bool stalled;               // Never reads
+    uint32_t events;            // Complete SSE events ("\n\n")
+    char last;                  // Last byte received, for events split across reads
+    bool closed;
+} Client_t;
+
+static const char* channel_names[CHANNEL_COUNT];
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// A plausible monitor: ten tasks, eight stacks, every channel
+static void fill_snapshot(MetricsSnapshot_t* s) {
+    static const char* const tasks[] = {
+        "SafetyTask", "EmergencyLane", "SensorTask", "AnomalyTask", "NetworkTask",
+        "DashboardTask", "HttpTask", "IDLE", "Tmr Svc", "ISRTimer"
+    };
+    memset(s, 0, sizeof(*s));
+    s->channel_count = CHANNEL_COUNT;
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        s->sensors[ch] = sensor_channels[ch].nominal;
+    }
+    s->health_score = 97.5f;
+    s->task_count = sizeof(tasks) / sizeof(tasks[0]);
+    for (uint32_t i = 0; i < s->task_count; i++) {
+        strncpy(s->tasks[i].name, tasks[i], METRICS_NAME_LEN - 1);
+        s->tasks[i].priority = 6 - (i < 6 ? i : 6);
+        s->tasks[i].cpu_usage_percent = 3 * i;
+        s->tasks[i].stack_usage_percent = 20 + 5 * i;
+        s->tasks[i].runtime = 1000000u * (i + 1);
+    }
+    s->stack_count = 8;
+    for (uint32_t i = 0; i < s->stack_count; i++) {
+        strncpy(s->stacks[i].name, tasks[i], METRICS_NAME_LEN - 1);
+        s->stacks[i].stack_size_words = 1024;
+        s->stacks[i].free_words = 600 - 20 * i;
+        s->stacks[i].minimum_free_words = 500 - 20 * i;
+    }
+    s->isr_latency.p50_us = 12;
+    s->isr_latency.p99_us = 45;
+    s->isr_latency.max_us = 180;
+    s->heap_free = 40000;
+    s->minimum_heap_free = 36000;
+}
+
+static bool connect_stream(Client_t* client, uint16_t port, bool stalled) {
+    memset(client, 0, sizeof(*client));
+    client->stalled = stalled;
+    client->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (client->fd < 0) {
+        return false;
+    }
+    if (stalled) {
+        int size = STALLED_RCVBUF;
+        setsockopt(client->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    static const char request[] = "GET /stream HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (connect(client->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        send(client->fd, request, sizeof(request) - 1, 0) != (ssize_t)(sizeof(request) - 1)) {
+        close(client->fd);
+        return false;
+    }
+    return true;
+}
+
+static void drain(Client_t* client) {
+    char buffer[16384];
+    while (!client->stalled && !client->closed) {
+        ssize_t n = recv(client->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            client->closed = true;
+            return;
+        }
+        if (n < 0) {
+            return;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            client->events += client->last == '\n' && buffer[i] == '\n' ? 1 : 0;
+            client->last = buffer[i];
+        }
+    }
+}
+
+static uint32_t monotonic_ms(void) {
+    return (uint32_t)(now_seconds() * 1000.0);
+}
+
+static int run(uint16_t port, uint32_t frames, uint32_t readers, bool with_stalled) {
+    static StatusHttp_t server;
+    if (!status_http_open(&server, port, NULL)) {
+        fprintf(stderr, "status_bench: cannot listen on 127.0.0.1:%u\n", (unsigned)port);
+        return 1;
+    }
+    Client_t clients[STATUS_HTTP_MAX_CLIENTS];
+    uint32_t count = readers + (with_stalled ? 1 : 0);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!connect_stream(&clients[i], port, with_stalled && i == count - 1)) {
+            fprintf(stderr, "status_bench: cannot connect client %u\n", (unsigned)i);
+            return 1;
+        }
+    }
+    // Accept and parse every request before the first frame
+    for (uint32_t i = 0; i < 100 && server.stats.streams < count; i++) {
+        status_http_poll(&server, monotonic_ms());
+        nanosleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL);
+    }
+
+    MetricsSnapshot_t snapshot;
+    fill_snapshot(&snapshot);
+    double serialize_s = 0.0, fanout_s = 0.0;
+    uint32_t stalled_dropped_at = 0;
+    for (uint32_t f = 0; f < frames; f++) {
+        snapshot.tick = f * 1000;
+        snapshot.uptime_seconds = f;
+        snapshot.sensors[0] += 0.001f;
+
+        double t0 = now_seconds();
+        uint32_t capacity;
+        char* frame = status_http_begin(&server, &capacity);
+        uint32_t length = metrics_snapshot_json(&snapshot, channel_names, frame, capacity);
+        double t1 = now_seconds();
+        status_http_commit(&server, length);
+        double t2 = now_seconds();
+        serialize_s += t1 - t0;
+        fanout_s += t2 - t1;
+
+        status_http_poll(&server, monotonic_ms());
+        for (uint32_t i = 0; i < count; i++) {
+            drain(&clients[i]);
+        }
+        if (with_stalled && stalled_dropped_at == 0 && server.stats.dropped_slow > 0) {
+            stalled_dropped_at = f + 1;
+        }
+    }
+
+    uint32_t min_events = frames, max_events = 0;
+    for (uint32_t i = 0; i < readers; i++) {
+        min_events = clients[i].events < min_events ? clients[i].events : min_events;
+        max_events = clients[i].events > max_events ? clients[i].events : max_events;
+    }
+    printf("  %u reader%s%s  frame %4u bytes | serialize %5.2f us | fan-out %6.2f us (%5.2f per client)"
+           " | events per reader %u-%u of %u",
+           (unsigned)readers, readers == 1 ? " " : "s", with_stalled ? " + stalled" : "          ",
+           (unsigned)server.json_length, serialize_s * 1e6 / frames, fanout_s * 1e6 / frames,
+           count > 0 ? fanout_s * 1e6 / frames / count : 0.0, (unsigned)(readers > 0 ? min_events : 0),
+           (unsigned)max_events, (unsigned)frames);
+    if (with_stalled) {
+        printf(" | stalled dropped at frame %u", (unsigned)stalled_dropped_at);
+    }
+    printf("\n");
+
+    for (uint32_t i = 0; i < count; i++) {
+        close(clients[i].fd);
+    }
+    status_http_close(&server);
+    return readers > 0 && min_events != frames ? 1 : 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-p port] [-n frames]\n", prog);
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = 18080;
+    uint32_t frames = 2000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:h")) != -1) {
+        switch (opt) {
+            case 'p':
+                port = (uint16_t)atoi(optarg);
+                break;
+            case 'n':
+                frames = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    for (uint32_t ch = 0; ch < CHANNEL_COUNT; ch++) {
+        channel_names[ch] = sensor_channels[ch].name;
+    }
+
+    printf("%u frames per run, as fast as they can be formatted and sent, to 127.0.0.1:%u\n",
+           (unsigned)frames, (unsigned)port);
+    static const uint32_t reader_counts[] = { 0, 1, 2, 4, 7 };
+    int failed = 0;
+    for (uint32_t i = 0; i < sizeof(reader_counts) / sizeof(reader_counts[0]); i++) {
+        failed |= run(port, frames, reader_counts[i], false);
+    }
+    failed |= run(port, frames, STATUS_HTTP_MAX_CLIENTS - 1, true);
+    return failed;
+}